@@ -0,0 +1,50 @@
+#include "AllocCounter.h"
+
+#include <atomic>
+
+namespace {
+  std::atomic<uint32_t> s_allocs{0};
+  uint32_t s_loopStart = 0;
+  AllocLoopStats s_loop;
+}
+
+#if defined(CONFIG_HEAP_USE_HOOKS)
+// Called by the heap for every successful allocation, from any task and also
+// while the flash cache is disabled, hence IRAM and no locking.
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+  (void)ptr; (void)size; (void)caps;
+  s_allocs.fetch_add(1, std::memory_order_relaxed);
+}
+
+extern "C" void IRAM_ATTR esp_heap_trace_free_hook(void* ptr) {
+  (void)ptr;
+}
+#endif
+
+bool allocCounterSupported() {
+#if defined(CONFIG_HEAP_USE_HOOKS)
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint32_t allocCounterGet() {
+  return s_allocs.load(std::memory_order_relaxed);
+}
+
+void allocCounterLoopBegin() {
+  s_loopStart = allocCounterGet();
+}
+
+void allocCounterLoopEnd() {
+  const uint32_t n = allocCounterGet() - s_loopStart;
+  s_loop.lastPerLoop = n;
+  if (n > s_loop.maxPerLoop) s_loop.maxPerLoop = n;
+  s_loop.avgPerLoop = s_loop.loops ? (s_loop.avgPerLoop * 0.99f + (float)n * 0.01f) : (float)n;
+  s_loop.loops++;
+}
+
+AllocLoopStats allocCounterGetLoopStats() {
+  return s_loop;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Heap allocation counter for loop diagnostics.
+// Counts every malloc/calloc/realloc served by the ESP-IDF heap through its
+// allocation hooks (CONFIG_HEAP_USE_HOOKS). All tasks are counted, so WiFi /
+// lwIP traffic adds some noise. Without hook support in the core,
+// allocCounterSupported() returns false and the counters stay at 0.
+
+struct AllocLoopStats {
+  uint32_t lastPerLoop = 0;
+  uint32_t maxPerLoop = 0;
+  float avgPerLoop = 0.0f; // exponential moving average
+  uint32_t loops = 0;
+};
+
+bool allocCounterSupported();
+uint32_t allocCounterGet();
+
+// Bracket one pass of loop().
+void allocCounterLoopBegin();
+void allocCounterLoopEnd();
+AllocLoopStats allocCounterGetLoopStats();
@@ -5,11 +5,35 @@
 
 #include <NimBLEDevice.h>
 
+#include "OpenThermMailbox.h"
+#include "TaskDomains.h"
+
 namespace {
   static BleConfig g_cfg;
   static BleStatus g_st;
   static BleMeteoData g_meteo;
 
+  // What bleGetMeteo() / bleFillFastJson() read: published at the end of
+  // every bleLoop() and on reconfiguration, so web / MQTT pushes and the
+  // temperature registry read it without taking IoLock (TaskDomains.h).
+  // Everything else here belongs to the I/O domain.
+  struct BleFast {
+    bool enabled;
+    bool scanning;
+    bool connected;
+    BleMeteoData meteo;
+  };
+  OtSnapshot<BleFast> g_fast;
+
+  static void publishFast() {
+    BleFast f;
+    f.enabled = g_cfg.enabled;
+    f.scanning = g_st.scanning;
+    f.connected = g_st.connected;
+    f.meteo = g_meteo;
+    g_fast.publish(f);
+  }
+
   static NimBLEScan* g_scan = nullptr;
   static NimBLEClient* g_client = nullptr;
   static NimBLERemoteCharacteristic* g_ch = nullptr;
@@ -238,9 +262,10 @@ namespace {
 void bleInit() {
   g_st.enabled = g_cfg.enabled;
   if (g_cfg.enabled) ensureInit();
+  publishFast();
 }
 
-void bleLoop() {
+static void bleStep() {
   g_st.enabled = g_cfg.enabled;
 
   if (!g_cfg.enabled) {
@@ -298,7 +323,13 @@ void bleLoop() {
   }
 }
 
+void bleLoop() {
+  bleStep();
+  publishFast();
+}
+
 void bleApplyConfig(const String& json) {
+  IoLock lock;
   StaticJsonDocument<512> doc;
   if (deserializeJson(doc, json)) return;
   JsonObjectConst o = doc.as<JsonObjectConst>();
@@ -322,13 +353,23 @@ void bleApplyConfig(const String& json) {
   } else {
     g_nextScanMs = millis() + 200;
   }
+  publishFast();
+}
+
+BleConfig bleGetConfig() {
+  IoLock lock;
+  return g_cfg;
+}
+
+BleStatus bleGetStatus() {
+  IoLock lock;
+  return g_st;
 }
 
-BleConfig bleGetConfig() { return g_cfg; }
-BleStatus bleGetStatus() { return g_st; }
-BleMeteoData bleGetMeteo() { return g_meteo; }
+BleMeteoData bleGetMeteo() { return g_fast.read().meteo; }
 
 String bleGetStatusJson() {
+  IoLock lock;
   DynamicJsonDocument doc(768);
   doc["ok"] = true;
   doc["en"] = g_cfg.enabled;
@@ -358,16 +399,18 @@ String bleGetStatusJson() {
 }
 
 void bleFillFastJson(JsonObject& out) {
-  out["en"] = g_cfg.enabled;
-  out["sc"] = g_st.scanning;
-  out["cn"] = g_st.connected;
-  if (g_meteo.valid && isfinite(g_meteo.tempC)) out["t"] = g_meteo.tempC;
+  const BleFast f = g_fast.read();
+  const BleMeteoData& m = f.meteo;
+  out["en"] = f.enabled;
+  out["sc"] = f.scanning;
+  out["cn"] = f.connected;
+  if (m.valid && isfinite(m.tempC)) out["t"] = m.tempC;
   else out["t"] = nullptr;
-  if (g_meteo.valid && g_meteo.humidityPct >= 0) out["h"] = g_meteo.humidityPct;
+  if (m.valid && m.humidityPct >= 0) out["h"] = m.humidityPct;
   else out["h"] = nullptr;
-  if (g_meteo.valid && isfinite(g_meteo.pressureHpa)) out["p"] = g_meteo.pressureHpa;
+  if (m.valid && isfinite(m.pressureHpa)) out["p"] = m.pressureHpa;
   else out["p"] = nullptr;
-  out["ms"] = g_meteo.lastUpdateMs;
+  out["ms"] = m.lastUpdateMs;
 }
 
 #else
@@ -38,6 +38,8 @@ void bleInit();
 void bleLoop();
 void bleApplyConfig(const String& json);
 
+// bleLoop() runs on the I/O task. bleGetMeteo() and bleFillFastJson() read a
+// snapshot published by it; the other calls take IoLock (TaskDomains.h).
 BleConfig bleGetConfig();
 BleStatus bleGetStatus();
 BleMeteoData bleGetMeteo();
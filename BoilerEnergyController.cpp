@@ -0,0 +1,501 @@
+#include "BoilerEnergyController.h"
+
+#include <LittleFS.h>
+#include <time.h>
+
+#include "FsController.h"
+#include "NetworkController.h"
+#include "OpenThermController.h"
+#include "OpenThermMailbox.h"
+#include "TaskDomains.h"
+
+namespace {
+  // Data-IDs 116..123: burner / CH pump / DHW pump+valve / DHW burner starts,
+  // then the same four as operation hours. All are 16-bit running totals.
+  static constexpr uint8_t kCounterFirstId = 116;
+  static constexpr uint8_t kCounterCount = 8;
+  static constexpr uint32_t kCounterMaxAgeMs = 10UL * 60UL * 1000UL;
+  static constexpr uint32_t kCounterValidMs = 30UL * 60UL * 1000UL;
+  // ID116 jumps larger than this are a counter reset (service), not starts.
+  static constexpr uint16_t kMaxStartsDelta = 1000;
+
+  static constexpr uint32_t kSampleMs = 1000;
+  static constexpr uint32_t kMaxSampleGapMs = 10000;
+  static constexpr uint32_t kTelemetryMaxAgeMs = 30000;
+  static constexpr uint32_t kFlushMs = 60000;
+  static constexpr uint32_t kSaveMs = 30UL * 60UL * 1000UL;
+  static constexpr uint8_t kHourSlots = 12; // 5 min each
+
+  // Persistent ring: kSlots fixed-size records in one file, written round-robin.
+  // A torn write only damages the slot being written; load picks the valid
+  // record with the highest sequence number.
+  static constexpr const char* kRingPath = "/ot_energy.bin";
+  static constexpr uint8_t kSlots = 8;
+  static constexpr uint32_t kMagic = 0x4E45544FUL; // "OTEN"
+  static constexpr uint16_t kVersion = 1;
+
+  struct EnergyBucket {
+    uint32_t wh = 0;
+    uint16_t starts = 0;
+    uint16_t flameMin = 0;
+  };
+
+  struct EnergyRecord {
+    uint32_t magic = kMagic;
+    uint16_t version = kVersion;
+    uint16_t size = sizeof(EnergyRecord);
+    uint32_t seq = 0;
+    // Key of the newest bucket (last array element), 0 = wall clock not seen yet.
+    int32_t dayKey = 0;   // local days since 1970-01-01
+    int32_t weekKey = 0;  // dayKey of that week's Monday
+    int32_t monthKey = 0; // year * 12 + month (0..11)
+    EnergyBucket days[kBoilerEnergyDays];
+    EnergyBucket weeks[kBoilerEnergyWeeks];
+    EnergyBucket months[kBoilerEnergyMonths];
+    uint64_t totalWh = 0;
+    uint16_t lastStartsRaw = 0;
+    uint8_t lastStartsValid = 0;
+    uint8_t reserved = 0;
+    uint32_t check = 0;
+  };
+
+  EnergyRecord g_rec;
+  bool g_inited = false;
+  bool g_dirty = false;
+  uint8_t g_nextSlot = 0;
+  uint32_t g_revision = 0;
+  uint32_t g_saveCount = 0;
+  uint32_t g_lastSaveMs = 0;
+
+  uint32_t g_lastSampleMs = 0;
+  uint32_t g_lastFlushMs = 0;
+  float g_pendingWh = 0.0f;
+  uint32_t g_pendingFlameMs = 0;
+  uint16_t g_pendingEdges = 0;
+  bool g_lastFlame = false;
+  float g_powerKw = 0.0f;
+  float g_maxKw = 9.0f;
+
+  uint16_t g_counters[kCounterCount] = {0};
+  uint8_t g_counterValid = 0; // bit per counter
+  uint32_t g_startsSeenMs = 0;
+
+  uint8_t g_hourEdges[kHourSlots] = {0};
+  uint32_t g_hourSlotKey = 0;
+
+  // What boilerEnergyGetStatus() / FillFastJson() / SeriesRevision() read:
+  // published after every sample, so the web and MQTT pushes read it without
+  // taking IoLock (TaskDomains.h). Everything else here belongs to the I/O
+  // domain.
+  struct PublishedEnergy {
+    BoilerEnergyStatus status;
+    uint32_t revision;
+  };
+  OtSnapshot<PublishedEnergy> g_pub;
+
+  static uint32_t recordCheck(const EnergyRecord& r) {
+    // FNV-1a over everything before the check field.
+    const uint8_t* p = (const uint8_t*)&r;
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < offsetof(EnergyRecord, check); i++) {
+      h ^= p[i];
+      h *= 16777619UL;
+    }
+    return h;
+  }
+
+  static bool recordValid(const EnergyRecord& r) {
+    return r.magic == kMagic && r.version == kVersion && r.size == sizeof(EnergyRecord) && r.check == recordCheck(r);
+  }
+
+  static void ringLoad() {
+    if (!fsInit()) return;
+    fsLock();
+    File f = LittleFS.open(kRingPath, "r");
+    if (f) {
+      EnergyRecord tmp;
+      bool found = false;
+      for (uint8_t s = 0; s < kSlots; s++) {
+        if (f.read((uint8_t*)&tmp, sizeof(tmp)) != sizeof(tmp)) break;
+        if (!recordValid(tmp)) continue;
+        if (!found || (int32_t)(tmp.seq - g_rec.seq) > 0) {
+          g_rec = tmp;
+          g_nextSlot = (uint8_t)((s + 1) % kSlots);
+          found = true;
+        }
+      }
+      f.close();
+      if (found) {
+        Serial.printf("[ENERGY] loaded seq %u, total %.1f kWh\n", (unsigned)g_rec.seq, (double)g_rec.totalWh / 1000.0);
+      }
+    }
+    fsUnlock();
+  }
+
+  static bool ringSave() {
+    if (!fsInit()) return false;
+    g_rec.seq++;
+    g_rec.check = recordCheck(g_rec);
+    fsLock();
+    // "r+" keeps the other slots; a missing or short file is (re)created with "w".
+    File f = LittleFS.exists(kRingPath) ? LittleFS.open(kRingPath, "r+") : File();
+    if (!f || f.size() < (size_t)kSlots * sizeof(EnergyRecord)) {
+      if (f) f.close();
+      f = LittleFS.open(kRingPath, "w");
+      if (f) {
+        const EnergyRecord blank{};
+        for (uint8_t s = 0; s < kSlots; s++) f.write((const uint8_t*)&blank, sizeof(blank));
+      }
+    }
+    bool ok = false;
+    if (f) {
+      ok = f.seek((uint32_t)g_nextSlot * sizeof(EnergyRecord)) &&
+           f.write((const uint8_t*)&g_rec, sizeof(g_rec)) == sizeof(g_rec);
+      f.close();
+    }
+    fsUnlock();
+    if (!ok) {
+      Serial.println(F("[ENERGY] ring write failed"));
+      return false;
+    }
+    g_nextSlot = (uint8_t)((g_nextSlot + 1) % kSlots);
+    g_dirty = false;
+    g_saveCount++;
+    g_lastSaveMs = millis();
+    g_revision++;
+    return true;
+  }
+
+  // Days since 1970-01-01 for a proleptic Gregorian date (m = 1..12).
+  static int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+    y -= m <= 2;
+    const int32_t era = (y >= 0 ? y : y - 399) / 400;
+    const uint32_t yoe = (uint32_t)(y - era * 400);
+    const uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+  }
+
+  static void civilFromDays(int32_t z, int32_t& y, uint32_t& m, uint32_t& d) {
+    z += 719468;
+    const int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const uint32_t doe = (uint32_t)(z - era * 146097);
+    const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const uint32_t mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int32_t)yoe + era * 400 + (m <= 2);
+  }
+
+  static bool localKeys(int32_t& day, int32_t& week, int32_t& month) {
+    if (!networkIsTimeValid()) return false;
+    const time_t now = (time_t)networkGetTimeEpoch();
+    if (now <= (time_t)1672531200) return false;
+    struct tm tmv{};
+    localtime_r(&now, &tmv);
+    day = daysFromCivil(tmv.tm_year + 1900, (uint32_t)tmv.tm_mon + 1, (uint32_t)tmv.tm_mday);
+    week = day - ((tmv.tm_wday + 6) % 7);
+    month = (tmv.tm_year + 1900) * 12 + tmv.tm_mon;
+    return true;
+  }
+
+  // Moves the series forward by `steps` buckets (gaps become empty buckets).
+  static void shiftSeries(EnergyBucket* arr, uint8_t n, int32_t steps) {
+    if (steps <= 0) return;
+    if (steps >= n) {
+      for (uint8_t i = 0; i < n; i++) arr[i] = EnergyBucket{};
+      return;
+    }
+    memmove(arr, arr + steps, (size_t)(n - steps) * sizeof(EnergyBucket));
+    for (uint8_t i = (uint8_t)(n - steps); i < n; i++) arr[i] = EnergyBucket{};
+  }
+
+  // Returns true when a bucket boundary was crossed. A clock stepping back
+  // keeps adding to the newest buckets.
+  static bool rollBuckets() {
+    int32_t day, week, month;
+    if (!localKeys(day, week, month)) return false;
+    if (!g_rec.dayKey) {
+      // First valid wall clock: energy counted so far belongs to the current buckets.
+      g_rec.dayKey = day;
+      g_rec.weekKey = week;
+      g_rec.monthKey = month;
+      g_dirty = true;
+      return false;
+    }
+    bool rolled = false;
+    if (day > g_rec.dayKey) {
+      shiftSeries(g_rec.days, kBoilerEnergyDays, day - g_rec.dayKey);
+      g_rec.dayKey = day;
+      rolled = true;
+    }
+    if (week > g_rec.weekKey) {
+      shiftSeries(g_rec.weeks, kBoilerEnergyWeeks, (week - g_rec.weekKey) / 7);
+      g_rec.weekKey = week;
+      rolled = true;
+    }
+    if (month > g_rec.monthKey) {
+      shiftSeries(g_rec.months, kBoilerEnergyMonths, month - g_rec.monthKey);
+      g_rec.monthKey = month;
+      rolled = true;
+    }
+    return rolled;
+  }
+
+  static void addToBuckets(uint32_t wh, uint16_t starts, uint16_t flameMin) {
+    EnergyBucket* newest[] = {
+      &g_rec.days[kBoilerEnergyDays - 1],
+      &g_rec.weeks[kBoilerEnergyWeeks - 1],
+      &g_rec.months[kBoilerEnergyMonths - 1],
+    };
+    for (EnergyBucket* b : newest) {
+      b->wh += wh;
+      b->starts = (uint16_t)((uint32_t)b->starts + starts > 0xFFFF ? 0xFFFF : b->starts + starts);
+      b->flameMin = (uint16_t)((uint32_t)b->flameMin + flameMin > 0xFFFF ? 0xFFFF : b->flameMin + flameMin);
+    }
+    g_rec.totalWh += wh;
+    if (wh || starts || flameMin) g_dirty = true;
+  }
+
+  static void noteHourEdge(uint32_t now, bool edge) {
+    const uint32_t key = now / 300000UL;
+    if (key != g_hourSlotKey) {
+      const uint32_t steps = key - g_hourSlotKey;
+      for (uint32_t i = 1; i <= steps && i <= kHourSlots; i++) g_hourEdges[(g_hourSlotKey + i) % kHourSlots] = 0;
+      g_hourSlotKey = key;
+    }
+    if (edge && g_hourEdges[key % kHourSlots] < 0xFF) g_hourEdges[key % kHourSlots]++;
+  }
+
+  static uint16_t startsLastHour() {
+    noteHourEdge(millis(), false);
+    uint16_t n = 0;
+    for (uint8_t i = 0; i < kHourSlots; i++) n += g_hourEdges[i];
+    return n;
+  }
+
+  static void sample(uint32_t now) {
+    const OpenThermTelemetry ot = openthermGetTelemetry();
+    const bool fresh = ot.present && ot.ready && ot.lastUpdateMs &&
+                       (uint32_t)(now - ot.lastUpdateMs) <= kTelemetryMaxAgeMs;
+    const bool flame = fresh && ot.flameOn;
+    float kw = 0.0f;
+    if (flame && isfinite(ot.modulationPct)) {
+      const float pct = ot.modulationPct < 0.0f ? 0.0f : (ot.modulationPct > 100.0f ? 100.0f : ot.modulationPct);
+      kw = pct / 100.0f * g_maxKw;
+    }
+    g_powerKw = kw;
+
+    uint32_t dt = g_lastSampleMs ? (uint32_t)(now - g_lastSampleMs) : 0;
+    if (dt > kMaxSampleGapMs) dt = kMaxSampleGapMs;
+    g_lastSampleMs = now;
+    g_pendingWh += kw * (float)dt / 3600.0f; // kW * ms / 3600 = Wh
+    if (flame) g_pendingFlameMs += dt;
+
+    const bool edge = flame && !g_lastFlame;
+    if (edge) g_pendingEdges++;
+    noteHourEdge(now, edge);
+    g_lastFlame = flame;
+  }
+
+  static void readCounters(uint32_t now) {
+    for (uint8_t i = 0; i < kCounterCount; i++) {
+      uint16_t raw = 0;
+      if (!openthermGetDataIdValue((uint8_t)(kCounterFirstId + i), raw, kCounterValidMs, nullptr)) continue;
+      g_counters[i] = raw;
+      g_counterValid |= (uint8_t)(1u << i);
+    }
+    uint16_t starts = 0;
+    uint32_t ageMs = 0;
+    if (openthermGetDataIdValue(kCounterFirstId, starts, kCounterValidMs, &ageMs)) {
+      g_startsSeenMs = now - ageMs;
+    }
+  }
+
+  static bool countersActive(uint32_t now) {
+    return (g_counterValid & 1u) && g_startsSeenMs && (uint32_t)(now - g_startsSeenMs) <= kCounterValidMs;
+  }
+
+  static void flush(uint32_t now) {
+    readCounters(now);
+    g_maxKw = openthermGetAssumedMaxBoilerKw();
+    if (!isfinite(g_maxKw) || g_maxKw < 1.0f) g_maxKw = 1.0f;
+
+    // Burner starts come from the boiler's own counter (ID116) when it
+    // answers; otherwise from flame off->on transitions seen in the telemetry.
+    uint16_t starts = 0;
+    if (countersActive(now)) {
+      const uint16_t raw = g_counters[0];
+      if (g_rec.lastStartsValid) {
+        const uint16_t delta = (uint16_t)(raw - g_rec.lastStartsRaw);
+        if (delta <= kMaxStartsDelta) starts = delta;
+      }
+      if (!g_rec.lastStartsValid || raw != g_rec.lastStartsRaw) g_dirty = true;
+      g_rec.lastStartsRaw = raw;
+      g_rec.lastStartsValid = 1;
+    } else {
+      starts = g_pendingEdges;
+    }
+    g_pendingEdges = 0;
+
+    const bool rolled = rollBuckets();
+    const uint32_t wh = (uint32_t)g_pendingWh;
+    g_pendingWh -= (float)wh;
+    const uint16_t flameMin = (uint16_t)(g_pendingFlameMs / 60000UL);
+    g_pendingFlameMs -= (uint32_t)flameMin * 60000UL;
+    addToBuckets(wh, starts, flameMin);
+
+    if (g_dirty && (rolled || !g_lastSaveMs || (uint32_t)(now - g_lastSaveMs) >= kSaveMs)) ringSave();
+  }
+
+  static void publishStatus() {
+    PublishedEnergy p;
+    BoilerEnergyStatus& st = p.status;
+    const uint32_t now = millis();
+    int32_t day, week, month;
+    st.timeValid = localKeys(day, week, month);
+    st.countersValid = countersActive(now);
+    st.powerKw = g_powerKw;
+    st.todayKwh = g_rec.days[kBoilerEnergyDays - 1].wh / 1000.0f;
+    st.weekKwh = g_rec.weeks[kBoilerEnergyWeeks - 1].wh / 1000.0f;
+    st.monthKwh = g_rec.months[kBoilerEnergyMonths - 1].wh / 1000.0f;
+    st.totalKwh = (float)((double)g_rec.totalWh / 1000.0);
+    st.todayStarts = g_rec.days[kBoilerEnergyDays - 1].starts;
+    st.todayFlameMin = g_rec.days[kBoilerEnergyDays - 1].flameMin;
+    st.startsLastHour = startsLastHour();
+    st.saveCount = g_saveCount;
+    st.lastSaveMs = g_lastSaveMs;
+    p.revision = g_revision;
+    g_pub.publish(p);
+  }
+
+  static void putSeries(JsonObject out, const EnergyBucket* arr, uint8_t n, const String& last) {
+    if (last.length()) out["last"] = last;
+    else out["last"] = nullptr;
+    JsonArray wh = out.createNestedArray("wh");
+    JsonArray starts = out.createNestedArray("starts");
+    JsonArray flame = out.createNestedArray("flameMin");
+    for (uint8_t i = 0; i < n; i++) {
+      wh.add(arr[i].wh);
+      starts.add(arr[i].starts);
+      flame.add(arr[i].flameMin);
+    }
+  }
+
+  static String dayLabel(int32_t key) {
+    if (!key) return String();
+    int32_t y;
+    uint32_t m, d;
+    civilFromDays(key, y, m, d);
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%04d-%02u-%02u", (int)y, (unsigned)m, (unsigned)d);
+    return String(buf);
+  }
+
+  static String monthLabel(int32_t key) {
+    if (!key) return String();
+    char buf[10];
+    snprintf(buf, sizeof(buf), "%04d-%02d", (int)(key / 12), (int)(key % 12) + 1);
+    return String(buf);
+  }
+}
+
+void boilerEnergyInit() {
+  if (g_inited) return;
+  g_inited = true;
+  g_rec = EnergyRecord{};
+  ringLoad();
+  g_lastFlushMs = millis();
+  g_hourSlotKey = g_lastFlushMs / 300000UL;
+  // Running totals change slowly; low priority keeps them to spare poll slots.
+  for (uint8_t i = 0; i < kCounterCount; i++) {
+    openthermDeclarePollInterest((uint8_t)(kCounterFirstId + i), kCounterMaxAgeMs, OpenThermPollPriority::Low);
+  }
+  publishStatus();
+}
+
+void boilerEnergyLoop() {
+  if (!g_inited) return;
+  const uint32_t now = millis();
+  if (g_lastSampleMs && (uint32_t)(now - g_lastSampleMs) < kSampleMs) return;
+  sample(now);
+  if ((uint32_t)(now - g_lastFlushMs) >= kFlushMs) {
+    g_lastFlushMs = now;
+    flush(now);
+  }
+  publishStatus();
+}
+
+BoilerEnergyStatus boilerEnergyGetStatus() {
+  return g_pub.read().status;
+}
+
+void boilerEnergyFillFastJson(JsonObject& out) {
+  const BoilerEnergyStatus st = boilerEnergyGetStatus();
+  out["kw"] = st.powerKw;
+  out["d"] = st.todayKwh;
+  out["w"] = st.weekKwh;
+  out["m"] = st.monthKwh;
+  out["sd"] = st.todayStarts;
+  out["sph"] = st.startsLastHour;
+}
+
+String boilerEnergyGetJson() {
+  static const char* const kCounterNames[kCounterCount] = {
+    "burnerStarts", "chPumpStarts", "dhwPumpValveStarts", "dhwBurnerStarts",
+    "burnerHours", "chPumpHours", "dhwPumpValveHours", "dhwBurnerHours",
+  };
+  IoLock lock;
+  const BoilerEnergyStatus st = boilerEnergyGetStatus();
+  const uint32_t now = millis();
+
+  DynamicJsonDocument doc(6144);
+  doc["ok"] = true;
+  doc["timeValid"] = st.timeValid;
+  doc["maxKw"] = g_maxKw;
+  doc["powerKw"] = st.powerKw;
+  doc["totalKwh"] = st.totalKwh;
+  doc["startsLastHour"] = st.startsLastHour;
+  doc["startsSrc"] = st.countersValid ? "ot" : "flame";
+  doc["saves"] = st.saveCount;
+  if (st.lastSaveMs) doc["lastSaveAgeS"] = (uint32_t)((now - st.lastSaveMs) / 1000UL);
+  else doc["lastSaveAgeS"] = nullptr;
+
+  JsonObject counters = doc.createNestedObject("counters");
+  for (uint8_t i = 0; i < kCounterCount; i++) {
+    if (g_counterValid & (1u << i)) counters[kCounterNames[i]] = g_counters[i];
+    else counters[kCounterNames[i]] = nullptr;
+  }
+
+  putSeries(doc.createNestedObject("day"), g_rec.days, kBoilerEnergyDays, dayLabel(g_rec.dayKey));
+  putSeries(doc.createNestedObject("week"), g_rec.weeks, kBoilerEnergyWeeks, dayLabel(g_rec.weekKey));
+  putSeries(doc.createNestedObject("month"), g_rec.months, kBoilerEnergyMonths, monthLabel(g_rec.monthKey));
+
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
+
+uint32_t boilerEnergySeriesRevision() {
+  return g_pub.read().revision;
+}
+
+bool boilerEnergyClear() {
+  IoLock lock;
+  const uint16_t startsRaw = g_rec.lastStartsRaw;
+  const uint8_t startsValid = g_rec.lastStartsValid;
+  const uint32_t seq = g_rec.seq;
+  g_rec = EnergyRecord{};
+  g_rec.seq = seq;
+  g_rec.lastStartsRaw = startsRaw;
+  g_rec.lastStartsValid = startsValid;
+  g_pendingWh = 0.0f;
+  g_pendingFlameMs = 0;
+  g_pendingEdges = 0;
+  memset(g_hourEdges, 0, sizeof(g_hourEdges));
+  rollBuckets();
+  const bool ok = ringSave();
+  publishStatus();
+  return ok;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Long-term boiler statistics built from OpenTherm without extra fast-path frames:
+//  - start / operation-hour counters (Data-IDs 116..123), declared to the poll
+//    scheduler at low priority with a 10 min max age,
+//  - heat energy integrated from the already polled flame + modulation
+//    telemetry (modulation x OpenThermConfig::assumedMaxBoilerKw),
+//  - per-day / per-week / per-month buckets (energy, burner starts, flame time)
+//    kept in a slot ring on LittleFS that survives reboots.
+
+static constexpr uint8_t kBoilerEnergyDays = 14;
+static constexpr uint8_t kBoilerEnergyWeeks = 8;
+static constexpr uint8_t kBoilerEnergyMonths = 12;
+
+struct BoilerEnergyStatus {
+  bool timeValid = false;
+  bool countersValid = false; // ID116 answered within the last 30 min
+  float powerKw = 0.0f;       // current estimate (0 when the flame is off)
+  float todayKwh = 0.0f;
+  float weekKwh = 0.0f;
+  float monthKwh = 0.0f;
+  float totalKwh = 0.0f;      // since the ring was created
+  uint16_t todayStarts = 0;
+  uint16_t todayFlameMin = 0;
+  uint16_t startsLastHour = 0; // flame off->on transitions, rolling hour
+  uint32_t saveCount = 0;
+  uint32_t lastSaveMs = 0;
+};
+
+void boilerEnergyInit();
+void boilerEnergyLoop();
+
+// boilerEnergyLoop() runs on the I/O task and publishes the status after every
+// sample; GetStatus / FillFastJson / SeriesRevision read that copy, GetJson and
+// Clear take IoLock (TaskDomains.h).
+BoilerEnergyStatus boilerEnergyGetStatus();
+// Summary for the fast snapshot / MQTT state (short keys).
+void boilerEnergyFillFastJson(JsonObject& out);
+// Counters and series (oldest bucket first, energy in Wh).
+String boilerEnergyGetJson();
+// Incremented whenever a bucket is persisted; lets publishers skip unchanged series.
+uint32_t boilerEnergySeriesRevision();
+bool boilerEnergyClear();
@@ -1,5 +1,6 @@
 #include "BuzzerController.h"
 #include "config_pins.h"
+#include "TaskDomains.h"
 
 namespace {
   struct Step {
@@ -88,11 +89,13 @@ void buzzerLoop() {
 }
 
 void buzzerPlayStartup() {
+  ControlLock lock;
   if (s_pat.warning) return; // warning has priority
   startPattern(kStartupPattern, (uint8_t)(sizeof(kStartupPattern) / sizeof(kStartupPattern[0])), false, false);
 }
 
 void buzzerPlayWarning(bool enable) {
+  ControlLock lock;
   if (!enable) {
     if (s_pat.warning) stopPattern();
     return;
@@ -12,6 +12,7 @@
 #include "OpenThermController.h"
 #include "OtaController.h"
 #include "PressureAlarmController.h"
+#include "TemperatureManager.h"
 
 namespace {
   String buildOpenThermConfigJson() {
@@ -24,7 +25,12 @@ namespace {
     const String mode = ConfigStore::getOtMode();
     ot["mode"] = mode;
     ot["allowRawWrite"] = ConfigStore::getOtAllowRawWrite();
+    ot["runInTask"] = ConfigStore::getOtRunInTask();
     ot["boilerControl"] = mode == "control" ? "opentherm" : "relay";
+    uint8_t ids[32];
+    const uint8_t n = ConfigStore::getOtPollIds(ids, sizeof(ids));
+    JsonArray pollIds = ot.createNestedArray("pollIds");
+    for (uint8_t i = 0; i < n; i++) pollIds.add(ids[i]);
     String out;
     serializeJson(doc, out);
     return out;
@@ -77,6 +83,18 @@ namespace ConfigRuntime {
     networkApplyConfig(buildTimeConfigJson());
     otaApplyConfig(buildOtaConfigJson());
     dallasApplyConfig(String("{\"enabled\":") + (ConfigStore::getDallasEnabled() ? "true}" : "false}"));
+    DallasController::setParallelConversion(ConfigStore::getDallasParallel());
+    {
+      uint64_t roms[8];
+      uint8_t bits[8];
+      const uint8_t n = ConfigStore::getDallasResolutions(roms, bits, 8);
+      DallasController::setResolutions(roms, bits, n);
+    }
+    for (uint8_t i = 0; i < (uint8_t)TempRole::COUNT; i++) {
+      TempConditionerConfig f;
+      ConfigStore::getTempFilter(i, f.medianN, f.tauMs);
+      TemperatureManager::setRoleFilter((TempRole)i, f);
+    }
     equithermReloadFromStore();
     dhwReloadFromStore();
     mqttApplyConfig(String());
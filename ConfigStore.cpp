@@ -17,12 +17,20 @@ namespace {
   uint32_t g_otBootDelayMs = 15000;
   String   g_otMode = "readOnly";
   bool     g_otAllowRawWrite = false;
+  bool     g_otRunInTask = false;
+  uint8_t  g_otPollIds[33] = {0}; // [0]=count, [1..32]=Data-IDs
 
   bool     g_bleEnabled = false;
   String   g_bleNamePrefix = "ESP-Meteostanice";
   uint32_t g_bleScanMs = 10000;
 
   bool     g_dallasEnabled = true;
+  bool     g_dallasParallel = false;
+  // Per-ROM DS18B20 resolution: [0]=count, then count x (ROM LE 8 B + bits 1 B)
+  uint8_t  g_dallasRes[1 + 8 * 9] = {0};
+  // Per-role temperature filter: 8 x (median N 1 B, tau in 100 ms LE 2 B).
+  // All zero => defaults (median 3, no low-pass).
+  uint8_t  g_tempFilt[8 * 3] = {0};
 
   // DHW / TUV
   bool     g_dhwEnabled = true;
@@ -181,12 +189,17 @@ namespace {
   static constexpr const char* K_OT_BOOT = "ot_boot";
   static constexpr const char* K_OT_MODE = "ot_mode";
   static constexpr const char* K_OT_RAWW = "ot_raww";
+  static constexpr const char* K_OT_PIDS = "ot_pids";
+  static constexpr const char* K_OT_TASK = "ot_task";
 
   static constexpr const char* K_BLE_EN = "ble_en";
   static constexpr const char* K_BLE_NAME = "ble_name";
   static constexpr const char* K_BLE_SCAN = "ble_scan";
 
   static constexpr const char* K_DS_EN = "ds_en";
+  static constexpr const char* K_DS_PAR = "ds_par";
+  static constexpr const char* K_DS_RES = "ds_res";
+  static constexpr const char* K_TM_FILT = "tm_filt";
 
   // Dallas role ROM mapping (split to hi/lo 32-bit for compatibility)
   static constexpr const char* K_DS_TTOP_H = "ds_tt_h";
@@ -355,12 +368,25 @@ static constexpr const char* K_EQ_BA_CH = "eq_ba_ch";
     g_otBootDelayMs = g_prefs.getUInt(K_OT_BOOT, g_otBootDelayMs);
     g_otMode        = g_prefs.getString(K_OT_MODE, g_otMode);
     g_otAllowRawWrite = g_prefs.getBool(K_OT_RAWW, g_otAllowRawWrite);
+    g_otRunInTask = g_prefs.getBool(K_OT_TASK, g_otRunInTask);
+    if (g_prefs.getBytesLength(K_OT_PIDS) == sizeof(g_otPollIds)) {
+      g_prefs.getBytes(K_OT_PIDS, g_otPollIds, sizeof(g_otPollIds));
+      if (g_otPollIds[0] > 32) g_otPollIds[0] = 0;
+    }
 
     g_bleEnabled    = g_prefs.getBool(K_BLE_EN, g_bleEnabled);
     g_bleNamePrefix = g_prefs.getString(K_BLE_NAME, g_bleNamePrefix);
     g_bleScanMs     = g_prefs.getUInt(K_BLE_SCAN, g_bleScanMs);
 
     g_dallasEnabled = g_prefs.getBool(K_DS_EN, g_dallasEnabled);
+    g_dallasParallel = g_prefs.getBool(K_DS_PAR, g_dallasParallel);
+    if (g_prefs.getBytesLength(K_DS_RES) == sizeof(g_dallasRes)) {
+      g_prefs.getBytes(K_DS_RES, g_dallasRes, sizeof(g_dallasRes));
+      if (g_dallasRes[0] > 8) g_dallasRes[0] = 0;
+    }
+    if (g_prefs.getBytesLength(K_TM_FILT) == sizeof(g_tempFilt)) {
+      g_prefs.getBytes(K_TM_FILT, g_tempFilt, sizeof(g_tempFilt));
+    }
 
     // Dallas roles
     uint32_t hi=0, lo=0;
@@ -819,6 +845,28 @@ namespace ConfigStore {
 
   bool getOtAllowRawWrite() { begin(); return g_otAllowRawWrite; }
   void setOtAllowRawWrite(bool v) { begin(); g_otAllowRawWrite = v; saveBool(K_OT_RAWW, v); }
+  bool getOtRunInTask() { begin(); return g_otRunInTask; }
+  void setOtRunInTask(bool v) { begin(); g_otRunInTask = v; saveBool(K_OT_TASK, v); }
+
+  uint8_t getOtPollIds(uint8_t* out, uint8_t maxCount) {
+    begin();
+    uint8_t n = g_otPollIds[0];
+    if (n > maxCount) n = maxCount;
+    for (uint8_t i = 0; i < n; i++) out[i] = g_otPollIds[1 + i];
+    return n;
+  }
+
+  void setOtPollIds(const uint8_t* ids, uint8_t count) {
+    begin();
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < count && n < 32; i++) {
+      if (ids[i] == 0 || ids[i] > 127) continue;
+      g_otPollIds[1 + n++] = ids[i];
+    }
+    for (uint8_t i = n; i < 32; i++) g_otPollIds[1 + i] = 0;
+    g_otPollIds[0] = n;
+    saveBytes(K_OT_PIDS, g_otPollIds, sizeof(g_otPollIds));
+  }
 
   // BLE
   bool getBleEnabled() { begin(); return g_bleEnabled; }
@@ -837,6 +885,61 @@ namespace ConfigStore {
   // Dallas
   bool getDallasEnabled() { begin(); return g_dallasEnabled; }
   void setDallasEnabled(bool v) { begin(); g_dallasEnabled = v; saveBool(K_DS_EN, v); }
+  bool getDallasParallel() { begin(); return g_dallasParallel; }
+  void setDallasParallel(bool v) { begin(); g_dallasParallel = v; saveBool(K_DS_PAR, v); }
+
+  uint8_t getDallasResolutions(uint64_t* roms, uint8_t* bits, uint8_t maxCount) {
+    begin();
+    uint8_t n = g_dallasRes[0];
+    if (n > maxCount) n = maxCount;
+    for (uint8_t i = 0; i < n; i++) {
+      const uint8_t* e = &g_dallasRes[1 + i * 9];
+      uint64_t rom = 0;
+      for (uint8_t b = 0; b < 8; b++) rom |= (uint64_t)e[b] << (8 * b);
+      roms[i] = rom;
+      bits[i] = e[8];
+    }
+    return n;
+  }
+
+  void setDallasResolutions(const uint64_t* roms, const uint8_t* bits, uint8_t count) {
+    begin();
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < count && n < 8; i++) {
+      if (!roms[i] || bits[i] < 9 || bits[i] > 12) continue;
+      uint8_t* e = &g_dallasRes[1 + n++ * 9];
+      for (uint8_t b = 0; b < 8; b++) e[b] = (uint8_t)(roms[i] >> (8 * b));
+      e[8] = bits[i];
+    }
+    for (uint8_t i = 1 + n * 9; i < sizeof(g_dallasRes); i++) g_dallasRes[i] = 0;
+    g_dallasRes[0] = n;
+    saveBytes(K_DS_RES, g_dallasRes, sizeof(g_dallasRes));
+  }
+
+  void getTempFilter(uint8_t role, uint8_t& medianN, uint32_t& tauMs) {
+    begin();
+    medianN = 3;
+    tauMs = 0;
+    if (role >= 8) return;
+    const uint8_t* e = &g_tempFilt[role * 3];
+    if (e[0]) medianN = e[0];
+    tauMs = (uint32_t)(e[1] | (e[2] << 8)) * 100u;
+  }
+
+  void setTempFilter(uint8_t role, uint8_t medianN, uint32_t tauMs) {
+    begin();
+    if (role >= 8) return;
+    if (medianN != 1 && medianN != 5) medianN = 3;
+    uint32_t t = (tauMs + 50) / 100;
+    if (t > 0xFFFF) t = 0xFFFF;
+    uint8_t* e = &g_tempFilt[role * 3];
+    const uint8_t m = medianN == 3 ? 0 : medianN;
+    if (e[0] == m && e[1] == (uint8_t)t && e[2] == (uint8_t)(t >> 8)) return;
+    e[0] = m;
+    e[1] = (uint8_t)t;
+    e[2] = (uint8_t)(t >> 8);
+    saveBytes(K_TM_FILT, g_tempFilt, sizeof(g_tempFilt));
+  }
 
   uint64_t getDallasTankTopRom() { begin(); return g_dsTankTopRom; }
   void setDallasTankTopRom(uint64_t rom) { begin(); g_dsTankTopRom = rom; saveU64(K_DS_TTOP_H, K_DS_TTOP_L, rom); }
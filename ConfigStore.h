@@ -42,6 +42,12 @@ namespace ConfigStore {
   // Default false.
   bool getOtAllowRawWrite();
   void setOtAllowRawWrite(bool v);
+  bool getOtRunInTask();
+  void setOtRunInTask(bool v);
+
+  // Extra Data-IDs for the OpenTherm poll scheduler (1..127, max 32).
+  uint8_t getOtPollIds(uint8_t* out, uint8_t maxCount);
+  void setOtPollIds(const uint8_t* ids, uint8_t count);
 
   // BLE (subset)
   bool getBleEnabled();
@@ -54,6 +60,19 @@ namespace ConfigStore {
   // DS18B20 (GPIO3 tank)
   bool getDallasEnabled();
   void setDallasEnabled(bool v);
+  // Convert T on all DS buses at once instead of round-robin. Default false.
+  bool getDallasParallel();
+  void setDallasParallel(bool v);
+  // Per-ROM DS18B20 resolution (9..12 bit, max 8 entries). ROMs without an
+  // entry keep the resolution stored in the sensor's EEPROM.
+  uint8_t getDallasResolutions(uint64_t* roms, uint8_t* bits, uint8_t maxCount);
+  void setDallasResolutions(const uint64_t* roms, const uint8_t* bits, uint8_t count);
+
+  // Per-role temperature filter (TempRole index 0..7): median of 1/3/5
+  // samples and low-pass time constant (stored with 100 ms resolution, max
+  // ~109 min). Default median 3, no low-pass.
+  void getTempFilter(uint8_t role, uint8_t& medianN, uint32_t& tauMs);
+  void setTempFilter(uint8_t role, uint8_t medianN, uint32_t tauMs);
 
   // DS18B20 role mapping (ROM=0 => AUTO)
   uint64_t getDallasTankTopRom();
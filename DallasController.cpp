@@ -2,6 +2,9 @@
 
 // Local copy of https://github.com/junkfix/esp32-ds18b20 (RMT-based OneWire)
 #include "OneWireESP32.h"
+#include "DallasScheduler.h"
+#include "DallasScratchpad.h"
+#include "TaskDomains.h"
 
 #include <ArduinoJson.h>
 
@@ -14,35 +17,65 @@
 
 // NOTE:
 // We keep exactly one active OneWire32 instance at a time (RMT channels are limited and
-// other peripherals (e.g. WS2812) may also use them). To reduce heap fragmentation we
-// avoid allocating/deallocating the OneWire32 object itself; we reuse static storage
-// and only recreate the internal RMT driver when switching GPIO.
+// other peripherals (e.g. WS2812, OpenTherm RMT RX) may also use them; one OneWire32
+// takes two RMT memory blocks per direction, so a per-GPIO pool does not fit the S3).
+// The instance lives in static storage and is created once; switching GPIO re-routes
+// its TX/RX channels through the GPIO matrix (OneWire32::switchPin()). Only if that is
+// not possible do we fall back to recreating the RMT driver on every switch.
 
 namespace {
 
 constexpr uint8_t  GPIO_MIN = 0;
 constexpr uint8_t  GPIO_MAX = 3;
-constexpr uint8_t  MAX_DEVICES_PER_GPIO = 8;
+constexpr uint8_t  MAX_DEVICES_PER_GPIO = DALLAS_MAX_DEVICES_PER_GPIO;
 
-constexpr uint32_t CONVERSION_MS = 800;   // DS18B20 12-bit: 750ms typ.
-constexpr uint32_t CYCLE_MS      = 1500;  // request -> read cadence
-
-struct InternalDallas {
-    uint8_t gpio = 255;
+// The public part (DallasGpioStatus) is what getStatus() hands out.
+// Conversion timing per GPIO lives in the scheduler (DallasScheduler.h).
+struct InternalDallas : DallasGpioStatus {
     TempInputType type = TEMP_INPUT_NONE;
-    TempInputStatus status = TEMP_STATUS_DISABLED;
-
-    std::vector<DallasDeviceInfo> devices;
-
-    // async state (per GPIO)
-    bool converting = false;
-    uint32_t convertStartMs = 0;
-    uint32_t lastCycleMs = 0;
-    uint32_t lastDiscoverMs = 0;
-    uint32_t lastReadMs = 0;
+    // Any parasite-powered sensor: the conversion-done bit cannot be polled.
+    bool parasite = true;
+    // Worst-case conversion time of the sensors on this bus.
+    uint32_t conversionMs = 800;
 };
 
+// Per-ROM resolution table (ConfigStore "ds_res").
+constexpr uint8_t MAX_RES_ENTRIES = 8;
+uint64_t s_resRom[MAX_RES_ENTRIES] = {0};
+uint8_t  s_resBits[MAX_RES_ENTRIES] = {0};
+uint8_t  s_resCount = 0;
+
 InternalDallas g_bus[GPIO_MAX + 1];
+
+// Read health per ROM. Kept across re-discovery and disconnects so a
+// flapping sensor keeps its history; one slot per possible device, the
+// least recently seen ROM is replaced when all are taken.
+constexpr uint8_t MAX_HEALTH_ENTRIES = (GPIO_MAX + 1) * MAX_DEVICES_PER_GPIO;
+struct HealthEntry {
+    uint64_t rom = 0;
+    uint32_t lastSeenMs = 0;
+    DallasSensorHealth h;
+};
+HealthEntry s_health[MAX_HEALTH_ENTRIES];
+
+static DallasSensorHealth& healthFor(uint64_t rom) {
+    HealthEntry* victim = &s_health[0];
+    for (auto &e : s_health) {
+        if (e.rom == rom) {
+            e.lastSeenMs = millis();
+            return e.h;
+        }
+        if (!e.rom) {
+            if (victim->rom) victim = &e;
+        } else if (victim->rom && (int32_t)(e.lastSeenMs - victim->lastSeenMs) < 0) {
+            victim = &e;
+        }
+    }
+    *victim = HealthEntry{};
+    victim->rom = rom;
+    victim->lastSeenMs = millis();
+    return victim->h;
+}
 static std::aligned_storage_t<sizeof(OneWire32), alignof(OneWire32)> s_oneWireStorage;
 static OneWire32* s_oneWire = nullptr;
 static uint8_t s_oneWireGpio = 255;
@@ -57,11 +90,6 @@ static void destroyOneWire() {
     s_oneWireGpio = 255;
 }
 
-// Global scheduler: keep OneWire/RMT usage strictly sequential (1 GPIO at a time)
-static uint8_t s_rrGpio = 0;
-static bool    s_busy  = false;
-static uint8_t s_activeGpio = 0;
-
 static inline bool gpioSupportsDallas(uint8_t gpio) {
     return gpio >= GPIO_MIN && gpio <= GPIO_MAX;
 }
@@ -72,6 +100,19 @@ static inline void ensureDallasPullup(uint8_t gpio) {
     gpio_set_pull_mode((gpio_num_t)gpio, GPIO_PULLUP_ONLY);
 }
 
+// Driver cost accounting, rolled over per scheduler cycle in loop().
+struct DriverCycle {
+    uint32_t setupUs = 0;
+    uint32_t trafficUs = 0;
+    uint16_t creates = 0;
+    uint16_t switches = 0;
+};
+static DriverCycle s_drvCur;
+static DriverCycle s_drvLast;
+static uint32_t s_drvCreates = 0;
+static uint32_t s_drvSwitches = 0;
+static bool s_pinSwitchOk = true;
+
 static OneWire32* getOneWireBus(uint8_t gpio) {
     if (!gpioSupportsDallas(gpio)) return nullptr;
 
@@ -79,26 +120,118 @@ static OneWire32* getOneWireBus(uint8_t gpio) {
         return s_oneWire;
     }
 
-    // Switch GPIO: cleanup + re-create driver in the same static storage.
+    const uint32_t t0 = micros();
+
+    // Preferred: keep the RMT channels and move them to the new pin.
+    if (s_oneWire && s_pinSwitchOk) {
+        if (s_oneWire->switchPin(gpio)) {
+            s_oneWireGpio = gpio;
+            s_drvCur.switches++;
+            s_drvSwitches++;
+            s_drvCur.setupUs += micros() - t0;
+            return s_oneWire;
+        }
+        s_pinSwitchOk = false;
+    }
+
+    // Fallback: cleanup + re-create driver in the same static storage.
     destroyOneWire();
 
     s_oneWire = new (&s_oneWireStorage) OneWire32(gpio);
+    s_drvCur.creates++;
+    s_drvCreates++;
     if (!s_oneWire->ready()) {
         destroyOneWire();
+        s_drvCur.setupUs += micros() - t0;
         return nullptr;
     }
 
     s_oneWireGpio = gpio;
+    s_drvCur.setupUs += micros() - t0;
     return s_oneWire;
 }
 
+// Readers (TemperatureManager) compare generations to skip unchanged buses.
+static inline void markChanged(uint8_t gpio) {
+    g_bus[gpio].generation++;
+}
+
 static void clearBus(uint8_t gpio) {
+    markChanged(gpio);
     g_bus[gpio].devices.clear();
-    g_bus[gpio].converting = false;
-    g_bus[gpio].convertStartMs = 0;
-    g_bus[gpio].lastCycleMs = 0;
-    g_bus[gpio].lastDiscoverMs = 0;
     g_bus[gpio].lastReadMs = 0;
+    g_bus[gpio].parasite = true;
+    g_bus[gpio].conversionMs = 800;
+}
+
+// DS18B20 / DS1822 have a resolution config register; DS18S20 (0x10) and
+// others convert at a fixed 750 ms.
+static inline bool romHasResolution(uint64_t rom) {
+    const uint8_t family = (uint8_t)(rom & 0xFF);
+    return family == 0x28 || family == 0x22;
+}
+
+static inline uint8_t resolutionCfgByte(uint8_t bits) {
+    return (uint8_t)(((bits - 9) << 5) | 0x1F);
+}
+
+static inline uint8_t resolutionFromCfg(uint8_t cfg) {
+    return (uint8_t)(9 + ((cfg >> 5) & 0x03));
+}
+
+// Datasheet max: 93.75 / 187.5 / 375 / 750 ms, rounded up with margin.
+static inline uint32_t conversionMsFor(uint8_t bits) {
+    switch (bits) {
+        case 9:  return 100;
+        case 10: return 200;
+        case 11: return 400;
+        default: return 800;
+    }
+}
+
+static uint8_t lookupResolution(uint64_t rom) {
+    for (uint8_t i = 0; i < s_resCount; i++) {
+        if (s_resRom[i] == rom) return s_resBits[i];
+    }
+    return 0;
+}
+
+static void updateBusConversionMs(uint8_t gpio) {
+    uint32_t ms = 0;
+    for (const auto &dev : g_bus[gpio].devices) {
+        const uint32_t d = conversionMsFor(romHasResolution(dev.rom) ? dev.resolution : 12);
+        if (d > ms) ms = d;
+    }
+    g_bus[gpio].conversionMs = ms ? ms : 800;
+}
+
+// Read the config register and program the configured resolution if it
+// differs. Keeps TH/TL (alarm bytes, also used as user data) unchanged.
+static void applyResolution(OneWire32* ow, DallasDeviceInfo& dev, const uint8_t (&sp)[9]) {
+    dev.resolution = resolutionFromCfg(sp[4]);
+    const uint8_t want = lookupResolution(dev.rom);
+    if (!want || want == dev.resolution) return;
+    if (ow->writeScratchpad(dev.rom, sp[2], sp[3], resolutionCfgByte(want)) == 0) {
+        dev.resolution = want;
+    }
+}
+
+// OneWire32 as the bus of dallasReadScratchpad().
+struct ScratchpadBus {
+    OneWire32* ow;
+    DallasReadStatus readScratchpadRaw(uint64_t rom, uint8_t (&sp)[9]) {
+        switch (ow->readScratchpadRaw(rom, sp)) {
+            case 0: return DallasReadStatus::Ok;
+            case 5: return DallasReadStatus::NoPresence;
+            default: return DallasReadStatus::BusError;
+        }
+    }
+};
+
+// Checked read with one immediate retry, counted in the ROM's health.
+static bool readScratchpadChecked(OneWire32* ow, uint64_t rom, uint8_t (&sp)[9]) {
+    ScratchpadBus bus{ow};
+    return dallasReadScratchpad(bus, rom, sp, healthFor(rom)) == DallasReadStatus::Ok;
 }
 
 static void invalidateTemps(uint8_t gpio) {
@@ -131,15 +264,25 @@ static bool probeAndDiscover(uint8_t gpio) {
         return true;
     }
 
-    g_bus[gpio].devices.reserve(found);
     for (uint8_t i = 0; i < found; i++) {
         DallasDeviceInfo d{};
         d.rom = addrs[i];
         d.address = d.rom;
         d.temperature = NAN;
         d.valid = false;
+        if (romHasResolution(d.rom)) {
+            uint8_t sp[9];
+            if (readScratchpadChecked(ow, d.rom, sp)) applyResolution(ow, d, sp);
+        }
         g_bus[gpio].devices.push_back(d);
     }
+
+    // Unknown power mode counts as parasite: never poll the done bit then.
+    bool parasite = true;
+    if (!ow->readPowerSupply(parasite)) parasite = true;
+    g_bus[gpio].parasite = parasite;
+    updateBusConversionMs(gpio);
+
     g_bus[gpio].status = TEMP_STATUS_OK;
     return true;
 }
@@ -189,9 +332,6 @@ static bool startConversion(uint8_t gpio) {
     // Skip ROM + Convert T
     ow->write(0xCC);
     ow->write(0x44);
-
-    g_bus[gpio].converting = true;
-    g_bus[gpio].convertStartMs = millis();
     return true;
 }
 
@@ -210,12 +350,21 @@ static void readTemperatures(uint8_t gpio) {
     }
 
     bool anyOk = false;
+    bool resChanged = false;
     for (auto &dev : g_bus[gpio].devices) {
-        float t = NAN;
-        uint64_t addr = dev.rom;
-        uint8_t err = ow->getTemp(addr, t);
-        if (err == 0 && isfinite(t)) {
-            dev.temperature = t;
+        uint8_t sp[9];
+        if (readScratchpadChecked(ow, dev.rom, sp)) {
+            int16_t raw = (int16_t)((sp[1] << 8) | sp[0]);
+            if (romHasResolution(dev.rom)) {
+                // Low bits are undefined below 12-bit resolution.
+                const uint8_t res = resolutionFromCfg(sp[4]);
+                raw &= (int16_t)~((1 << (12 - res)) - 1);
+                // Sensor lost its configured resolution (power cycle): re-apply.
+                const uint8_t before = dev.resolution;
+                applyResolution(ow, dev, sp);
+                if (dev.resolution != before) resChanged = true;
+            }
+            dev.temperature = (float)raw / 16.0f;
             dev.valid = true;
             anyOk = true;
         } else {
@@ -224,10 +373,59 @@ static void readTemperatures(uint8_t gpio) {
         }
     }
 
+    if (resChanged) updateBusConversionMs(gpio);
     g_bus[gpio].lastReadMs = millis();
     g_bus[gpio].status = anyOk ? TEMP_STATUS_OK : TEMP_STATUS_ERROR;
 }
 
+// One read slot after Convert T: externally powered sensors hold it low
+// while converting and release it (1) when done.
+static bool conversionDone(uint8_t gpio) {
+    OneWire32* ow = getOneWireBus(gpio);
+    if (!ow) return false;
+    uint8_t bit = 0;
+    if (!ow->read(bit, 1)) return false;
+    return bit != 0;
+}
+
+// Bus operations for the conversion scheduler. Every call goes through
+// getOneWireBus(), so the single-driver rule above still holds.
+// Time spent outside getOneWireBus() is booked as 1-Wire traffic.
+struct DallasHal {
+    struct TrafficTimer {
+        uint32_t t0 = micros();
+        uint32_t setup0 = s_drvCur.setupUs;
+        ~TrafficTimer() { s_drvCur.trafficUs += (micros() - t0) - (s_drvCur.setupUs - setup0); }
+    };
+
+    bool busEnabled(uint8_t gpio) const {
+        return g_bus[gpio].type == TEMP_INPUT_DALLAS || g_bus[gpio].type == TEMP_INPUT_AUTO;
+    }
+    bool hasDevices(uint8_t gpio) const {
+        return !g_bus[gpio].devices.empty();
+    }
+    bool discover(uint8_t gpio) {
+        TrafficTimer tt;
+        markChanged(gpio);
+        if (probeAndDiscover(gpio)) return true;
+        g_bus[gpio].status = TEMP_STATUS_ERROR;
+        return false;
+    }
+    bool startConversion(uint8_t gpio) {
+        TrafficTimer tt;
+        if (::startConversion(gpio)) return true;
+        markChanged(gpio);  // status / device list changed on failure
+        return false;
+    }
+    void readTemperatures(uint8_t gpio) { TrafficTimer tt; ::readTemperatures(gpio); markChanged(gpio); }
+    uint32_t conversionMs(uint8_t gpio) const { return g_bus[gpio].conversionMs; }
+    bool canPollDone(uint8_t gpio) const { return !g_bus[gpio].parasite; }
+    bool conversionDone(uint8_t gpio) { TrafficTimer tt; return ::conversionDone(gpio); }
+};
+
+DallasHal s_hal;
+DallasScheduler<DallasHal, GPIO_MAX + 1> s_sched(s_hal);
+
 } // namespace
 
 bool DallasController::gpioSupportsDallas(uint8_t gpio) {
@@ -242,16 +440,16 @@ void DallasController::begin() {
         g_bus[i].status = TEMP_STATUS_DISABLED;
         clearBus(i);
     }
-    s_busy = false;
-    s_rrGpio = 0;
-    s_activeGpio = 0;
+    s_sched.reset();
 }
 
 void DallasController::configureGpio(uint8_t gpio, TempInputType type) {
+    IoLock lock;
     if (!gpioSupportsDallas(gpio)) return;
 
     g_bus[gpio].type = type;
     clearBus(gpio);
+    s_sched.resetBus(gpio);
 
     if (type == TEMP_INPUT_NONE) {
         g_bus[gpio].status = TEMP_STATUS_DISABLED;
@@ -261,75 +459,101 @@ void DallasController::configureGpio(uint8_t gpio, TempInputType type) {
     // IMPORTANT:
     // Do NOT run RMT/OneWire discovery inside configure. This function is called during boot
     // (setup + config apply) and creating multiple RMT channels here can crash ESP32-S3.
-    // Discovery/reading is handled non-blocking in DallasController::loop().
+    // Discovery/reading is handled non-blocking in DallasController::loop()
+    // (resetBus() above schedules discovery ASAP).
     g_bus[gpio].status = TEMP_STATUS_NO_SENSOR;
-    g_bus[gpio].lastDiscoverMs = 0; // 0 => discover ASAP in loop
-    g_bus[gpio].lastCycleMs = 0;
-    g_bus[gpio].converting = false;
-    g_bus[gpio].convertStartMs = 0;
 }
 
 void DallasController::loop() {
-    const uint32_t now = millis();
-
-    // If converting on an active GPIO, only check completion/read for that GPIO.
-    if (s_busy) {
-        const uint8_t gpio = s_activeGpio;
-        if (g_bus[gpio].converting) {
-            if (now - g_bus[gpio].convertStartMs >= CONVERSION_MS) {
-                readTemperatures(gpio);
-                g_bus[gpio].converting = false;
-                s_busy = false;
-                s_rrGpio = (gpio + 1) % (GPIO_MAX + 1);
-            }
-        } else {
-            s_busy = false;
-        }
-        return;
+    static uint32_t seenCycles = 0;
+    s_sched.step(millis());
+    if (s_sched.cycles() != seenCycles) {
+        seenCycles = s_sched.cycles();
+        s_drvLast = s_drvCur;
+        s_drvCur = DriverCycle{};
     }
+}
+
+void DallasController::setParallelConversion(bool on) {
+    IoLock lock;
+    s_sched.setMode(on ? DallasSchedMode::Parallel : DallasSchedMode::Sequential);
+}
 
-    // Not busy: pick next eligible GPIO (round-robin)
-    for (uint8_t step = 0; step <= GPIO_MAX; step++) {
-        const uint8_t gpio = (s_rrGpio + step) % (GPIO_MAX + 1);
+bool DallasController::parallelConversion() {
+    return s_sched.mode() == DallasSchedMode::Parallel;
+}
+
+uint32_t DallasController::lastParallelCycleMs() {
+    return s_sched.lastCycleLenMs();
+}
 
+void DallasController::setResolutions(const uint64_t* roms, const uint8_t* bits, uint8_t count) {
+    IoLock lock;
+    s_resCount = 0;
+    for (uint8_t i = 0; i < count && s_resCount < MAX_RES_ENTRIES; i++) {
+        if (!roms[i] || bits[i] < 9 || bits[i] > 12) continue;
+        s_resRom[s_resCount] = roms[i];
+        s_resBits[s_resCount] = bits[i];
+        s_resCount++;
+    }
+    // Re-discover so the new table is written to the sensors.
+    for (uint8_t gpio = GPIO_MIN; gpio <= GPIO_MAX; gpio++) {
         if (g_bus[gpio].type == TEMP_INPUT_NONE) continue;
-        if (!(g_bus[gpio].type == TEMP_INPUT_DALLAS || g_bus[gpio].type == TEMP_INPUT_AUTO)) continue;
-
-        // If no devices, occasionally probe/discover (hot-plug + AUTO)
-        if (g_bus[gpio].devices.empty() || g_bus[gpio].status == TEMP_STATUS_NO_SENSOR) {
-            if (g_bus[gpio].lastDiscoverMs == 0 || now - g_bus[gpio].lastDiscoverMs >= 3000) {
-                g_bus[gpio].lastDiscoverMs = now;
-                if (!probeAndDiscover(gpio)) {
-                    g_bus[gpio].status = TEMP_STATUS_ERROR;
-                }
-            }
-        }
+        clearBus(gpio);
+        s_sched.resetBus(gpio);
+    }
+}
 
-        if (g_bus[gpio].devices.empty()) continue;
+uint8_t DallasController::configuredResolution(uint64_t rom) {
+    return lookupResolution(rom);
+}
 
-        // Periodic cycle guard
-        if (now - g_bus[gpio].lastCycleMs < CYCLE_MS) continue;
-        g_bus[gpio].lastCycleMs = now;
+uint32_t DallasController::busConversionMs(uint8_t gpio) {
+    if (!gpioSupportsDallas(gpio)) return 0;
+    return g_bus[gpio].conversionMs;
+}
 
-        // Start conversion ONLY for this GPIO (sequential)
-        if (startConversion(gpio)) {
-            s_busy = true;
-            s_activeGpio = gpio;
-            s_rrGpio = (gpio + 1) % (GPIO_MAX + 1);
-        }
-        return;
-    }
+uint32_t DallasController::busPeriodMs(uint8_t gpio) {
+    if (!gpioSupportsDallas(gpio)) return 0;
+    if (s_sched.mode() == DallasSchedMode::Parallel) return s_sched.busPeriodMs(gpio);
+    return s_sched.timing().sequentialCycleMs;
+}
+
+bool DallasController::busParasite(uint8_t gpio) {
+    if (!gpioSupportsDallas(gpio)) return false;
+    return g_bus[gpio].parasite;
+}
+
+DallasDriverStats DallasController::getDriverStats() {
+    DallasDriverStats st;
+    st.pinSwitching = s_pinSwitchOk;
+    st.cycleSetupUs = s_drvLast.setupUs;
+    st.cycleTrafficUs = s_drvLast.trafficUs;
+    st.cycleCreates = s_drvLast.creates;
+    st.cycleSwitches = s_drvLast.switches;
+    st.totalCreates = s_drvCreates;
+    st.totalSwitches = s_drvSwitches;
+    return st;
 }
 
 const DallasGpioStatus* DallasController::getStatus(uint8_t gpio) {
     if (!gpioSupportsDallas(gpio)) return nullptr;
+    return &g_bus[gpio];
+}
+
+bool DallasController::getSensorHealth(uint64_t rom, DallasSensorHealth& out) {
+    if (!rom) return false;
+    for (const auto &e : s_health) {
+        if (e.rom != rom) continue;
+        out = e.h;
+        return true;
+    }
+    return false;
+}
 
-    static DallasGpioStatus status;
-    status.gpio = gpio;
-    status.status = g_bus[gpio].status;
-    status.devices = g_bus[gpio].devices;
-    status.lastReadMs = g_bus[gpio].lastReadMs;
-    return &status;
+uint32_t DallasController::generation(uint8_t gpio) {
+    if (!gpioSupportsDallas(gpio)) return 0;
+    return g_bus[gpio].generation;
 }
 
 // ---------------- Legacy/simple API used across the project ----------------
@@ -589,6 +813,7 @@ void applyCfgObj(const JsonObjectConst& root){
 } // namespace
 
 void dallasApplyConfig(const String& jsonStr){
+  IoLock lock;
   if (!s_inited){
     DallasController::begin();
     for (uint8_t gpio=0; gpio<=3; gpio++){
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <Arduino.h>
-#include <vector>
+#include <array>
+
+#include "DallasScratchpad.h"
 
 enum TempInputType : uint8_t {
   TEMP_INPUT_NONE = 0,
@@ -22,21 +24,92 @@ struct DallasDeviceInfo {
   uint64_t address = 0;
   float    temperature = NAN;
   bool     valid = false;
+  uint8_t  resolution = 12;   // bits, from the scratchpad config register
+};
+
+constexpr uint8_t DALLAS_MAX_DEVICES_PER_GPIO = 8;
+
+// Fixed-capacity device list (no heap allocation); push_back() fails once
+// the bus is full.
+struct DallasDeviceList {
+  std::array<DallasDeviceInfo, DALLAS_MAX_DEVICES_PER_GPIO> items{};
+  uint8_t count = 0;
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  void clear() { count = 0; }
+  bool push_back(const DallasDeviceInfo& d) {
+    if (count >= items.size()) return false;
+    items[count++] = d;
+    return true;
+  }
+  DallasDeviceInfo& operator[](size_t i) { return items[i]; }
+  const DallasDeviceInfo& operator[](size_t i) const { return items[i]; }
+  DallasDeviceInfo* begin() { return items.data(); }
+  DallasDeviceInfo* end() { return items.data() + count; }
+  const DallasDeviceInfo* begin() const { return items.data(); }
+  const DallasDeviceInfo* end() const { return items.data() + count; }
 };
 
 struct DallasGpioStatus {
   uint8_t gpio = 255;
   TempInputStatus status = TEMP_STATUS_DISABLED;
-  std::vector<DallasDeviceInfo> devices;
+  DallasDeviceList devices;
   uint32_t lastReadMs = 0;
+  // Bumped on every change of the fields above (read pass, discovery,
+  // disconnect, reconfiguration). Compare with a stored value to skip
+  // work when the bus has nothing new.
+  uint32_t generation = 0;
+};
+
+// OneWire driver cost, split into driver setup (RMT channel creation or GPIO
+// re-route) and actual 1-Wire traffic, for the last completed scheduler cycle.
+struct DallasDriverStats {
+  bool pinSwitching = false;   // one channel pair re-routed between GPIOs
+  uint32_t cycleSetupUs = 0;
+  uint32_t cycleTrafficUs = 0;
+  uint16_t cycleCreates = 0;
+  uint16_t cycleSwitches = 0;
+  uint32_t totalCreates = 0;
+  uint32_t totalSwitches = 0;
 };
 
 namespace DallasController {
   bool gpioSupportsDallas(uint8_t gpio);
   void begin();
+  // Configuration calls take IoLock, so the network task can make them.
   void configureGpio(uint8_t gpio, TempInputType type);
   void loop();
+  // Read-only view of the controller's own bus state (no copy). Stays valid
+  // for the lifetime of the program; its contents change only inside loop()
+  // and configuration calls, so read it from the I/O task or under IoLock.
   const DallasGpioStatus* getStatus(uint8_t gpio);
+  // Current generation of a bus (0 for unsupported GPIOs).
+  uint32_t generation(uint8_t gpio);
+
+  // Conversion scheduling: sequential round-robin (default) or Convert T on
+  // all buses at once followed by one read pass (see DallasScheduler.h).
+  void setParallelConversion(bool on);
+  bool parallelConversion();
+  uint32_t lastParallelCycleMs();
+  DallasDriverStats getDriverStats();
+
+  // Per-ROM resolution (9..12 bit), written to the scratchpad config register
+  // on discovery and re-applied if a sensor comes back with a different one
+  // (e.g. after a brown-out reloads its EEPROM). Replaces the whole table and
+  // re-discovers all buses.
+  void setResolutions(const uint64_t* roms, const uint8_t* bits, uint8_t count);
+  // Configured resolution for a ROM, 0 = not configured.
+  uint8_t configuredResolution(uint64_t rom);
+
+  // Scratchpad read health of a ROM (CRC errors, missing presence, retries;
+  // see DallasScratchpad.h). Survives re-discovery. False if never read.
+  bool getSensorHealth(uint64_t rom, DallasSensorHealth& out);
+
+  // Per-bus timing diagnostics.
+  uint32_t busConversionMs(uint8_t gpio);
+  uint32_t busPeriodMs(uint8_t gpio);
+  bool busParasite(uint8_t gpio);
 }
 
 void dallasApplyConfig(const String& jsonStr);
@@ -0,0 +1,279 @@
+#pragma once
+
+// DS18B20 conversion scheduler for the DallasController buses (GPIO0..3).
+// Arduino-free so it can be driven on a host with a fake bus
+// (tools/ds_sched_bench.cpp). The hardware side is the Hal template
+// parameter, which provides:
+//   bool busEnabled(uint8_t bus)        // bus configured for DS18B20
+//   bool hasDevices(uint8_t bus)        // at least one ROM known
+//   bool discover(uint8_t bus)          // reset + ROM search (+ resolution setup)
+//   bool startConversion(uint8_t bus)   // reset + Skip ROM + Convert T
+//   void readTemperatures(uint8_t bus)  // read every scratchpad on the bus
+//   uint32_t conversionMs(uint8_t bus)  // worst-case wait for the slowest
+//                                       // (highest-resolution) sensor
+//   bool canPollDone(uint8_t bus)       // no parasite-powered sensor on the bus
+//   bool conversionDone(uint8_t bus)    // one read slot: 1 = all finished
+//
+// Each of these touches exactly one bus and step() issues at most one of
+// them per call (a successful done-poll is followed by the read, and
+// Sequential discovery is followed by the start, as before), so only one
+// OneWire32 (one RMT TX/RX pair) is ever in use and a step() stays bounded.
+//
+// Sequential: convert, wait, read one bus at a time, round-robin. With all
+// four buses populated every sensor refreshes only every ~3-6 s.
+// Parallel: every bus runs its own convert/read loop and the loops overlap.
+// A DS18B20 converts on its own after Convert T, so the driver is free to
+// serve the other buses during the wait. Each bus restarts every
+// 4/3 x its conversion time (clamped to minCycleMs..parallelCycleMs): 1 s
+// for 12-bit sensors, ~130 ms for a 9-bit bus.
+//
+// The conversion wait is conversionMs(bus), or shorter when the bus has no
+// parasite-powered sensor: then, from half of conversionMs on, the done bit
+// is polled every conversionMs/16 (at least pollMs), and the measured
+// conversion time replaces conversionMs for the bus period.
+
+#include <stdint.h>
+
+enum class DallasSchedMode : uint8_t { Sequential = 0, Parallel };
+
+struct DallasSchedTiming {
+  uint32_t sequentialCycleMs = 1500;  // per bus, request -> read cadence
+  uint32_t parallelCycleMs = 1000;    // longest per-bus period in Parallel
+  uint32_t minCycleMs = 100;          // shortest per-bus period in Parallel
+  uint32_t pollMs = 10;               // conversion-done poll interval
+  uint32_t discoverMs = 3000;         // re-probe of empty buses (hot-plug)
+};
+
+template <class Hal, uint8_t BusCount>
+class DallasScheduler {
+  static_assert(BusCount > 0 && BusCount <= 8, "bus mask is 8 bits");
+
+public:
+  explicit DallasScheduler(Hal& hal, const DallasSchedTiming& t = DallasSchedTiming())
+    : _hal(hal), _t(t) { reset(); }
+
+  void reset() {
+    _converting = 0;
+    _readMask = 0;
+    _rr = 0;
+    _active = 0;
+    _busy = false;
+    _cycleStartMs = 0;
+    _haveCycle = false;
+    _lastCycleLenMs = 0;
+    _lastStarted = 0xFF;
+    for (uint8_t i = 0; i < BusCount; i++) resetBus(i);
+  }
+
+  // Bus reconfigured: drop its timing state and probe it as soon as possible.
+  void resetBus(uint8_t bus) {
+    if (bus >= BusCount) return;
+    const uint8_t bit = (uint8_t)(1u << bus);
+    _discoverAsap |= bit;
+    _converting &= (uint8_t)~bit;
+    _readMask &= (uint8_t)~bit;
+    _cycleSeen &= (uint8_t)~bit;
+    _lastDiscoverMs[bus] = 0;
+    _lastCycleMs[bus] = 0;
+    _convertStartMs[bus] = 0;
+    _lastPollMs[bus] = 0;
+    _measuredMs[bus] = 0;
+    if (_busy && _active == bus) _busy = false;
+  }
+
+  void setMode(DallasSchedMode m) {
+    if (m == _mode) return;
+    // Let the hardware finish whatever conversion is in flight; the new mode
+    // starts from a clean slate on the next step().
+    _mode = m;
+    _converting = 0;
+    _readMask = 0;
+    _cycleSeen = 0;
+    _busy = false;
+    _haveCycle = false;
+  }
+  DallasSchedMode mode() const { return _mode; }
+  const DallasSchedTiming& timing() const { return _t; }
+  void setTiming(const DallasSchedTiming& t) { _t = t; }
+
+  // Time for every populated bus to deliver one fresh reading, measured at
+  // the last completed cycle.
+  uint32_t lastCycleLenMs() const { return _lastCycleLenMs; }
+  // Completed cycles (every populated bus read at least once in Parallel,
+  // a round-robin wrap in Sequential). Lets the caller roll per-cycle
+  // counters.
+  uint32_t cycles() const { return _cycles; }
+
+  // Per-bus restart period in Parallel mode.
+  uint32_t busPeriodMs(uint8_t bus) {
+    uint32_t conv = _hal.conversionMs(bus);
+    if (_hal.canPollDone(bus) && _measuredMs[bus] && _measuredMs[bus] < conv) conv = _measuredMs[bus];
+    uint32_t p = conv * 4 / 3;
+    if (p < _t.minCycleMs) p = _t.minCycleMs;
+    if (p > _t.parallelCycleMs) p = _t.parallelCycleMs;
+    return p;
+  }
+
+  void step(uint32_t now) {
+    if (_mode == DallasSchedMode::Parallel) stepParallel(now);
+    else stepSequential(now);
+  }
+
+private:
+  bool discoverDue(uint8_t bus, uint32_t now) const {
+    if (_discoverAsap & (1u << bus)) return true;
+    return (uint32_t)(now - _lastDiscoverMs[bus]) >= _t.discoverMs;
+  }
+
+  void runDiscover(uint8_t bus, uint32_t now) {
+    _discoverAsap &= (uint8_t)~(1u << bus);
+    _lastDiscoverMs[bus] = now;
+    _hal.discover(bus);
+  }
+
+  // Conversion on `bus` finished? Either the worst-case time has elapsed or
+  // (externally powered sensors only) the done bit reads 1. `polled` is set
+  // when a bus transaction was spent on the poll.
+  bool conversionFinished(uint8_t bus, uint32_t now, bool& polled) {
+    polled = false;
+    const uint32_t elapsed = (uint32_t)(now - _convertStartMs[bus]);
+    const uint32_t conv = _hal.conversionMs(bus);
+    if (elapsed >= conv) return true;
+    if (!_hal.canPollDone(bus) || elapsed < conv / 2) return false;
+    uint32_t every = conv / 16;
+    if (every < _t.pollMs) every = _t.pollMs;
+    if ((uint32_t)(now - _lastPollMs[bus]) < every) return false;
+    _lastPollMs[bus] = now;
+    polled = true;
+    if (!_hal.conversionDone(bus)) return false;
+    _measuredMs[bus] = elapsed;
+    return true;
+  }
+
+  void stepSequential(uint32_t now) {
+    // A conversion is in flight: only check completion/read for that bus.
+    if (_busy) {
+      const uint8_t bus = _active;
+      bool polled = false;
+      if (conversionFinished(bus, now, polled)) {
+        _hal.readTemperatures(bus);
+        _busy = false;
+        _rr = (uint8_t)((bus + 1) % BusCount);
+      }
+      return;
+    }
+
+    for (uint8_t s = 0; s < BusCount; s++) {
+      const uint8_t bus = (uint8_t)((_rr + s) % BusCount);
+      if (!_hal.busEnabled(bus)) continue;
+
+      // No devices: occasionally probe (hot-plug + AUTO).
+      if (!_hal.hasDevices(bus) && discoverDue(bus, now)) runDiscover(bus, now);
+      if (!_hal.hasDevices(bus)) continue;
+
+      const uint8_t bit = (uint8_t)(1u << bus);
+      if ((_cycleSeen & bit) && (uint32_t)(now - _lastCycleMs[bus]) < _t.sequentialCycleMs) continue;
+      _cycleSeen |= bit;
+      _lastCycleMs[bus] = now;
+
+      if (_hal.startConversion(bus)) {
+        if (_lastStarted != 0xFF && bus <= _lastStarted) _cycles++;
+        _lastStarted = bus;
+        _busy = true;
+        _active = bus;
+        _convertStartMs[bus] = now;
+        _lastPollMs[bus] = now;
+        _rr = (uint8_t)((bus + 1) % BusCount);
+      }
+      return;
+    }
+  }
+
+  void stepParallel(uint32_t now) {
+    if (!_haveCycle) {
+      _haveCycle = true;
+      _cycleStartMs = now;
+      _readMask = 0;
+    }
+
+    // 1) Finished conversions first: reads are what keeps the data fresh.
+    //    Start from a rotating bus so a fast bus cannot starve the others.
+    for (uint8_t s = 0; s < BusCount; s++) {
+      const uint8_t bus = (uint8_t)((_rr + s) % BusCount);
+      const uint8_t bit = (uint8_t)(1u << bus);
+      if (!(_converting & bit)) continue;
+      bool polled = false;
+      if (conversionFinished(bus, now, polled)) {
+        _hal.readTemperatures(bus);
+        _converting &= (uint8_t)~bit;
+        _readMask |= bit;
+        _rr = (uint8_t)((bus + 1) % BusCount);
+        noteRead(now);
+        return;
+      }
+      if (polled) return;  // spent this step's bus transaction on the poll
+    }
+
+    // 2) Start buses whose period has elapsed; probe empty ones.
+    for (uint8_t bus = 0; bus < BusCount; bus++) {
+      const uint8_t bit = (uint8_t)(1u << bus);
+      if (_converting & bit) continue;
+      if (!_hal.busEnabled(bus)) continue;
+      if (!_hal.hasDevices(bus)) {
+        if (!discoverDue(bus, now)) continue;
+        // Probe now; if it finds sensors a later step converts them.
+        runDiscover(bus, now);
+        return;
+      }
+      if ((_cycleSeen & bit) && (uint32_t)(now - _lastCycleMs[bus]) < busPeriodMs(bus)) continue;
+      _cycleSeen |= bit;
+      _lastCycleMs[bus] = now;
+      if (_hal.startConversion(bus)) {
+        _converting |= bit;
+        _convertStartMs[bus] = now;
+        _lastPollMs[bus] = now;
+      }
+      return;
+    }
+  }
+
+  // A cycle ends once every populated bus has delivered a reading.
+  void noteRead(uint32_t now) {
+    uint8_t populated = 0;
+    for (uint8_t bus = 0; bus < BusCount; bus++) {
+      if (_hal.busEnabled(bus) && _hal.hasDevices(bus)) populated |= (uint8_t)(1u << bus);
+    }
+    if ((_readMask & populated) != populated) return;
+    _lastCycleLenMs = (uint32_t)(now - _cycleStartMs);
+    _cycles++;
+    _cycleStartMs = now;
+    _readMask = 0;
+  }
+
+  Hal& _hal;
+  DallasSchedTiming _t;
+  DallasSchedMode _mode = DallasSchedMode::Sequential;
+
+  // Parallel
+  uint8_t _converting = 0;  // buses with a conversion in flight
+  uint8_t _readMask = 0;    // buses read in the current cycle
+  bool _haveCycle = false;
+  uint32_t _cycleStartMs = 0;
+  uint32_t _lastCycleLenMs = 0;
+
+  // Sequential
+  uint8_t _active = 0;
+  bool _busy = false;
+  uint8_t _lastStarted = 0xFF;
+
+  // Shared
+  uint8_t _rr = 0;
+  uint8_t _cycleSeen = 0;  // buses with a valid _lastCycleMs
+  uint8_t _discoverAsap = 0;
+  uint32_t _cycles = 0;
+  uint32_t _lastDiscoverMs[BusCount] = {};
+  uint32_t _lastCycleMs[BusCount] = {};
+  uint32_t _convertStartMs[BusCount] = {};
+  uint32_t _lastPollMs[BusCount] = {};
+  uint32_t _measuredMs[BusCount] = {};  // last conversion time seen by polling
+};
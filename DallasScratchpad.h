@@ -0,0 +1,83 @@
+#pragma once
+
+// DS18B20 scratchpad read with CRC8 check and bounded retry.
+// Arduino-free so it can be driven on a host with injected bit errors
+// (tools/ds_scratchpad_bench.cpp). The bus is the template parameter and
+// provides one transaction:
+//   DallasReadStatus readScratchpadRaw(uint64_t rom, uint8_t (&sp)[9])
+//     reset + Match ROM + Read Scratchpad, no CRC check; returns Ok,
+//     NoPresence (no presence pulse after reset) or BusError.
+//
+// A scratchpad is accepted only if its CRC matches and it is not blank: a
+// sensor that does not drive the line reads all 0xFF, a line shorted low
+// reads all 0x00, and the all-zero scratchpad passes the CRC. A failed
+// attempt is retried at most `retries` times right away, in the same bus
+// slot, so one disturbed read no longer costs the sensor a whole cycle.
+
+#include <stdint.h>
+
+enum class DallasReadStatus : uint8_t {
+  Ok = 0,
+  Crc,         // CRC mismatch or blank scratchpad
+  NoPresence,  // no presence pulse
+  BusError     // driver / RX timeout
+};
+
+// Per-ROM read health, counted per attempt. A trend in crcErrors or
+// noPresence points at marginal wiring before the sensor drops out.
+struct DallasSensorHealth {
+  uint32_t reads = 0;       // bus slots (first attempts)
+  uint32_t crcErrors = 0;   // attempts with a bad or blank scratchpad
+  uint32_t noPresence = 0;  // attempts without presence pulse
+  uint32_t busErrors = 0;   // attempts lost to the driver / RX timeout
+  uint32_t retries = 0;     // immediate re-reads
+  uint32_t failures = 0;    // slots without a valid scratchpad
+};
+
+// Dallas/Maxim CRC8 (x^8 + x^5 + x^4 + 1, reflected).
+inline uint8_t dallasCrc8(const uint8_t* p, uint8_t n) {
+  uint8_t crc = 0;
+  while (n--) {
+    uint8_t b = *p++;
+    for (uint8_t i = 0; i < 8; i++) {
+      const uint8_t mix = (uint8_t)((crc ^ b) & 0x01);
+      crc >>= 1;
+      if (mix) crc ^= 0x8C;
+      b >>= 1;
+    }
+  }
+  return crc;
+}
+
+inline bool dallasScratchpadValid(const uint8_t (&sp)[9]) {
+  uint8_t all = 0xFF;
+  uint8_t any = 0x00;
+  for (uint8_t b : sp) {
+    all &= b;
+    any |= b;
+  }
+  if (all == 0xFF || any == 0x00) return false;
+  return dallasCrc8(sp, 8) == sp[8];
+}
+
+template <class Bus>
+DallasReadStatus dallasReadScratchpad(Bus& bus, uint64_t rom, uint8_t (&sp)[9],
+                                      DallasSensorHealth& h, uint8_t retries = 1) {
+  h.reads++;
+  DallasReadStatus st = DallasReadStatus::BusError;
+  for (uint8_t attempt = 0; attempt <= retries; attempt++) {
+    if (attempt) h.retries++;
+    st = bus.readScratchpadRaw(rom, sp);
+    if (st == DallasReadStatus::Ok) {
+      if (dallasScratchpadValid(sp)) return st;
+      st = DallasReadStatus::Crc;
+    }
+    switch (st) {
+      case DallasReadStatus::Crc: h.crcErrors++; break;
+      case DallasReadStatus::NoPresence: h.noPresence++; break;
+      default: h.busErrors++; break;
+    }
+  }
+  h.failures++;
+  return st;
+}
@@ -9,6 +9,7 @@
 #include "OpenThermController.h"
 #include "EventLog.h"
 #include "RelayController.h"
+#include "TaskDomains.h"
 #include "TemperatureManager.h"
 #include "EquithermController.h"
 
@@ -568,17 +569,24 @@ namespace {
 }
 
 void dhwInit() {
+  ControlLock lock;
   if (s_inited) return;
   s_inited = true;
   dhwReloadFromStore();
+  // Tank temperature + boiler DHW setpoint (boiler DHW mode detection).
+  openthermDeclarePollInterest(26, 10000, OpenThermPollPriority::Normal);
+  openthermDeclarePollInterest(56, 30000, OpenThermPollPriority::Low);
 }
 
 void dhwReloadFromStore() {
+  ControlLock lock;
   loadFromPrefs();
 }
 
 void dhwLoop() {
   if (!s_inited) dhwInit();
+  // Valve, boiler request and circulation relays of this pass: one expander write.
+  RelayTransaction relayTx;
   const bool prevHeatActive = s_st.heatActive;
   const bool prevOtDhwEnable = s_st.otDhwEnable;
   s_st = DhwStatus{};
@@ -620,7 +628,7 @@ void dhwLoop() {
     s_st.tankTempAgeMs = tv.ageMs;
   }
 
-  const OpenThermStatusSnapshot ot = openthermGetStatus();
+  const OpenThermTelemetry ot = openthermGetTelemetry();
   bool boilerDhwMode = ot.present && ot.ready && ot.dhwActive;
   if (!boilerDhwMode && ot.present && ot.ready && isfinite(ot.dhwSetpointC) && ot.dhwEnable && ot.flameOn && !ot.chActive) {
     boilerDhwMode = true;
@@ -726,15 +734,18 @@ void dhwLoop() {
 }
 
 DhwConfig dhwGetConfig() {
+  ControlLock lock;
   if (!s_inited) dhwInit();
   return s_cfg;
 }
 
 DhwStatus dhwGetStatus() {
+  ControlLock lock;
   return s_st;
 }
 
 String dhwGetStatusJson() {
+  ControlLock lock;
   DynamicJsonDocument doc(4096);
   doc["ok"] = true;
   JsonObject cfg = doc.createNestedObject("config");
@@ -747,6 +758,7 @@ String dhwGetStatusJson() {
 }
 
 void dhwFillFastJson(JsonObject& out) {
+  ControlLock lock;
   out["en"] = s_st.enabled;
   out["hr"] = s_st.heatRequested;
   out["ha"] = s_st.heatActive;
@@ -771,6 +783,7 @@ void dhwFillFastJson(JsonObject& out) {
 }
 
 void dhwApplyConfig(const String& json) {
+  ControlLock lock;
   if (!s_inited) dhwInit();
   DynamicJsonDocument doc(8192);
   if (deserializeJson(doc, json)) return;
@@ -888,6 +901,7 @@ void dhwApplyConfig(const String& json) {
 }
 
 bool dhwHandleCmdJson(const String& json, String& outErr) {
+  ControlLock lock;
   outErr = "";
   StaticJsonDocument<512> doc;
   if (deserializeJson(doc, json) || !doc.is<JsonObject>()) {
@@ -20,8 +20,36 @@
 #include "MqttController.h"
 #include "BuzzerController.h"
 #include "PressureAlarmController.h"
+#include "BoilerEnergyController.h"
 #include "EventLog.h"
 #include "HistoryBuffer.h"
+#include "AllocCounter.h"
+#include "LoopScheduler.h"
+#include "TaskDomains.h"
+#include "I2cBus.h"
+
+// -------------------- Main loop scheduler --------------------
+// Modules run from one LoopScheduler per task domain (TaskDomains.h): the
+// control and I/O schedulers on their own prioritised tasks, the network
+// one from loop(). Each runs only the modules that are due and then blocks
+// until the earliest deadline or a wake event.
+static constexpr uint32_t kWakeInput = 1u << 0;  // raw edge on IN1..IN8
+
+static uint32_t loopClockUs() { return (uint32_t)micros(); }
+static LoopScheduler s_ctlSched(loopClockUs);
+static LoopScheduler s_ioSched(loopClockUs);
+static LoopScheduler s_netSched(loopClockUs);
+static uint32_t s_schedStatsSinceUs = 0;
+
+// Synthetic network load (console NETLOAD): a net task that keeps the CPU
+// busy like a long HTTP response, to measure its effect on the control task.
+static uint32_t s_netLoadBusyUs = 0;
+static int8_t s_netLoadTask = -1;
+
+static void IRAM_ATTR onInputEdgeWake() {
+  s_ctlSched.wake(kWakeInput);
+  taskDomainNotifyFromIsr(TaskDomain::Control);
+}
 
 // -------------------- Console --------------------
 static String s_cmd;
@@ -50,6 +78,10 @@ static void printHelp() {
   Serial.println(F("  INPUTS         - vstupy (raw+logical)"));
   Serial.println(F("  TEMP           - teploty (OpenTherm + DS18B20 role mapping)"));
   Serial.println(F("  OT             - OpenTherm status JSON"));
+  Serial.println(F("  OTBENCH        - alokace/čas: openthermGetStatus() vs openthermGetTelemetry() + alokace na loop()"));
+  Serial.println(F("  LOOP           - plánovače úloh (control/io/net): perioda, běhy, zpoždění, čas (LOOP RESET)"));
+  Serial.println(F("  I2C            - sdílená I2C sběrnice: fronta, obnovy, výsledky a časy po zařízeních"));
+  Serial.println(F("  NETLOAD ms [ms] - umělá zátěž sítě: výpočet ms každých [ms] v net úloze (NETLOAD OFF)"));
   Serial.println(F("  OTSCAN START   - scan Data-IDs 0..127 (supported only)"));
   Serial.println(F("  OTSCAN ALL     - scan Data-IDs 0..127 (includeAll=true)"));
   Serial.println(F("  OTSCAN STATUS  - print scan status JSON"));
@@ -120,11 +152,147 @@ static void printTemps() {
   printTankTemps();
 }
 
+// Compares the String-based OpenTherm status adapter with the POD telemetry
+// read and prints heap allocations per loop() pass.
+static void runOtBench() {
+  static constexpr uint32_t kIter = 1000;
+  volatile uint32_t sink = 0;
+  const bool counted = allocCounterSupported();
+
+  uint32_t a0 = allocCounterGet();
+  uint32_t t0 = micros();
+  for (uint32_t i = 0; i < kIter; i++) {
+    const OpenThermStatusSnapshot s = openthermGetStatus();
+    sink += s.okCount + s.lastCmd.length();
+  }
+  const uint32_t statusUs = micros() - t0;
+  const uint32_t statusAllocs = allocCounterGet() - a0;
+
+  a0 = allocCounterGet();
+  t0 = micros();
+  for (uint32_t i = 0; i < kIter; i++) {
+    const OpenThermTelemetry t = openthermGetTelemetry();
+    sink += t.okCount + (uint32_t)t.lastCmdText[0];
+  }
+  const uint32_t telemetryUs = micros() - t0;
+  const uint32_t telemetryAllocs = allocCounterGet() - a0;
+  (void)sink;
+
+  Serial.printf("[BENCH] openthermGetStatus():    %.2f us/call, allocs/call %s%.2f\n",
+                (float)statusUs / kIter, counted ? "" : "n/a ", (float)statusAllocs / kIter);
+  Serial.printf("[BENCH] openthermGetTelemetry(): %.2f us/call, allocs/call %s%.2f\n",
+                (float)telemetryUs / kIter, counted ? "" : "n/a ", (float)telemetryAllocs / kIter);
+  if (!counted) {
+    Serial.println(F("[BENCH] allocation counter n/a (core built without CONFIG_HEAP_USE_HOOKS)"));
+    return;
+  }
+  const AllocLoopStats ls = allocCounterGetLoopStats();
+  Serial.printf("[BENCH] loop(): allocs last=%lu max=%lu avg=%.2f (%lu loops)\n",
+                (unsigned long)ls.lastPerLoop, (unsigned long)ls.maxPerLoop, ls.avgPerLoop, (unsigned long)ls.loops);
+}
+
 static void setRelayWithMixingInterlock(RelayId id, bool on) {
   // RelayController already applies the configured mixing-valve interlock.
   relaySet(id, on);
 }
 
+// Stats are copied under the domain lock and printed outside it, so the
+// console never holds up the control task.
+static void printSchedStats(const char* title, TaskDomain domain, const LoopScheduler& sched, uint32_t spanUs) {
+  LoopTaskStats st[LoopScheduler::kMaxTasks];
+  uint8_t n = 0;
+  uint32_t passes = 0;
+  uint64_t busy = 0;
+  {
+    TaskDomainLock lock(domain);
+    n = sched.taskCount();
+    for (uint8_t i = 0; i < n; i++) st[i] = sched.taskStats(i);
+    passes = sched.passes();
+    busy = sched.busyUs();
+  }
+  const bool ownTask = domain == TaskDomain::Net || taskDomainRunning(domain);
+  Serial.printf("[%s%s] passes=%u in %.1f s, busy %.2f%%\n", title, ownTask ? "" : " in loop()", (unsigned)passes,
+                spanUs / 1e6, spanUs ? 100.0 * (double)busy / (double)spanUs : 0.0);
+  Serial.println(F("task         period   runs  woken  lateAvg lateMax  costAvg costMax [us]"));
+  for (uint8_t i = 0; i < n; i++) {
+    const uint32_t timed = st[i].runs - st[i].wakeRuns;
+    Serial.printf("%-12s %6u %6u %6u %8u %7u %8u %7u\n", sched.taskName(i), (unsigned)sched.taskPeriodMs(i),
+                  (unsigned)st[i].runs, (unsigned)st[i].wakeRuns,
+                  (unsigned)(timed ? st[i].lateSumUs / timed : 0), (unsigned)st[i].lateMaxUs,
+                  (unsigned)(st[i].runs ? st[i].costSumUs / st[i].runs : 0), (unsigned)st[i].costMaxUs);
+  }
+}
+
+static void printLoopStats() {
+  const uint32_t spanUs = (uint32_t)micros() - s_schedStatsSinceUs;
+  printSchedStats("control", TaskDomain::Control, s_ctlSched, spanUs);
+  printSchedStats("io", TaskDomain::Io, s_ioSched, spanUs);
+  printSchedStats("net", TaskDomain::Net, s_netSched, spanUs);
+  const EquithermPulseTiming pt = equithermGetPulseTiming();
+  Serial.printf("valve pulses=%u (timer %u), on-time over request avg %u us, max %u us; netload %u ms\n",
+                (unsigned)pt.pulses, (unsigned)pt.timerEnds,
+                (unsigned)(pt.pulses ? pt.lateSumUs / pt.pulses : 0), (unsigned)pt.lateMaxUs,
+                (unsigned)(s_netLoadBusyUs / 1000u));
+}
+
+static void printI2cStats() {
+  const I2cBusStats bus = i2cGetStats();
+  Serial.printf("[I2C] %s, queued %u (max %u), submitted %u, full %u, urgent %u, wait max %u us, "
+                "recoveries %u (failed %u)\n",
+                bus.online ? "online" : "OFFLINE", (unsigned)bus.queued, (unsigned)bus.queuedMax,
+                (unsigned)bus.submitted, (unsigned)bus.queueFull, (unsigned)bus.urgent, (unsigned)bus.waitMaxUs,
+                (unsigned)bus.recoveries, (unsigned)bus.recoveryFails);
+  for (uint8_t i = 0; i < i2cDeviceCount(); i++) {
+    const I2cDeviceStats d = i2cGetDeviceStats(i);
+    Serial.printf("  0x%02X timeout %u ms: ok %u, nack %u, timeout %u, offline %u, bus max %u us\n",
+                  (unsigned)d.addr, (unsigned)d.timeoutMs, (unsigned)d.ok, (unsigned)d.nacks, (unsigned)d.timeouts,
+                  (unsigned)d.offline, (unsigned)d.busMaxUs);
+  }
+}
+
+static void resetLoopStats() {
+  {
+    ControlLock lock;
+    s_ctlSched.resetStats();
+  }
+  {
+    IoLock lock;
+    s_ioSched.resetStats();
+  }
+  {
+    NetLock lock;
+    s_netSched.resetStats();
+  }
+  equithermResetPulseTiming();
+  s_schedStatsSinceUs = (uint32_t)micros();
+}
+
+static void netLoadTask() {
+  const uint32_t busyUs = s_netLoadBusyUs;
+  if (!busyUs) return;
+  const uint32_t t0 = (uint32_t)micros();
+  while ((uint32_t)micros() - t0 < busyUs) {}
+}
+
+// NETLOAD <busy ms> [every ms] | NETLOAD OFF
+static void setNetLoad(String arg) {
+  arg.trim();
+  uint32_t busyMs = 0;
+  uint32_t everyMs = 1000;
+  if (arg.length() && arg != "OFF") {
+    const int sp = arg.indexOf(' ');
+    busyMs = (uint32_t)arg.substring(0, sp < 0 ? arg.length() : sp).toInt();
+    if (sp > 0) everyMs = (uint32_t)arg.substring(sp + 1).toInt();
+  }
+  if (busyMs > 500) busyMs = 500;
+  if (everyMs < 2 * busyMs) everyMs = 2 * busyMs;
+  if (everyMs < 10) everyMs = 10;
+  s_netLoadBusyUs = busyMs * 1000u;
+  s_netSched.setPeriod(s_netLoadTask, everyMs);
+  if (busyMs) Serial.printf("[LOOP] netload %u ms every %u ms\n", (unsigned)busyMs, (unsigned)everyMs);
+  else Serial.println(F("[LOOP] netload off"));
+}
+
 static void processCommand(String cmd) {
   cmd.trim();
   String up = cmd;
@@ -159,6 +327,15 @@ static void processCommand(String cmd) {
   }
 
   if (up == "OT") { Serial.println(openthermGetStatusJson()); return; }
+  if (up == "OTBENCH") { runOtBench(); return; }
+  if (up == "LOOP") { printLoopStats(); return; }
+  if (up == "LOOP RESET") {
+    resetLoopStats();
+    Serial.println(F("[LOOP] stats reset"));
+    return;
+  }
+  if (up == "I2C") { printI2cStats(); return; }
+  if (up.startsWith("NETLOAD")) { setNetLoad(up.substring(7)); return; }
   if (up == "BLE") { Serial.println(bleGetStatusJson()); return; }
   if (up == "OTA") { Serial.println(otaGetStatusJson()); return; }
   if (up == "EQ") { Serial.println(equithermGetStatusJson()); return; }
@@ -231,6 +408,64 @@ static void processCommand(String cmd) {
   Serial.println(F("Unknown command. Use HELP."));
 }
 
+static void serviceConsole() {
+  while (Serial.available()) {
+    char c = (char)Serial.read();
+    if (c == '\n' || c == '\r') {
+      if (s_cmd.length()) {
+        processCommand(s_cmd);
+        s_cmd = "";
+      }
+    } else {
+      s_cmd += c;
+      if (s_cmd.length() > 160) s_cmd = "";
+    }
+  }
+}
+
+// Periods bound how long a module waits for its turn; each module still
+// keeps its own timing. Within a domain, registration order is the former
+// loop() order.
+static void setupLoopTasks() {
+  // Control: relay outputs and everything that drives them.
+  s_ctlSched.add("inputs", inputUpdate, 10, kWakeInput);
+  s_ctlSched.add("relays", relayUpdate, 10);
+  s_ctlSched.add("buzzer", buzzerLoop, 10);
+  s_ctlSched.add("pressure", pressureAlarmLoop, 200);
+  // DHW / circulation priority control
+  s_ctlSched.add("dhw", dhwLoop, 100);
+  // Ekviterm (uses temps + OT). Valve pulses end on the relay stop timer; the
+  // short period accounts for them promptly and is the backstop without it.
+  s_ctlSched.add("equitherm", equithermLoop, 5);
+
+  // I/O: sensors and the boiler bus.
+  s_ioSched.add("dallas", DallasController::loop, 10);
+  // OpenTherm polling (no-op when opentherm.runInTask moved it to core 0)
+  s_ioSched.add("opentherm", openthermLoop, 5);
+  s_ioSched.add("ble", bleLoop, 20);
+  s_ioSched.add("history", HistoryBuffer::loop, 1000);
+  // Central temperature registry (keeps roles consistent across program)
+  s_ioSched.add("temps", TemperatureManager::loop, 100);
+  s_ioSched.add("energy", boilerEnergyLoop, 100);
+
+  // Network and operator commands. The synchronous raw Data-ID read/write
+  // paths and an OTA upload still wait inside this task, but under NetLock
+  // only, so the I/O task keeps running.
+  s_netSched.add("console", serviceConsole, 20);
+  s_netSched.add("network", networkLoop, 10);
+  s_netSched.add("web", webPortalLoop, 5);
+  // ArduinoOTA.handle() takes over for the whole upload once it starts.
+  s_netSched.add("ota", otaLoop, 10);
+  // MQTT runtime: reconnect, subscriptions, periodic state and HA discovery.
+  s_netSched.add("mqtt", mqttLoop, 20);
+  s_netLoadTask = s_netSched.add("netload", netLoadTask, 1000);
+
+  s_schedStatsSinceUs = (uint32_t)micros();
+  inputSetEdgeHook(onInputEdgeWake);
+  taskDomainStart(TaskDomain::Control, s_ctlSched);
+  taskDomainStart(TaskDomain::Io, s_ioSched);
+}
+
 // -------------------- Setup/Loop --------------------
 
 void setup() {
@@ -238,6 +473,9 @@ void setup() {
   Serial.println();
   Serial.println(F("=== ESP Heat & Domestic Controller (MINIMAL) ==="));
 
+  // Domain locks first: module APIs take them from here on.
+  taskDomainsBegin();
+
   relayInit();
   inputInit();
 
@@ -272,6 +510,7 @@ void setup() {
   // Buzzer + pressure alarm + diagnostics
   buzzerInit();
   pressureAlarmInit();
+  boilerEnergyInit();
   EventLog::begin();
   HistoryBuffer::begin();
   EventLog::record("system", "boot", "startup");
@@ -286,58 +525,21 @@ void setup() {
   // DHW / circulation
   dhwInit();
 
+  setupLoopTasks();
+
   printHelp();
 }
 
 void loop() {
-  // Console
-  while (Serial.available()) {
-    char c = (char)Serial.read();
-    if (c == '\n' || c == '\r') {
-      if (s_cmd.length()) {
-        processCommand(s_cmd);
-        s_cmd = "";
-      }
-    } else {
-      s_cmd += c;
-      if (s_cmd.length() > 160) s_cmd = "";
-    }
-  }
-
-  inputUpdate();
-  relayUpdate();
-
-  DallasController::loop();
-
-  // Network and operator commands are serviced before potentially longer
-  // OpenTherm transactions. The WebSocket loop is also called from the OT wait
-  // hook, so manual valve commands remain responsive throughout polling.
-  networkLoop();
-  webPortalLoop();
-
-  // OpenTherm polling
-  openthermLoop();
-
-  // BLE client
-  bleLoop();
-
-  HistoryBuffer::loop();
-
-  // Central temperature registry (keeps roles consistent across program)
-  TemperatureManager::loop();
-
-  // OTA handler must run often (active when any IP interface is connected)
-  otaLoop();
-
-  // MQTT runtime: reconnect, subscriptions, periodic state and HA discovery.
-  mqttLoop();
-
-  buzzerLoop();
-  pressureAlarmLoop();
-
-  // DHW / circulation priority control
-  dhwLoop();
-
-  // Ekviterm (uses temps + OT)
-  equithermLoop();
+  allocCounterLoopBegin();
+  uint32_t idleUs = taskDomainRunPass(TaskDomain::Net, s_netSched);
+  // A domain whose task could not be created runs here, at loop priority.
+  if (!taskDomainRunning(TaskDomain::Control)) idleUs = min(idleUs, taskDomainRunPass(TaskDomain::Control, s_ctlSched));
+  if (!taskDomainRunning(TaskDomain::Io)) idleUs = min(idleUs, taskDomainRunPass(TaskDomain::Io, s_ioSched));
+  allocCounterLoopEnd();
+
+  // Sleep until the earliest deadline or a wake event. A wait of n ticks
+  // ends on the n-th tick interrupt, so it is rounded up; ending a little
+  // early only costs one more short wait, never a busy spin.
+  if (idleUs) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(idleUs / 1000u) + 1);
 }
@@ -17,6 +17,7 @@
 #include "RelayController.h"
 #include "NetworkController.h"
 #include "OpenThermController.h"
+#include "TaskDomains.h"
 #include "EventLog.h"
 #include "WebPortalController.h"
 
@@ -26,6 +27,11 @@ namespace {
   EquithermStatus s_st;
   bool s_externalBlock = false;
 
+  // Hydraulic port sources resolved from s_cfg.mixTempSource* at load.
+  TemperatureManager::SourceId s_mixSrcA = TemperatureManager::SourceId::None;
+  TemperatureManager::SourceId s_mixSrcB = TemperatureManager::SourceId::None;
+  TemperatureManager::SourceId s_mixSrcAB = TemperatureManager::SourceId::None;
+
   float s_outsideFiltered = NAN;
   uint32_t s_lastComputeMs = 0;
   uint32_t s_lastOutsideFilterMs = 0;
@@ -37,6 +43,9 @@ namespace {
   static constexpr uint32_t kMixFeedbackMissingWarnMs = 5000;
   static constexpr uint32_t kMixFeedbackMissingFaultMs = 20000;
   static constexpr uint32_t kMixActuatorRetryHoldMs = 120000;
+  // The relay stop timer ends valve pulses; the control loop stops one itself
+  // only when the timer is this late.
+  static constexpr uint32_t kMixStopBackstopMs = 50;
   // A temperature change smaller than this is treated as sensor noise. There is
   // only one automatic post-pulse evaluation window and its duration is always
   // the configured mixMinIntervalMs; no hidden fixed 2.5/7.5 s timer exists.
@@ -227,6 +236,9 @@ namespace {
     s_cfg.mixTempSourceA = TemperatureManager::normalizeSourceKey(ConfigStore::getEqMixTempSourceA(), "tank_mid");
     s_cfg.mixTempSourceB = TemperatureManager::normalizeSourceKey(ConfigStore::getEqMixTempSourceB(), "return_dallas");
     s_cfg.mixTempSourceAB = TemperatureManager::normalizeSourceKey(ConfigStore::getEqMixTempSourceAB(), "opentherm_ch");
+    s_mixSrcA = TemperatureManager::resolveSourceKey(s_cfg.mixTempSourceA);
+    s_mixSrcB = TemperatureManager::resolveSourceKey(s_cfg.mixTempSourceB);
+    s_mixSrcAB = TemperatureManager::resolveSourceKey(s_cfg.mixTempSourceAB);
 
     // Boiler assist
     s_cfg.boilerAssistEnabled = ConfigStore::getEqBoilerAssistEnabled();
@@ -374,7 +386,7 @@ namespace {
     if (now - lastTryMs < 60000) return true;
     lastTryMs = now;
 
-    OpenThermStatusSnapshot ot = openthermGetStatus();
+    OpenThermTelemetry ot = openthermGetTelemetry();
     s_st.boilerMaxChC = ot.maxChSetpointC;
     s_st.boilerMaxBoundMinC = ot.maxChBoundMinC;
     s_st.boilerMaxBoundMaxC = ot.maxChBoundMaxC;
@@ -439,9 +451,11 @@ namespace {
     int8_t lastCalibrationDir = 0;
     bool feedbackAtStartValid = false;
     float feedbackAtStartC = NAN;
+    uint32_t relaySeq = 0;  // RelayMixingPulse::seq of the running pulse
   };
 
   static MixPulse s_mix;
+  static EquithermPulseTiming s_pulseTiming;
 
   static bool mixFeedbackRecent(uint32_t now) {
     return isfinite(s_lastMixFeedbackC)
@@ -607,17 +621,41 @@ namespace {
     const bool pulsePostTargetMove = s_mix.postTargetMove;
     const bool pulseFeedbackValid = s_mix.feedbackAtStartValid;
     const float pulseStartFeedbackC = s_mix.feedbackAtStartC;
-    const uint32_t elapsedMs = mixElapsedMs(now);
 
     // The pulse is complete only after both direction relays have been verified
-    // OFF. Even if that verification fails, clear the software pulse state so a
-    // later retry can only target the fail-safe OFF mask.
-    (void)mixAllOff();
-    s_mix.lastPulseMs = elapsedMs;
+    // OFF. Normally the relay stop timer has done that at the deadline; otherwise
+    // (no timer, stopped early, OFF write failed) it is done here. Even if that
+    // verification fails, clear the software pulse state so a later retry can
+    // only target the fail-safe OFF mask.
+    RelayMixingPulse rp = relayGetMixingPulse();
+    bool relayEnded = rp.seq == s_mix.relaySeq && !rp.active;
+    if (relayEnded && rp.offOk) {
+      s_mix.lastRelayApplyOk = true;
+      s_mix.lastRelayMask = relayGetMask();
+    } else {
+      (void)mixAllOff();
+      if (!relayEnded) {
+        rp = relayGetMixingPulse();
+        relayEnded = rp.seq == s_mix.relaySeq && !rp.active;
+      }
+    }
+
+    // Measured on-time, from the ON write to the OFF write, so the position
+    // follows what the actuator really got.
+    const uint32_t onTimeUs = relayEnded ? rp.onTimeUs : mixElapsedMs(now) * 1000u;
+    const uint32_t requestedUs = s_mix.requestedMs * 1000u;
+    if (requestedUs && onTimeUs >= requestedUs) {
+      const uint32_t lateUs = onTimeUs - requestedUs;
+      s_pulseTiming.pulses++;
+      if (relayEnded && rp.endedByTimer) s_pulseTiming.timerEnds++;
+      s_pulseTiming.lateSumUs += lateUs;
+      if (lateUs > s_pulseTiming.lateMaxUs) s_pulseTiming.lateMaxUs = lateUs;
+    }
+    s_mix.lastPulseMs = (onTimeUs + 500u) / 1000u;
     s_mix.lastActMs = now; // minimum interval is measured from relay OFF
 
     const float stepPct = (s_cfg.mixTravelMs > 0)
-      ? (100.0f * ((float)elapsedMs / (float)s_cfg.mixTravelMs))
+      ? (100.0f * ((float)onTimeUs / 1000.0f / (float)s_cfg.mixTravelMs))
       : 0.0f;
     if (pulseForceEndPosition) {
       mixMarkCalibrated(s_mix.endPositionPct, pulseDir);
@@ -636,6 +674,7 @@ namespace {
     s_mix.postTargetMove = false;
     s_mix.feedbackAtStartValid = false;
     s_mix.feedbackAtStartC = NAN;
+    s_mix.relaySeq = 0;
 
     // One and only one automatic post-pulse state machine is used for support.
     // It waits until AB has been stable for the full configured minimum interval,
@@ -681,6 +720,7 @@ namespace {
     s_mix.postTargetMove = false;
     s_mix.feedbackAtStartValid = false;
     s_mix.feedbackAtStartC = NAN;
+    s_mix.relaySeq = 0;
   }
 
   static bool mixStartPulse(int8_t dir, uint32_t now, bool manual = false,
@@ -705,11 +745,13 @@ namespace {
     // Physical meaning is fixed and shared by UI/backend:
     // A/+1/R1 = hot accumulator branch, raises AB, estimated position 100 %.
     // B/-1/R2 = return/cool branch, lowers AB, estimated position 0 %.
+    // The relay driver ends the pulse on its own timer (relayStartMixingPulse).
     uint8_t appliedMask = relayGetMask();
-    const bool relayApplied = relaySetMixingDirection(dir, &appliedMask);
+    const bool relayApplied = relayStartMixingPulse(dir, pulseMs, &appliedMask);
     s_mix.lastRelayApplyOk = relayApplied;
     s_mix.lastRelayMask = appliedMask;
     if (!relayApplied) return false;
+    s_mix.relaySeq = relayGetMixingPulse().seq;
 
     s_mix.active = true;
     s_mix.manual = manual;
@@ -737,7 +779,12 @@ namespace {
       if (s_mix.active) stopMixingNow(now, true);
       return;
     }
-    if (s_mix.active && (int32_t)(now - s_mix.untilMs) >= 0) mixFinalizePulse(now);
+    if (!s_mix.active) return;
+    // Accounts for a pulse the relay stop timer has ended. The deadline here is
+    // only the backstop: at once without the timer, after a margin with it.
+    const RelayMixingPulse rp = relayGetMixingPulse();
+    const int32_t backstopMs = rp.timed ? (int32_t)kMixStopBackstopMs : 0;
+    if (rp.seq != s_mix.relaySeq || !rp.active || (int32_t)(now - s_mix.untilMs) >= backstopMs) mixFinalizePulse(now);
   }
 
   static bool mixAutoRecalibrationDue(uint32_t now) {
@@ -844,9 +891,9 @@ namespace {
 
     // Read all three hydraulic ports even when automatic equitherm control is
     // disabled, so the Thermometers and Mixing pages remain useful for service.
-    const TempValue mixATv = TemperatureManager::getBySourceKey(s_cfg.mixTempSourceA, s_cfg.tempMaxAgeMs);
-    const TempValue mixBTv = TemperatureManager::getBySourceKey(s_cfg.mixTempSourceB, s_cfg.tempMaxAgeMs);
-    const TempValue mixABTv = TemperatureManager::getBySourceKey(s_cfg.mixTempSourceAB, s_cfg.tempMaxAgeMs);
+    const TempValue mixATv = TemperatureManager::getBySource(s_mixSrcA, s_cfg.tempMaxAgeMs);
+    const TempValue mixBTv = TemperatureManager::getBySource(s_mixSrcB, s_cfg.tempMaxAgeMs);
+    const TempValue mixABTv = TemperatureManager::getBySource(s_mixSrcAB, s_cfg.tempMaxAgeMs);
     s_st.mixTempASelected = s_cfg.mixTempSourceA;
     s_st.mixTempBSelected = s_cfg.mixTempSourceB;
     s_st.mixTempABSelected = s_cfg.mixTempSourceAB;
@@ -890,9 +937,9 @@ namespace {
     }
 
     // Need OpenTherm present if we want to control via OT.
-    OpenThermStatusSnapshot ot{};
+    OpenThermTelemetry ot{};
     if (s_cfg.useOpenTherm) {
-      ot = openthermGetStatus();
+      ot = openthermGetTelemetry();
       if (!ot.present || !ot.ready) {
         if (s_mix.active && s_mix.manual) {
           fillManualMixStatus(millis(), "manual_pulse");
@@ -1559,6 +1606,7 @@ namespace {
 }
 
 void equithermInit() {
+  ControlLock lock;
   if (s_inited) return;
   s_inited = true;
   equithermReloadFromStore();
@@ -1572,6 +1620,8 @@ void equithermInit() {
   s_mix = MixPulse{};
   s_mix.positionPct = 50.0f;
   mixAllOff();
+  // Tboiler is the mixing-valve feedback (port AB) -> keep it fresh.
+  openthermDeclarePollInterest(25, 2000, OpenThermPollPriority::Control);
   Serial.println("[EQ] Init");
 }
 
@@ -1583,20 +1633,25 @@ void equithermLoop() {
   // OpenTherm writes are still rate-limited by minSendIntervalMs inside computeAndSend().
   if (now - s_lastComputeMs < kEqControlIntervalMs) return;
   s_lastComputeMs = now;
+  // Night relay and valve pair of one decision go out in one expander write.
+  RelayTransaction relayTx;
   computeAndSend();
 }
 
 EquithermConfig equithermGetConfig() {
+  ControlLock lock;
   equithermInit();
   return s_cfg;
 }
 
 EquithermStatus equithermGetStatus() {
+  ControlLock lock;
   equithermInit();
   return s_st;
 }
 
 void equithermFillFastJson(JsonObject& out) {
+  ControlLock lock;
   equithermInit();
   out["en"] = s_cfg.enabled;
   if (s_st.modeReq.length()) out["m"] = s_st.modeReq; else out["m"] = nullptr;
@@ -1639,6 +1694,7 @@ void equithermFillFastJson(JsonObject& out) {
 }
 
 String equithermGetStatusJson() {
+  ControlLock lock;
   equithermInit();
   DynamicJsonDocument doc(8192);
   doc["ok"] = true;
@@ -1834,6 +1890,7 @@ static void applyConfigDoc(JsonObjectConst o) {
 }
 
 void equithermReloadFromStore() {
+  ControlLock lock;
   const String previousFeedbackSource = s_cfg.mixTempSourceAB;
   const float previousSupportOffsetC = s_cfg.mixTargetOffsetC;
   const String previousTargetAction = s_cfg.mixTargetReachedAction;
@@ -1852,6 +1909,7 @@ void equithermReloadFromStore() {
 }
 
 void equithermApplyConfig(const String& json) {
+  ControlLock lock;
   StaticJsonDocument<4096> doc;
   if (deserializeJson(doc, json)) return;
   if (!doc.is<JsonObject>()) return;
@@ -1885,6 +1943,7 @@ void equithermApplyConfig(const String& json) {
 }
 
 bool equithermHandleCmdJson(const String& json, String& outErr) {
+  ControlLock lock;
   outErr = "";
   StaticJsonDocument<512> doc;
   if (deserializeJson(doc, json) || !doc.is<JsonObject>()) {
@@ -2036,8 +2095,11 @@ bool equithermHandleCmdJson(const String& json, String& outErr) {
 }
 
 void equithermBackgroundService() {
-  equithermInit();
-  mixUpdate(millis());
+  {
+    ControlLock lock;
+    equithermInit();
+    mixUpdate(millis());
+  }
   // OpenTherm transactions can block for several hundred milliseconds. Service
   // the allow-listed WebSocket command channel during those waits so a manual
   // valve action reaches R1/R2 immediately after the pointer press.
@@ -2045,14 +2107,33 @@ void equithermBackgroundService() {
 }
 
 void equithermRequestRecompute() {
+  ControlLock lock;
   recomputeNow();
 }
 
+EquithermPulseTiming equithermGetPulseTiming() {
+  ControlLock lock;
+  return s_pulseTiming;
+}
+
+void equithermResetPulseTiming() {
+  ControlLock lock;
+  s_pulseTiming = EquithermPulseTiming{};
+}
+
 extern "C" void openThermBackgroundService(void) {
+  // Only the synchronous raw Data-ID paths wait inside the OpenTherm library.
+  // The dedicated OpenTherm task never does, and must not run loop-task code.
+  if (openthermIsTaskContext()) return;
+  // With its own task the valve needs no help, and the waiting network task
+  // holds the OpenTherm lock: WebSocket commands taking ControlLock here
+  // would invert the lock order (TaskDomains.h). They wait for the read.
+  if (taskDomainRunning(TaskDomain::Control)) return;
   equithermBackgroundService();
 }
 
 void equithermSetExternalBlock(bool blocked) {
+  ControlLock lock;
   const bool changed = (s_externalBlock != blocked);
   s_externalBlock = blocked;
   if (blocked) {
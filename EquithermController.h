@@ -217,3 +217,14 @@ void equithermBackgroundService();
 
 // Force immediate recompute on external state changes such as IN1 day/night input.
 void equithermRequestRecompute();
+
+// Mixing valve pulse end timing: how long after the requested end the relays
+// were switched off, over pulses that ran to their end (console LOOP).
+struct EquithermPulseTiming {
+  uint32_t pulses = 0;     // valve pulses that ran to their requested length
+  uint32_t timerEnds = 0;  // of those, ended by the relay stop timer
+  uint32_t lateMaxUs = 0;  // measured on-time beyond the requested length
+  uint64_t lateSumUs = 0;
+};
+EquithermPulseTiming equithermGetPulseTiming();
+void equithermResetPulseTiming();
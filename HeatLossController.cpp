@@ -46,13 +46,13 @@ namespace {
     }
 
     if (s == "opentherm.room") {
-      OpenThermStatusSnapshot ot = openthermGetStatus();
+      OpenThermTelemetry ot = openthermGetTelemetry();
       if (isfinite(ot.roomTempC)) { if (ok) *ok = true; return ot.roomTempC; }
       if (why) *why = "ot room NAN";
       return NAN;
     }
     if (s == "opentherm.outdoor") {
-      OpenThermStatusSnapshot ot = openthermGetStatus();
+      OpenThermTelemetry ot = openthermGetTelemetry();
       if (isfinite(ot.outsideTempC)) { if (ok) *ok = true; return ot.outsideTempC; }
       if (why) *why = "ot outdoor NAN";
       return NAN;
@@ -70,7 +70,7 @@ namespace {
 
   static float getPowerKw(bool* ok, String* why) {
     if (ok) *ok = false;
-    OpenThermStatusSnapshot ot = openthermGetStatus();
+    OpenThermTelemetry ot = openthermGetTelemetry();
     if (isfinite(ot.modulationPct)) {
       if (ok) *ok = true;
       return (ot.modulationPct / 100.0f) * g_cfg.assumedMaxBoilerKw;
@@ -4,28 +4,33 @@
 #include "OpenThermController.h"
 #include "EquithermController.h"
 #include "DhwController.h"
+#include "TaskDomains.h"
 
 namespace {
+  // Fixed point (TempCenti.h): hundredths of a degree, of a bar and of a
+  // percent; kTempCentiInvalid marks a missing value. 24 bytes per sample
+  // instead of 44 with floats.
   struct Sample {
     uint32_t ms = 0;
-    float outsideC = NAN;
-    float flowC = NAN;
-    float dhwC = NAN;
-    float returnC = NAN;
-    float tankTopC = NAN;
-    float tankMidC = NAN;
-    float tankBottomC = NAN;
-    float pressureBar = NAN;
-    float mixPct = NAN;
+    TempCenti outsideC = kTempCentiInvalid;
+    TempCenti flowC = kTempCentiInvalid;
+    TempCenti dhwC = kTempCentiInvalid;
+    TempCenti returnC = kTempCentiInvalid;
+    TempCenti tankTopC = kTempCentiInvalid;
+    TempCenti tankMidC = kTempCentiInvalid;
+    TempCenti tankBottomC = kTempCentiInvalid;
+    TempCenti pressureBar = kTempCentiInvalid;
+    TempCenti mixPct = kTempCentiInvalid;
     bool dhwHeat = false;
   };
+  static_assert(sizeof(Sample) <= 24, "history sample grew");
   constexpr size_t kCap = 240;
   constexpr uint32_t kPeriodMs = 60000UL;
   Sample g_samples[kCap];
   size_t g_head = 0;
   size_t g_count = 0;
   uint32_t g_lastSampleMs = 0;
-  inline float tv(TempRole r){ TempValue v = TemperatureManager::get(r, 1800000UL); return (v.valid && isfinite(v.c)) ? v.c : NAN; }
+  inline TempCenti tv(TempRole r){ return TemperatureManager::get(r, 1800000UL).centi; }
   void pushSample() {
     Sample s{};
     s.ms = millis();
@@ -36,10 +41,10 @@ namespace {
     s.tankTopC = tv(TempRole::TankTop);
     s.tankMidC = tv(TempRole::TankMid);
     s.tankBottomC = tv(TempRole::TankBottom);
-    OpenThermStatusSnapshot ot = openthermGetStatus();
-    s.pressureBar = (ot.present && ot.ready && isfinite(ot.pressureBar)) ? ot.pressureBar : NAN;
+    OpenThermTelemetry ot = openthermGetTelemetry();
+    s.pressureBar = (ot.present && ot.ready) ? tempCentiFromC(ot.pressureBar) : kTempCentiInvalid;
     EquithermStatus eq = equithermGetStatus();
-    s.mixPct = eq.mixPositionPct;
+    s.mixPct = tempCentiFromC(eq.mixPositionPct);
     s.dhwHeat = dhwIsHeatActive();
     g_samples[g_head] = s;
     g_head = (g_head + 1) % kCap;
@@ -48,7 +53,9 @@ namespace {
 }
 namespace HistoryBuffer {
   void begin() { clear(); }
-  void clear() { for(size_t i=0;i<kCap;i++) g_samples[i]=Sample{}; g_head=0; g_count=0; g_lastSampleMs=0; }
+  // The ring belongs to the I/O domain; the readers below run on the network
+  // task and take IoLock (TaskDomains.h).
+  void clear() { IoLock lock; for(size_t i=0;i<kCap;i++) g_samples[i]=Sample{}; g_head=0; g_count=0; g_lastSampleMs=0; }
   void loop() {
     uint32_t now = millis();
     if (g_lastSampleMs && (uint32_t)(now - g_lastSampleMs) < kPeriodMs) return;
@@ -56,6 +63,7 @@ namespace HistoryBuffer {
     pushSample();
   }
   void fillJson(JsonArray out, size_t maxItems) {
+    IoLock lock;
     const size_t count = (g_count < maxItems) ? g_count : maxItems;
     const size_t start = (g_head + kCap - count) % kCap;
     for(size_t i=0;i<count;i++){
@@ -63,23 +71,52 @@ namespace HistoryBuffer {
       if(!s.ms) continue;
       JsonObject o = out.createNestedObject();
       o["ms"] = s.ms;
-      if (isfinite(s.outsideC)) o["outsideC"] = s.outsideC; else o["outsideC"] = nullptr;
-      if (isfinite(s.flowC)) o["flowC"] = s.flowC; else o["flowC"] = nullptr;
-      if (isfinite(s.dhwC)) o["dhwC"] = s.dhwC; else o["dhwC"] = nullptr;
-      if (isfinite(s.returnC)) o["returnC"] = s.returnC; else o["returnC"] = nullptr;
-      if (isfinite(s.tankTopC)) o["tankTopC"] = s.tankTopC; else o["tankTopC"] = nullptr;
-      if (isfinite(s.tankMidC)) o["tankMidC"] = s.tankMidC; else o["tankMidC"] = nullptr;
-      if (isfinite(s.tankBottomC)) o["tankBottomC"] = s.tankBottomC; else o["tankBottomC"] = nullptr;
-      if (isfinite(s.pressureBar)) o["pressureBar"] = s.pressureBar; else o["pressureBar"] = nullptr;
-      if (isfinite(s.mixPct)) o["mixPct"] = s.mixPct; else o["mixPct"] = nullptr;
+      TemperatureManager::putCentiJson(o["outsideC"], s.outsideC);
+      TemperatureManager::putCentiJson(o["flowC"], s.flowC);
+      TemperatureManager::putCentiJson(o["dhwC"], s.dhwC);
+      TemperatureManager::putCentiJson(o["returnC"], s.returnC);
+      TemperatureManager::putCentiJson(o["tankTopC"], s.tankTopC);
+      TemperatureManager::putCentiJson(o["tankMidC"], s.tankMidC);
+      TemperatureManager::putCentiJson(o["tankBottomC"], s.tankBottomC);
+      TemperatureManager::putCentiJson(o["pressureBar"], s.pressureBar);
+      TemperatureManager::putCentiJson(o["mixPct"], s.mixPct);
       o["dhwHeat"] = s.dhwHeat;
     }
   }
+  // Written directly (same shape as fillJson()): 240 samples no longer need
+  // a 24 kB document, and values are copied as pre-formatted digits.
   String toJson(size_t maxItems) {
-    DynamicJsonDocument doc(24576);
-    doc["ok"] = true;
-    JsonArray arr = doc.createNestedArray("items");
-    fillJson(arr, maxItems);
-    String out; serializeJson(doc,out); return out;
+    IoLock lock;
+    const size_t count = (g_count < maxItems) ? g_count : maxItems;
+    const size_t start = (g_head + kCap - count) % kCap;
+    String out;
+    out.reserve(16 + count * 180);
+    out += "{\"ok\":true,\"items\":[";
+    char num[kTempCentiTextMax];
+    const auto put = [&](const char* key, TempCenti v) {
+      out += key;
+      tempCentiFormat(v, num);
+      out += num;
+    };
+    bool first = true;
+    for(size_t i=0;i<count;i++){
+      const Sample &s = g_samples[(start+i)%kCap];
+      if(!s.ms) continue;
+      out += first ? "{\"ms\":" : ",{\"ms\":";
+      first = false;
+      out += String(s.ms);
+      put(",\"outsideC\":", s.outsideC);
+      put(",\"flowC\":", s.flowC);
+      put(",\"dhwC\":", s.dhwC);
+      put(",\"returnC\":", s.returnC);
+      put(",\"tankTopC\":", s.tankTopC);
+      put(",\"tankMidC\":", s.tankMidC);
+      put(",\"tankBottomC\":", s.tankBottomC);
+      put(",\"pressureBar\":", s.pressureBar);
+      put(",\"mixPct\":", s.mixPct);
+      out += s.dhwHeat ? ",\"dhwHeat\":true}" : ",\"dhwHeat\":false}";
+    }
+    out += "]}";
+    return out;
   }
 }
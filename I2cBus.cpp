@@ -1,16 +1,291 @@
-#include "I2cBus.h"
-#include <Wire.h>
-#include "config_pins.h"
-
-static bool s_i2cReady = false;
-
-void i2cInit() {
-  if (s_i2cReady) return;
-  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
-  Wire.setClock(I2C_FREQ_HZ);
-  s_i2cReady = true;
-}
-
-bool i2cIsReady() {
-  return s_i2cReady;
-}
+#include "I2cBus.h"
+#include <driver/gpio.h>
+#include <driver/i2c_master.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "config_pins.h"
+#include "Log.h"
+
+namespace {
+  // Above the control task (TaskDomains.cpp): it mostly waits for the bus,
+  // and a control pass waiting for a relay write should not wait for the CPU
+  // on top of that.
+  constexpr UBaseType_t kI2cTaskPrio = 5;
+  constexpr uint32_t kI2cTaskStack = 4096;
+  constexpr BaseType_t kI2cTaskCore = 1;
+  constexpr uint8_t kNoEvent = 0xFF;
+
+  // i2c master driver in async mode: the transfer is queued in the driver and
+  // its end signalled from the ISR, so the timeout is ours, per device. After
+  // a timeout the transfer may still be owned by the hardware; the buffers are
+  // members and the bus is re-created before the next one.
+  class IdfBackend : public I2cBackend {
+  public:
+    bool begin() {
+      if (!_done) _done = xSemaphoreCreateBinary();
+      return _done && createBus();
+    }
+
+    bool attach(uint8_t dev, uint8_t addr) override {
+      if (dev >= I2cBusCore::kMaxDevices) return false;
+      _addr[dev] = addr;
+      if (dev >= _devCount) _devCount = (uint8_t)(dev + 1);
+      return !_bus || attachDevice(dev);
+    }
+
+    I2cResult transfer(uint8_t dev, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen,
+                       uint32_t timeoutMs) override {
+      i2c_master_dev_handle_t h = dev < _devCount ? _devs[dev] : nullptr;
+      if (!h) return I2cResult::BusError;
+      memcpy(_tx, tx, txLen);
+      xSemaphoreTake(_done, 0);  // left over from a timed-out transfer
+      _event = kNoEvent;
+      esp_err_t err;
+      if (!txLen) err = i2c_master_receive(h, _rx, rxLen, -1);
+      else if (!rxLen) err = i2c_master_transmit(h, _tx, txLen, -1);
+      else err = i2c_master_transmit_receive(h, _tx, txLen, _rx, rxLen, -1);
+      if (err != ESP_OK) return err == ESP_ERR_TIMEOUT ? I2cResult::Timeout : I2cResult::BusError;
+      if (xSemaphoreTake(_done, pdMS_TO_TICKS(timeoutMs) + 1) != pdTRUE) return I2cResult::Timeout;
+      switch (_event) {
+        case I2C_EVENT_DONE:
+          memcpy(rx, _rx, rxLen);
+          return I2cResult::Ok;
+        case I2C_EVENT_NACK:
+          return I2cResult::Nack;
+        default:
+          return I2cResult::BusError;
+      }
+    }
+
+    I2cResult probe(uint8_t addr, uint32_t timeoutMs) override {
+      if (!_bus) return I2cResult::BusError;
+      switch (i2c_master_probe(_bus, addr, (int)timeoutMs)) {
+        case ESP_OK: return I2cResult::Ok;
+        case ESP_ERR_NOT_FOUND: return I2cResult::Nack;
+        case ESP_ERR_TIMEOUT: return I2cResult::Timeout;
+        default: return I2cResult::BusError;
+      }
+    }
+
+    // Nine clocks and a STOP free a slave holding SDA; the driver is then
+    // re-created, which also drops a transfer it still considers running.
+    bool recover() override {
+      if (_bus) i2c_master_bus_reset(_bus);
+      destroyBus();
+      return createBus() && gpio_get_level((gpio_num_t)I2C_SDA_PIN) == 1;
+    }
+
+  private:
+    bool createBus() {
+      i2c_master_bus_config_t cfg = {};
+      cfg.i2c_port = -1;  // any free port
+      cfg.sda_io_num = (gpio_num_t)I2C_SDA_PIN;
+      cfg.scl_io_num = (gpio_num_t)I2C_SCL_PIN;
+      cfg.clk_source = I2C_CLK_SRC_DEFAULT;
+      cfg.glitch_ignore_cnt = 7;
+      cfg.trans_queue_depth = 1;  // async; the queue is I2cBusCore's
+      cfg.flags.enable_internal_pullup = true;
+      if (i2c_new_master_bus(&cfg, &_bus) != ESP_OK) {
+        _bus = nullptr;
+        return false;
+      }
+      for (uint8_t i = 0; i < _devCount; i++) {
+        if (!attachDevice(i)) return false;
+      }
+      return true;
+    }
+
+    bool attachDevice(uint8_t dev) {
+      i2c_device_config_t dc = {};
+      dc.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+      dc.device_address = _addr[dev];
+      dc.scl_speed_hz = I2C_FREQ_HZ;
+      if (i2c_master_bus_add_device(_bus, &dc, &_devs[dev]) != ESP_OK) {
+        _devs[dev] = nullptr;
+        return false;
+      }
+      i2c_master_event_callbacks_t cbs = {};
+      cbs.on_trans_done = onTransDone;
+      if (i2c_master_register_event_callbacks(_devs[dev], &cbs, this) != ESP_OK) {
+        i2c_master_bus_rm_device(_devs[dev]);
+        _devs[dev] = nullptr;
+        return false;
+      }
+      return true;
+    }
+
+    void destroyBus() {
+      for (uint8_t i = 0; i < _devCount; i++) {
+        if (_devs[i]) i2c_master_bus_rm_device(_devs[i]);
+        _devs[i] = nullptr;
+      }
+      if (_bus) i2c_del_master_bus(_bus);
+      _bus = nullptr;
+    }
+
+    static bool IRAM_ATTR onTransDone(i2c_master_dev_handle_t, const i2c_master_event_data_t* evt, void* arg) {
+      IdfBackend* self = (IdfBackend*)arg;
+      self->_event = (uint8_t)evt->event;
+      BaseType_t woken = pdFALSE;
+      xSemaphoreGiveFromISR(self->_done, &woken);
+      return woken == pdTRUE;
+    }
+
+    i2c_master_bus_handle_t _bus = nullptr;
+    i2c_master_dev_handle_t _devs[I2cBusCore::kMaxDevices] = {};
+    uint8_t _addr[I2cBusCore::kMaxDevices] = {};
+    uint8_t _devCount = 0;
+    SemaphoreHandle_t _done = nullptr;
+    volatile uint8_t _event = kNoEvent;
+    uint8_t _tx[kI2cMaxTx] = {};
+    uint8_t _rx[kI2cMaxRx] = {};
+  };
+
+  uint32_t busClockUs() { return (uint32_t)micros(); }
+
+  IdfBackend s_backend;
+  I2cBusCore s_core(s_backend, busClockUs);
+  bool s_ready = false;
+  TaskHandle_t s_task = nullptr;
+  // Queue (submit/pop) under the spinlock; the bus itself (execute, service,
+  // device table) under the mutex, held by the i2c task per transaction.
+  portMUX_TYPE s_queueMux = portMUX_INITIALIZER_UNLOCKED;
+  SemaphoreHandle_t s_busMtx = nullptr;
+
+  bool popNext(I2cTxn& t) {
+    taskENTER_CRITICAL(&s_queueMux);
+    const bool have = s_core.pop(t);
+    taskEXIT_CRITICAL(&s_queueMux);
+    return have;
+  }
+
+  // One recovery attempt if due, then one transaction. False when idle.
+  bool runNext() {
+    xSemaphoreTakeRecursive(s_busMtx, portMAX_DELAY);
+    s_core.service();
+    I2cTxn t;
+    const bool have = popNext(t);
+    if (have) s_core.execute(t);
+    xSemaphoreGiveRecursive(s_busMtx);
+    return have;
+  }
+
+  void i2cTaskMain(void*) {
+    for (;;) {
+      if (runNext()) continue;
+      const bool online = s_core.online();
+      ulTaskNotifyTake(pdTRUE, online ? portMAX_DELAY : pdMS_TO_TICKS(s_core.recoveryInMs()) + 1);
+    }
+  }
+
+  struct SyncWait {
+    SemaphoreHandle_t sem;
+    I2cResult res;
+    uint8_t* rx;
+    uint8_t rxLen;
+  };
+
+  void syncDone(void* ctx, I2cResult res, const uint8_t* rx, uint8_t rxLen) {
+    SyncWait& w = *(SyncWait*)ctx;
+    w.res = res;
+    if (w.rx && rxLen) memcpy(w.rx, rx, rxLen < w.rxLen ? rxLen : w.rxLen);
+    xSemaphoreGive(w.sem);  // last: the waiter owns w from here
+  }
+
+  I2cResult submitAndWait(I2cTxn& t, uint8_t* rx, uint8_t rxLen, bool urgent) {
+    if (!s_ready) return I2cResult::Offline;
+    if (t.dev != kI2cProbe && t.dev >= s_core.deviceCount()) return I2cResult::BusError;
+    if (s_task && xTaskGetCurrentTaskHandle() == s_task) return I2cResult::Offline;  // would wait for itself
+    StaticSemaphore_t semBuf;
+    SyncWait w = {xSemaphoreCreateBinaryStatic(&semBuf), I2cResult::Offline, rx, rxLen};
+    t.done = syncDone;
+    t.ctx = &w;
+    if (!i2cSubmit(t, urgent)) {
+      vSemaphoreDelete(w.sem);
+      return I2cResult::QueueFull;
+    }
+    // Every accepted transaction completes: within its timeout on the bus, at
+    // once while the bus is offline.
+    xSemaphoreTake(w.sem, portMAX_DELAY);
+    vSemaphoreDelete(w.sem);
+    return w.res;
+  }
+}
+
+void i2cInit() {
+  if (s_ready) return;
+  s_busMtx = xSemaphoreCreateRecursiveMutex();
+  if (!s_busMtx) return;
+  // A failed start is a bus error at the first transaction; recovery retries.
+  if (!s_backend.begin()) LOGW("I2C bus init failed, recovering from the i2c task");
+  s_ready = true;
+
+  TaskHandle_t h = nullptr;
+  if (xTaskCreatePinnedToCore(i2cTaskMain, "i2c", kI2cTaskStack, nullptr, kI2cTaskPrio, &h, kI2cTaskCore) != pdPASS) {
+    LOGW("I2C task create failed, transactions run in the caller");
+    return;
+  }
+  s_task = h;
+}
+
+bool i2cIsReady() {
+  return s_ready;
+}
+
+int8_t i2cAddDevice(uint8_t addr, uint16_t timeoutMs) {
+  if (!s_ready) return -1;
+  xSemaphoreTakeRecursive(s_busMtx, portMAX_DELAY);
+  const int8_t id = s_core.addDevice(addr, timeoutMs);
+  xSemaphoreGiveRecursive(s_busMtx);
+  return id;
+}
+
+bool i2cSubmit(const I2cTxn& t, bool urgent) {
+  if (!s_ready) return false;
+  taskENTER_CRITICAL(&s_queueMux);
+  const bool ok = s_core.submit(t, urgent);
+  taskEXIT_CRITICAL(&s_queueMux);
+  if (!ok) return false;
+  if (s_task) {
+    xTaskNotifyGive(s_task);
+  } else {
+    while (runNext()) {}
+  }
+  return true;
+}
+
+I2cResult i2cTransact(uint8_t dev, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen, bool urgent) {
+  if (txLen > kI2cMaxTx || rxLen > kI2cMaxRx) return I2cResult::BusError;
+  I2cTxn t;
+  t.dev = dev;
+  t.txLen = txLen;
+  t.rxLen = rxLen;
+  if (txLen) memcpy(t.tx, tx, txLen);
+  return submitAndWait(t, rx, rxLen, urgent);
+}
+
+I2cResult i2cProbe(uint8_t addr) {
+  I2cTxn t;
+  t.dev = kI2cProbe;
+  t.addr = addr;
+  return submitAndWait(t, nullptr, 0, false);
+}
+
+I2cBusStats i2cGetStats() {
+  taskENTER_CRITICAL(&s_queueMux);
+  const I2cBusStats s = s_core.stats();
+  taskEXIT_CRITICAL(&s_queueMux);
+  return s;
+}
+
+I2cDeviceStats i2cGetDeviceStats(uint8_t dev) {
+  taskENTER_CRITICAL(&s_queueMux);
+  const I2cDeviceStats s = s_core.deviceStats(dev);
+  taskEXIT_CRITICAL(&s_queueMux);
+  return s;
+}
+
+uint8_t i2cDeviceCount() {
+  return s_core.deviceCount();
+}
@@ -2,6 +2,37 @@
 
 #include <Arduino.h>
 
-// Centralized I2C init for the board.
+#include "I2cBusCore.h"
+
+// Shared I2C bus of the board (TCA9554 relay expander, PCF85063 RTC).
+//
+// The bus belongs to the "i2c" task: callers queue transactions and the task
+// runs them one at a time on the ESP-IDF i2c master driver in async mode,
+// each with the timeout of its device. Recovery of a stuck bus (clock pulses,
+// driver re-init, backoff) runs on that task too; while the bus is down
+// transactions fail at once with Offline instead of blocking their caller.
+// Wire is not used and must not be started (it would claim the same port).
+
 void i2cInit();
 bool i2cIsReady();
+
+// Registers a device (7-bit address) and its transaction timeout. Returns the
+// device id, -1 when the table is full. The same address gets the same id.
+int8_t i2cAddDevice(uint8_t addr, uint16_t timeoutMs);
+
+// Queues a transaction; t.done is called from the i2c task when it completes.
+// Urgent ones run next, ahead of the queue. False (no callback) when it was
+// not accepted.
+bool i2cSubmit(const I2cTxn& t, bool urgent = false);
+
+// Queues the transaction and waits for its result: at most the transactions
+// ahead of it plus its own device timeout. Not from a completion callback.
+I2cResult i2cTransact(uint8_t dev, const uint8_t* tx, uint8_t txLen, uint8_t* rx = nullptr, uint8_t rxLen = 0,
+                      bool urgent = false);
+
+// Address probe (START, address, STOP) without a registered device.
+I2cResult i2cProbe(uint8_t addr);
+
+I2cBusStats i2cGetStats();
+I2cDeviceStats i2cGetDeviceStats(uint8_t dev);
+uint8_t i2cDeviceCount();
@@ -0,0 +1,238 @@
+#pragma once
+
+// Transaction queue of the shared I2C bus (I2cBus.h) without the RTOS and
+// the driver: those are the I2cBackend and the worker task in I2cBus.cpp.
+// A host tool drives it with a simulated bus and a virtual clock
+// (tools/i2c_bus_bench.cpp).
+//
+// Callers queue transactions (a write, a write + repeated-start read, or an
+// address probe) and get the result in a completion callback; urgent ones
+// (the valve OFF write) go ahead of the queue. The worker takes them one at
+// a time and runs each on the bus with the timeout of its device.
+//
+// A timeout or a bus error takes the bus offline: from then on queued
+// transactions complete at once with Offline and never touch the bus, and
+// service() attempts a recovery (clock pulses, driver re-init) with backoff.
+// A NACK is the device's answer and leaves the bus online.
+//
+// Every accepted transaction gets exactly one callback. submit() and pop()
+// are the only calls that touch the queue; the caller serialises them.
+// Fixed memory, no allocation.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "RetryPolicy.h"
+
+enum class I2cResult : uint8_t { Ok = 0, Nack, Timeout, BusError, Offline, QueueFull };
+
+inline const char* i2cResultName(I2cResult r) {
+  switch (r) {
+    case I2cResult::Ok: return "ok";
+    case I2cResult::Nack: return "nack";
+    case I2cResult::Timeout: return "timeout";
+    case I2cResult::BusError: return "bus error";
+    case I2cResult::Offline: return "offline";
+    case I2cResult::QueueFull: return "queue full";
+  }
+  return "?";
+}
+
+static constexpr uint8_t kI2cMaxTx = 8;
+static constexpr uint8_t kI2cMaxRx = 8;
+static constexpr uint8_t kI2cProbe = 0xFF;  // I2cTxn::dev of an address probe
+
+// Runs on the worker: short, no bus calls of its own and no locks a waiting
+// submitter may hold. rx is valid only during the call.
+typedef void (*I2cDoneFn)(void* ctx, I2cResult res, const uint8_t* rx, uint8_t rxLen);
+
+struct I2cTxn {
+  uint8_t dev = 0;      // id from addDevice(), kI2cProbe for a probe of addr
+  uint8_t addr = 0;     // probes only
+  uint8_t txLen = 0;
+  uint8_t rxLen = 0;    // read after the write, with a repeated start
+  uint8_t tx[kI2cMaxTx] = {};
+  I2cDoneFn done = nullptr;
+  void* ctx = nullptr;
+  uint32_t queuedUs = 0;  // set by submit()
+};
+
+struct I2cDeviceStats {
+  uint8_t addr = 0;
+  uint16_t timeoutMs = 0;
+  uint32_t ok = 0;
+  uint32_t nacks = 0;
+  uint32_t timeouts = 0;   // also bus errors
+  uint32_t offline = 0;    // failed fast while the bus was down
+  uint32_t busMaxUs = 0;   // on the bus, per transaction
+};
+
+struct I2cBusStats {
+  bool online = true;
+  uint32_t submitted = 0;
+  uint32_t completed = 0;
+  uint32_t queueFull = 0;
+  uint32_t urgent = 0;
+  uint32_t recoveries = 0;      // successful
+  uint32_t recoveryFails = 0;
+  uint32_t waitMaxUs = 0;       // submit to start on the bus
+  uint8_t queued = 0;
+  uint8_t queuedMax = 0;
+};
+
+// One transaction at a time; returns when it completed or its timeout expired.
+class I2cBackend {
+public:
+  virtual ~I2cBackend() = default;
+  virtual bool attach(uint8_t dev, uint8_t addr) = 0;
+  virtual I2cResult transfer(uint8_t dev, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen,
+                             uint32_t timeoutMs) = 0;
+  virtual I2cResult probe(uint8_t addr, uint32_t timeoutMs) = 0;
+  // Frees a stuck bus and re-creates the driver; true when the bus is usable.
+  virtual bool recover() = 0;
+};
+
+class I2cBusCore {
+public:
+  static constexpr uint8_t kMaxDevices = 4;
+  static constexpr uint8_t kQueueLen = 16;
+  static constexpr uint16_t kProbeTimeoutMs = 10;
+  typedef uint32_t (*ClockUs)();
+
+  I2cBusCore(I2cBackend& backend, ClockUs clock)
+      : _backend(backend), _clock(clock), _recoverRetry(20, 2.0f, 2000, 0.2f) {}
+
+  // Returns the device id, -1 when the table is full.
+  int8_t addDevice(uint8_t addr, uint16_t timeoutMs) {
+    for (uint8_t i = 0; i < _devCount; i++) {
+      if (_dev[i].addr == addr) return (int8_t)i;
+    }
+    if (_devCount >= kMaxDevices) return -1;
+    I2cDeviceStats& d = _dev[_devCount];
+    d = I2cDeviceStats{};
+    d.addr = addr;
+    d.timeoutMs = timeoutMs ? timeoutMs : kProbeTimeoutMs;
+    _backend.attach(_devCount, addr);
+    return (int8_t)_devCount++;
+  }
+
+  // False (no callback) for an unknown device, an oversized transfer or a
+  // full queue.
+  bool submit(const I2cTxn& t, bool urgent = false) {
+    const bool valid = t.dev == kI2cProbe ? (t.txLen == 0 && t.rxLen == 0)
+                                          : (t.dev < _devCount && t.txLen <= kI2cMaxTx && t.rxLen <= kI2cMaxRx &&
+                                             (t.txLen || t.rxLen));
+    if (!valid) return false;
+    if (_count >= kQueueLen) {
+      _stats.queueFull++;
+      return false;
+    }
+    if (urgent) {
+      _head = (uint8_t)((_head + kQueueLen - 1) % kQueueLen);
+      _queue[_head] = t;
+      _queue[_head].queuedUs = _clock();
+      _stats.urgent++;
+    } else {
+      I2cTxn& slot = _queue[(_head + _count) % kQueueLen];
+      slot = t;
+      slot.queuedUs = _clock();
+    }
+    _count++;
+    _stats.submitted++;
+    if (_count > _stats.queuedMax) _stats.queuedMax = _count;
+    return true;
+  }
+
+  bool pop(I2cTxn& out) {
+    if (!_count) return false;
+    out = _queue[_head];
+    _head = (uint8_t)((_head + 1) % kQueueLen);
+    _count--;
+    return true;
+  }
+
+  // Runs t on the bus (or fails it fast when offline) and calls its callback.
+  void execute(const I2cTxn& t) {
+    const uint32_t startUs = _clock();
+    const uint32_t waitUs = startUs - t.queuedUs;
+    if (waitUs > _stats.waitMaxUs) _stats.waitMaxUs = waitUs;
+
+    uint8_t rx[kI2cMaxRx] = {};
+    I2cResult res = I2cResult::Offline;
+    I2cDeviceStats* d = t.dev < _devCount ? &_dev[t.dev] : nullptr;
+    if (_online) {
+      res = t.dev == kI2cProbe ? _backend.probe(t.addr, kProbeTimeoutMs)
+                               : _backend.transfer(t.dev, t.tx, t.txLen, rx, t.rxLen, d->timeoutMs);
+      if (res == I2cResult::Timeout || res == I2cResult::BusError) {
+        _online = false;
+        _recoverRetry.reset(startUs / 1000u);
+      }
+    }
+
+    if (d) {
+      const uint32_t busUs = _clock() - startUs;
+      if (res != I2cResult::Offline && busUs > d->busMaxUs) d->busMaxUs = busUs;
+      switch (res) {
+        case I2cResult::Ok: d->ok++; break;
+        case I2cResult::Nack: d->nacks++; break;
+        case I2cResult::Offline: d->offline++; break;
+        default: d->timeouts++; break;
+      }
+    }
+    _stats.completed++;
+    if (t.done) t.done(t.ctx, res, rx, res == I2cResult::Ok ? t.rxLen : 0);
+  }
+
+  // Recovery attempt when the bus is offline and the backoff allows it.
+  // Returns true when the bus is online.
+  bool service() {
+    if (_online) return true;
+    const uint32_t nowMs = _clock() / 1000u;
+    if (!_recoverRetry.canAttempt(nowMs)) return false;
+    if (_backend.recover()) {
+      _online = true;
+      _stats.recoveries++;
+      _recoverRetry.onSuccess(nowMs);
+      return true;
+    }
+    _stats.recoveryFails++;
+    _recoverRetry.onFail(nowMs);
+    return false;
+  }
+
+  // Until the next recovery attempt; 0 when due or online.
+  uint32_t recoveryInMs() const {
+    if (_online) return 0;
+    const int32_t left = (int32_t)(_recoverRetry.nextAttemptAt() - _clock() / 1000u);
+    return left > 0 ? (uint32_t)left : 0;
+  }
+
+  bool online() const { return _online; }
+  uint8_t queued() const { return _count; }
+  uint8_t deviceCount() const { return _devCount; }
+  uint16_t deviceTimeoutMs(uint8_t dev) const { return dev < _devCount ? _dev[dev].timeoutMs : kProbeTimeoutMs; }
+
+  I2cBusStats stats() const {
+    I2cBusStats s = _stats;
+    s.online = _online;
+    s.queued = _count;
+    return s;
+  }
+
+  I2cDeviceStats deviceStats(uint8_t dev) const { return dev < _devCount ? _dev[dev] : I2cDeviceStats{}; }
+
+private:
+  I2cBackend& _backend;
+  ClockUs _clock;
+  RetryPolicy _recoverRetry;
+  bool _online = true;
+
+  I2cDeviceStats _dev[kMaxDevices];
+  uint8_t _devCount = 0;
+
+  I2cTxn _queue[kQueueLen];
+  uint8_t _head = 0;
+  uint8_t _count = 0;
+
+  I2cBusStats _stats;
+};
@@ -23,6 +23,12 @@ static InputItem inputs[INPUT_COUNT] = {
 };
 
 static InputChangeCallback callback = nullptr;
+static volatile InputEdgeHook edgeHook = nullptr;
+
+static void IRAM_ATTR onInputEdge() {
+    const InputEdgeHook hook = edgeHook;
+    if (hook != nullptr) hook();
+}
 
 void inputInit() {
     const uint32_t now = millis();
@@ -53,6 +59,16 @@ void inputSetCallback(InputChangeCallback cb) {
     callback = cb;
 }
 
+void inputSetEdgeHook(InputEdgeHook hook) {
+    edgeHook = hook;
+    for (uint8_t i = 0; i < INPUT_COUNT; i++) {
+        const uint8_t pin = inputs[i].pin;
+        if (pin == 0xFF) continue;
+        if (hook != nullptr) attachInterrupt(digitalPinToInterrupt(pin), onInputEdge, CHANGE);
+        else detachInterrupt(digitalPinToInterrupt(pin));
+    }
+}
+
 static bool isIndexValid(InputId id) {
     return static_cast<uint8_t>(id) < INPUT_COUNT;
 }
@@ -16,10 +16,15 @@ enum class InputId : uint8_t {
 };
 
 using InputChangeCallback = void(*)(InputId id, bool state);
+// Called from the GPIO interrupt on every raw edge of a used input (before
+// debounce). Must be IRAM-safe and short; meant to wake the main loop so
+// inputUpdate() runs right away instead of at its next period.
+using InputEdgeHook = void(*)();
 
 void inputInit();
 void inputUpdate();
 void inputSetCallback(InputChangeCallback cb);
+void inputSetEdgeHook(InputEdgeHook hook);
 
 // Debounced raw level (HIGH/LOW as bool: true=HIGH)
 bool inputGetRaw(InputId id);
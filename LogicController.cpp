@@ -826,7 +826,7 @@ static bool tryGetTempFromSource(const EqSourceCfg& src, float &outC, EqSourceDi
 
     if (s.startsWith("opentherm")){
         #if defined(FEATURE_OPENTHERM)
-        OpenThermStatusSnapshot ot = openthermGetStatus();
+        OpenThermTelemetry ot = openthermGetTelemetry();
         if (!ot.ready) {
             if (diag) diag->reason = "OT not ready";
             return false;
@@ -0,0 +1,147 @@
+#pragma once
+
+// Deadline-based cooperative scheduler for the main loop. Arduino-free (the
+// clock is injected) so it can be driven by a virtual clock on a host
+// (tools/loop_sched_bench.cpp).
+//
+// Every task has a period and optionally a set of wake events. One pass
+// (runDue()) runs, in registration order, each task whose deadline has
+// passed or that listens to an event raised since the last pass, and
+// returns the time to the earliest remaining deadline; the caller blocks
+// for that long (or until wake() is signalled) instead of spinning.
+//
+// Deadlines advance by the period from the previous deadline, so a task
+// keeps its cadence however late a single pass is. A task that missed whole
+// periods (a long OpenTherm transmit, a blocking HTTP request) runs once
+// and continues one period from now: no burst of catch-up runs. A run
+// triggered by an event also restarts the period.
+//
+// Modules keep their own internal timing; the period only bounds how often
+// they are asked. Fixed memory, no allocation.
+
+#include <atomic>
+#include <stdint.h>
+
+struct LoopTaskStats {
+  uint32_t runs = 0;
+  uint32_t wakeRuns = 0;   // runs started by an event before the deadline
+  uint32_t lateMaxUs = 0;  // worst start after the deadline
+  uint64_t lateSumUs = 0;  // over deadline runs, for the mean
+  uint32_t costMaxUs = 0;
+  uint64_t costSumUs = 0;
+};
+
+class LoopScheduler {
+public:
+  static constexpr uint8_t kMaxTasks = 20;
+  typedef void (*TaskFn)();
+  typedef uint32_t (*ClockUs)();
+
+  explicit LoopScheduler(ClockUs clock) : _clock(clock) {}
+
+  // Returns the task id, -1 when the table is full. The first run is at
+  // the next pass.
+  int8_t add(const char* name, TaskFn fn, uint32_t periodMs, uint32_t wakeEvents = 0) {
+    if (_count >= kMaxTasks || !fn) return -1;
+    Task& t = _tasks[_count];
+    t.name = name;
+    t.fn = fn;
+    t.periodUs = periodUs(periodMs);
+    t.wakeEvents = wakeEvents;
+    t.nextUs = _clock();
+    t.stats = LoopTaskStats{};
+    return (int8_t)_count++;
+  }
+
+  void setPeriod(int8_t id, uint32_t periodMs) {
+    if (id < 0 || id >= (int8_t)_count) return;
+    Task& t = _tasks[id];
+    const uint32_t p = periodUs(periodMs);
+    t.nextUs = t.nextUs - t.periodUs + p;
+    t.periodUs = p;
+  }
+
+  // Raises events; every task listening to one of them runs at the next
+  // pass. Lock-free, callable from an ISR or another task. Waking the
+  // blocked loop itself is up to the caller (task notification).
+  void wake(uint32_t events) { _events.fetch_or(events, std::memory_order_relaxed); }
+
+  // One pass. Returns microseconds until the earliest deadline, 0 when a
+  // task is already due again or an event arrived during the pass.
+  uint32_t runDue() {
+    const uint32_t passStart = _clock();
+    const uint32_t events = _events.exchange(0, std::memory_order_acquire);
+    for (uint8_t i = 0; i < _count; i++) {
+      Task& t = _tasks[i];
+      const uint32_t now = _clock();
+      const int32_t late = (int32_t)(now - t.nextUs);
+      const bool woken = (events & t.wakeEvents) != 0;
+      if (late < 0 && !woken) continue;
+
+      LoopTaskStats& s = t.stats;
+      if (late >= 0) {
+        if ((uint32_t)late > s.lateMaxUs) s.lateMaxUs = (uint32_t)late;
+        s.lateSumUs += (uint32_t)late;
+        t.nextUs += t.periodUs;
+        if ((int32_t)(now - t.nextUs) >= 0) t.nextUs = now + t.periodUs;  // missed whole periods
+      } else {
+        s.wakeRuns++;
+        t.nextUs = now + t.periodUs;
+      }
+      s.runs++;
+      t.fn();
+      const uint32_t cost = _clock() - now;
+      if (cost > s.costMaxUs) s.costMaxUs = cost;
+      s.costSumUs += cost;
+    }
+    const uint32_t end = _clock();
+    _passes++;
+    _busyUs += end - passStart;
+
+    if (_events.load(std::memory_order_relaxed)) return 0;
+    uint32_t idle = UINT32_MAX;
+    for (uint8_t i = 0; i < _count; i++) {
+      const int32_t left = (int32_t)(_tasks[i].nextUs - end);
+      if (left <= 0) return 0;
+      if ((uint32_t)left < idle) idle = (uint32_t)left;
+    }
+    return _count ? idle : 0;
+  }
+
+  uint8_t taskCount() const { return _count; }
+  const char* taskName(uint8_t i) const { return i < _count ? _tasks[i].name : nullptr; }
+  uint32_t taskPeriodMs(uint8_t i) const { return i < _count ? _tasks[i].periodUs / 1000u : 0; }
+  const LoopTaskStats& taskStats(uint8_t i) const { return _tasks[i < _count ? i : 0].stats; }
+  uint32_t passes() const { return _passes; }
+  uint64_t busyUs() const { return _busyUs; }  // time spent inside runDue()
+
+  void resetStats() {
+    for (uint8_t i = 0; i < _count; i++) _tasks[i].stats = LoopTaskStats{};
+    _passes = 0;
+    _busyUs = 0;
+  }
+
+private:
+  struct Task {
+    const char* name = nullptr;
+    TaskFn fn = nullptr;
+    uint32_t periodUs = 0;
+    uint32_t wakeEvents = 0;
+    uint32_t nextUs = 0;
+    LoopTaskStats stats;
+  };
+
+  // At least 1 ms; at most 30 min so deadline arithmetic stays wrap-safe.
+  static uint32_t periodUs(uint32_t ms) {
+    if (ms < 1) ms = 1;
+    if (ms > 1800000u) ms = 1800000u;
+    return ms * 1000u;
+  }
+
+  ClockUs _clock;
+  Task _tasks[kMaxTasks];
+  uint8_t _count = 0;
+  std::atomic<uint32_t> _events{0};
+  uint32_t _passes = 0;
+  uint64_t _busyUs = 0;
+};
@@ -15,6 +15,7 @@
 #include "OtaController.h"
 #include "EquithermController.h"
 #include "DhwController.h"
+#include "BoilerEnergyController.h"
 #include "Log.h"
 
 namespace {
@@ -44,6 +45,8 @@ namespace {
     uint32_t lastConnectAttemptMs = 0;
     uint32_t lastPublishMs = 0;
     uint32_t lastDiscoveryMs = 0;
+    uint32_t energyRevision = 0;
+    bool energyPublished = false;
     uint32_t connectCount = 0;
     uint32_t disconnectCount = 0;
     int lastError = 0;
@@ -54,6 +57,7 @@ namespace {
     String topicAvailability;
     String topicCmdRoot;
     String topicInfo;
+    String topicEnergy;
     esp_mqtt_client_handle_t client = nullptr;
   };
 
@@ -87,6 +91,7 @@ namespace {
   static String mqttTopicAvailability() { return s_st.topicAvailability.length() ? s_st.topicAvailability : (s_cfg.baseTopic + "/availability"); }
   static String mqttTopicCmdRoot() { return s_st.topicCmdRoot.length() ? s_st.topicCmdRoot : (s_cfg.baseTopic + "/cmd"); }
   static String mqttTopicInfo() { return s_st.topicInfo.length() ? s_st.topicInfo : (s_cfg.baseTopic + "/info"); }
+  static String mqttTopicEnergy() { return s_st.topicEnergy.length() ? s_st.topicEnergy : (s_cfg.baseTopic + "/energy"); }
 
   static String relayStateTemplate(uint8_t idx) {
     const uint8_t mask = (uint8_t)(1u << idx);
@@ -131,6 +136,7 @@ namespace {
     s_st.topicAvailability = s_cfg.baseTopic + "/availability";
     s_st.topicCmdRoot = s_cfg.baseTopic + "/cmd";
     s_st.topicInfo = s_cfg.baseTopic + "/info";
+    s_st.topicEnergy = s_cfg.baseTopic + "/energy";
   }
 
   static void mqttStopClient() {
@@ -179,8 +185,7 @@ namespace {
   static void fillTemps(JsonObject temps) {
     const auto putRole = [&](const char* key, TempRole role) {
       TempValue tv = TemperatureManager::get(role, 600000);
-      if (tv.valid && isfinite(tv.c)) temps[key] = tv.c;
-      else temps[key] = nullptr;
+      TemperatureManager::putCentiJson(temps[key], tv.centi);
       temps[String(key) + "Src"] = tempSourceText(tv.src);
       temps[String(key) + "AgeMs"] = tv.valid ? tv.ageMs : 0;
     };
@@ -232,6 +237,9 @@ namespace {
     JsonObject dhw = doc.createNestedObject("dhw");
     dhwFillFastJson(dhw);
 
+    JsonObject en = doc.createNestedObject("en");
+    boilerEnergyFillFastJson(en);
+
     String out;
     serializeJson(doc, out);
     return out;
@@ -317,6 +325,8 @@ namespace {
       {"mix_position", "Smesovaci ventil", "{{ value_json.eq.mix.pct }}", "%", nullptr, "measurement", "mdi:valve"},
       {"boiler_pressure", "Tlak systemu", "{{ value_json.ot.pr }}", "bar", "pressure", "measurement", nullptr},
       {"boiler_setpoint", "Pozadovana CH", "{{ value_json.ot.cs }}", "°C", "temperature", "measurement", nullptr},
+      {"boiler_energy_today", "Energie kotle dnes", "{{ value_json.en.d }}", "kWh", "energy", "total_increasing", nullptr},
+      {"burner_starts_hour", "Starty horaku za hodinu", "{{ value_json.en.sph }}", nullptr, nullptr, "measurement", "mdi:fire"},
     };
     for (const auto& def : sensors) {
       DynamicJsonDocument doc(1024);
@@ -428,6 +438,18 @@ namespace {
     publishRaw(mqttTopicState(), buildStateJson(), true, 0);
   }
 
+  // Day/week/month series change only when a bucket is persisted; publish
+  // them retained on their own topic instead of growing the periodic state.
+  static void publishEnergy(bool force = false) {
+    if (!s_st.connected) return;
+    const uint32_t rev = boilerEnergySeriesRevision();
+    if (!force && s_st.energyPublished && rev == s_st.energyRevision) return;
+    if (publishRaw(mqttTopicEnergy(), boilerEnergyGetJson(), true, 0)) {
+      s_st.energyRevision = rev;
+      s_st.energyPublished = true;
+    }
+  }
+
   static void handleCmdRelay(const String& suffix, const String& payload) {
     if (!suffix.startsWith("relay/")) return;
     int slash = suffix.indexOf('/', 6);
@@ -545,6 +567,7 @@ namespace {
           s_st.runtime = "connected";
           s_st.discoveryPublished = false;
           s_st.subscribed = false;
+          s_st.energyPublished = false; // republished from mqttLoop()
           s_st.lastError = 0;
           s_st.lastErrorText = "";
           publishAvailability("online");
@@ -620,6 +643,7 @@ void mqttLoop() {
       publishDiscovery();
     }
     publishState(false);
+    publishEnergy(false);
   }
 }
 
@@ -654,6 +678,7 @@ void mqttFillStatusJson(JsonObject& mqtt, bool includePreview) {
   mqtt["publishIntervalMs"] = (uint32_t)s_cfg.publishIntervalMs;
   mqtt["stateTopic"] = mqttTopicState();
   mqtt["availabilityTopic"] = mqttTopicAvailability();
+  mqtt["energyTopic"] = mqttTopicEnergy();
   mqtt["connectCount"] = (uint32_t)s_st.connectCount;
   mqtt["disconnectCount"] = (uint32_t)s_st.disconnectCount;
   mqtt["lastError"] = s_st.lastError;
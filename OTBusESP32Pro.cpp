@@ -1,4 +1,5 @@
 #include "OTBusESP32Pro.h"
+#include "OpenThermRmtRx.h"
 
 #if defined(ARDUINO_ARCH_ESP32)
 #include <esp_task_wdt.h>
@@ -8,13 +9,32 @@
 
 using namespace otbus;
 
+extern "C" void openThermBackgroundService(void) __attribute__((weak));
+
 OTBusESP32Pro* OTBusESP32Pro::instance = nullptr;
 
 OTBusESP32Pro::OTBusESP32Pro() {}
 
-void OTBusESP32Pro::begin(int inPin, int outPin, bool roleMaster)
+OTBusESP32Pro::~OTBusESP32Pro()
+{
+  if (_rmt) {
+    delete _rmt;
+    _rmt = nullptr;
+  }
+  if (ot) {
+    delete ot;
+    ot = nullptr;
+  }
+  if (instance == this) instance = nullptr;
+}
+
+void OTBusESP32Pro::begin(int inPin, int outPin, bool roleMaster, RxBackend rx)
 {
   this->roleMaster = roleMaster;
+  if (_rmt) {
+    delete _rmt;
+    _rmt = nullptr;
+  }
   if (ot) {
     delete ot;
     ot = nullptr;
@@ -25,6 +45,18 @@ void OTBusESP32Pro::begin(int inPin, int outPin, bool roleMaster)
   _lastSuccessMs = millis();
   _consecutiveFailures = 0;
   _watchdogTripped = false;
+  _asyncPending = false;
+
+  // RMT capture (master only: a slave has to detect unsolicited requests).
+  if (rx == RxBackend::Rmt && roleMaster) {
+    _rmt = new OpenThermRmtRx();
+    if (_rmt && _rmt->begin(inPin)) {
+      ot->beginExternalRx();
+      return;
+    }
+    delete _rmt;
+    _rmt = nullptr;
+  }
 
   // Use internal interrupt handler
   ot->begin([](){
@@ -32,9 +64,20 @@ void OTBusESP32Pro::begin(int inPin, int outPin, bool roleMaster)
   });
 }
 
+// Hands a completed RMT capture to the OpenTherm state machine; process()
+// then validates parity/type exactly as for the interrupt decoder.
+void OTBusESP32Pro::serviceRmt()
+{
+  uint32_t frame = 0;
+  OtManchesterResult res;
+  if (!_rmt->poll(frame, res)) return;
+  (void)ot->deliverResponse(frame, res == OtManchesterResult::Ok);
+}
+
 void OTBusESP32Pro::loop()
 {
   if (!ot) return;
+  if (_rmt) serviceRmt();
   ot->process();
 
   // Feed ESP32 task watchdog (if enabled)
@@ -44,6 +87,9 @@ void OTBusESP32Pro::loop()
   }
 #endif
 
+  // A non-blocking request owns the bus until pollRequest() collects it.
+  if (_asyncPending) return;
+
   // Control watchdog: if enabled control mode is not getting valid responses, disable control.
   if (roleMaster && _ctrl.enabled && _wd.enabled && ot->isReady()) {
     const uint32_t nowWd = millis();
@@ -207,21 +253,71 @@ bool OTBusESP32Pro::request(MessageType type, DataID id, uint16_t value, Frame &
   unsigned long req = OpenTherm::buildRequest((OpenThermMessageType)((uint8_t)type),
                                               (OpenThermMessageID)((uint8_t)id),
                                               value);
-  unsigned long resp = ot->sendRequest(req);
+  _lastRequestRaw = (uint32_t)req;
+  unsigned long resp = 0;
+  if (_rmt) {
+    // Same wait as OpenTherm::sendRequest(), with the RMT capture serviced.
+    if (ot->sendRequestAsync(req)) {
+      _rmt->arm();
+      while (!ot->isReady()) {
+        serviceRmt();
+        ot->process();
+        if (openThermBackgroundService) openThermBackgroundService();
+        yield();
+      }
+      resp = ot->getLastResponse();
+    }
+  } else {
+    resp = ot->sendRequest(req);
+  }
   outFrame.raw = (uint32_t)resp;
   outStatus = ot->getLastResponseStatus();
-  const bool ok = (outStatus == OpenThermResponseStatus::SUCCESS);
-  if (ok) {
+  noteResult(outStatus);
+  return outStatus == OpenThermResponseStatus::SUCCESS;
+}
+
+bool OTBusESP32Pro::beginRequest(MessageType type, DataID id, uint16_t value)
+{
+  if (!ot || !roleMaster || _asyncPending) return false;
+
+  unsigned long req = OpenTherm::buildRequest((OpenThermMessageType)((uint8_t)type),
+                                              (OpenThermMessageID)((uint8_t)id),
+                                              value);
+  _lastRequestRaw = (uint32_t)req;
+  if (!ot->sendRequestAsync(req)) return false;
+  if (_rmt) _rmt->arm();
+  _asyncPending = true;
+  return true;
+}
+
+bool OTBusESP32Pro::pollRequest(Frame &outFrame, OpenThermResponseStatus &outStatus)
+{
+  if (!ot || !_asyncPending) return false;
+
+  // process() turns a received frame / timeout into a response status;
+  // the status stays NONE while the slave is still answering.
+  if (_rmt) serviceRmt();
+  ot->process();
+  const OpenThermResponseStatus st = ot->getLastResponseStatus();
+  if (st == OpenThermResponseStatus::NONE) return false;
+
+  _asyncPending = false;
+  outFrame.raw = (uint32_t)ot->getLastResponse();
+  outStatus = st;
+  noteResult(st);
+  return true;
+}
+
+void OTBusESP32Pro::noteResult(OpenThermResponseStatus st)
+{
+  if (st == OpenThermResponseStatus::SUCCESS) {
     _lastSuccessMs = millis();
     _consecutiveFailures = 0;
     _watchdogTripped = false;
-  } else {
+  } else if (st != OpenThermResponseStatus::NONE) {
     // Count failures for watchdog (TIMEOUT / INVALID). Ignore NONE.
-    if (outStatus != OpenThermResponseStatus::NONE) {
-      if (_consecutiveFailures < 255) _consecutiveFailures++;
-    }
+    if (_consecutiveFailures < 255) _consecutiveFailures++;
   }
-  return ok;
 }
 
 static const __FlashStringHelper* _respStatusStr(OpenThermResponseStatus st)
@@ -15,6 +15,8 @@
 #include <stdint.h>
 #include "OpenTherm.h"
 
+class OpenThermRmtRx;
+
 namespace otbus {
 
 // OpenTherm v2.2 message types (DataLink layer) (see protocol v2.2, section 4.2.2)
@@ -202,9 +204,17 @@ struct DateMD {
 class OTBusESP32Pro {
 public:
   OTBusESP32Pro();
+  ~OTBusESP32Pro();
+
+  // RX decoding: Isr = edge interrupts (OpenTherm::handleInterrupt), Rmt = RMT
+  // capture of the whole frame decoded in one pass (master only, OpenThermRmtRx).
+  enum class RxBackend : uint8_t { Isr = 0, Rmt };
 
   // roleMaster=true => OpenTherm Master (room controller), roleMaster=false => Slave (boiler)
-  void begin(int inPin, int outPin, bool roleMaster = true);
+  // Rmt falls back to Isr when the RMT channel cannot be allocated (see rxBackend()).
+  void begin(int inPin, int outPin, bool roleMaster = true, RxBackend rx = RxBackend::Isr);
+  RxBackend rxBackend() const { return _rmt ? RxBackend::Rmt : RxBackend::Isr; }
+  const OpenThermRmtRx* rmtRx() const { return _rmt; }
 
   // Must be called often from loop()
   void loop();
@@ -283,6 +293,15 @@ OpenThermResponseStatus lastStatus() const;
 // Low-level request helper (Master mode). Returns true only when outStatus == SUCCESS.
 bool request(MessageType type, DataID id, uint16_t value, Frame &outFrame, OpenThermResponseStatus &outStatus);
 
+// Non-blocking request (Master mode).
+// beginRequest() transmits the frame and returns without waiting for the slave
+// (returns false when the bus is not ready). pollRequest() must then be called
+// from loop() until it returns true; it never blocks and updates the control
+// watchdog exactly like request(). The transmit itself (~34 ms) is synchronous.
+bool beginRequest(MessageType type, DataID id, uint16_t value);
+bool pollRequest(Frame &outFrame, OpenThermResponseStatus &outStatus);
+bool requestPending() const { return _asyncPending; }
+
 // Bulk scan Data-IDs (Master mode):
 // Sends READ-DATA for each Data-ID in [startId, endId] and prints a one-line report to 'out'.
 // Tip: use a larger delayMs (200..500) for slower boilers.
@@ -303,10 +322,13 @@ void scanDataIDs(Stream &out, uint8_t startId = 0, uint8_t endId = 127, uint16_t
 
   // Raw access
   uint32_t lastResponseRaw() const;
+  uint32_t lastRequestRaw() const { return _lastRequestRaw; }
 
 private:
   bool roleMaster = true;
   OpenTherm *ot = nullptr;
+  OpenThermRmtRx *_rmt = nullptr;
+  void serviceRmt();
 
   // internal
   static void IRAM_ATTR isrRouter();
@@ -326,6 +348,14 @@ uint32_t _lastSuccessMs = 0;
 uint8_t _consecutiveFailures = 0;
 bool _watchdogTripped = false;
 
+// Non-blocking request in flight (beginRequest/pollRequest)
+bool _asyncPending = false;
+
+// Last master frame sent by request()/beginRequest() (frame trace)
+uint32_t _lastRequestRaw = 0;
+
+void noteResult(OpenThermResponseStatus st);
+
 // Hardware watchdog (ESP32)
 bool _hwWdtEnabled = false;
 
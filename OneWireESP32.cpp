@@ -5,11 +5,17 @@ https://github.com/junkfix/esp32-ds18b20
 #include <Arduino.h>
 #include "OneWireESP32.h"
 
+#include <driver/gpio.h>
+#include <esp_rom_gpio.h>
+#include <soc/gpio_reg.h>
+#include <soc/gpio_sig_map.h>
+
 #define OWR_OK 0
 #define OWR_CRC 1
 #define OWR_BAD_DATA 2
 #define OWR_TIMEOUT 3
 #define OWR_DRIVER 4
+#define OWR_NO_PRESENCE 5
 
 #define OW_RESET_PULSE 500
 #define OW_RESET_WAIT 200
@@ -62,6 +68,12 @@ IRAM_ATTR bool owrxdone(rmt_channel_handle_t ch, const rmt_rx_done_event_data_t
 void OneWire32::cleanup() {
   alive = false;
   drv = false;
+  // Re-routed: release the current pin; the driver only knows homepin.
+  if (owpin != homepin && owpin != GPIO_NUM_NC) {
+    esp_rom_gpio_connect_out_signal(owpin, SIG_GPIO_OUT_IDX, false, false);
+    gpio_set_direction(owpin, GPIO_MODE_INPUT);
+    owpin = homepin;
+  }
   // order matters: disable -> delete
   if (owbenc) {
     rmt_del_encoder(owbenc);
@@ -89,6 +101,7 @@ void OneWire32::cleanup() {
 
 OneWire32::OneWire32(uint8_t pin) {
   owpin = static_cast<gpio_num_t>(pin);
+  homepin = owpin;
 
   rmt_bytes_encoder_config_t bnc = {
     .bit0 = ow_bit0,
@@ -189,6 +202,48 @@ OneWire32::~OneWire32() {
   drv = false;
 }
 
+bool OneWire32::switchPin(uint8_t pin) {
+  if (!drv) return false;
+  const gpio_num_t to = static_cast<gpio_num_t>(pin);
+  if (to == owpin) return true;
+
+#if defined(RMT_SIG_OUT0_IDX) && defined(RMT_SIG_IN0_IDX)
+  if (txsig < 0 || rxsig < 0) {
+    // The driver routed its channels to owpin when they were created; find
+    // which RMT signals those are from the GPIO matrix configuration.
+    const uint32_t outSel = REG_GET_FIELD(GPIO_FUNC0_OUT_SEL_CFG_REG + 4 * (uint32_t)owpin, GPIO_FUNC0_OUT_SEL);
+    for (int c = 0; c < 4; c++) {
+      if (outSel == (uint32_t)(RMT_SIG_OUT0_IDX + c)) txsig = (int16_t)(RMT_SIG_OUT0_IDX + c);
+      const uint32_t inReg = GPIO_FUNC0_IN_SEL_CFG_REG + 4 * (uint32_t)(RMT_SIG_IN0_IDX + c);
+      if (REG_GET_BIT(inReg, GPIO_SIG0_IN_SEL) &&
+          REG_GET_FIELD(inReg, GPIO_FUNC0_IN_SEL) == (uint32_t)owpin) {
+        rxsig = (int16_t)(RMT_SIG_IN0_IDX + c);
+      }
+    }
+    if (txsig < 0 || rxsig < 0) return false;
+  }
+
+  // Nothing may be in flight while the pad changes.
+  rmt_tx_wait_all_done(owtx, OW_TIMEOUT);
+
+  // Release the old pin (idle high through the pull-up).
+  esp_rom_gpio_connect_out_signal(owpin, SIG_GPIO_OUT_IDX, false, false);
+  gpio_set_direction(owpin, GPIO_MODE_INPUT);
+
+  // Same pad setup the RMT driver does with io_od_mode: open-drain output
+  // with input enabled so RX samples the real line.
+  gpio_set_direction(to, GPIO_MODE_INPUT_OUTPUT_OD);
+  gpio_set_pull_mode(to, GPIO_PULLUP_ONLY);
+  esp_rom_gpio_connect_out_signal(to, (uint32_t)txsig, false, false);
+  esp_rom_gpio_connect_in_signal(to, (uint32_t)rxsig, false);
+
+  owpin = to;
+  return true;
+#else
+  return false;
+#endif
+}
+
 bool OneWire32::reset() {
   if (!drv) return false;
 
@@ -286,38 +341,80 @@ const uint8_t crc_table[] = {
   0, 94, 188, 226, 97, 63, 221, 131, 194, 156, 126, 32, 163, 253, 31, 65, 157, 195, 33, 127, 252, 162, 64, 30, 95, 1, 227, 189, 62, 96, 130, 220, 35, 125, 159, 193, 66, 28, 254, 160, 225, 191, 93, 3, 128, 222, 60, 98, 190, 224, 2, 92, 223, 129, 99, 61, 124, 34, 192, 158, 29, 67, 161, 255, 70, 24, 250, 164, 39, 121, 155, 197, 132, 218, 56, 102, 229, 187, 89, 7, 219, 133, 103, 57, 186, 228, 6, 88, 25, 71, 165, 251, 120, 38, 196, 154, 101, 59, 217, 135, 4, 90, 184, 230, 167, 249, 27, 69, 198, 152, 122, 36, 248, 166, 68, 26, 153, 199, 37, 123, 58, 100, 134, 216, 91, 5, 231, 185, 140, 210, 48, 110, 237, 179, 81, 15, 78, 16, 242, 172, 47, 113, 147, 205, 17, 79, 173, 243, 112, 46, 204, 146, 211, 141, 111, 49, 178, 236, 14, 80, 175, 241, 19, 77, 206, 144, 114, 44, 109, 51, 209, 143, 12, 82, 176, 238, 50, 108, 142, 208, 83, 13, 239, 177, 240, 174, 76, 18, 145, 207, 45, 115, 202, 148, 118, 40, 171, 245, 23, 73, 8, 86, 180, 234, 105, 55, 213, 139, 87, 9, 235, 181, 54, 104, 138, 212, 149, 203, 41, 119, 244, 170, 72, 22, 233, 183, 85, 11, 136, 214, 52, 106, 43, 117, 151, 201, 74, 20, 246, 168, 116, 42, 200, 150, 21, 75, 169, 247, 182, 232, 10, 84, 215, 137, 107, 53
 };
 
-uint8_t OneWire32::getTemp(uint64_t &addr, float &temp) {
-  if (!drv) return OWR_DRIVER;
+bool OneWire32::selectRom(uint64_t addr) {
+  if (!reset()) return false;
+  write(0x55);
+  const uint8_t *a = (const uint8_t *)&addr;
+  for (uint8_t i = 0; i < 8; i++) {
+    write(a[i]);
+  }
+  return true;
+}
 
-  if (reset()) {
-    write(0x55);
-    uint8_t *a = (uint8_t *)&addr;
+uint8_t OneWire32::readScratchpad(uint64_t addr, uint8_t (&data)[9]) {
+  if (!drv) return OWR_DRIVER;
 
-    uint8_t crc = 0;
-    for (uint8_t i = 0; i < 8; i++) {
-      write(*a);
-      crc = crc_table[crc ^ *a];
-      a++;
-    }
-    if (crc) { return OWR_CRC; }
+  const uint8_t *a = (const uint8_t *)&addr;
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i < 8; i++) {
+    crc = crc_table[crc ^ a[i]];
+  }
+  if (crc) { return OWR_CRC; }
 
-    write(0xBE);
-    uint8_t data[9] = {0};
-    for (uint8_t i = 0; i < 9; i++) {
-      if (!read(data[i])) { return OWR_TIMEOUT; }
-    }
+  if (!selectRom(addr)) { return OWR_TIMEOUT; }
+  write(0xBE);
+  for (uint8_t i = 0; i < 9; i++) {
+    if (!read(data[i])) { return OWR_TIMEOUT; }
+  }
 
-    crc = 0;
-    for (uint8_t i = 0; i < 8; i++) {
-      crc = crc_table[crc ^ data[i]];
-    }
-    if (crc != data[8]) { return OWR_CRC; }
+  crc = 0;
+  for (uint8_t i = 0; i < 8; i++) {
+    crc = crc_table[crc ^ data[i]];
+  }
+  if (crc != data[8]) { return OWR_CRC; }
+  return OWR_OK;
+}
 
-    int16_t raw = (data[1] << 8) | data[0];
-    temp = (float)raw / 16.0f;
-    return OWR_OK;
+uint8_t OneWire32::readScratchpadRaw(uint64_t addr, uint8_t (&data)[9]) {
+  if (!drv) return OWR_DRIVER;
+  if (!selectRom(addr)) { return OWR_NO_PRESENCE; }
+  write(0xBE);
+  for (uint8_t i = 0; i < 9; i++) {
+    if (!read(data[i])) { return OWR_TIMEOUT; }
   }
-  return OWR_TIMEOUT;
+  return OWR_OK;
+}
+
+uint8_t OneWire32::writeScratchpad(uint64_t addr, uint8_t th, uint8_t tl, uint8_t cfg) {
+  if (!drv) return OWR_DRIVER;
+  if (!selectRom(addr)) { return OWR_TIMEOUT; }
+  write(0x4E);
+  write(th);
+  write(tl);
+  write(cfg);
+  return OWR_OK;
+}
+
+bool OneWire32::readPowerSupply(bool &parasite) {
+  if (!drv) return false;
+  if (!reset()) return false;
+  write(0xCC);
+  write(0xB4);
+  uint8_t bit = 1;
+  if (!read(bit, 1)) return false;
+  // Parasite-powered devices pull the read slot low.
+  parasite = (bit == 0);
+  return true;
+}
+
+uint8_t OneWire32::getTemp(uint64_t &addr, float &temp) {
+  uint8_t data[9] = {0};
+  const uint8_t err = readScratchpad(addr, data);
+  if (err != OWR_OK) { return err; }
+
+  int16_t raw = (data[1] << 8) | data[0];
+  temp = (float)raw / 16.0f;
+  return OWR_OK;
 }
 
 uint8_t OneWire32::search(uint64_t *addresses, uint8_t total) {
@@ -19,6 +19,13 @@ class OneWire32 {
 
   bool ready() const { return alive; }
   bool isAlive() const { return alive; }
+  uint8_t pin() const { return (uint8_t)owpin; }
+
+  // Move the live TX/RX channel pair to another GPIO through the GPIO matrix
+  // (no RMT channel/encoder re-allocation). The previous pin is released as
+  // a pulled-up input. Returns false if the channel signals cannot be
+  // located; the caller should then recreate the driver on the new pin.
+  bool switchPin(uint8_t pin);
 
   bool reset();
   // NOTE: default is a full byte (8 bits). Pass len=1 for single-bit operations.
@@ -28,6 +35,18 @@ class OneWire32 {
   // Returns 0 on OK, non-zero on error.
   uint8_t getTemp(uint64_t& addr, float& temp);
 
+  // Match ROM + Read Scratchpad (9 bytes, CRC checked). Returns 0 on OK.
+  uint8_t readScratchpad(uint64_t addr, uint8_t (&data)[9]);
+  // Same without the CRC check (the caller validates, DallasScratchpad.h).
+  // Returns 0 on OK, 5 if no device answered the reset, 3/4 on RX timeout /
+  // no driver.
+  uint8_t readScratchpadRaw(uint64_t addr, uint8_t (&data)[9]);
+  // Match ROM + Write Scratchpad (TH, TL, config register). Returns 0 on OK.
+  uint8_t writeScratchpad(uint64_t addr, uint8_t th, uint8_t tl, uint8_t cfg);
+  // Skip ROM + Read Power Supply. Sets `parasite` if any device on the bus
+  // is parasite-powered. Returns false on bus error / no presence.
+  bool readPowerSupply(bool& parasite);
+
   // Search ROMs; returns number of found addresses (<= total).
   uint8_t search(uint64_t* addresses, uint8_t total);
 
@@ -37,12 +56,18 @@ class OneWire32 {
  private:
   void cleanup();
   void request();
+  bool selectRom(uint64_t addr);
 
   bool alive = false;
   // Some legacy call sites in OneWireESP32.cpp use 'drv' as a shorthand flag.
   // Keep it as an alias to 'alive' for compatibility.
   bool drv = false;
   gpio_num_t owpin = GPIO_NUM_NC;
+  // GPIO the driver was created on (the RMT driver resets it on cleanup).
+  gpio_num_t homepin = GPIO_NUM_NC;
+  // GPIO matrix signal indices of the TX/RX channels (-1 = not resolved yet).
+  int16_t txsig = -1;
+  int16_t rxsig = -1;
 
   // RX buffer for RMT receive. Size is in symbols.
   rmt_symbol_word_t owbuf[MAX_BLOCKS] = {};
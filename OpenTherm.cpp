@@ -64,6 +64,29 @@ void OpenTherm::begin(std::function<void(unsigned long, OpenThermResponseStatus)
 }
 #endif
 
+void OpenTherm::beginExternalRx()
+{
+    pinMode(inPin, INPUT);
+    pinMode(outPin, OUTPUT);
+    activateBoiler();
+    status = OpenThermStatus::READY;
+}
+
+bool OpenTherm::deliverResponse(unsigned long frame, bool valid)
+{
+    noInterrupts();
+    if (status != OpenThermStatus::RESPONSE_WAITING)
+    {
+        interrupts();
+        return false;
+    }
+    response = frame;
+    responseTimestamp = micros();
+    status = valid ? OpenThermStatus::RESPONSE_READY : OpenThermStatus::RESPONSE_INVALID;
+    interrupts();
+    return true;
+}
+
 bool IRAM_ATTR OpenTherm::isReady()
 {
     return status == OpenThermStatus::READY;
@@ -389,7 +412,7 @@ bool OpenTherm::isValidResponse(unsigned long response)
 {
     if (parity(response))
         return false;
-    byte msgType = (response << 1) >> 29;
+    byte msgType = (byte)getMessageType(response);
     return msgType == (byte)OpenThermMessageType::READ_ACK || msgType == (byte)OpenThermMessageType::WRITE_ACK;
 }
 
@@ -397,7 +420,7 @@ bool OpenTherm::isValidRequest(unsigned long request)
 {
     if (parity(request))
         return false;
-    byte msgType = (request << 1) >> 29;
+    byte msgType = (byte)getMessageType(request);
     return msgType == (byte)OpenThermMessageType::READ_DATA || msgType == (byte)OpenThermMessageType::WRITE_DATA || msgType == (byte)OpenThermMessageType::INVALID_DATA;
 }
 
@@ -172,6 +172,10 @@ public:
     void begin();
     void begin(std::function<void(unsigned long, OpenThermResponseStatus)> processResponseFunction);
 #endif
+    // External receiver (e.g. RMT capture): no RX interrupt is attached; the
+    // owner hands each received frame to deliverResponse() (master only).
+    void beginExternalRx();
+    bool deliverResponse(unsigned long frame, bool valid);
     bool isReady();
     unsigned long sendRequest(unsigned long request);
     bool sendResponse(unsigned long request);
@@ -4,15 +4,83 @@
 #if defined(FEATURE_OPENTHERM)
 
 #include <Arduino.h>
+#include <Preferences.h>
+#include <atomic>
+#include <stdarg.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include "Log.h"
 #include "config_pins.h"
 #include "OpenThermDataIds.h"
+#include "OpenThermMailbox.h"
+#include "OpenThermStats.h"
+#include "OpenThermTrace.h"
 
 #include "OTBusESP32Pro.h"   // OTBusESP32Pro (wraps Ihor Melnyk OpenTherm backend)
+#include "OpenThermRmtRx.h"
+#include "RetryPolicy.h"
 
 namespace {
   OpenThermConfig g_cfg;
-  OpenThermStatusSnapshot g_st;
+  OpenThermTelemetry g_st;
+
+  // Published copy of g_st for readers (openthermGetTelemetry()).
+  OtSnapshot<OpenThermTelemetry> g_pub;
+
+  // ---- Dedicated task mode (g_cfg.runInTask) ----
+  // Module state belongs to whoever holds g_otMtx: the OpenTherm task while it
+  // steps the engine, or an API caller. g_cfg is written under the lock by
+  // openthermInit()/openthermApplyConfig(), from the network task only (the
+  // Arduino loop task, TaskDomains.h). That task may read it without locking;
+  // any other task (I/O: openthermLoop(), energy collector; control) reads it
+  // under OtLock or from a published POD copy (g_gate) - never unlocked, the
+  // String members are reallocated on every config apply.
+  //
+  // The mailbox is also used in loop mode by tasks other than the one calling
+  // openthermLoop() (g_loopOwner): the control task (TaskDomains.h) queues
+  // its requests instead of waiting for a transaction of the I/O task.
+  enum class OtCmdKind : uint8_t { SetEquitherm = 0, ClearEquitherm, SetDhw, ClearDhw, SetMaxCh };
+
+  struct OtCmd {
+    OtCmdKind kind = OtCmdKind::SetEquitherm;
+    OpenThermSourceRequest req;
+    float value = NAN;  // SetMaxCh
+  };
+
+  static constexpr uint32_t kOtTaskStack = 6144;
+  static constexpr UBaseType_t kOtTaskPriority = 3;
+  static constexpr BaseType_t kOtTaskCore = 0;
+
+  OtMailbox<OtCmd, 16> g_mailbox;
+  SemaphoreHandle_t g_otMtx = nullptr;
+  TaskHandle_t g_otTask = nullptr;
+  std::atomic<bool> g_taskRunning{false};
+  bool g_taskStartFailed = false;
+  std::atomic<uint32_t> g_mailboxFull{0};
+  std::atomic<TaskHandle_t> g_loopOwner{nullptr};
+
+  // The part of g_cfg precheckControl() needs, for callers on other tasks.
+  struct OtGate {
+    bool enabled = false;
+    bool autoStart = false;
+    bool readOnly = true;
+    uint32_t bootDelayMs = 0;
+  };
+  OtSnapshot<OtGate> g_gate;
+
+  struct OtLock {
+    explicit OtLock(TickType_t wait = portMAX_DELAY)
+      : _held(!g_otMtx || xSemaphoreTakeRecursive(g_otMtx, wait) == pdTRUE) {}
+    ~OtLock() { if (g_otMtx && _held) xSemaphoreGiveRecursive(g_otMtx); }
+    OtLock(const OtLock&) = delete;
+    OtLock& operator=(const OtLock&) = delete;
+    bool held() const { return _held; }
+
+  private:
+    bool _held;
+  };
 
   OTBusESP32Pro* g_bus = nullptr;
   bool g_inited = false;
@@ -27,7 +95,7 @@ namespace {
   float g_reqChSetpointC = NAN;
   float g_reqDhwSetpointC = NAN;
   float g_reqMaxModPct = NAN;
-  String g_activeSource = "manual";
+  const char* g_activeSource = "manual";
 
   uint32_t g_lastPollMs = 0;
 
@@ -64,7 +132,7 @@ namespace {
   static bool cfgIsReadOnly();
   static bool clampMaybe(float& v, float lo, float hi);
   static void otInitIfNeeded();
-  static void otPollOnce();
+  static void otResetEngine();
 
   static bool isSupportedByFrame(OpenThermResponseStatus st, const otbus::Frame& f) {
     if (st != OpenThermResponseStatus::SUCCESS) return false;
@@ -77,6 +145,7 @@ namespace {
       g_bus = nullptr;
     }
     g_inited = false;
+    otResetEngine();
   }
 
   static void stNoteResponse(OpenThermResponseStatus rs) {
@@ -85,6 +154,25 @@ namespace {
     else if (rs == OpenThermResponseStatus::INVALID) g_st.invalidCount++;
   }
 
+  static void stSetText(char* buf, size_t cap, const char* text) {
+    snprintf(buf, cap, "%s", text ? text : "");
+  }
+
+  // Bounded append into a fixed telemetry text buffer (truncates silently).
+  static void stAppendf(char* buf, size_t cap, const char* fmt, ...) {
+    const size_t len = strnlen(buf, cap);
+    if (len + 1 >= cap) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf + len, cap - len, fmt, ap);
+    va_end(ap);
+  }
+
+  // Caller must hold OtLock (single writer).
+  static void otPublish() {
+    g_pub.publish(g_st);
+  }
+
   static void clearCoreTelemetry() {
     g_st.fault = false;
     g_st.chEnable = false;
@@ -134,8 +222,8 @@ namespace {
     g_st.reqChSetpointC = NAN;
     g_st.reqDhwSetpointC = NAN;
     g_st.reqMaxModulationPct = NAN;
-    g_st.activeSource = "";
-    g_st.lastCmd = "";
+    g_st.activeSourceText[0] = 0;
+    g_st.lastCmdText[0] = 0;
   }
 
   static OpenThermSourceRequest defaultManualBaseRequest() {
@@ -188,14 +276,14 @@ namespace {
                                  bool& chEnable, bool& dhwEnable,
                                  float& chSetpointC, float& dhwSetpointC, float& maxModPct,
                                  bool& haveChSetpoint, bool& haveDhwSetpoint, bool& haveMaxMod,
-                                 String& activeSource) {
+                                 const char*& activeSource) {
     if (!src.active) return false;
     if (src.chEnableSet) chEnable = src.chEnable;
     if (src.dhwEnableSet) dhwEnable = src.dhwEnable;
     if (src.chSetpointSet && isfinite(src.chSetpointC)) { chSetpointC = src.chSetpointC; haveChSetpoint = true; }
     if (src.dhwSetpointSet && isfinite(src.dhwSetpointC)) { dhwSetpointC = src.dhwSetpointC; haveDhwSetpoint = true; }
     if (src.maxModulationSet && isfinite(src.maxModulationPct)) { maxModPct = src.maxModulationPct; haveMaxMod = true; }
-    activeSource = String(name);
+    activeSource = name;
     return true;
   }
 
@@ -220,7 +308,7 @@ namespace {
     bool haveChSetpoint = false;
     bool haveDhwSetpoint = false;
     bool haveMaxMod = false;
-    String activeSource = String("default");
+    const char* activeSource = "default";
 
     applySourceRequest(g_manualReq, "manual", chEnable, dhwEnable, chSetpointC, dhwSetpointC, maxModPct,
                        haveChSetpoint, haveDhwSetpoint, haveMaxMod, activeSource);
@@ -242,27 +330,785 @@ namespace {
     g_reqDhwSetpointC = haveDhwSetpoint ? dhwSetpointC : NAN;
     g_reqMaxModPct = haveMaxMod ? maxModPct : NAN;
     g_activeSource = activeSource;
-    g_st.activeSource = activeSource;
+    stSetText(g_st.activeSourceText, sizeof(g_st.activeSourceText), activeSource);
   }
 
-  static bool validateReadyForControl(String& outErr) {
-    outErr = "";
+  // ---- Asynchronous transaction engine ----
+  // Regular bus traffic (poll cycle, control writes, scan) goes through
+  // OTBusESP32Pro::beginRequest()/pollRequest(). openthermLoop() advances one
+  // step per call (start the next frame or check the one in flight) and results
+  // are published into g_st as they arrive, so loop() never waits for the boiler.
+  enum class TxOwner : uint8_t { None = 0, Poll, Scan };
+
+  struct TxFrame {
+    otbus::MessageType type = otbus::MessageType::READ_DATA;
+    uint8_t id = 0;
+    uint16_t value = 0;
+  };
+
+  struct TxState {
+    TxOwner owner = TxOwner::None;
+    TxFrame frame;
+    uint32_t sentMs = 0;
+    uint32_t sentUs = 0;
+  };
+
+  static constexpr uint8_t kPollQueueMax = 16;
+
+  // One poll cycle compiled into a frame queue: pending control writes first,
+  // then the ID0 status exchange and telemetry reads.
+  struct PollCycle {
+    bool active = false;
+    TxFrame q[kPollQueueMax];
+    uint8_t count = 0;
+    uint8_t pos = 0;
+    uint32_t startedMs = 0;
+    uint32_t plannedMs = 0; // estimated duration (cycle budget)
+  };
+
+  // Control writes requested by the merge layer. A write stays pending (and is
+  // retried by the following cycles) until the boiler acknowledges it; an
+  // unchanged value is re-sent only every kWriteRefreshMs.
+  enum WriteSlot : uint8_t { kWrChSetpoint = 0, kWrDhwSetpoint, kWrMaxModulation, kWrMaxChSetpoint, kWrCount };
+
+  struct PendingWrite {
+    bool pending = false;
+    float valueC = NAN;
+    float lastOkC = NAN;
+    uint32_t lastOkMs = 0;
+  };
+
+  static constexpr uint8_t kWriteIds[kWrCount] = { 1, 56, 14, 57 };
+  static constexpr uint32_t kWriteRefreshMs = 10000;
+  static constexpr uint32_t kNotReadyGraceMs = 2000;
+
+  TxState g_tx;
+  PollCycle g_cycle;
+  PendingWrite g_writes[kWrCount];
+  uint32_t g_notReadySinceMs = 0;
+  uint32_t g_budgetDeferred = 0; // due reads postponed by the cycle budget
+  uint32_t g_frameWindowStartMs = 0;
+  uint32_t g_framesInWindow = 0;
+
+  // ---- Frame trace ----
+  // Every completed exchange (request word, response word, status) lands in a
+  // fixed ring; recording is a handful of stores, so it is always on. g_traceSeq
+  // counts all frames ever recorded, the ring keeps the last kTraceCap of them.
+  // Written and read under OtLock.
+  static constexpr uint32_t kTraceCap = 512; // power of two, 16 B per record
+  OpenThermTraceRecord g_trace[kTraceCap];
+  uint32_t g_traceSeq = 0;
+
+  static void otTraceRecord(OpenThermTraceOrigin origin, uint32_t startUs, uint32_t request,
+                            uint32_t response, OpenThermResponseStatus rs) {
+    OpenThermTraceRecord& r = g_trace[g_traceSeq & (kTraceCap - 1)];
+    const uint32_t durMs = (micros() - startUs) / 1000UL;
+    r.tUs = startUs;
+    r.request = request;
+    r.response = response;
+    r.durMs = durMs > 0xFFFF ? 0xFFFF : (uint16_t)durMs;
+    r.status = (uint8_t)rs;
+    r.origin = (uint8_t)origin;
+    g_traceSeq++;
+  }
+
+  static uint32_t otTraceOldestSeq() {
+    return g_traceSeq > kTraceCap ? g_traceSeq - kTraceCap : 0;
+  }
+
+  // ---- Per-Data-ID exchange statistics ----
+  // Every completed exchange (poll, scan, raw) also updates the counters and
+  // latency histogram of its Data-ID (OpenThermStats.h, constant time). The
+  // poll scheduler uses costMs to keep a cycle within pollMs.
+  // Written and read under OtLock.
+  OpenThermIdStats g_idStats[128];
+
+  static OtExchangeResult exchangeResult(OpenThermResponseStatus rs, const otbus::Frame& f) {
+    if (rs == OpenThermResponseStatus::SUCCESS) return OtExchangeResult::Ok;
+    if (rs == OpenThermResponseStatus::TIMEOUT) return OtExchangeResult::Timeout;
+    if (rs == OpenThermResponseStatus::INVALID && f.type() == otbus::MessageType::UNKNOWN_DATA_ID) return OtExchangeResult::Unknown;
+    return OtExchangeResult::Invalid;
+  }
+
+  // A response carrying another Data-ID is a late answer to an earlier frame
+  // (it arrived after that one timed out, once the receiver was armed for the
+  // next request). It is not this request's result: counted as invalid and
+  // neither published, nor taken as UNKNOWN_DATA_ID for the requested ID.
+  static void otRejectStray(uint8_t id, otbus::Frame& f, OpenThermResponseStatus& rs) {
+    if (rs == OpenThermResponseStatus::TIMEOUT || rs == OpenThermResponseStatus::NONE) return;
+    if ((uint8_t)f.id() == id) return;
+    rs = OpenThermResponseStatus::INVALID;
+    f.raw = 0;
+  }
+
+  // Trace record + statistics for one completed exchange.
+  static void otNoteExchange(OpenThermTraceOrigin origin, uint32_t startUs, uint8_t id,
+                             const otbus::Frame& f, OpenThermResponseStatus rs, uint32_t nowMs) {
+    otTraceRecord(origin, startUs, g_bus->lastRequestRaw(), f.raw, rs);
+    if (id < 128) g_idStats[id].record(exchangeResult(rs, f), (micros() - startUs) / 1000UL, nowMs);
+  }
+
+  // ---- Poll scheduler ----
+  // Every polled Data-ID carries a priority class and the maximum age its
+  // consumers accept (built-in defaults, openthermDeclarePollInterest() and
+  // config pollIds; the strictest declaration wins). A cycle sends ID0 plus at
+  // most kMaxReadsPerCycle due reads, most urgent first. IDs the boiler answers
+  // with UNKNOWN_DATA_ID are backed off exponentially (30 s .. 1 h).
+  static constexpr uint8_t kPollEntriesMax = 56;
+  static constexpr uint8_t kMaxReadsPerCycle = 6;
+  // Cycle budget: planned frames must fit into pollMs (so ID0 keeps its
+  // cadence). A frame costs its Data-ID's average exchange time (costMs,
+  // timeouts included) plus the library's inter-frame delay; IDs without
+  // history assume kDefaultFrameCostMs. The first due read is always taken.
+  static constexpr uint32_t kInterFrameMs = 100;
+  static constexpr uint32_t kDefaultFrameCostMs = 150;
+  static constexpr uint8_t kNoEntry = 0xFF;
+  static constexpr uint8_t kAgeBuckets = 8;
+  // Upper bounds of the refresh-interval histogram buckets (last is open).
+  static constexpr uint32_t kAgeBucketMs[kAgeBuckets] = { 500, 1000, 2000, 5000, 10000, 30000, 60000, 0xFFFFFFFFu };
+
+  struct PollEntry {
+    uint8_t id = 0;
+    OpenThermPollPriority prio = OpenThermPollPriority::Low;
+    uint32_t maxAgeMs = 0;
+    uint32_t lastOkMs = 0;
+    uint32_t lastTryMs = 0;
+    uint32_t worstAgeMs = 0;
+    uint32_t okCount = 0;
+    uint32_t failCount = 0;
+    uint32_t unknownCount = 0;
+    uint16_t raw = 0;
+    uint16_t ageHist[kAgeBuckets] = {0};
+    RetryPolicy unknownBackoff{30000, 2.0f, 3600000, 0.1f};
+    bool capsSkip = false; // unsupported per capability profile
+  };
+
+  PollEntry g_poll[kPollEntriesMax];
+  uint8_t g_pollCount = 0;
+  uint8_t g_pollIndex[128];
+  bool g_pollTableReady = false;
+
+  static void pollDeclareRaw(uint8_t id, uint32_t maxAgeMs, OpenThermPollPriority prio);
+
+  // ---- Persisted capability profile ----
+  // Data-IDs the boiler answers with UNKNOWN_DATA_ID (seen by a scan, or
+  // kCapsLearnFails times in a row by the poller) are stored in NVS together
+  // with the slave identity: ID3 member ID and ID127 product type/version.
+  // A loaded profile is applied from the first cycle after boot. Listed IDs are
+  // re-checked only every kCapsReverifyMs. A successful read removes the ID,
+  // and a different boiler identity drops the whole profile.
+  static constexpr const char* kCapsNs = "ot_caps";
+  static constexpr const char* kCapsKey = "prof";
+  static constexpr uint8_t kCapsVersion = 1;
+  static constexpr uint32_t kCapsReverifyMs = 6UL * 3600UL * 1000UL;
+  static constexpr uint32_t kCapsLearnFails = 3;
+  static constexpr uint32_t kIdentityMaxAgeMs = 3600000;
+
+  struct CapsProfile {
+    uint8_t version = kCapsVersion;
+    uint8_t memberId = 0;          // ID3 LB
+    uint16_t product = 0;          // ID127 raw (HB type, LB version), 0 = not reported
+    uint8_t unsupported[16] = {0}; // one bit per Data-ID
+  };
+
+  CapsProfile g_caps;
+  bool g_capsValid = false;   // profile belongs to a known identity (loaded or read)
+  bool g_capsMatched = false; // identity confirmed by the connected boiler
+  bool g_seenMemberOk = false;
+  uint8_t g_seenMember = 0;
+  bool g_seenProductOk = false;
+  uint16_t g_seenProduct = 0;
+
+  static bool capsTest(uint8_t id) {
+    return id < 128 && ((g_caps.unsupported[id >> 3] >> (id & 7)) & 1);
+  }
+
+  static void capsSet(uint8_t id, bool on) {
+    if (id >= 128) return;
+    const uint8_t bit = (uint8_t)(1u << (id & 7));
+    if (on) g_caps.unsupported[id >> 3] |= bit;
+    else g_caps.unsupported[id >> 3] &= (uint8_t)~bit;
+  }
+
+  static uint8_t capsCount() {
+    uint8_t n = 0;
+    for (uint8_t id = 0; id < 128; id++) n += capsTest(id) ? 1 : 0;
+    return n;
+  }
+
+  static void capsLoad() {
+    Preferences p;
+    if (!p.begin(kCapsNs, true)) return;
+    CapsProfile tmp;
+    const size_t n = p.getBytes(kCapsKey, &tmp, sizeof(tmp));
+    p.end();
+    if (n != sizeof(tmp) || tmp.version != kCapsVersion) return;
+    g_caps = tmp;
+    g_capsValid = true;
+    Serial.printf("[OT] capability profile loaded: member %u, product 0x%04X, %u unsupported IDs\n",
+                  (unsigned)g_caps.memberId, (unsigned)g_caps.product, (unsigned)capsCount());
+  }
+
+  static void capsSave() {
+    Preferences p;
+    if (!p.begin(kCapsNs, false)) return;
+    p.putBytes(kCapsKey, &g_caps, sizeof(g_caps));
+    p.end();
+  }
+
+  // ID3 must stay readable: it is what confirms the identity.
+  static void capsMarkEntry(PollEntry& e, uint32_t now) {
+    const bool skip = g_capsValid && e.id != 3 && capsTest(e.id);
+    if (skip) e.unknownBackoff.reset(now + kCapsReverifyMs);
+    else if (e.capsSkip) e.unknownBackoff.reset(now);
+    e.capsSkip = skip;
+  }
+
+  static void capsApplyAll(uint32_t now) {
+    for (uint8_t i = 0; i < g_pollCount; i++) capsMarkEntry(g_poll[i], now);
+  }
+
+  static void capsNoteIdentity(uint8_t id, uint16_t raw, uint32_t now) {
+    if (id == 3) { g_seenMember = (uint8_t)(raw & 0xFF); g_seenMemberOk = true; }
+    else { g_seenProduct = raw; g_seenProductOk = true; }
+    if (!g_seenMemberOk) return;
+
+    const bool same = g_capsValid && g_caps.memberId == g_seenMember &&
+                      (!g_seenProductOk || !g_caps.product || g_caps.product == g_seenProduct);
+    if (g_capsValid && !same) {
+      Serial.println(F("[OT] boiler identity changed, capability profile dropped"));
+      g_caps = CapsProfile{};
+      g_capsValid = false;
+      capsApplyAll(now);
+    }
+    const bool dirty = !g_capsValid || (g_seenProductOk && g_caps.product != g_seenProduct);
+    g_caps.memberId = g_seenMember;
+    if (g_seenProductOk) g_caps.product = g_seenProduct;
+    g_capsValid = true;
+    g_capsMatched = true;
+    if (dirty) capsSave();
+  }
+
+  // Merge a finished scan: UNKNOWN_DATA_ID adds an ID, any answer removes it,
+  // timeouts leave it unchanged.
+  static void capsOnScanDone(uint32_t now) {
+    static const uint8_t identityIds[] = { 3, 127 };
+    for (uint8_t i = 0; i < sizeof(identityIds); i++) {
+      const uint8_t id = identityIds[i];
+      if (id < g_scan.startId || id > g_scan.endId) continue;
+      if ((OpenThermResponseStatus)g_scan.respStatus[id] != OpenThermResponseStatus::SUCCESS) continue;
+      if ((otbus::MessageType)g_scan.msgType[id] != otbus::MessageType::READ_ACK) continue;
+      capsNoteIdentity(id, g_scan.value[id], now);
+    }
+    if (!g_capsMatched) return;
+
+    for (uint16_t id = g_scan.startId; id <= g_scan.endId; id++) {
+      const OpenThermResponseStatus rs = (OpenThermResponseStatus)g_scan.respStatus[id];
+      const otbus::MessageType mt = (otbus::MessageType)g_scan.msgType[id];
+      if (rs == OpenThermResponseStatus::INVALID && mt == otbus::MessageType::UNKNOWN_DATA_ID) capsSet((uint8_t)id, true);
+      else if (rs == OpenThermResponseStatus::SUCCESS || mt == otbus::MessageType::DATA_INVALID) capsSet((uint8_t)id, false);
+    }
+    capsSave();
+    capsApplyAll(now);
+    Serial.printf("[OT] capability profile updated from scan: %u unsupported IDs\n", (unsigned)capsCount());
+  }
+
+  // Defaults cover everything the snapshot / UI shows; consumers tighten them.
+  static void pollTableEnsure() {
+    if (g_pollTableReady) return;
+    g_pollTableReady = true;
+    memset(g_pollIndex, kNoEntry, sizeof(g_pollIndex));
+    g_pollCount = 0;
+
+    // Core telemetry
+    pollDeclareRaw(25, 10000, OpenThermPollPriority::Normal); // Tboiler
+    pollDeclareRaw(28, 10000, OpenThermPollPriority::Normal); // Tret
+    pollDeclareRaw(26, 10000, OpenThermPollPriority::Normal); // Tdhw
+    pollDeclareRaw(17, 10000, OpenThermPollPriority::Normal); // modulation
+    pollDeclareRaw(18, 120000, OpenThermPollPriority::Low);   // CH pressure
+    pollDeclareRaw(5, 30000, OpenThermPollPriority::Low);     // ASF flags + OEM fault
+
+    // Extended temperatures (often unsupported -> backoff)
+    static const uint8_t extTempIds[] = { 24, 27, 29, 30, 31, 32, 33, 34 };
+    for (uint8_t i = 0; i < sizeof(extTempIds); i++) pollDeclareRaw(extTempIds[i], 60000, OpenThermPollPriority::Low);
+
+    // Remote parameters (bounds + setpoints)
+    static const uint8_t rpIds[] = { 48, 49, 56, 57 };
+    for (uint8_t i = 0; i < sizeof(rpIds); i++) pollDeclareRaw(rpIds[i], 60000, OpenThermPollPriority::Low);
+
+    // Slave identity (keys the capability profile); read in the first cycle.
+    pollDeclareRaw(3, kIdentityMaxAgeMs, OpenThermPollPriority::Normal);
+    pollDeclareRaw(127, kIdentityMaxAgeMs, OpenThermPollPriority::Normal);
+  }
+
+  static void pollDeclareRaw(uint8_t id, uint32_t maxAgeMs, OpenThermPollPriority prio) {
+    // ID0 is exchanged every cycle; writes are not polled.
+    if (id == 0 || id > 127) return;
+    if (maxAgeMs < 250) maxAgeMs = 250;
+    uint8_t idx = g_pollIndex[id];
+    if (idx == kNoEntry) {
+      if (g_pollCount >= kPollEntriesMax) return;
+      idx = g_pollCount++;
+      g_pollIndex[id] = idx;
+      g_poll[idx] = PollEntry{};
+      g_poll[idx].id = id;
+      g_poll[idx].prio = prio;
+      g_poll[idx].maxAgeMs = maxAgeMs;
+      capsMarkEntry(g_poll[idx], millis());
+      return;
+    }
+    PollEntry& e = g_poll[idx];
+    if (maxAgeMs < e.maxAgeMs) e.maxAgeMs = maxAgeMs;
+    if ((uint8_t)prio < (uint8_t)e.prio) e.prio = prio;
+  }
+
+  static PollEntry* pollFind(uint8_t id) {
+    if (!g_pollTableReady || id > 127) return nullptr;
+    const uint8_t idx = g_pollIndex[id];
+    return (idx == kNoEntry) ? nullptr : &g_poll[idx];
+  }
+
+  static bool pollIsDue(const PollEntry& e, uint32_t now) {
+    if (!e.unknownBackoff.canAttempt(now)) return false;
+    if (!e.lastTryMs) return true;
+    // Refresh one poll period early, so the value is at most maxAgeMs old plus
+    // its position in the cycle. The age counts from the last good value: a
+    // failed read is retried by the next cycle, not a full period later.
+    const uint32_t since = e.lastOkMs ? e.lastOkMs : e.lastTryMs;
+    return (uint32_t)(now - since) + g_cfg.pollMs >= e.maxAgeMs;
+  }
+
+  // true when a is more urgent than b: priority class first, then how far
+  // the value is into its allowed age.
+  static bool pollMoreUrgent(const PollEntry& a, const PollEntry& b, uint32_t now) {
+    if (a.prio != b.prio) return (uint8_t)a.prio < (uint8_t)b.prio;
+    if (!a.lastOkMs || !b.lastOkMs) return !a.lastOkMs && b.lastOkMs;
+    const float ra = (float)(uint32_t)(now - a.lastOkMs) / (float)a.maxAgeMs;
+    const float rb = (float)(uint32_t)(now - b.lastOkMs) / (float)b.maxAgeMs;
+    return ra > rb;
+  }
+
+  static void pollNoteResult(uint8_t id, OpenThermResponseStatus rs, const otbus::Frame& f, uint32_t now) {
+    PollEntry* e = pollFind(id);
+    if (!e) return;
+    if (rs == OpenThermResponseStatus::SUCCESS) {
+      if (e->lastOkMs) {
+        const uint32_t age = now - e->lastOkMs;
+        if (age > e->worstAgeMs) e->worstAgeMs = age;
+        uint8_t b = 0;
+        while (b < kAgeBuckets - 1 && age > kAgeBucketMs[b]) b++;
+        if (e->ageHist[b] < 0xFFFF) e->ageHist[b]++;
+      }
+      e->lastOkMs = now;
+      e->raw = f.value();
+      e->okCount++;
+      e->unknownBackoff.onSuccess(now);
+      if (e->capsSkip) {
+        capsSet(id, false);
+        e->capsSkip = false;
+        capsSave();
+      }
+      if (id == 3 || id == 127) capsNoteIdentity(id, f.value(), now);
+      return;
+    }
+    e->failCount++;
+    if (rs == OpenThermResponseStatus::INVALID && f.type() == otbus::MessageType::UNKNOWN_DATA_ID) {
+      e->unknownCount++;
+      if (e->capsSkip) {
+        e->unknownBackoff.reset(now + kCapsReverifyMs);
+        return;
+      }
+      e->unknownBackoff.onFail(now);
+      if (g_capsMatched && id != 3 && e->unknownBackoff.failCount() >= kCapsLearnFails) {
+        capsSet(id, true);
+        capsMarkEntry(*e, now);
+        capsSave();
+      }
+    }
+  }
+
+  // Upper bound of the histogram bucket holding the given percentile (0..100).
+  static uint32_t pollAgePercentileMs(const PollEntry& e, uint8_t pct) {
+    uint32_t total = 0;
+    for (uint8_t b = 0; b < kAgeBuckets; b++) total += e.ageHist[b];
+    if (!total) return 0;
+    const uint32_t target = (total * pct + 99) / 100;
+    uint32_t acc = 0;
+    for (uint8_t b = 0; b < kAgeBuckets; b++) {
+      acc += e.ageHist[b];
+      if (acc >= target) return (b == kAgeBuckets - 1) ? e.worstAgeMs : kAgeBucketMs[b];
+    }
+    return e.worstAgeMs;
+  }
+
+  static void otResetEngine() {
+    g_tx = TxState{};
+    g_cycle = PollCycle{};
+    for (uint8_t i = 0; i < kWrCount; i++) g_writes[i] = PendingWrite{};
+    g_notReadySinceMs = 0;
+    for (uint8_t i = 0; i < g_pollCount; i++) {
+      g_poll[i].lastTryMs = 0;
+      g_poll[i].unknownBackoff.reset(0);
+      g_poll[i].capsSkip = false;
+    }
+    capsApplyAll(millis());
+  }
+
+  // Returns true when the write was (re-)armed.
+  static bool markWrite(WriteSlot slot, float v, uint32_t now) {
+    PendingWrite& w = g_writes[slot];
+    if (!isfinite(v)) {
+      w.pending = false;
+      w.valueC = NAN;
+      return false;
+    }
+    const bool same = isfinite(w.lastOkC) && otbus::F88::encode(w.lastOkC) == otbus::F88::encode(v);
+    if (same && (uint32_t)(now - w.lastOkMs) < kWriteRefreshMs) {
+      w.pending = false;
+      w.valueC = v;
+      return false;
+    }
+    const bool changed = !w.pending || otbus::F88::encode(w.valueC) != otbus::F88::encode(v);
+    w.pending = true;
+    w.valueC = v;
+    return changed;
+  }
+
+  static uint16_t masterStatusRequest() {
+    const bool ro = cfgIsReadOnly();
+    return otbus::StatusFlags::encodeMaster(ro ? false : g_reqChEnable, ro ? false : g_reqDhwEnable, false, false, false);
+  }
+
+  static uint32_t frameCostMs(uint8_t id) {
+    const OpenThermIdStats& st = g_idStats[id & 0x7F];
+    return (st.exchanges() ? st.costMs : kDefaultFrameCostMs) + kInterFrameMs;
+  }
+
+  static void cyclePush(otbus::MessageType type, uint8_t id, uint16_t value) {
+    if (g_cycle.count >= kPollQueueMax) return;
+    TxFrame& fr = g_cycle.q[g_cycle.count++];
+    fr.type = type;
+    fr.id = id;
+    fr.value = value;
+    g_cycle.plannedMs += frameCostMs(id);
+  }
+
+  static void otBuildPollCycle(uint32_t now) {
+    g_cycle.active = true;
+    g_cycle.count = 0;
+    g_cycle.pos = 0;
+    g_cycle.startedMs = now;
+    g_cycle.plannedMs = 0;
+
+    // 0) Control writes (only in control mode)
+    if (!cfgIsReadOnly()) {
+      for (uint8_t i = 0; i < kWrCount; i++) {
+        if (!g_writes[i].pending) continue;
+        cyclePush(otbus::MessageType::WRITE_DATA, kWriteIds[i], otbus::F88::encode(g_writes[i].valueC));
+      }
+    }
+
+    // 1) Status exchange (ID0) with current master enable flags
+    cyclePush(otbus::MessageType::READ_DATA, 0, masterStatusRequest());
+
+    // 2) Due reads, most urgent first, within the cycle budget. A read that
+    //    does not fit is skipped so cheaper ones behind it can still go.
+    pollTableEnsure();
+    bool picked[kPollEntriesMax] = {false};
+    uint8_t reads = 0;
+    while (reads < kMaxReadsPerCycle) {
+      int best = -1;
+      for (uint8_t i = 0; i < g_pollCount; i++) {
+        if (picked[i] || !pollIsDue(g_poll[i], now)) continue;
+        if (best < 0 || pollMoreUrgent(g_poll[i], g_poll[best], now)) best = i;
+      }
+      if (best < 0) break;
+      picked[best] = true;
+      if (reads > 0 && g_cycle.plannedMs + frameCostMs(g_poll[best].id) > g_cfg.pollMs) {
+        g_budgetDeferred++;
+        continue;
+      }
+      cyclePush(otbus::MessageType::READ_DATA, g_poll[best].id, 0);
+      reads++;
+    }
+  }
+
+  static void otFinishPollCycle(uint32_t now) {
+    g_cycle.active = false;
+    g_st.lastUpdateMs = now;
+    g_st.lastCycleMs = now - g_cycle.startedMs;
+  }
+
+  static void otPublishWrite(const TxFrame& fr, bool ok, uint32_t now) {
+    for (uint8_t i = 0; i < kWrCount; i++) {
+      if (kWriteIds[i] != fr.id) continue;
+      if (!ok) return; // stays pending -> retried next cycle
+      PendingWrite& w = g_writes[i];
+      // A newer value may have been requested while this frame was in flight.
+      if (w.pending && otbus::F88::encode(w.valueC) == fr.value) w.pending = false;
+      w.lastOkC = otbus::F88::decode(fr.value);
+      w.lastOkMs = now;
+      switch (i) {
+        case kWrChSetpoint: g_st.reqChSetpointC = w.lastOkC; break;
+        case kWrDhwSetpoint: g_st.reqDhwSetpointC = w.lastOkC; break;
+        case kWrMaxModulation: g_st.reqMaxModulationPct = w.lastOkC; break;
+        case kWrMaxChSetpoint: g_st.maxChSetpointC = w.lastOkC; break;
+        default: break;
+      }
+      return;
+    }
+  }
+
+  static void otPublishPollFrame(const TxFrame& fr, OpenThermResponseStatus rs, const otbus::Frame& f, uint32_t now) {
+    stNoteResponse(rs);
+    const bool ok = (rs == OpenThermResponseStatus::SUCCESS);
+
+    if (fr.type == otbus::MessageType::WRITE_DATA) {
+      otPublishWrite(fr, ok, now);
+      return;
+    }
+
+    if (fr.id != 0) pollNoteResult(fr.id, rs, f, now);
+
+    const uint16_t raw = f.value();
+    const float f88 = otbus::F88::decode(raw);
+
+    switch (fr.id) {
+      case 0: {
+        if (!ok) {
+          // Without a status exchange the rest of the cycle is meaningless.
+          clearAllTelemetry();
+          g_st.reasonCode = (rs == OpenThermResponseStatus::TIMEOUT) ? OpenThermReason::Timeout : OpenThermReason::Invalid;
+          g_cycle.active = false;
+          return;
+        }
+        const otbus::StatusFlags flags = otbus::StatusFlags::decode(raw);
+        g_st.reasonCode = OpenThermReason::None;
+        g_st.statusRaw = raw;
+        g_st.masterStatusRaw = (uint8_t)((raw >> 8) & 0xFF);
+        g_st.slaveStatusRaw = (uint8_t)(raw & 0xFF);
+        g_st.otcActive = flags.otcActive;
+        g_st.ch2Enable = flags.ch2Enable;
+        g_st.fault = flags.fault;
+        g_st.chActive = flags.chActive;
+        g_st.dhwActive = flags.dhwActive;
+        g_st.flameOn = flags.flameOn;
+        g_st.coolingActive = flags.coolingActive;
+        g_st.ch2Active = flags.ch2Active;
+        g_st.diagnostic = flags.diagnostic;
+        g_st.chEnable = g_reqChEnable;
+        g_st.dhwEnable = g_reqDhwEnable;
+        stSetText(g_st.activeSourceText, sizeof(g_st.activeSourceText), g_activeSource);
+        break;
+      }
+
+      // Core telemetry: a failed read invalidates the value.
+      case 25: g_st.boilerTempC = ok ? f88 : NAN; break;
+      case 28: g_st.returnTempC = ok ? f88 : NAN; break;
+      case 26: g_st.dhwTempC = ok ? f88 : NAN; break;
+      case 17: g_st.modulationPct = ok ? f88 : NAN; break;
+      case 18: g_st.pressureBar = ok ? f88 : NAN; break;
+
+      // ASF flags + OEM fault code (ID5): high byte flags, low byte OEM fault code
+      case 5:
+        g_st.faultFlags = ok ? (uint8_t)(raw >> 8) : 0;
+        g_st.oemFaultCode = ok ? (uint8_t)(raw & 0xFF) : 0;
+        break;
+
+      // Extended temperatures keep their last value when a read fails.
+      // Most are f8.8, but Texhaust (ID33) is s16 (°C).
+      case 24: if (ok && isfinite(f88)) g_st.roomTempC = f88; break;
+      case 27: if (ok && isfinite(f88)) g_st.outsideTempC = f88; break;
+      case 29: if (ok && isfinite(f88)) g_st.solarStorageTempC = f88; break;
+      case 30: if (ok && isfinite(f88)) g_st.solarCollectorTempC = f88; break;
+      case 31: if (ok && isfinite(f88)) g_st.ch2FlowTempC = f88; break;
+      case 32: if (ok && isfinite(f88)) g_st.dhw2TempC = f88; break;
+      case 33: if (ok) g_st.exhaustTempC = (float)((int16_t)raw); break;
+      case 34: if (ok && isfinite(f88)) g_st.heatExchangerTempC = f88; break;
+
+      // Remote parameters. Convention: HB=upper bound, LB=lower bound
+      case 48:
+        if (ok) {
+          g_st.dhwBoundMaxC = (float)((int8_t)(raw >> 8));
+          g_st.dhwBoundMinC = (float)((int8_t)(raw & 0xFF));
+        }
+        break;
+      case 49:
+        if (ok) {
+          g_st.maxChBoundMaxC = (float)((int8_t)(raw >> 8));
+          g_st.maxChBoundMinC = (float)((int8_t)(raw & 0xFF));
+        }
+        break;
+      case 56: if (ok) g_st.dhwSetpointC = f88; break;
+      case 57: if (ok) g_st.maxChSetpointC = f88; break;
+      default: break;
+    }
+
+    if (g_cycle.active && g_cycle.pos >= g_cycle.count) otFinishPollCycle(now);
+  }
+
+  static void otScanRecord(uint8_t id, OpenThermResponseStatus rs, const otbus::Frame& f, uint32_t now) {
+    if (!g_scan.active || id > 127) return;
+
+    g_scan.respStatus[id] = (uint8_t)rs;
+    g_scan.msgType[id] = (uint8_t)f.type();
+    g_scan.value[id] = f.value();
+
+    const bool supported = isSupportedByFrame(rs, f);
+    if (supported && !g_scan.supported[id]) g_scan.supportedCount++;
+    g_scan.supported[id] = supported;
+
+    g_scan.nextStepMs = now + (uint32_t)g_scan.delayMs;
+    if (id >= g_scan.endId) {
+      g_scan.active = false;
+      g_scan.done = true;
+      g_scan.finishedMs = now;
+      capsOnScanDone(now);
+      return;
+    }
+    g_scan.curId = (uint8_t)(id + 1);
+  }
+
+  static bool otBeginFrame(TxOwner owner, const TxFrame& fr, uint32_t now) {
+    const uint32_t startUs = micros();
+    if (!g_bus->beginRequest(fr.type, (otbus::DataID)fr.id, fr.value)) return false;
+    g_tx.owner = owner;
+    g_tx.sentUs = startUs;
+    g_tx.frame = fr;
+    g_tx.sentMs = now;
+
+    // Bus load statistics (frames per minute, published once per window)
+    if (!g_frameWindowStartMs) g_frameWindowStartMs = now;
+    if ((uint32_t)(now - g_frameWindowStartMs) >= 60000) {
+      g_st.framesPerMin = g_framesInWindow;
+      g_framesInWindow = 0;
+      g_frameWindowStartMs = now;
+    }
+    g_framesInWindow++;
+
+    if (owner == TxOwner::Poll && fr.type == otbus::MessageType::READ_DATA && fr.id != 0) {
+      if (PollEntry* e = pollFind(fr.id)) e->lastTryMs = now;
+    }
+    return true;
+  }
+
+  // One engine step. Returns without waiting in every branch.
+  static void otStep(uint32_t now) {
+    // a) Frame in flight: collect the response once it is there.
+    if (g_tx.owner != TxOwner::None) {
+      otbus::Frame f;
+      OpenThermResponseStatus rs = OpenThermResponseStatus::NONE;
+      if (!g_bus->pollRequest(f, rs)) return;
+      const TxOwner owner = g_tx.owner;
+      const TxFrame fr = g_tx.frame;
+      g_tx.owner = TxOwner::None;
+      otRejectStray(fr.id, f, rs);
+      otNoteExchange(owner == TxOwner::Scan ? OpenThermTraceOrigin::Scan : OpenThermTraceOrigin::Poll,
+                     g_tx.sentUs, fr.id, f, rs, now);
+      if (owner == TxOwner::Scan) otScanRecord(fr.id, rs, f, now);
+      else otPublishPollFrame(fr, rs, f, now);
+      return;
+    }
+
+    // b) Bus idle but not ready (inter-frame delay, or adapter not responding).
+    if (!g_bus->isReady()) {
+      if (!g_notReadySinceMs) g_notReadySinceMs = now;
+      if ((uint32_t)(now - g_notReadySinceMs) >= kNotReadyGraceMs) {
+        g_st.ready = false;
+        clearAllTelemetry();
+        g_st.reasonCode = OpenThermReason::NotReady;
+        g_cycle.active = false;
+      }
+      return;
+    }
+    g_notReadySinceMs = 0;
+    g_st.ready = true;
+
+    // c) Data-ID scan temporarily pauses regular polling.
+    if (g_scan.active) {
+      if ((int32_t)(now - g_scan.nextStepMs) < 0) return;
+      if (g_scan.curId > 127) { g_scan.active = false; g_scan.done = true; g_scan.finishedMs = now; return; }
+      TxFrame fr;
+      fr.id = g_scan.curId;
+      otBeginFrame(TxOwner::Scan, fr, now);
+      return;
+    }
+
+    // d) Poll cycle: start a new one when due, otherwise send the next frame.
+    if (!g_cycle.active) {
+      if ((uint32_t)(now - g_lastPollMs) < g_cfg.pollMs) return;
+      g_lastPollMs = now;
+      otBuildPollCycle(now);
+    }
+    if (g_cycle.pos >= g_cycle.count) {
+      otFinishPollCycle(now);
+      return;
+    }
+    TxFrame fr = g_cycle.q[g_cycle.pos];
+    // Status request always carries the latest master enable flags.
+    if (fr.id == 0 && fr.type == otbus::MessageType::READ_DATA) fr.value = masterStatusRequest();
+    if (otBeginFrame(TxOwner::Poll, fr, now)) g_cycle.pos++;
+  }
+
+  // Blocking helper for the manual web paths (raw Data-ID read/write): finish
+  // the frame in flight (its result is published normally) and wait for the
+  // inter-frame delay so a synchronous request can be issued.
+  static bool otWaitIdle(uint32_t timeoutMs) {
+    const uint32_t t0 = millis();
+    while ((uint32_t)(millis() - t0) < timeoutMs) {
+      const uint32_t now = millis();
+      if (g_tx.owner != TxOwner::None) {
+        otStep(now);
+      } else {
+        g_bus->loop();
+        if (g_bus->isReady()) return true;
+      }
+      yield();
+    }
+    return g_tx.owner == TxOwner::None && g_bus->isReady();
+  }
+
+  // Worst-case openthermLoop() duration (includes the synchronous ~34 ms
+  // frame transmit); exposed as loopLastUs / loopMaxUs.
+  struct LoopLatencyProbe {
+    uint32_t t0 = micros();
+    ~LoopLatencyProbe() {
+      const uint32_t us = micros() - t0;
+      g_st.loopLastUs = us;
+      if (us > g_st.loopMaxUs) g_st.loopMaxUs = us;
+    }
+  };
+
+  static bool cfgAllowsControlNow(String& outErr) {
     if (!g_cfg.enabled) { outErr = "disabled"; return false; }
     if (!g_cfg.autoStart) { outErr = "paused"; return false; }
     if (g_bootMs && (uint32_t)(millis() - g_bootMs) < g_cfg.bootDelayMs) { outErr = "boot delay"; return false; }
+    return true;
+  }
+
+  static bool validateReadyForControl(String& outErr) {
+    outErr = "";
+    if (!cfgAllowsControlNow(outErr)) return false;
     otInitIfNeeded();
-    if (!g_bus) { outErr = g_st.reason.length() ? g_st.reason : String("init failed"); return false; }
+    if (!g_bus) {
+      outErr = (g_st.reasonCode != OpenThermReason::None) ? openthermReasonText(g_st.reasonCode) : "init failed";
+      return false;
+    }
     if (cfgIsReadOnly()) { outErr = "readOnly"; return false; }
     return true;
   }
 
+  // Validates the merged request and arms the corresponding control writes.
+  // The frames themselves are sent by the asynchronous engine at the head of
+  // the next poll cycle (started immediately when something changed).
   static bool applyEffectiveRequestToBus(String& outErr) {
     outErr = "";
     rebuildEffectiveRequest();
     if (!validateReadyForControl(outErr)) return false;
 
-    bool did = false;
-    String cmdSummary;
+    const uint32_t now = millis();
+    bool kick = false;
+    char cmdSummary[sizeof(g_st.lastCmdText)] = {0};
 
     if (isfinite(g_reqChSetpointC)) {
       float v = g_reqChSetpointC;
@@ -272,35 +1118,22 @@ namespace {
       // the independent OpenTherm UI default (historically fixed at 25 C).
       // Keep the OpenTherm lower clamp for manual and DHW-originated requests.
       const float effectiveMinCh =
-          g_activeSource.equalsIgnoreCase("equitherm") ? 10.0f : g_cfg.minChSetpointC;
+          (strcmp(g_activeSource, "equitherm") == 0) ? 10.0f : g_cfg.minChSetpointC;
       clampMaybe(v, effectiveMinCh, g_cfg.maxChSetpointC);
-      if (!g_bus->setCHWaterSetpoint(v)) {
-        stNoteResponse(g_bus->lastStatus());
-        if (!outErr.length()) outErr = "setCHWaterSetpoint failed";
-      } else {
-        stNoteResponse(g_bus->lastStatus());
-        g_reqChSetpointC = v;
-        g_st.reqChSetpointC = v;
-        did = true;
-        cmdSummary += String("CH=") + String(v, 1) + "C ";
-      }
+      g_reqChSetpointC = v;
+      kick |= markWrite(kWrChSetpoint, v, now);
+      stAppendf(cmdSummary, sizeof(cmdSummary), "CH=%.1fC ", v);
     } else {
+      markWrite(kWrChSetpoint, NAN, now);
       g_st.reqChSetpointC = NAN;
     }
 
     if (isfinite(g_reqDhwSetpointC)) {
-      float v = g_reqDhwSetpointC;
-      otbus::Frame f;
-      const bool ok = g_bus->write(otbus::DataID::DHWSetpoint, otbus::F88::encode(v), f);
-      stNoteResponse(g_bus->lastStatus());
-      if (!ok) {
-        if (!outErr.length()) outErr = "setDHWSetpoint failed";
-      } else {
-        g_st.reqDhwSetpointC = v;
-        did = true;
-        cmdSummary += String("DHW=") + String(v, 1) + "C ";
-      }
+      const float v = g_reqDhwSetpointC;
+      kick |= markWrite(kWrDhwSetpoint, v, now);
+      stAppendf(cmdSummary, sizeof(cmdSummary), "DHW=%.1fC ", v);
     } else {
+      markWrite(kWrDhwSetpoint, NAN, now);
       g_st.reqDhwSetpointC = NAN;
     }
 
@@ -308,35 +1141,93 @@ namespace {
       float v = g_reqMaxModPct;
       if (v < 0) v = 0;
       if (v > 100) v = 100;
-      const bool ok = g_bus->setMaxRelModulationLevel(v);
-      stNoteResponse(g_bus->lastStatus());
-      if (!ok) {
-        if (!outErr.length()) outErr = "max modulation write failed";
-      } else {
-        g_st.reqMaxModulationPct = v;
-        did = true;
-        cmdSummary += String("MAXMOD=") + String(v, 0) + "% ";
-      }
+      kick |= markWrite(kWrMaxModulation, v, now);
+      stAppendf(cmdSummary, sizeof(cmdSummary), "MAXMOD=%.0f%% ", v);
     } else {
+      markWrite(kWrMaxModulation, NAN, now);
       g_st.reqMaxModulationPct = NAN;
     }
 
-    {
-      otbus::Frame f;
-      const bool ro = cfgIsReadOnly();
-      const uint16_t req = otbus::StatusFlags::encodeMaster(ro ? false : g_reqChEnable, ro ? false : g_reqDhwEnable, false, false, false);
-      const bool ok = g_bus->read(otbus::DataID::Status, f, req);
-      stNoteResponse(g_bus->lastStatus());
-      if (!ok && !outErr.length()) outErr = "setMasterStatus failed";
-      did = true;
-      cmdSummary += String("FLAGS=") + (g_reqChEnable ? "CH" : "") + (g_reqDhwEnable ? "+DHW" : "") + " SRC=" + g_activeSource + " ";
+    // Master status flags travel with the ID0 exchange of every cycle.
+    if (g_st.chEnable != g_reqChEnable || g_st.dhwEnable != g_reqDhwEnable) kick = true;
+    stAppendf(cmdSummary, sizeof(cmdSummary), "FLAGS=%s%s SRC=%s ",
+              g_reqChEnable ? "CH" : "", g_reqDhwEnable ? "+DHW" : "", g_activeSource);
+
+    g_st.lastCmdMs = now;
+    stSetText(g_st.lastCmdText, sizeof(g_st.lastCmdText), cmdSummary);
+    otPublish();
+    if (kick && !g_cycle.active) g_lastPollMs = now - g_cfg.pollMs;
+    return true;
+  }
+
+  // Caller must hold OtLock.
+  static void otPublishGate() {
+    OtGate g;
+    g.enabled = g_cfg.enabled;
+    g.autoStart = g_cfg.autoStart;
+    g.readOnly = cfgIsReadOnly();
+    g.bootDelayMs = g_cfg.bootDelayMs;
+    g_gate.publish(g);
+  }
+
+  // validateReadyForControl() evaluated on published state, for callers that
+  // queue a request instead of taking the module lock.
+  static bool precheckControl(String& outErr) {
+    outErr = "";
+    const OtGate g = g_gate.read();
+    if (!g.enabled) { outErr = "disabled"; return false; }
+    if (!g.autoStart) { outErr = "paused"; return false; }
+    if (g_bootMs && (uint32_t)(millis() - g_bootMs) < g.bootDelayMs) { outErr = "boot delay"; return false; }
+    const OpenThermTelemetry t = g_pub.read();
+    if (!t.present) {
+      outErr = (t.reasonCode != OpenThermReason::None) ? openthermReasonText(t.reasonCode) : "init failed";
+      return false;
     }
+    if (g.readOnly) { outErr = "readOnly"; return false; }
+    return true;
+  }
 
-    g_st.lastCmdMs = millis();
-    g_st.lastCmd = cmdSummary;
-    g_lastPollMs = 0;
-    otPollOnce();
-    return did && !outErr.length();
+  // Requests go through the mailbox when another task steps the engine: the
+  // OpenTherm task, or in loop mode a task other than the caller.
+  static bool otQueueRequests() {
+    if (g_taskRunning.load(std::memory_order_acquire)) return true;
+    const TaskHandle_t owner = g_loopOwner.load(std::memory_order_relaxed);
+    return owner && owner != xTaskGetCurrentTaskHandle();
+  }
+
+  static bool otEnqueue(OtCmdKind kind, const OpenThermSourceRequest& req, float value = NAN) {
+    OtCmd cmd;
+    cmd.kind = kind;
+    cmd.req = req;
+    cmd.value = value;
+    if (g_mailbox.push(cmd)) return true;
+    g_mailboxFull.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  static void otSetMaxCh(float v);
+
+  static void otApplyCommand(const OtCmd& cmd) {
+    switch (cmd.kind) {
+      case OtCmdKind::SetEquitherm: g_equithermReq = cmd.req; break;
+      case OtCmdKind::ClearEquitherm: clearReq(g_equithermReq); break;
+      case OtCmdKind::SetDhw: g_dhwReq = cmd.req; break;
+      case OtCmdKind::ClearDhw: clearReq(g_dhwReq); break;
+      case OtCmdKind::SetMaxCh:
+        // A bus write of its own; the effective request is unchanged.
+        if (g_bus) otSetMaxCh(cmd.value);
+        return;
+    }
+    // Already validated by precheckControl(); a bus that went away meanwhile
+    // keeps the request stored and it is armed again by the next update.
+    String err;
+    applyEffectiveRequestToBus(err);
+  }
+
+  // Caller must hold OtLock.
+  static void otDrainMailbox() {
+    OtCmd cmd;
+    while (g_mailbox.pop(cmd)) otApplyCommand(cmd);
   }
 
   static bool clampMaybe(float& v, float lo, float hi) {
@@ -349,7 +1240,7 @@ namespace {
 
   // Mode helpers
   static bool cfgIsReadOnly() {
-    const String m = g_cfg.mode;
+    const String& m = g_cfg.mode;
     if (m.equalsIgnoreCase("readOnly") || m.equalsIgnoreCase("readonly")) return true;
     // Back-compat: boilerControl=relay means read-only
     if (g_cfg.boilerControl.equalsIgnoreCase("relay")) return true;
@@ -363,7 +1254,7 @@ namespace {
     if (!g_cfg.enabled) {
       g_st.present = false;
       g_st.ready = false;
-      g_st.reason = "disabled";
+      g_st.reasonCode = OpenThermReason::Disabled;
       return;
     }
 
@@ -371,7 +1262,7 @@ namespace {
     if (!g_cfg.autoStart) {
       g_st.present = false;
       g_st.ready = false;
-      g_st.reason = "paused";
+      g_st.reasonCode = OpenThermReason::Paused;
       return;
     }
 
@@ -379,14 +1270,14 @@ namespace {
     if (g_bootMs && (uint32_t)(millis() - g_bootMs) < g_cfg.bootDelayMs) {
       g_st.present = false;
       g_st.ready = false;
-      g_st.reason = "boot delay";
+      g_st.reasonCode = OpenThermReason::BootDelay;
       return;
     }
 
     // Pins + master
     g_bus = new OTBusESP32Pro();
     if (!g_bus) {
-      g_st.reason = "alloc failed";
+      g_st.reasonCode = OpenThermReason::AllocFailed;
       return;
     }
 
@@ -397,16 +1288,20 @@ namespace {
     if (rx < 0 || tx < 0) {
       delete g_bus;
       g_bus = nullptr;
-      g_st.reason = "bad pins";
+      g_st.reasonCode = OpenThermReason::BadPins;
       return;
     }
 
     pinMode(tx, OUTPUT);
     pinMode(rx, INPUT);
 
-    // NOTE: OTBusESP32Pro::begin(inPin, outPin, roleMaster)
+    // NOTE: OTBusESP32Pro::begin(inPin, outPin, roleMaster, rxBackend)
     // This is the historically most fragile call on ESP32-S3 when wiring is wrong.
-    g_bus->begin(rx, tx, true /*master*/);
+    const bool wantRmt = g_cfg.rxBackend.equalsIgnoreCase("rmt");
+    g_bus->begin(rx, tx, true /*master*/,
+                 wantRmt ? OTBusESP32Pro::RxBackend::Rmt : OTBusESP32Pro::RxBackend::Isr);
+    const bool rmtRx = g_bus->rxBackend() == OTBusESP32Pro::RxBackend::Rmt;
+    if (wantRmt && !rmtRx) Serial.println("[OT] RMT RX unavailable, using edge interrupts");
 
     // Apply OTBus control/watchdog configuration.
     {
@@ -428,193 +1323,10 @@ namespace {
 
     g_inited = true;
     g_st.present = true;
-    g_st.reason = "";
+    g_st.reasonCode = OpenThermReason::None;
     g_lastPollMs = 0;
 
-    Serial.printf("[OT] Initialized (RX=%d TX=%d, master)\n", rx, tx);
-  }
-
-  static bool otReadF88(otbus::DataID id, float& outVal) {
-    otbus::Frame f;
-    if (!g_bus->read(id, f)) { stNoteResponse(g_bus->lastStatus()); return false; }
-    stNoteResponse(g_bus->lastStatus());
-    outVal = otbus::F88::decode(f.value());
-    return true;
-  }
-
-  static bool otReadU16(otbus::DataID id, uint16_t& outVal, uint16_t requestValue = 0) {
-    otbus::Frame f;
-    if (!g_bus->read(id, f, requestValue)) { stNoteResponse(g_bus->lastStatus()); return false; }
-    stNoteResponse(g_bus->lastStatus());
-    outVal = f.value();
-    return true;
-  }
-
-  static void otPollOnce() {
-    otInitIfNeeded();
-    if (!g_bus) {
-      g_st.present = false;
-      g_st.ready = false;
-      clearAllTelemetry();
-      if (!g_st.reason.length()) g_st.reason = "no instance";
-      return;
-    }
-
-    // Keep internal state machine moving (interrupt + timing)
-    g_bus->loop();
-
-    g_st.present = true;
-    g_st.ready = g_bus->isReady();
-    if (!g_st.ready) {
-      clearAllTelemetry();
-      g_st.reason = "not ready";
-      return;
-    }
-
-    g_st.reason = "";
-    clearCoreTelemetry();
-
-    // 1) Status exchange (ID0) with current master enable flags
-    {
-      const bool ro = cfgIsReadOnly();
-      const uint16_t req = otbus::StatusFlags::encodeMaster(
-        ro ? false : g_reqChEnable,
-        ro ? false : g_reqDhwEnable,
-        false, false, false
-      );
-
-      otbus::Frame f;
-      const bool ok = g_bus->read(otbus::DataID::Status, f, req);
-      stNoteResponse(g_bus->lastStatus());
-      if (!ok) {
-        clearAllTelemetry();
-        g_st.reason = (g_bus->lastStatus() == OpenThermResponseStatus::TIMEOUT) ? "timeout" : "invalid";
-        return;
-      }
-      const uint16_t statusRaw = f.value();
-      const otbus::StatusFlags flags = otbus::StatusFlags::decode(statusRaw);
-      g_st.statusRaw = statusRaw;
-      g_st.masterStatusRaw = (uint8_t)((statusRaw >> 8) & 0xFF);
-      g_st.slaveStatusRaw = (uint8_t)(statusRaw & 0xFF);
-      g_st.otcActive = flags.otcActive;
-      g_st.ch2Enable = flags.ch2Enable;
-      g_st.fault = flags.fault;
-      g_st.chActive = flags.chActive;
-      g_st.dhwActive = flags.dhwActive;
-      g_st.flameOn = flags.flameOn;
-      g_st.coolingActive = flags.coolingActive;
-      g_st.ch2Active = flags.ch2Active;
-      g_st.diagnostic = flags.diagnostic;
-      g_st.chEnable = g_reqChEnable;
-      g_st.dhwEnable = g_reqDhwEnable;
-      g_st.activeSource = g_activeSource;
-    }
-
-    // 2) Read core telemetry
-    float v = NAN;
-
-    if (otReadF88(otbus::DataID::BoilerWaterTemperature_Tboiler, v)) g_st.boilerTempC = v;
-    if (otReadF88(otbus::DataID::ReturnWaterTemperature_Tret, v)) g_st.returnTempC = v;
-    if (otReadF88(otbus::DataID::DHWTemperature_Tdhw, v)) g_st.dhwTempC = v;
-    if (otReadF88(otbus::DataID::RelativeModulationLevel, v)) g_st.modulationPct = v;
-    if (otReadF88(otbus::DataID::CHWaterPressure, v)) g_st.pressureBar = v;
-
-    // 3) Extended temperatures (round-robin, low bus load)
-    // Some boilers expose additional sensors via optional Data-IDs.
-    // We try a small subset in a round-robin fashion so polling remains light.
-    {
-      static const uint8_t extTempIds[] = { 24, 27, 29, 30, 31, 32, 33, 34 };
-      static uint8_t rr = 0;
-
-      // Most temperature IDs are f8.8, but some (e.g. Texhaust=33) are s16.
-      auto readTempByIdNum = [&](uint8_t idNum, float& outVal) -> bool {
-        otbus::Frame f;
-        const bool ok = g_bus->read((otbus::DataID)idNum, f);
-        stNoteResponse(g_bus->lastStatus());
-        if (!ok) return false;
-        if (idNum == 33) {
-          // Texhaust is s16 (°C)
-          outVal = (float)((int16_t)f.value());
-        } else {
-          outVal = otbus::F88::decode(f.value());
-        }
-        return true;
-      };
-
-      auto store = [&](uint8_t idNum, float val) {
-        switch (idNum) {
-          case 24: g_st.roomTempC = val; break;
-          case 27: g_st.outsideTempC = val; break;
-          case 29: g_st.solarStorageTempC = val; break;
-          case 30: g_st.solarCollectorTempC = val; break;
-          case 31: g_st.ch2FlowTempC = val; break;
-          case 32: g_st.dhw2TempC = val; break;
-          case 33: g_st.exhaustTempC = val; break;
-          case 34: g_st.heatExchangerTempC = val; break;
-          default: break;
-        }
-      };
-
-      // Try at most 2 extra reads per poll cycle
-      for (int i = 0; i < 2; i++) {
-        const uint8_t idNum = extTempIds[rr++ % (uint8_t)(sizeof(extTempIds) / sizeof(extTempIds[0]))];
-        float tv = NAN;
-        if (readTempByIdNum(idNum, tv) && isfinite(tv)) store(idNum, tv);
-      }
-    }
-
-    // ASF flags + OEM fault code (ID5): high byte flags, low byte OEM fault code
-    {
-      uint16_t raw = 0;
-      if (otReadU16(otbus::DataID::ASFflags_OEMfaultCode, raw)) {
-        g_st.faultFlags = (uint8_t)(raw >> 8);
-        g_st.oemFaultCode = (uint8_t)(raw & 0xFF);
-      }
-    }
-
-    // 5) Remote parameters (very low frequency)
-    // Useful for Ekviterm (limits) and UI display. Keep bus load minimal.
-    {
-      static const uint8_t rpIds[] = { 48, 49, 56, 57 };
-      static uint8_t rr = 0;
-      static uint32_t lastRpMs = 0;
-      const uint32_t now = millis();
-      if (now - lastRpMs >= 5000) {
-        lastRpMs = now;
-        const uint8_t idNum = rpIds[rr++ % (uint8_t)(sizeof(rpIds) / sizeof(rpIds[0]))];
-        if (idNum == 48) {
-          uint16_t raw = 0;
-          if (otReadU16((otbus::DataID)48, raw)) {
-            int8_t hi = (int8_t)(raw >> 8);
-            int8_t lo = (int8_t)(raw & 0xFF);
-            // Convention: HB=upper bound, LB=lower bound
-            g_st.dhwBoundMaxC = (float)hi;
-            g_st.dhwBoundMinC = (float)lo;
-          }
-        } else if (idNum == 49) {
-          uint16_t raw = 0;
-          if (otReadU16((otbus::DataID)49, raw)) {
-            int8_t hi = (int8_t)(raw >> 8);
-            int8_t lo = (int8_t)(raw & 0xFF);
-            // Convention: HB=upper bound, LB=lower bound
-            g_st.maxChBoundMaxC = (float)hi;
-            g_st.maxChBoundMinC = (float)lo;
-          }
-        } else if (idNum == 56) {
-          float v = NAN;
-          if (otReadF88((otbus::DataID)56, v)) {
-            g_st.dhwSetpointC = v;
-          }
-        } else if (idNum == 57) {
-          float v = NAN;
-          if (otReadF88((otbus::DataID)57, v)) {
-            g_st.maxChSetpointC = v;
-          }
-        }
-      }
-    }
-
-    g_st.lastUpdateMs = millis();
+    Serial.printf("[OT] Initialized (RX=%d TX=%d, master, rx=%s)\n", rx, tx, rmtRx ? "rmt" : "isr");
   }
 
   // ---- config parsing helpers (pins are fixed; enabled can be controlled) ----
@@ -640,12 +1352,17 @@ namespace {
     if (ot.containsKey("allowRawWrite")) {
       g_cfg.allowRawWrite = (bool)(ot["allowRawWrite"] | false);
     }
+    g_cfg.runInTask = ot["runInTask"] | g_cfg.runInTask;
 
     // Optional pin overrides (defaults are still kOT_TX/kOT_RX)
     g_cfg.txPin = (int)(ot["txPin"] | g_cfg.txPin);
     g_cfg.rxPin = (int)(ot["rxPin"] | g_cfg.rxPin);
     g_cfg.invertTx = (bool)(ot["invertTx"] | g_cfg.invertTx);
     g_cfg.invertRx = (bool)(ot["invertRx"] | g_cfg.invertRx);
+    g_cfg.rxBackend = String((const char*)(ot["rxBackend"] | g_cfg.rxBackend.c_str()));
+    g_cfg.rxBackend.trim();
+    if (!g_cfg.rxBackend.equalsIgnoreCase("rmt")) g_cfg.rxBackend = "isr";
+    else g_cfg.rxBackend = "rmt";
 
     // watchdog
     {
@@ -671,6 +1388,22 @@ namespace {
     g_cfg.dhwBoostChSetpointC = ot["dhwBoostChSetpointC"] | g_cfg.dhwBoostChSetpointC;
     g_cfg.assumedMaxBoilerKw = ot["assumedMaxBoilerKw"] | g_cfg.assumedMaxBoilerKw;
 
+    // Extra poll list. Removing an ID takes effect after restart (the
+    // scheduler only ever tightens declarations).
+    if (ot["pollIds"].is<JsonArray>()) {
+      g_cfg.pollIdsCount = 0;
+      for (JsonVariant v : ot["pollIds"].as<JsonArray>()) {
+        const int id = v | -1;
+        if (id <= 0 || id > 127) continue;
+        if (g_cfg.pollIdsCount >= sizeof(g_cfg.pollIds)) break;
+        g_cfg.pollIds[g_cfg.pollIdsCount++] = (uint8_t)id;
+      }
+      pollTableEnsure();
+      for (uint8_t i = 0; i < g_cfg.pollIdsCount; i++) {
+        pollDeclareRaw(g_cfg.pollIds[i], 30000, OpenThermPollPriority::Low);
+      }
+    }
+
     // If watchdog/mode changed -> re-init to apply configs
     if (g_inited) {
       otDestroy();
@@ -686,6 +1419,7 @@ namespace {
     out["boilerControl"] = g_cfg.boilerControl;
     out["mode"] = g_cfg.mode;
     out["allowRawWrite"] = g_cfg.allowRawWrite;
+    out["runInTask"] = g_cfg.runInTask;
     out["watchdogTimeoutMs"] = g_cfg.watchdogTimeoutMs;
     out["maxConsecutiveFailures"] = g_cfg.maxConsecutiveFailures;
     out["mapEquithermChSetpoint"] = g_cfg.mapEquithermChSetpoint;
@@ -701,7 +1435,10 @@ namespace {
     out["rxPin"] = g_cfg.rxPin;
     out["invertTx"] = g_cfg.invertTx;
     out["invertRx"] = g_cfg.invertRx;
+    out["rxBackend"] = g_cfg.rxBackend;
     out["autoDetectLogic"] = g_cfg.autoDetectLogic;
+    JsonArray ids = out.createNestedArray("pollIds");
+    for (uint8_t i = 0; i < g_cfg.pollIdsCount; i++) ids.add(g_cfg.pollIds[i]);
   }
 
   static void fillSourceRequestJson(JsonObject out, const OpenThermSourceRequest& req) {
@@ -780,13 +1517,57 @@ namespace {
     out["okCount"] = g_st.okCount;
     out["timeoutCount"] = g_st.timeoutCount;
     out["invalidCount"] = g_st.invalidCount;
-    out["reason"] = g_st.reason;
-    out["lastCmd"] = g_st.lastCmd;
-    out["activeSource"] = g_st.activeSource;
+    out["loopLastUs"] = g_st.loopLastUs;
+    out["loopMaxUs"] = g_st.loopMaxUs;
+    out["lastCycleMs"] = g_st.lastCycleMs;
+    out["framesPerMin"] = g_st.framesPerMin;
+    out["task"] = g_taskRunning.load(std::memory_order_relaxed);
+    out["mailboxFull"] = g_mailboxFull.load(std::memory_order_relaxed);
+    out["traceFrames"] = g_traceSeq;
+    {
+      // Latency over all Data-IDs (per-ID detail: openthermGetIdStatsJson()).
+      OpenThermIdStats all;
+      uint8_t slowestId = 0;
+      uint32_t slowestP95 = 0;
+      for (uint8_t id = 0; id < 128; id++) {
+        const OpenThermIdStats& st = g_idStats[id];
+        if (!st.exchanges()) continue;
+        for (uint8_t b = 0; b < kOtLatencyBuckets; b++) {
+          const uint32_t sum = (uint32_t)all.hist[b] + st.hist[b];
+          all.hist[b] = sum > 0xFFFF ? 0xFFFF : (uint16_t)sum;
+        }
+        if (st.maxMs > all.maxMs) all.maxMs = st.maxMs;
+        all.unknown += st.unknown;
+        const uint32_t p95 = st.latencyPercentileMs(95);
+        if (p95 > slowestP95) { slowestP95 = p95; slowestId = id; }
+      }
+      JsonObject ex = out.createNestedObject("exchange");
+      ex["p50Ms"] = all.latencyPercentileMs(50);
+      ex["p95Ms"] = all.latencyPercentileMs(95);
+      ex["maxMs"] = all.maxMs;
+      ex["unknownCount"] = all.unknown;
+      if (slowestP95) { ex["slowestId"] = slowestId; ex["slowestP95Ms"] = slowestP95; }
+    }
+    const OpenThermRmtRx* rmt = g_bus ? g_bus->rmtRx() : nullptr;
+    out["rxBackend"] = rmt ? "rmt" : "isr";
+    if (rmt) {
+      // Decoder outcome per captured frame (parity is counted in invalidCount).
+      JsonObject rx = out.createNestedObject("rmtRx");
+      for (uint8_t r = 0; r <= (uint8_t)OtManchesterResult::Long; r++) {
+        rx[OtManchesterDecoder::resultText((OtManchesterResult)r)] = rmt->count((OtManchesterResult)r);
+      }
+      rx["decodeUs"] = rmt->lastDecodeUs();
+    }
+    out["reason"] = openthermReasonText(g_st.reasonCode);
+    out["lastCmd"] = g_st.lastCmdText;
+    out["activeSource"] = g_st.activeSourceText;
   }
 } // namespace
 
 void openthermInit() {
+  if (!g_otMtx) g_otMtx = xSemaphoreCreateRecursiveMutex();
+  OtLock lock;
+
   // default config (UI compatible) – enabled + pins are forced elsewhere
   g_cfg.enabled = false;
   g_cfg.autoStart = false;
@@ -811,8 +1592,10 @@ void openthermInit() {
   g_cfg.rxPin = kOT_RX;
   g_cfg.invertTx = false;
   g_cfg.invertRx = false;
+  g_cfg.rxBackend = "isr";
   g_cfg.autoDetectLogic = true;
   g_cfg.pollIdsCount = 0;
+  g_cfg.runInTask = false;
   g_cfg.watchdogTimeoutMs = 3000;
   g_cfg.maxConsecutiveFailures = 3;
 
@@ -820,10 +1603,17 @@ void openthermInit() {
   clearReq(g_equithermReq);
   clearReq(g_dhwReq);
   g_activeSource = "manual";
-  g_st = OpenThermStatusSnapshot{};
+  g_st = OpenThermTelemetry{};
   g_st.present = false;
   g_st.ready = false;
-  g_st.reason = "";
+  g_st.reasonCode = OpenThermReason::None;
+  otPublish();
+  otPublishGate();
+
+  capsLoad();
+  pollTableEnsure();
+  // Entries declared by other modules before init get the profile too.
+  capsApplyAll(millis());
 
   // Do NOT init unless enabled+autoStart via config/UI.
   g_bootMs = millis();
@@ -849,17 +1639,21 @@ void openthermApplyConfig(const String& configJson) {
   }
   if (ot.isNull()) return;
 
+  OtLock lock;
   applyConfigDoc(ot);
+  otPublishGate();
+  g_taskStartFailed = false;
 
   // reflect into status
   g_st.present = false;
   g_st.ready = false;
   clearAllTelemetry();
-  g_st.reason = "";
+  g_st.reasonCode = OpenThermReason::None;
+  otPublish();
 }
 
 
-void openthermLoop() {
+static void openthermLoopStep() {
   // Enable gate
   if (!g_cfg.enabled) {
     if (g_inited) otDestroy();
@@ -867,7 +1661,7 @@ void openthermLoop() {
     g_st.present = false;
     g_st.ready = false;
     clearAllTelemetry();
-    g_st.reason = "disabled";
+    g_st.reasonCode = OpenThermReason::Disabled;
     return;
   }
 
@@ -878,7 +1672,7 @@ void openthermLoop() {
     g_st.present = false;
     g_st.ready = false;
     clearAllTelemetry();
-    g_st.reason = "paused";
+    g_st.reasonCode = OpenThermReason::Paused;
     return;
   }
 
@@ -889,7 +1683,7 @@ void openthermLoop() {
     g_st.present = false;
     g_st.ready = false;
     clearAllTelemetry();
-    g_st.reason = "boot delay";
+    g_st.reasonCode = OpenThermReason::BootDelay;
     return;
   }
 
@@ -898,122 +1692,162 @@ void openthermLoop() {
     g_st.present = false;
     g_st.ready = false;
     clearAllTelemetry();
-    if (!g_st.reason.length()) g_st.reason = "init failed";
+    if (g_st.reasonCode == OpenThermReason::None) g_st.reasonCode = OpenThermReason::InitFailed;
     return;
   }
 
-  const uint32_t now = millis();
-
-  // Non-blocking Data-ID scan (temporarily pauses regular polling)
-  if (g_scan.active) {
-    // keep state machine moving
-    g_bus->loop();
-
-    if (!g_bus->isReady()) {
-      // wait until ready
-      return;
-    }
-
-    if ((int32_t)(now - g_scan.nextStepMs) < 0) return;
-    g_scan.nextStepMs = now + (uint32_t)g_scan.delayMs;
-
-    const uint8_t id = g_scan.curId;
-    if (id > 127) { g_scan.active = false; g_scan.done = true; g_scan.finishedMs = now; return; }
-
-    otbus::Frame f;
-    const bool ok = g_bus->read((otbus::DataID)id, f, 0x0000);
-    const OpenThermResponseStatus rs = g_bus->lastStatus();
-    (void)ok;
+  g_st.present = true;
 
-    g_scan.respStatus[id] = (uint8_t)rs;
-    g_scan.msgType[id] = (uint8_t)f.type();
-    g_scan.value[id] = f.value();
+  // Keep internal state machine moving (interrupt + timing), then advance the
+  // transaction engine by one step (scan or poll cycle).
+  g_bus->loop();
+  otStep(millis());
+}
 
-    const bool supported = isSupportedByFrame(rs, f);
-    if (supported && !g_scan.supported[id]) g_scan.supportedCount++;
-    g_scan.supported[id] = supported;
+// Caller must hold OtLock.
+static void openthermRunStep() {
+  {
+    LoopLatencyProbe probe;
+    openthermLoopStep();
+  }
+  otPublish();
+}
 
-    if (id >= g_scan.endId) {
-      g_scan.active = false;
-      g_scan.done = true;
-      g_scan.finishedMs = now;
-      return;
+static void openthermTaskMain(void*) {
+  for (;;) {
+    {
+      OtLock lock;
+      otDrainMailbox();
+      if (!g_cfg.runInTask) {
+        // Hand the bus back to openthermLoop().
+        g_otTask = nullptr;
+        g_taskRunning.store(false, std::memory_order_release);
+        break;
+      }
+      openthermRunStep();
     }
-    g_scan.curId = (uint8_t)(id + 1);
-    return;
+    vTaskDelay(1);
   }
+  vTaskDelete(nullptr);
+}
 
-  if ((uint32_t)(now - g_lastPollMs) >= g_cfg.pollMs) {
-    g_lastPollMs = now;
-    otPollOnce();
-  } else {
-    // keep state machine moving
-    g_bus->loop();
+static bool openthermStartTask() {
+  TaskHandle_t h = nullptr;
+  if (xTaskCreatePinnedToCore(openthermTaskMain, "opentherm", kOtTaskStack, nullptr,
+                              kOtTaskPriority, &h, kOtTaskCore) != pdPASS) {
+    Serial.println(F("[OT] task create failed, staying in loop mode"));
+    g_taskStartFailed = true;
+    return false;
   }
+  g_otTask = h;
+  g_taskRunning.store(true, std::memory_order_release);
+  Serial.printf("[OT] running on dedicated task (core %d)\n", (int)kOtTaskCore);
+  return true;
+}
+
+void openthermLoop() {
+  if (g_taskRunning.load(std::memory_order_acquire)) return;
+  g_loopOwner.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+  // A raw Data-ID read/write from the network task holds the lock for its
+  // whole exchange (up to ~2.5 s) and drives the bus itself meanwhile; skip
+  // the pass rather than hold up the I/O task. Queued requests wait for the
+  // next one.
+  OtLock lock(0);
+  if (!lock.held()) return;
+  // Requests queued right before the task handed the bus back.
+  otDrainMailbox();
+  // g_cfg is read under the lock from here on (I/O task).
+  if (g_cfg.enabled && g_cfg.runInTask && !g_taskStartFailed && openthermStartTask()) return;
+  openthermRunStep();
+}
+
+bool openthermTaskActive() {
+  return g_taskRunning.load(std::memory_order_acquire);
+}
+
+bool openthermIsTaskContext() {
+  return g_otTask && xTaskGetCurrentTaskHandle() == g_otTask;
 }
 
 OpenThermConfig openthermGetConfig() {
+  OtLock lock;
   return g_cfg;
 }
 
+float openthermGetAssumedMaxBoilerKw() {
+  OtLock lock;
+  return g_cfg.assumedMaxBoilerKw;
+}
+
+OpenThermTelemetry openthermGetTelemetry() {
+  return g_pub.read();
+}
+
 OpenThermStatusSnapshot openthermGetStatus() {
-  return g_st;
+  OpenThermStatusSnapshot out;
+  static_cast<OpenThermTelemetry&>(out) = openthermGetTelemetry();
+  out.reason = openthermReasonText(out.reasonCode);
+  out.lastCmd = out.lastCmdText;
+  out.activeSource = out.activeSourceText;
+  return out;
 }
 
 // Helper for /api/fast JSON payload.
 void openthermFillFastJson(JsonObject& out) {
+  const OpenThermTelemetry st = g_pub.read();
   const bool en = g_cfg.enabled;
   out["en"] = en;
-  out["rd"] = en ? g_st.ready : false;
-  out["fl"] = en ? g_st.fault : false;
-  out["ce"] = en ? g_st.chEnable : false;
-  out["de"] = en ? g_st.dhwEnable : false;
-  out["ca"] = en ? g_st.chActive : false;
-  out["da"] = en ? g_st.dhwActive : false;
-  out["fo"] = en ? g_st.flameOn : false;
-  out["sr"] = en ? g_st.statusRaw : 0;
-
-  if (en && isfinite(g_st.boilerTempC)) out["bt"] = g_st.boilerTempC; else out["bt"] = nullptr;
-  if (en && isfinite(g_st.returnTempC)) out["rt"] = g_st.returnTempC; else out["rt"] = nullptr;
-  if (en && isfinite(g_st.dhwTempC)) out["dt"] = g_st.dhwTempC; else out["dt"] = nullptr;
+  out["rd"] = en ? st.ready : false;
+  out["fl"] = en ? st.fault : false;
+  out["ce"] = en ? st.chEnable : false;
+  out["de"] = en ? st.dhwEnable : false;
+  out["ca"] = en ? st.chActive : false;
+  out["da"] = en ? st.dhwActive : false;
+  out["fo"] = en ? st.flameOn : false;
+  out["sr"] = en ? st.statusRaw : 0;
+
+  if (en && isfinite(st.boilerTempC)) out["bt"] = st.boilerTempC; else out["bt"] = nullptr;
+  if (en && isfinite(st.returnTempC)) out["rt"] = st.returnTempC; else out["rt"] = nullptr;
+  if (en && isfinite(st.dhwTempC)) out["dt"] = st.dhwTempC; else out["dt"] = nullptr;
 
   // Extended temperatures (when supported by boiler)
-  if (en && isfinite(g_st.outsideTempC)) out["ot"] = g_st.outsideTempC; else out["ot"] = nullptr;
-  if (en && isfinite(g_st.roomTempC)) out["rm"] = g_st.roomTempC; else out["rm"] = nullptr;
-  if (en && isfinite(g_st.solarStorageTempC)) out["ss"] = g_st.solarStorageTempC; else out["ss"] = nullptr;
-  if (en && isfinite(g_st.solarCollectorTempC)) out["sc"] = g_st.solarCollectorTempC; else out["sc"] = nullptr;
-  if (en && isfinite(g_st.ch2FlowTempC)) out["c2"] = g_st.ch2FlowTempC; else out["c2"] = nullptr;
-  if (en && isfinite(g_st.dhw2TempC)) out["d2"] = g_st.dhw2TempC; else out["d2"] = nullptr;
-  if (en && isfinite(g_st.exhaustTempC)) out["ex"] = g_st.exhaustTempC; else out["ex"] = nullptr;
-  if (en && isfinite(g_st.heatExchangerTempC)) out["hx"] = g_st.heatExchangerTempC; else out["hx"] = nullptr;
-
-  if (en && isfinite(g_st.modulationPct)) out["mt"] = g_st.modulationPct; else out["mt"] = nullptr;
-  if (en && isfinite(g_st.pressureBar)) out["pr"] = g_st.pressureBar; else out["pr"] = nullptr;
+  if (en && isfinite(st.outsideTempC)) out["ot"] = st.outsideTempC; else out["ot"] = nullptr;
+  if (en && isfinite(st.roomTempC)) out["rm"] = st.roomTempC; else out["rm"] = nullptr;
+  if (en && isfinite(st.solarStorageTempC)) out["ss"] = st.solarStorageTempC; else out["ss"] = nullptr;
+  if (en && isfinite(st.solarCollectorTempC)) out["sc"] = st.solarCollectorTempC; else out["sc"] = nullptr;
+  if (en && isfinite(st.ch2FlowTempC)) out["c2"] = st.ch2FlowTempC; else out["c2"] = nullptr;
+  if (en && isfinite(st.dhw2TempC)) out["d2"] = st.dhw2TempC; else out["d2"] = nullptr;
+  if (en && isfinite(st.exhaustTempC)) out["ex"] = st.exhaustTempC; else out["ex"] = nullptr;
+  if (en && isfinite(st.heatExchangerTempC)) out["hx"] = st.heatExchangerTempC; else out["hx"] = nullptr;
+
+  if (en && isfinite(st.modulationPct)) out["mt"] = st.modulationPct; else out["mt"] = nullptr;
+  if (en && isfinite(st.pressureBar)) out["pr"] = st.pressureBar; else out["pr"] = nullptr;
 
   // Remote params
-  if (en && isfinite(g_st.maxChSetpointC)) out["mx"] = g_st.maxChSetpointC; else out["mx"] = nullptr;
-  if (en && isfinite(g_st.maxChBoundMinC)) out["mxl"] = g_st.maxChBoundMinC; else out["mxl"] = nullptr;
-  if (en && isfinite(g_st.maxChBoundMaxC)) out["mxu"] = g_st.maxChBoundMaxC; else out["mxu"] = nullptr;
-  if (en && isfinite(g_st.dhwSetpointC)) out["dw"] = g_st.dhwSetpointC; else out["dw"] = nullptr;
-  if (en && isfinite(g_st.dhwBoundMinC)) out["dwl"] = g_st.dhwBoundMinC; else out["dwl"] = nullptr;
-  if (en && isfinite(g_st.dhwBoundMaxC)) out["dwu"] = g_st.dhwBoundMaxC; else out["dwu"] = nullptr;
-
-  out["ff"] = (uint16_t)(en ? g_st.faultFlags : 0);
-  out["oc"] = (uint16_t)(en ? g_st.oemFaultCode : 0);
-
-  if (en && isfinite(g_st.reqChSetpointC)) out["cs"] = g_st.reqChSetpointC; else out["cs"] = nullptr;
-  if (en && isfinite(g_st.reqDhwSetpointC)) out["ds"] = g_st.reqDhwSetpointC; else out["ds"] = nullptr;
-  if (en && isfinite(g_st.reqMaxModulationPct)) out["mm"] = g_st.reqMaxModulationPct; else out["mm"] = nullptr;
-
-  out["lu"] = en ? g_st.lastUpdateMs : 0;
-  out["lc"] = en ? g_st.lastCmdMs : 0;
-  out["rs"] = en ? g_st.reason : String("disabled");
-  out["cmd"] = en ? g_st.lastCmd : String("");
-  out["src"] = en ? g_st.activeSource : String("disabled");
+  if (en && isfinite(st.maxChSetpointC)) out["mx"] = st.maxChSetpointC; else out["mx"] = nullptr;
+  if (en && isfinite(st.maxChBoundMinC)) out["mxl"] = st.maxChBoundMinC; else out["mxl"] = nullptr;
+  if (en && isfinite(st.maxChBoundMaxC)) out["mxu"] = st.maxChBoundMaxC; else out["mxu"] = nullptr;
+  if (en && isfinite(st.dhwSetpointC)) out["dw"] = st.dhwSetpointC; else out["dw"] = nullptr;
+  if (en && isfinite(st.dhwBoundMinC)) out["dwl"] = st.dhwBoundMinC; else out["dwl"] = nullptr;
+  if (en && isfinite(st.dhwBoundMaxC)) out["dwu"] = st.dhwBoundMaxC; else out["dwu"] = nullptr;
+
+  out["ff"] = (uint16_t)(en ? st.faultFlags : 0);
+  out["oc"] = (uint16_t)(en ? st.oemFaultCode : 0);
+
+  if (en && isfinite(st.reqChSetpointC)) out["cs"] = st.reqChSetpointC; else out["cs"] = nullptr;
+  if (en && isfinite(st.reqDhwSetpointC)) out["ds"] = st.reqDhwSetpointC; else out["ds"] = nullptr;
+  if (en && isfinite(st.reqMaxModulationPct)) out["mm"] = st.reqMaxModulationPct; else out["mm"] = nullptr;
+
+  out["lu"] = en ? st.lastUpdateMs : 0;
+  out["lc"] = en ? st.lastCmdMs : 0;
+  out["rs"] = en ? openthermReasonText(st.reasonCode) : "disabled";
+  if (en) out["cmd"] = st.lastCmdText; else out["cmd"] = "";
+  if (en) out["src"] = st.activeSourceText; else out["src"] = "disabled";
   out["bc"] = g_cfg.boilerControl;
 }
 
 String openthermGetStatusJson() {
+  OtLock lock;
   DynamicJsonDocument doc(6144);
   doc["ok"] = true;
   JsonObject s = doc.createNestedObject("status");
@@ -1037,6 +1871,7 @@ String openthermGetStatusJson() {
 }
 
 bool openthermHandleCmdJson(const String& body, String& outErr) {
+  OtLock lock;
   outErr = "";
   StaticJsonDocument<512> doc;
   DeserializationError e = deserializeJson(doc, body);
@@ -1118,14 +1953,11 @@ bool openthermHandleCmdJson(const String& body, String& outErr) {
       if (!outErr.length()) outErr = ctlErr;
       ok = false;
     } else {
-      otbus::Frame f;
-      const bool ro = cfgIsReadOnly();
-      const uint16_t reqFlags = otbus::StatusFlags::encodeMaster(ro ? false : g_reqChEnable, ro ? false : g_reqDhwEnable, false, false, false);
-      const bool resetOk = g_bus->read(otbus::DataID::Status, f, reqFlags);
-      stNoteResponse(g_bus->lastStatus());
-      if (!resetOk && !outErr.length()) outErr = "reset (status) failed";
-      g_st.lastCmd += "RESET ";
-      ok = ok && resetOk;
+      // The status exchange (ID0) with current master flags is the first
+      // read of every cycle; start one right away.
+      if (!g_cycle.active) g_lastPollMs = millis() - g_cfg.pollMs;
+      stAppendf(g_st.lastCmdText, sizeof(g_st.lastCmdText), "RESET ");
+      otPublish();
     }
   }
 
@@ -1133,6 +1965,7 @@ bool openthermHandleCmdJson(const String& body, String& outErr) {
 }
 
 bool openthermSetChSetpointC(float v, String& outErr) {
+  OtLock lock;
   OpenThermSourceRequest req = g_manualReq;
   if (!req.active) resetManualReq(req);
   if (!isfinite(v)) { outErr = "bad value"; return false; }
@@ -1143,35 +1976,44 @@ bool openthermSetChSetpointC(float v, String& outErr) {
   return applyEffectiveRequestToBus(outErr);
 }
 
+namespace {
+  // Caller must hold OtLock; v is finite and the bus is up.
+  static void otSetMaxCh(float v) {
+    // If bounds are known, clamp. Otherwise clamp to a safe range.
+    float lo = isfinite(g_st.maxChBoundMinC) ? g_st.maxChBoundMinC : 10.0f;
+    float hi = isfinite(g_st.maxChBoundMaxC) ? g_st.maxChBoundMaxC : 90.0f;
+    clampMaybe(v, lo, hi);
+
+    // Sent by the next poll cycle; g_st.maxChSetpointC follows the boiler's ack.
+    const uint32_t now = millis();
+    if (markWrite(kWrMaxChSetpoint, v, now) && !g_cycle.active) g_lastPollMs = now - g_cfg.pollMs;
+    g_st.lastCmdMs = now;
+    snprintf(g_st.lastCmdText, sizeof(g_st.lastCmdText), "MAXCH=%.1f", v);
+    otPublish();
+  }
+}
+
 bool openthermSetMaxChSetpointC(float v, String& outErr) {
+  if (otQueueRequests()) {
+    if (!precheckControl(outErr)) return false;
+    if (!isfinite(v)) { outErr = "bad value"; return false; }
+    if (otEnqueue(OtCmdKind::SetMaxCh, OpenThermSourceRequest{}, v)) return true;
+  }
+  OtLock lock;
   outErr = "";
   if (!g_cfg.enabled) { outErr = "disabled"; return false; }
   otInitIfNeeded();
   if (!g_bus) { outErr = "init failed"; return false; }
   if (cfgIsReadOnly()) { outErr = "readOnly"; return false; }
   if (!isfinite(v)) { outErr = "bad value"; return false; }
-
-  // If bounds are known, clamp. Otherwise clamp to a safe range.
-  float lo = isfinite(g_st.maxChBoundMinC) ? g_st.maxChBoundMinC : 10.0f;
-  float hi = isfinite(g_st.maxChBoundMaxC) ? g_st.maxChBoundMaxC : 90.0f;
-  clampMaybe(v, lo, hi);
-
-  otbus::Frame f;
-  const bool ok = g_bus->write((otbus::DataID)57, otbus::F88::encode(v), f);
-  stNoteResponse(g_bus->lastStatus());
-  if (!ok) {
-    outErr = "write MaxCHSetpoint failed";
-    return false;
-  }
-  g_st.maxChSetpointC = v;
-  g_st.lastCmdMs = millis();
-  g_st.lastCmd = String("MAXCH=") + String(v, 1);
+  otSetMaxCh(v);
   return true;
 }
 
 
 
 bool openthermSetManualRequest(const OpenThermSourceRequest& req, String& outErr) {
+  OtLock lock;
   const OpenThermSourceRequest prev = g_manualReq;
   g_manualReq = req;
   if (!g_manualReq.active) resetManualReq(g_manualReq);
@@ -1183,6 +2025,11 @@ bool openthermSetManualRequest(const OpenThermSourceRequest& req, String& outErr
 }
 
 bool openthermSetEquithermRequest(const OpenThermSourceRequest& req, String& outErr) {
+  if (otQueueRequests()) {
+    if (!precheckControl(outErr)) return false;
+    if (otEnqueue(OtCmdKind::SetEquitherm, req)) return true;
+  }
+  OtLock lock;
   const OpenThermSourceRequest prev = g_equithermReq;
   g_equithermReq = req;
   if (applyEffectiveRequestToBus(outErr)) return true;
@@ -1193,12 +2040,24 @@ bool openthermSetEquithermRequest(const OpenThermSourceRequest& req, String& out
 }
 
 bool openthermClearEquithermRequest() {
+  if (otQueueRequests()) {
+    // Always queued (even when not ready) so the stored request is dropped.
+    String err;
+    const bool ready = precheckControl(err);
+    if (otEnqueue(OtCmdKind::ClearEquitherm, OpenThermSourceRequest{})) return ready;
+  }
+  OtLock lock;
   clearReq(g_equithermReq);
   String err;
   return applyEffectiveRequestToBus(err);
 }
 
 bool openthermSetDhwRequest(const OpenThermSourceRequest& req, String& outErr) {
+  if (otQueueRequests()) {
+    if (!precheckControl(outErr)) return false;
+    if (otEnqueue(OtCmdKind::SetDhw, req)) return true;
+  }
+  OtLock lock;
   const OpenThermSourceRequest prev = g_dhwReq;
   g_dhwReq = req;
   if (applyEffectiveRequestToBus(outErr)) return true;
@@ -1209,6 +2068,12 @@ bool openthermSetDhwRequest(const OpenThermSourceRequest& req, String& outErr) {
 }
 
 bool openthermClearDhwRequest() {
+  if (otQueueRequests()) {
+    String err;
+    const bool ready = precheckControl(err);
+    if (otEnqueue(OtCmdKind::ClearDhw, OpenThermSourceRequest{})) return ready;
+  }
+  OtLock lock;
   clearReq(g_dhwReq);
   String err;
   return applyEffectiveRequestToBus(err);
@@ -1219,10 +2084,32 @@ bool openthermClearLog() {
   return false;
 }
 
-static bool tempByAge(float value, float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
+// Temperature of a polled Data-ID. Value and age are read under one lock, so
+// they belong to the same response. The age is taken from the scheduler entry
+// of the Data-ID, so values refreshed less often than every cycle report
+// their real age.
+static bool tempByAge(uint8_t id, float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
+  OtLock lock;
+  float value = NAN;
+  switch (id) {
+    case 24: value = g_st.roomTempC; break;
+    case 25: value = g_st.boilerTempC; break;
+    case 26: value = g_st.dhwTempC; break;
+    case 27: value = g_st.outsideTempC; break;
+    case 28: value = g_st.returnTempC; break;
+    case 29: value = g_st.solarStorageTempC; break;
+    case 30: value = g_st.solarCollectorTempC; break;
+    case 31: value = g_st.ch2FlowTempC; break;
+    case 32: value = g_st.dhw2TempC; break;
+    case 33: value = g_st.exhaustTempC; break;
+    case 34: value = g_st.heatExchangerTempC; break;
+    default: break;
+  }
   if (!g_st.present || !g_st.ready || !isfinite(value)) return false;
   const uint32_t now = millis();
-  const uint32_t age = (uint32_t)(now - g_st.lastUpdateMs);
+  const PollEntry* e = pollFind(id);
+  const uint32_t stamp = (e && e->lastOkMs) ? e->lastOkMs : g_st.lastUpdateMs;
+  const uint32_t age = (uint32_t)(now - stamp);
   if (outAgeMs) *outAgeMs = age;
   if (age > maxAgeMs) return false;
   outC = value;
@@ -1230,50 +2117,145 @@ static bool tempByAge(float value, float& outC, uint32_t maxAgeMs, uint32_t* out
 }
 
 bool openthermGetBoilerTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
-  return tempByAge(g_st.boilerTempC, outC, maxAgeMs, outAgeMs);
+  return tempByAge(25, outC, maxAgeMs, outAgeMs);
 }
 
 bool openthermGetReturnTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
-  return tempByAge(g_st.returnTempC, outC, maxAgeMs, outAgeMs);
+  return tempByAge(28, outC, maxAgeMs, outAgeMs);
 }
 
 bool openthermGetDhwTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
-  return tempByAge(g_st.dhwTempC, outC, maxAgeMs, outAgeMs);
+  return tempByAge(26, outC, maxAgeMs, outAgeMs);
 }
 
 bool openthermGetOutsideTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
-  return tempByAge(g_st.outsideTempC, outC, maxAgeMs, outAgeMs);
+  return tempByAge(27, outC, maxAgeMs, outAgeMs);
 }
 
 bool openthermGetRoomTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
-  return tempByAge(g_st.roomTempC, outC, maxAgeMs, outAgeMs);
+  return tempByAge(24, outC, maxAgeMs, outAgeMs);
 }
 
 bool openthermGetSolarStorageTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
-  return tempByAge(g_st.solarStorageTempC, outC, maxAgeMs, outAgeMs);
+  return tempByAge(29, outC, maxAgeMs, outAgeMs);
 }
 
 bool openthermGetSolarCollectorTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
-  return tempByAge(g_st.solarCollectorTempC, outC, maxAgeMs, outAgeMs);
+  return tempByAge(30, outC, maxAgeMs, outAgeMs);
 }
 
 bool openthermGetCh2FlowTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
-  return tempByAge(g_st.ch2FlowTempC, outC, maxAgeMs, outAgeMs);
+  return tempByAge(31, outC, maxAgeMs, outAgeMs);
 }
 
 bool openthermGetDhw2Temp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
-  return tempByAge(g_st.dhw2TempC, outC, maxAgeMs, outAgeMs);
+  return tempByAge(32, outC, maxAgeMs, outAgeMs);
 }
 
 bool openthermGetExhaustTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
-  return tempByAge(g_st.exhaustTempC, outC, maxAgeMs, outAgeMs);
+  return tempByAge(33, outC, maxAgeMs, outAgeMs);
 }
 
 bool openthermGetHeatExchangerTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs) {
-  return tempByAge(g_st.heatExchangerTempC, outC, maxAgeMs, outAgeMs);
+  return tempByAge(34, outC, maxAgeMs, outAgeMs);
+}
+
+void openthermDeclarePollInterest(uint8_t id, uint32_t maxAgeMs, OpenThermPollPriority prio) {
+  OtLock lock;
+  pollTableEnsure();
+  pollDeclareRaw(id, maxAgeMs, prio);
+}
+
+bool openthermGetDataIdValue(uint8_t id, uint16_t& outRaw, uint32_t maxAgeMs, uint32_t* outAgeMs) {
+  OtLock lock;
+  const PollEntry* e = pollFind(id);
+  if (!e || !e->lastOkMs || !g_st.present) return false;
+  const uint32_t age = (uint32_t)(millis() - e->lastOkMs);
+  if (outAgeMs) *outAgeMs = age;
+  if (age > maxAgeMs) return false;
+  outRaw = e->raw;
+  return true;
+}
+
+String openthermGetPollStatsJson() {
+  OtLock lock;
+  pollTableEnsure();
+  DynamicJsonDocument doc(12288);
+  doc["ok"] = true;
+  const uint32_t now = millis();
+  doc["pollMs"] = g_cfg.pollMs;
+  doc["maxReadsPerCycle"] = kMaxReadsPerCycle;
+  doc["framesPerMin"] = g_st.framesPerMin;
+  doc["lastCycleMs"] = g_st.lastCycleMs;
+  doc["lastPlannedMs"] = g_cycle.plannedMs;
+  doc["budgetDeferred"] = g_budgetDeferred;
+  JsonArray arr = doc.createNestedArray("ids");
+  for (uint8_t i = 0; i < g_pollCount; i++) {
+    const PollEntry& e = g_poll[i];
+    JsonObject o = arr.createNestedObject();
+    o["id"] = e.id;
+    o["prio"] = (uint8_t)e.prio;
+    o["maxAgeMs"] = e.maxAgeMs;
+    if (e.lastOkMs) o["ageMs"] = (uint32_t)(now - e.lastOkMs); else o["ageMs"] = nullptr;
+    o["p50Ms"] = pollAgePercentileMs(e, 50);
+    o["p95Ms"] = pollAgePercentileMs(e, 95);
+    o["worstMs"] = e.worstAgeMs;
+    o["ok"] = e.okCount;
+    o["fail"] = e.failCount;
+    o["unknown"] = e.unknownCount;
+    o["costMs"] = frameCostMs(e.id);
+    const int32_t backoff = (int32_t)(e.unknownBackoff.nextAttemptAt() - now);
+    o["backoffMs"] = ((e.unknownBackoff.failCount() || e.capsSkip) && backoff > 0) ? (uint32_t)backoff : 0;
+    o["profileSkip"] = e.capsSkip;
+  }
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
+
+String openthermGetIdStatsJson() {
+  OtLock lock;
+  const uint32_t now = millis();
+  String out;
+  out.reserve(4096);
+  out += "{\"ok\":true,\"bucketsMs\":[";
+  for (uint8_t b = 0; b < kOtLatencyBuckets - 1; b++) {
+    if (b) out += ',';
+    out += String(openthermLatencyBucketUpperMs(b));
+  }
+  out += ",null],\"ids\":[";
+  bool first = true;
+  for (uint8_t id = 0; id < 128; id++) {
+    const OpenThermIdStats& st = g_idStats[id];
+    if (!st.exchanges()) continue;
+    StaticJsonDocument<640> doc;
+    JsonObject o = doc.to<JsonObject>();
+    o["id"] = id;
+    o["ok"] = st.ok;
+    o["timeout"] = st.timeout;
+    o["invalid"] = st.invalid;
+    o["unknown"] = st.unknown;
+    if (st.lastGoodMs) o["lastGoodAgeMs"] = (uint32_t)(now - st.lastGoodMs); else o["lastGoodAgeMs"] = nullptr;
+    o["failStreak"] = st.failStreak;
+    o["lastMs"] = st.lastMs;
+    o["p50Ms"] = st.latencyPercentileMs(50);
+    o["p95Ms"] = st.latencyPercentileMs(95);
+    o["maxMs"] = st.maxMs;
+    o["costMs"] = st.costMs;
+    JsonArray h = o.createNestedArray("hist");
+    for (uint8_t b = 0; b < kOtLatencyBuckets; b++) h.add(st.hist[b]);
+    if (!first) out += ',';
+    first = false;
+    String item;
+    serializeJson(doc, item);
+    out += item;
+  }
+  out += "]}";
+  return out;
 }
 
 bool openthermScanStart(uint8_t startId, uint8_t endId, uint16_t delayMs, bool includeAll) {
+  OtLock lock;
   if (!g_cfg.enabled) return false;
   otInitIfNeeded();
   if (!g_bus) return false;
@@ -1284,6 +2266,7 @@ bool openthermScanStart(uint8_t startId, uint8_t endId, uint16_t delayMs, bool i
   if (delayMs > 2000) delayMs = 2000;
 
   g_scan = ScanState{};
+  g_cycle.active = false; // polling resumes with a fresh cycle after the scan
   g_scan.active = true;
   g_scan.done = false;
   g_scan.includeAll = includeAll;
@@ -1298,6 +2281,7 @@ bool openthermScanStart(uint8_t startId, uint8_t endId, uint16_t delayMs, bool i
 }
 
 void openthermScanStop() {
+  OtLock lock;
   g_scan.active = false;
 }
 
@@ -1326,251 +2310,34 @@ static const char* mtToStr(uint8_t mt) {
 
 // ---- Advanced Data-ID read/write helpers (web portal) ----
 
-static bool idIsF88(uint8_t id) {
-  switch (id) {
-    // Many "telemetry" values are encoded as signed f8.8
-    case 1:  case 7:  case 8:  case 9:
-    case 14: case 16: case 17: case 18: case 19:
-    case 23: case 24:
-    case 25: case 26: case 27: case 28:
-    case 29: case 30: case 31: case 32:
-    // NOTE: Texhaust (ID33) is s16, not f8.8.
-    case 34:
-    case 56: case 57: case 58:
-    case 124: case 125:
-      return true;
-    default:
-      return false;
-  }
-}
-
-static const char* unitForId(uint8_t id) {
-  switch (id) {
-    case 7:  case 14: case 17: return "%";
-    case 18: return "bar";
-    case 19: return "L/min";
-    case 35: return "rpm";
-    case 36: return "uA";
-    case 38: return "%";
-    case 58: return "K";
-    case 79: return "ppm";
-    case 111: return "W";
-    case 112: return "kWh";
-    case 96: case 120: case 121: case 122: case 123: return "h";
-    case 97: case 113: case 114: case 116: case 117: case 118: case 119: return "count";
-    default: return "";
-  }
-}
-
-static const char* valueTypeForId(uint8_t id) {
-  switch (id) {
-    case 0: return "flags/flags";
-    case 2: case 3: return "flags/u8";
-    case 5: return "flags/u8";
-    case 6: return "flags/flags";
-
-    case 10: case 11: case 12: case 13: return "u8/u8";
-    case 15: case 35: return "u8/u8";
-    case 21: return "u8/u8";
-    case 22: return "u16";
-
-    case 48: case 49: case 50: return "s8/s8";
-
-    case 20: return "special";
-    case 98: case 99: return "special";
-
-    case 33: return "s16";
-
-    default:
-      // Most values are either f8.8 or u16; we distinguish f8.8 by table.
-      return idIsF88(id) ? "f8.8" : "u16";
-  }
-}
-
-static void fillMetaFields(JsonObject& out, uint8_t id) {
-  OpenThermDataIdMeta meta{};
-  openthermLookupDataIdMeta(id, meta);
-  char nameBuf[8];
-  const char* nm = meta.name;
-  if (!nm) { snprintf(nameBuf, sizeof(nameBuf), "ID%u", (unsigned)id); nm = nameBuf; }
-  out["id"] = id;
-  out["name"] = nm;
-  out["desc"] = meta.desc;
-  out["isTemp"] = meta.isTemperature;
-  out["type"] = valueTypeForId(id);
-
-  const char* unit = unitForId(id);
-  if ((!unit || !unit[0]) && meta.isTemperature) unit = "°C";
-  // Only include unit when it is meaningful.
-  if (unit && unit[0]) out["unit"] = unit;
-}
-
-static void fillDecodedValue(JsonObject& out, uint8_t id, uint16_t raw) {
-  out["raw"] = raw;
-  out["hb"] = (uint8_t)(raw >> 8);
-  out["lb"] = (uint8_t)(raw & 0xFF);
-  out["u16"] = (uint16_t)raw;
-  out["s16"] = (int16_t)raw;
-
-  OpenThermDataIdMeta meta{};
-  openthermLookupDataIdMeta(id, meta);
-
-  if (id == 0) {
-    const otbus::StatusFlags f = otbus::StatusFlags::decode(raw);
-    JsonObject st = out.createNestedObject("status");
-    st["chEnable"] = f.chEnable;
-    st["dhwEnable"] = f.dhwEnable;
-    st["coolingEnable"] = f.coolingEnable;
-    st["otcActive"] = f.otcActive;
-    st["ch2Enable"] = f.ch2Enable;
-    st["fault"] = f.fault;
-    st["chActive"] = f.chActive;
-    st["dhwActive"] = f.dhwActive;
-    st["flameOn"] = f.flameOn;
-    st["coolingActive"] = f.coolingActive;
-    st["ch2Active"] = f.ch2Active;
-    st["diagnostic"] = f.diagnostic;
-  }
-
-  if (id == 5) {
-    out["asfFlags"] = (uint8_t)(raw >> 8);
-    out["oemFault"] = (uint8_t)(raw & 0xFF);
-  }
-
-  if (id == 2) {
-    // Master configuration flags (HB) + Master MemberID (LB)
-    const uint8_t cfg = (uint8_t)(raw >> 8);
-    const uint8_t member = (uint8_t)(raw & 0xFF);
-    JsonObject c = out.createNestedObject("masterCfg");
-    c["memberId"] = member;
-    c["smartPower"] = (bool)((cfg >> 0) & 1);
-    c["cfgRaw"] = cfg;
-  }
-
-  if (id == 3) {
-    // Slave configuration flags (HB) + Slave MemberID (LB)
-    // Bit meanings follow common OpenTherm v2.2 tables.
-    const uint8_t cfg = (uint8_t)(raw >> 8);
-    const uint8_t member = (uint8_t)(raw & 0xFF);
-    JsonObject c = out.createNestedObject("slaveCfg");
-    c["memberId"] = member;
-    c["dhwPresent"] = (bool)((cfg >> 0) & 1);
-    c["controlType"] = (bool)((cfg >> 1) & 1);
-    c["coolingSupported"] = (bool)((cfg >> 2) & 1);
-    c["dhwConfiguration"] = (bool)((cfg >> 3) & 1); // 0=instant, 1=storage
-    c["masterLowOffPumpCtrl"] = (bool)((cfg >> 4) & 1);
-    c["ch2Present"] = (bool)((cfg >> 5) & 1);
-    c["remoteWaterFilling"] = (bool)((cfg >> 6) & 1);
-    c["heatCoolModeCtrl"] = (bool)((cfg >> 7) & 1);
-    c["cfgRaw"] = cfg;
-  }
-
-  if (id == 6) {
-    // Remote boiler parameter transfer-enable (HB) and read/write (LB)
-    const uint8_t te = (uint8_t)(raw >> 8);
-    const uint8_t rw = (uint8_t)(raw & 0xFF);
-    JsonObject r = out.createNestedObject("rbp");
-    r["teMask"] = te;
-    r["rwMask"] = rw;
-    // P1..P8 bits (not every boiler uses all)
-    for (uint8_t i = 0; i < 8; i++) {
-      char k1[6]; // "p1TE" etc
-      char k2[6]; // "p1RW" etc
-      snprintf(k1, sizeof(k1), "p%uTE", (unsigned)(i + 1));
-      snprintf(k2, sizeof(k2), "p%uRW", (unsigned)(i + 1));
-      r[k1] = (bool)((te >> i) & 1);
-      r[k2] = (bool)((rw >> i) & 1);
-    }
-  }
-
-  if (id == 10) {
-    // Transparent Slave Parameters supported: u8/u8
-    out["tspCount"] = (uint8_t)(raw >> 8);
-  }
-
-  if (id == 11) {
-    // Transparent Slave Parameter entry: u8/u8
-    out["tspIndex"] = (uint8_t)(raw >> 8);
-    out["tspValue"] = (uint8_t)(raw & 0xFF);
-  }
-
-  if (id == 15) {
-    // u8/u8: max capacity (kW) / min modulation (%)
-    out["maxCapacityKw"] = (uint8_t)(raw >> 8);
-    out["minModulationPct"] = (uint8_t)(raw & 0xFF);
-  }
-
-  if (id == 20) {
-    otbus::DayTime dt = otbus::DayTime::decode(raw);
-    JsonObject t = out.createNestedObject("dayTime");
-    t["day"] = dt.day;
-    t["hour"] = dt.hour;
-    t["minute"] = dt.minute;
-  }
-
-  if (id == 21) {
-    otbus::DateMD d = otbus::DateMD::decode(raw);
-    JsonObject t = out.createNestedObject("date");
-    t["month"] = d.month;
-    t["day"] = d.day;
-  }
-
-  if (id == 22) {
-    out["year"] = (uint16_t)raw;
-  }
-
-  if (id == 48 || id == 49 || id == 50) {
-    // s8/s8 bounds: HB=upper, LB=lower
-    const int8_t upper = (int8_t)(raw >> 8);
-    const int8_t lower = (int8_t)(raw & 0xFF);
-    out["upper"] = (int)upper;
-    out["lower"] = (int)lower;
-  }
-
-  if (id == 33) {
-    // Texhaust is s16 (°C)
-    out["celsius"] = (int16_t)raw;
-    out["unit"] = "°C";
-    return;
-  }
-
-  const bool asF88 = meta.isTemperature || idIsF88(id);
-  if (asF88) {
-    const float v = otbus::F88::decode(raw);
-    out["f88"] = v;
-
-    const char* unit = unitForId(id);
-    if ((!unit || !unit[0]) && meta.isTemperature) unit = "°C";
-    if (unit && unit[0]) out["unit"] = unit;
-  }
-}
-
 String openthermReadDataIdJson(uint8_t id, uint16_t reqValue) {
+  OtLock lock;
   DynamicJsonDocument doc(1536);
   doc["ok"] = false;
 
   JsonObject meta = doc.createNestedObject("meta");
-  fillMetaFields(meta, id);
+  openthermFillDataIdMeta(meta, id);
 
   if (!g_cfg.enabled) { doc["err"] = "disabled"; String out; serializeJson(doc, out); return out; }
   if (g_scan.active) { doc["err"] = "scan_active"; String out; serializeJson(doc, out); return out; }
 
   otInitIfNeeded();
   if (!g_bus) { doc["err"] = "init_failed"; String out; serializeJson(doc, out); return out; }
-  if (!g_bus->isReady()) { doc["err"] = "not_ready"; String out; serializeJson(doc, out); return out; }
+  if (!otWaitIdle(1500)) { doc["err"] = "not_ready"; String out; serializeJson(doc, out); return out; }
 
   // For ID0 (Status), default request value is current master enable bits.
   uint16_t req = reqValue;
-  if (id == 0 && reqValue == 0) {
-    const bool ro = cfgIsReadOnly();
-    req = otbus::StatusFlags::encodeMaster(ro ? false : g_reqChEnable, ro ? false : g_reqDhwEnable, false, false, false);
-  }
+  if (id == 0 && reqValue == 0) req = masterStatusRequest();
 
   otbus::Frame f;
   f.raw = 0;
-  const bool ok = g_bus->read((otbus::DataID)id, f, req);
-  const OpenThermResponseStatus rs = g_bus->lastStatus();
+  const uint32_t startUs = micros();
+  g_bus->read((otbus::DataID)id, f, req);
+  OpenThermResponseStatus rs = g_bus->lastStatus();
+  otRejectStray(id, f, rs);
+  const bool ok = rs == OpenThermResponseStatus::SUCCESS;
   stNoteResponse(rs);
+  otNoteExchange(OpenThermTraceOrigin::Raw, startUs, id, f, rs, millis());
 
   doc["ok"] = ok;
   doc["rs"] = rsToStr((uint8_t)rs);
@@ -1578,7 +2345,7 @@ String openthermReadDataIdJson(uint8_t id, uint16_t reqValue) {
   doc["req"] = req;
 
   JsonObject val = doc.createNestedObject("val");
-  fillDecodedValue(val, id, f.value());
+  openthermDecodeDataIdValue(val, id, f.value());
 
   // Compatibility helpers for frontend callers that expect common fields at top level.
   if (id == 15) {
@@ -1595,11 +2362,12 @@ String openthermReadDataIdJson(uint8_t id, uint16_t reqValue) {
 }
 
 String openthermWriteDataIdJson(uint8_t id, uint16_t value) {
+  OtLock lock;
   DynamicJsonDocument doc(1536);
   doc["ok"] = false;
 
   JsonObject meta = doc.createNestedObject("meta");
-  fillMetaFields(meta, id);
+  openthermFillDataIdMeta(meta, id);
 
   if (!g_cfg.enabled) { doc["err"] = "disabled"; String out; serializeJson(doc, out); return out; }
   if (g_scan.active) { doc["err"] = "scan_active"; String out; serializeJson(doc, out); return out; }
@@ -1609,13 +2377,17 @@ String openthermWriteDataIdJson(uint8_t id, uint16_t value) {
 
   otInitIfNeeded();
   if (!g_bus) { doc["err"] = "init_failed"; String out; serializeJson(doc, out); return out; }
-  if (!g_bus->isReady()) { doc["err"] = "not_ready"; String out; serializeJson(doc, out); return out; }
+  if (!otWaitIdle(1500)) { doc["err"] = "not_ready"; String out; serializeJson(doc, out); return out; }
 
   otbus::Frame f;
   f.raw = 0;
-  const bool ok = g_bus->write((otbus::DataID)id, value, f);
-  const OpenThermResponseStatus rs = g_bus->lastStatus();
+  const uint32_t startUs = micros();
+  g_bus->write((otbus::DataID)id, value, f);
+  OpenThermResponseStatus rs = g_bus->lastStatus();
+  otRejectStray(id, f, rs);
+  const bool ok = rs == OpenThermResponseStatus::SUCCESS;
   stNoteResponse(rs);
+  otNoteExchange(OpenThermTraceOrigin::Raw, startUs, id, f, rs, millis());
 
   doc["ok"] = ok;
   doc["rs"] = rsToStr((uint8_t)rs);
@@ -1623,7 +2395,7 @@ String openthermWriteDataIdJson(uint8_t id, uint16_t value) {
   doc["value"] = value;
 
   JsonObject val = doc.createNestedObject("val");
-  fillDecodedValue(val, id, f.value());
+  openthermDecodeDataIdValue(val, id, f.value());
 
   // refresh snapshot ASAP
   g_lastPollMs = 0;
@@ -1633,21 +2405,103 @@ String openthermWriteDataIdJson(uint8_t id, uint16_t value) {
   return out;
 }
 
+static const char* traceOriginToStr(uint8_t origin) {
+  switch ((OpenThermTraceOrigin)origin) {
+    case OpenThermTraceOrigin::Poll: return "poll";
+    case OpenThermTraceOrigin::Scan: return "scan";
+    case OpenThermTraceOrigin::Raw: return "raw";
+    default: return "?";
+  }
+}
+
+uint32_t openthermTraceBegin(OpenThermTraceHeader& outHdr) {
+  OtLock lock;
+  outHdr = OpenThermTraceHeader{};
+  outHdr.capacity = (uint16_t)kTraceCap;
+  outHdr.firstSeq = otTraceOldestSeq();
+  outHdr.dumpUs = micros();
+  return g_traceSeq;
+}
+
+size_t openthermTraceRead(uint32_t seq, OpenThermTraceRecord* out, size_t maxRecords) {
+  OtLock lock;
+  if (seq < otTraceOldestSeq()) return 0; // already overwritten
+  size_t n = 0;
+  while (n < maxRecords && seq < g_traceSeq) {
+    out[n++] = g_trace[seq & (kTraceCap - 1)];
+    seq++;
+  }
+  return n;
+}
+
+String openthermTraceReplayJson(uint32_t fromSeq, uint16_t limit) {
+  static constexpr uint16_t kReplayMax = 32;
+  if (limit == 0 || limit > kReplayMax) limit = kReplayMax;
+
+  // Copy under the lock, decode without it.
+  OpenThermTraceRecord recs[kReplayMax];
+  uint32_t oldest = 0;
+  uint32_t head = 0;
+  size_t n = 0;
+  {
+    OtLock lock;
+    oldest = otTraceOldestSeq();
+    head = g_traceSeq;
+    if (fromSeq < oldest) fromSeq = oldest;
+    n = openthermTraceRead(fromSeq, recs, limit);
+  }
+
+  DynamicJsonDocument doc(1024 + n * 640);
+  doc["ok"] = true;
+  doc["capacity"] = kTraceCap;
+  doc["oldest"] = oldest;
+  doc["head"] = head;
+  doc["from"] = fromSeq;
+  doc["next"] = fromSeq + (uint32_t)n;
+
+  JsonArray frames = doc.createNestedArray("frames");
+  for (size_t i = 0; i < n; i++) {
+    const OpenThermTraceRecord& r = recs[i];
+    otbus::Frame req;
+    req.raw = r.request;
+    otbus::Frame resp;
+    resp.raw = r.response;
+
+    JsonObject o = frames.createNestedObject();
+    o["seq"] = fromSeq + (uint32_t)i;
+    o["tUs"] = r.tUs;
+    o["durMs"] = r.durMs;
+    o["origin"] = traceOriginToStr(r.origin);
+    o["rs"] = rsToStr(r.status);
+    o["id"] = (uint8_t)req.id();
+    o["mt"] = mtToStr((uint8_t)req.type());
+    o["req"] = req.value();
+    if ((OpenThermResponseStatus)r.status != OpenThermResponseStatus::SUCCESS) continue;
+    o["respMt"] = mtToStr((uint8_t)resp.type());
+    JsonObject val = o.createNestedObject("val");
+    openthermDecodeDataIdValue(val, (uint8_t)resp.id(), resp.value());
+  }
+
+  String out;
+  serializeJson(doc, out);
+  return out;
+}
+
 static void jsonAppendEscaped(String& out, const char* s) {
   if (!s) return;
   for (const char* p = s; *p; ++p) {
     const char c = *p;
     switch (c) {
-      case '\\\\': out += "\\\\\\\\"; break;
-      case '\"': out += "\\\\\""; break;
-      case '\n': out += "\\\\n"; break;
-      case '\r': out += "\\\\r"; break;
-      case '\t': out += "\\\\t"; break;
+      case '\\': out += "\\\\"; break;
+      case '"': out += "\\\""; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
       default:
         if ((uint8_t)c < 0x20) {
-          // control -> \\u00XX
+          // control -> \u00XX
           char buf[7];
-          snprintf(buf, sizeof(buf), "\\\\u%04x", (unsigned)(uint8_t)c);
+          snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)(uint8_t)c);
           out += buf;
         } else {
           out += c;
@@ -1671,26 +2525,25 @@ static void jsonAppendNumField(String& out, const char* key, uint32_t v) {
   out += '\"'; out += key; out += "\":"; out += String(v);
 }
 
-static void jsonAppendIntField(String& out, const char* key, int32_t v) {
-  out += '\"'; out += key; out += "\":"; out += String(v);
-}
-
-static void jsonAppendFloatField(String& out, const char* key, float v, uint8_t decimals = 2) {
-  out += '\"'; out += key; out += "\":"; out += String(v, (unsigned int)decimals);
-}
-
-static void jsonAppendMaybeUnit(String& out, uint8_t id) {
-  OpenThermDataIdMeta meta{};
-  openthermLookupDataIdMeta(id, meta);
-  const char* unit = unitForId(id);
-  if ((!unit || !unit[0]) && meta.isTemperature) unit = "°C";
-  if (unit && unit[0]) {
-    out += ',';
-    jsonAppendStrField(out, "unit", unit);
-  }
+// Decoded value fields of one Data-ID (openthermDecodeDataIdValue(): raw/hb/lb,
+// f8.8, bounds, flags, ...), appended flat into the object being built, with
+// a leading ','. The table unit is added for every type.
+static void jsonAppendDecodedValue(String& out, uint8_t id, uint16_t raw) {
+  StaticJsonDocument<640> doc;
+  JsonObject val = doc.to<JsonObject>();
+  openthermDecodeDataIdValue(val, id, raw);
+  const OpenThermDataIdMeta& meta = openthermDataIdMeta(id);
+  if (meta.unit[0]) val["unit"] = meta.unit;
+  char buf[512];
+  const size_t n = serializeJson(doc, buf, sizeof(buf));
+  if (n < 3 || n >= sizeof(buf) - 1) return; // empty or truncated
+  buf[n - 1] = '\0';                        // drop the closing brace
+  out += ',';
+  out += buf + 1;
 }
 
 String openthermScanGetStatusJson(bool includeAll) {
+  OtLock lock;
   // Build JSON manually to avoid large DynamicJsonDocument allocations.
   // Note: names/descriptions are short and do not contain special characters, but we still escape for safety.
   String out;
@@ -1717,8 +2570,7 @@ String openthermScanGetStatusJson(bool includeAll) {
     if (!first) out += ',';
     first = false;
 
-    OpenThermDataIdMeta meta{};
-    openthermLookupDataIdMeta(id, meta);
+    const OpenThermDataIdMeta& meta = openthermDataIdMeta(id);
 
     char nameBuf[8];
     const char* nm = meta.name;
@@ -1729,61 +2581,14 @@ String openthermScanGetStatusJson(bool includeAll) {
     jsonAppendStrField(out, "name", nm); out += ',';
     jsonAppendStrField(out, "desc", meta.desc); out += ',';
     jsonAppendBoolField(out, "isTemp", meta.isTemperature); out += ',';
+    jsonAppendStrField(out, "type", openthermValueTypeText(meta.type)); out += ',';
     jsonAppendBoolField(out, "supported", g_scan.supported[id]); out += ',';
     jsonAppendStrField(out, "rs", rsToStr(g_scan.respStatus[id])); out += ',';
     jsonAppendStrField(out, "mt", mtToStr(g_scan.msgType[id])); out += ',';
     const uint16_t raw = g_scan.value[id];
     out += "\"val\":"; out += String(raw);
-
-    // Lightweight decode hints (kept flat for memory friendliness)
-    out += ','; jsonAppendNumField(out, "hb", (uint8_t)(raw >> 8));
-    out += ','; jsonAppendNumField(out, "lb", (uint8_t)(raw & 0xFF));
-
-    // f8.8 values
-    OpenThermDataIdMeta meta2{};
-    openthermLookupDataIdMeta(id, meta2);
-    const bool asF88 = (id != 33) && (meta2.isTemperature || idIsF88(id));
-    if (asF88) {
-      const float v = otbus::F88::decode(raw);
-      out += ','; jsonAppendFloatField(out, "f88", v, 2);
-      jsonAppendMaybeUnit(out, id);
-    }
-
-    // s16 values
-    if (id == 33) {
-      out += ','; jsonAppendIntField(out, "s16", (int16_t)raw);
-      out += ','; jsonAppendStrField(out, "unit", "°C");
-    }
-
-    // s8/s8 bounds
-    if (id == 48 || id == 49 || id == 50) {
-      const int8_t upper = (int8_t)(raw >> 8);
-      const int8_t lower = (int8_t)(raw & 0xFF);
-      out += ','; jsonAppendIntField(out, "upper", (int)upper);
-      out += ','; jsonAppendIntField(out, "lower", (int)lower);
-      out += ','; jsonAppendStrField(out, "unit", "°C");
-    }
-
-    // Common u8/u8 convenience decodes
-    if (id == 15) {
-      out += ','; jsonAppendNumField(out, "maxCapacityKw", (uint8_t)(raw >> 8));
-      out += ','; jsonAppendNumField(out, "minModulationPct", (uint8_t)(raw & 0xFF));
-    }
-    if (id == 3) {
-      out += ','; jsonAppendNumField(out, "memberId", (uint8_t)(raw & 0xFF));
-      out += ','; jsonAppendNumField(out, "cfg", (uint8_t)(raw >> 8));
-    }
-    if (id == 6) {
-      out += ','; jsonAppendNumField(out, "teMask", (uint8_t)(raw >> 8));
-      out += ','; jsonAppendNumField(out, "rwMask", (uint8_t)(raw & 0xFF));
-    }
-    if (id == 10) {
-      out += ','; jsonAppendNumField(out, "tspCount", (uint8_t)(raw >> 8));
-    }
-    if (id == 11) {
-      out += ','; jsonAppendNumField(out, "tspIndex", (uint8_t)(raw >> 8));
-      out += ','; jsonAppendNumField(out, "tspValue", (uint8_t)(raw & 0xFF));
-    }
+    // Same decoding as /api/opentherm/dataid/read (kept flat in the item).
+    jsonAppendDecodedValue(out, id, raw);
     out += '}';
   }
 
@@ -1792,6 +2597,7 @@ String openthermScanGetStatusJson(bool includeAll) {
 }
 
 String openthermGetScanProfileJson() {
+  OtLock lock;
   String out;
   out.reserve(1536);
 
@@ -1822,8 +2628,7 @@ String openthermGetScanProfileJson() {
     if (!first) out += ',';
     first = false;
 
-    OpenThermDataIdMeta meta{};
-    openthermLookupDataIdMeta(id, meta);
+    const OpenThermDataIdMeta& meta = openthermDataIdMeta(id);
 
     char nameBuf[8];
     const char* nm = meta.name;
@@ -1834,11 +2639,26 @@ String openthermGetScanProfileJson() {
     jsonAppendStrField(out, "name", nm); out += ',';
     jsonAppendStrField(out, "desc", meta.desc); out += ',';
     jsonAppendBoolField(out, "supported", true); out += ',';
-    jsonAppendStrField(out, "rs", rsToStr(g_scan.respStatus[id]));
+    jsonAppendStrField(out, "rs", rsToStr(g_scan.respStatus[id])); out += ',';
+    out += "\"val\":"; out += String(g_scan.value[id]);
+    jsonAppendDecodedValue(out, id, g_scan.value[id]);
     out += '}';
   }
 
-  out += "]}}";
+  out += "],\"persisted\":{";
+  jsonAppendBoolField(out, "valid", g_capsValid); out += ',';
+  jsonAppendBoolField(out, "matched", g_capsMatched); out += ',';
+  jsonAppendNumField(out, "memberId", g_caps.memberId); out += ',';
+  jsonAppendNumField(out, "product", g_caps.product); out += ',';
+  out += "\"unsupportedIds\":[";
+  first = true;
+  for (uint8_t id = 0; id < 128; id++) {
+    if (!capsTest(id)) continue;
+    if (!first) out += ',';
+    first = false;
+    out += String(id);
+  }
+  out += "]}}}";
   return out;
 }
 
@@ -1847,8 +2667,12 @@ String openthermGetScanProfileJson() {
 // Feature disabled stubs
 void openthermInit() {}
 void openthermLoop() {}
+bool openthermTaskActive() { return false; }
+bool openthermIsTaskContext() { return false; }
 void openthermApplyConfig(const String&) {}
 OpenThermConfig openthermGetConfig() { return OpenThermConfig{}; }
+float openthermGetAssumedMaxBoilerKw() { return OpenThermConfig{}.assumedMaxBoilerKw; }
+OpenThermTelemetry openthermGetTelemetry() { return OpenThermTelemetry{}; }
 OpenThermStatusSnapshot openthermGetStatus() { return OpenThermStatusSnapshot{}; }
 void openthermFillFastJson(JsonObject&) {}
 String openthermGetStatusJson() { return "{}"; }
@@ -1880,7 +2704,32 @@ void openthermScanStop() {}
 String openthermScanGetStatusJson(bool) { return "{}"; }
 String openthermGetScanProfileJson() { return "{\"ok\":true,\"profile\":{\"hasProfile\":false,\"supportedIds\":[],\"items\":[]}}"; }
 
+void openthermDeclarePollInterest(uint8_t, uint32_t, OpenThermPollPriority) {}
+bool openthermGetDataIdValue(uint8_t, uint16_t&, uint32_t, uint32_t*) { return false; }
+String openthermGetPollStatsJson() { return "{}"; }
+String openthermGetIdStatsJson() { return "{}"; }
+
+uint32_t openthermTraceBegin(OpenThermTraceHeader& outHdr) { outHdr = OpenThermTraceHeader{}; return 0; }
+size_t openthermTraceRead(uint32_t, OpenThermTraceRecord*, size_t) { return 0; }
+String openthermTraceReplayJson(uint32_t, uint16_t) { return "{}"; }
+
 String openthermReadDataIdJson(uint8_t, uint16_t) { return "{}"; }
 String openthermWriteDataIdJson(uint8_t, uint16_t) { return "{}"; }
 
 #endif // FEATURE_OPENTHERM
+
+const char* openthermReasonText(OpenThermReason r) {
+  switch (r) {
+    case OpenThermReason::None:        return "";
+    case OpenThermReason::Disabled:    return "disabled";
+    case OpenThermReason::Paused:      return "paused";
+    case OpenThermReason::BootDelay:   return "boot delay";
+    case OpenThermReason::AllocFailed: return "alloc failed";
+    case OpenThermReason::BadPins:     return "bad pins";
+    case OpenThermReason::InitFailed:  return "init failed";
+    case OpenThermReason::NotReady:    return "not ready";
+    case OpenThermReason::Timeout:     return "timeout";
+    case OpenThermReason::Invalid:     return "invalid";
+  }
+  return "";
+}
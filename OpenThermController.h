@@ -3,6 +3,8 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
+#include "OpenThermTrace.h"
+
 // OpenTherm module (Ihor Melnyk library backend).
 // Provides:
 //  - periodic polling of boiler via OpenTherm adapter
@@ -32,6 +34,11 @@ struct OpenThermConfig {
   // Default false.
   bool allowRawWrite = false;
 
+  // Run bus I/O on a dedicated FreeRTOS task pinned to core 0 instead of
+  // openthermLoop(). Equitherm/DHW requests are then queued through a
+  // lock-free mailbox and readers use the published telemetry snapshot.
+  bool runInTask = false;
+
   // OTBus control watchdog (only active when mode=="control")
   uint32_t watchdogTimeoutMs = 3000;
   uint8_t maxConsecutiveFailures = 3;
@@ -54,13 +61,24 @@ struct OpenThermConfig {
   int rxPin = -1; // adapter OUT -> controller (interrupt)
   bool invertTx = false;
   bool invertRx = false;
+  // RX decoder: "isr" (edge interrupts) or "rmt" (RMT capture, one interrupt
+  // per frame; falls back to "isr" when no RMT channel is free).
+  String rxBackend = "isr";
   bool autoDetectLogic = true;
 
-  // Optional additional poll list (Data-IDs) for future extension.
+  // Additional Data-IDs polled by the scheduler (low priority, 30 s max age).
+  // Raw values are available via openthermGetDataIdValue().
   uint8_t pollIds[32] = {0};
   uint8_t pollIdsCount = 0;
 };
 
+// Poll scheduler priority class (lower value = served first).
+enum class OpenThermPollPriority : uint8_t {
+  Control = 0, // feeds a control loop (e.g. Tboiler for Ekviterm)
+  Normal = 1,  // UI / temperature roles
+  Low = 2      // slow diagnostics (pressure, fault flags, remote params)
+};
+
 struct OpenThermSourceRequest {
   bool active = false;
   bool chEnableSet = false;
@@ -75,7 +93,24 @@ struct OpenThermSourceRequest {
   float maxModulationPct = NAN;
 };
 
-struct OpenThermStatusSnapshot {
+// Why telemetry is unavailable (None while the boiler answers normally).
+enum class OpenThermReason : uint8_t {
+  None = 0,
+  Disabled,
+  Paused,
+  BootDelay,
+  AllocFailed,
+  BadPins,
+  InitFailed,
+  NotReady,
+  Timeout,
+  Invalid
+};
+
+// Allocation-free status copy (no String members, trivially copyable).
+// openthermLoop() publishes it through a sequence counter, so readers get a
+// consistent copy without locks or heap allocation, also from another task.
+struct OpenThermTelemetry {
   bool present = false; // module enabled and initialized
   bool ready = false;   // library ready
 
@@ -133,17 +168,54 @@ struct OpenThermStatusSnapshot {
   uint32_t timeoutCount = 0;
   uint32_t invalidCount = 0;
 
+  // Transaction engine timing: openthermLoop() duration (last / worst case)
+  // and wall time of the last complete poll cycle.
+  uint32_t loopLastUs = 0;
+  uint32_t loopMaxUs = 0;
+  uint32_t lastCycleMs = 0;
+  // Bus load: frames sent during the last full minute.
+  uint32_t framesPerMin = 0;
+
+  OpenThermReason reasonCode = OpenThermReason::None;
+  char lastCmdText[64] = {0};
+  char activeSourceText[16] = {0};
+};
+
+// String-based snapshot kept for JSON/UI code (thin adapter over OpenThermTelemetry).
+struct OpenThermStatusSnapshot : OpenThermTelemetry {
   String reason;
   String lastCmd;
   String activeSource;
 };
 
 void openthermInit();
+// Steps the bus engine; returns immediately while the dedicated task runs it.
 void openthermLoop();
 void openthermApplyConfig(const String& configJson);
 
+// Dedicated task mode (OpenThermConfig::runInTask).
+bool openthermTaskActive();
+bool openthermIsTaskContext(); // true when called from the OpenTherm task itself
+
+// Copy of the runtime config, taken under the module lock (String members).
 OpenThermConfig openthermGetConfig();
+// Single config scalar for other tasks, without copying the Strings.
+float openthermGetAssumedMaxBoilerKw();
+// Hot-path status read (control loops, temperature roles, history): no allocation.
+OpenThermTelemetry openthermGetTelemetry();
+// Same data plus String copies of reason/lastCmd/activeSource.
 OpenThermStatusSnapshot openthermGetStatus();
+const char* openthermReasonText(OpenThermReason r);
+
+// Poll scheduler: declare that a consumer needs Data-ID `id` no older than
+// maxAgeMs. Declarations are merged per ID (shortest age, highest priority).
+void openthermDeclarePollInterest(uint8_t id, uint32_t maxAgeMs, OpenThermPollPriority prio);
+// Last raw value of a scheduled Data-ID (built-in, declared or config pollIds).
+bool openthermGetDataIdValue(uint8_t id, uint16_t& outRaw, uint32_t maxAgeMs, uint32_t* outAgeMs);
+// Per-ID scheduler statistics (age, refresh-interval percentiles, backoff).
+String openthermGetPollStatsJson();
+// Per-ID exchange statistics (outcome counts, last good response, latency histogram).
+String openthermGetIdStatsJson();
 
 // Helper for /api/fast JSON payload.
 void openthermFillFastJson(JsonObject& out);
@@ -170,6 +242,15 @@ bool openthermClearLog();
 String openthermReadDataIdJson(uint8_t id, uint16_t reqValue = 0);
 String openthermWriteDataIdJson(uint8_t id, uint16_t value);
 
+// Frame trace (always recording into a RAM ring, see OpenThermTrace.h).
+// openthermTraceBegin() fills a dump header and returns the end sequence;
+// openthermTraceRead() copies consecutive records starting at `seq` and returns
+// 0 at the end or once `seq` has been overwritten.
+uint32_t openthermTraceBegin(OpenThermTraceHeader& outHdr);
+size_t openthermTraceRead(uint32_t seq, OpenThermTraceRecord* out, size_t maxRecords);
+// Replays recorded frames through the Data-ID decoders (timeline JSON).
+String openthermTraceReplayJson(uint32_t fromSeq, uint16_t limit);
+
 // Temperature source helpers.
 bool openthermGetBoilerTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs);
 bool openthermGetReturnTemp(float& outC, uint32_t maxAgeMs, uint32_t* outAgeMs);
@@ -0,0 +1,358 @@
+#include "OpenThermDataIds.h"
+
+#include "OTBusESP32Pro.h"
+
+namespace {
+  // ---- ID-specific decoders ----
+
+  void decodeStatus(JsonObject& out, uint16_t raw) {
+    const otbus::StatusFlags f = otbus::StatusFlags::decode(raw);
+    JsonObject st = out.createNestedObject("status");
+    st["chEnable"] = f.chEnable;
+    st["dhwEnable"] = f.dhwEnable;
+    st["coolingEnable"] = f.coolingEnable;
+    st["otcActive"] = f.otcActive;
+    st["ch2Enable"] = f.ch2Enable;
+    st["fault"] = f.fault;
+    st["chActive"] = f.chActive;
+    st["dhwActive"] = f.dhwActive;
+    st["flameOn"] = f.flameOn;
+    st["coolingActive"] = f.coolingActive;
+    st["ch2Active"] = f.ch2Active;
+    st["diagnostic"] = f.diagnostic;
+  }
+
+  // Master configuration flags (HB) + Master MemberID (LB)
+  void decodeMasterConfig(JsonObject& out, uint16_t raw) {
+    const uint8_t cfg = (uint8_t)(raw >> 8);
+    JsonObject c = out.createNestedObject("masterCfg");
+    c["memberId"] = (uint8_t)(raw & 0xFF);
+    c["smartPower"] = (bool)((cfg >> 0) & 1);
+    c["cfgRaw"] = cfg;
+  }
+
+  // Slave configuration flags (HB) + Slave MemberID (LB)
+  // Bit meanings follow common OpenTherm v2.2 tables.
+  void decodeSlaveConfig(JsonObject& out, uint16_t raw) {
+    const uint8_t cfg = (uint8_t)(raw >> 8);
+    JsonObject c = out.createNestedObject("slaveCfg");
+    c["memberId"] = (uint8_t)(raw & 0xFF);
+    c["dhwPresent"] = (bool)((cfg >> 0) & 1);
+    c["controlType"] = (bool)((cfg >> 1) & 1);
+    c["coolingSupported"] = (bool)((cfg >> 2) & 1);
+    c["dhwConfiguration"] = (bool)((cfg >> 3) & 1); // 0=instant, 1=storage
+    c["masterLowOffPumpCtrl"] = (bool)((cfg >> 4) & 1);
+    c["ch2Present"] = (bool)((cfg >> 5) & 1);
+    c["remoteWaterFilling"] = (bool)((cfg >> 6) & 1);
+    c["heatCoolModeCtrl"] = (bool)((cfg >> 7) & 1);
+    c["cfgRaw"] = cfg;
+  }
+
+  void decodeAsfFault(JsonObject& out, uint16_t raw) {
+    out["asfFlags"] = (uint8_t)(raw >> 8);
+    out["oemFault"] = (uint8_t)(raw & 0xFF);
+  }
+
+  // Remote boiler parameter transfer-enable (HB) and read/write (LB)
+  void decodeRbp(JsonObject& out, uint16_t raw) {
+    const uint8_t te = (uint8_t)(raw >> 8);
+    const uint8_t rw = (uint8_t)(raw & 0xFF);
+    JsonObject r = out.createNestedObject("rbp");
+    r["teMask"] = te;
+    r["rwMask"] = rw;
+    // P1..P8 bits (not every boiler uses all)
+    for (uint8_t i = 0; i < 8; i++) {
+      char k1[6]; // "p1TE" etc
+      char k2[6]; // "p1RW" etc
+      snprintf(k1, sizeof(k1), "p%uTE", (unsigned)(i + 1));
+      snprintf(k2, sizeof(k2), "p%uRW", (unsigned)(i + 1));
+      r[k1] = (bool)((te >> i) & 1);
+      r[k2] = (bool)((rw >> i) & 1);
+    }
+  }
+
+  void decodeTspCount(JsonObject& out, uint16_t raw) {
+    out["tspCount"] = (uint8_t)(raw >> 8);
+  }
+
+  void decodeTspEntry(JsonObject& out, uint16_t raw) {
+    out["tspIndex"] = (uint8_t)(raw >> 8);
+    out["tspValue"] = (uint8_t)(raw & 0xFF);
+  }
+
+  // u8/u8: max capacity (kW) / min modulation (%)
+  void decodeCapacity(JsonObject& out, uint16_t raw) {
+    out["maxCapacityKw"] = (uint8_t)(raw >> 8);
+    out["minModulationPct"] = (uint8_t)(raw & 0xFF);
+  }
+
+  void decodeDayTime(JsonObject& out, uint16_t raw) {
+    const otbus::DayTime dt = otbus::DayTime::decode(raw);
+    JsonObject t = out.createNestedObject("dayTime");
+    t["day"] = dt.day;
+    t["hour"] = dt.hour;
+    t["minute"] = dt.minute;
+  }
+
+  void decodeDate(JsonObject& out, uint16_t raw) {
+    const otbus::DateMD d = otbus::DateMD::decode(raw);
+    JsonObject t = out.createNestedObject("date");
+    t["month"] = d.month;
+    t["day"] = d.day;
+  }
+
+  void decodeYear(JsonObject& out, uint16_t raw) {
+    out["year"] = (uint16_t)raw;
+  }
+
+  // s8/s8 bounds: HB=upper, LB=lower
+  void decodeBounds(JsonObject& out, uint16_t raw) {
+    out["upper"] = (int)(int8_t)(raw >> 8);
+    out["lower"] = (int)(int8_t)(raw & 0xFF);
+  }
+
+  // ---- Table rows ----
+  constexpr float kF88Scale = 1.0f / 256.0f;
+  constexpr const char* kUnknownDesc = "Unknown/undocumented Data-ID (boiler dependent)";
+
+  constexpr OpenThermDataIdMeta otId(uint8_t id, const char* name, const char* desc, OtValueType type,
+                                     const char* unit, OtAccess access, OtValueDecoder decode = nullptr) {
+    return OpenThermDataIdMeta{ id, name, desc, false, type, unit, access,
+                                type == OtValueType::F88 ? kF88Scale : 1.0f, decode };
+  }
+
+  // f8.8 temperature in °C
+  constexpr OpenThermDataIdMeta otTemp(uint8_t id, const char* name, const char* desc, OtAccess access) {
+    return OpenThermDataIdMeta{ id, name, desc, true, OtValueType::F88, "°C", access, kF88Scale, nullptr };
+  }
+
+  constexpr OpenThermDataIdMeta otNone(uint8_t id) {
+    return OpenThermDataIdMeta{ id, nullptr, kUnknownDesc, false, OtValueType::U16, "", OtAccess::Unknown, 1.0f, nullptr };
+  }
+
+  using T = OtValueType;
+  using A = OtAccess;
+
+  // One row per Data-ID, in ID order (checked below). Keep strings short (flash friendly).
+  constexpr OpenThermDataIdMeta kDataIds[128] = {
+    // 0..39: common boiler/room controller set
+    otId(0, "Status", "Master/Slave status flags (fault, CH/DHW active, flame, ...)", T::Flag8Flag8, "", A::R, decodeStatus),
+    otTemp(1, "CH control setpoint", "Requested CH water temperature setpoint (TSet)", A::W),
+    otId(2, "Master config + MemberID", "Master configuration flags + MemberID code", T::Flag8U8, "", A::W, decodeMasterConfig),
+    otId(3, "Slave config + MemberID", "Slave configuration flags + MemberID code", T::Flag8U8, "", A::R, decodeSlaveConfig),
+    otId(4, "Remote request", "Remote request (reset, service, water filling, ...)", T::U8U8, "", A::W),
+    otId(5, "ASF + OEM fault", "Application-specific fault flags + OEM fault code", T::Flag8U8, "", A::R, decodeAsfFault),
+    otId(6, "RBP flags", "Remote boiler parameter transfer-enable & read/write flags", T::Flag8Flag8, "", A::R, decodeRbp),
+    otId(7, "Cooling control", "Cooling control signal (%)", T::F88, "%", A::W),
+    otTemp(8, "CH2 control setpoint", "Control setpoint for 2nd CH circuit (TSetCH2)", A::W),
+    otTemp(9, "Room setpoint override", "Remote override room setpoint (TrOverride)", A::R),
+    otId(10, "TSP count", "Number of Transparent-Slave-Parameters supported by slave", T::U8U8, "", A::R, decodeTspCount),
+    otId(11, "TSP entry", "Index / value of referred-to transparent slave parameter", T::U8U8, "", A::RW, decodeTspEntry),
+    otId(12, "FHB size", "Size of Fault-History-Buffer supported by slave", T::U8U8, "", A::R),
+    otId(13, "FHB entry", "Index / value of referred-to fault-history buffer entry", T::U8U8, "", A::R),
+    otId(14, "Max modulation setting", "Maximum relative modulation level setting (%)", T::F88, "%", A::W),
+    otId(15, "Max capacity / min modulation", "Maximum boiler capacity (kW) / min modulation (%)", T::U8U8, "", A::R, decodeCapacity),
+    otTemp(16, "Room setpoint", "Room temperature setpoint (TrSet)", A::W),
+    otId(17, "Relative modulation", "Relative modulation level (%)", T::F88, "%", A::R),
+    otId(18, "CH pressure", "Water pressure in CH circuit (bar)", T::F88, "bar", A::R),
+    otId(19, "DHW flow rate", "Water flow rate in DHW circuit (L/min)", T::F88, "L/min", A::R),
+    otId(20, "Day/time", "Day of week and time of day", T::Special, "", A::RW, decodeDayTime),
+    otId(21, "Date", "Calendar date (month/day)", T::U8U8, "", A::RW, decodeDate),
+    otId(22, "Year", "Calendar year", T::U16, "", A::RW, decodeYear),
+    otTemp(23, "Room setpoint CH2", "Room setpoint for 2nd CH circuit", A::W),
+    otTemp(24, "Room temperature", "Measured room temperature (Tr)", A::W),
+    otTemp(25, "Boiler flow temperature", "Boiler flow water temperature (Tboiler)", A::R),
+    otTemp(26, "DHW temperature", "Domestic hot water temperature (Tdhw)", A::R),
+    otTemp(27, "Outside temperature", "Outside temperature (Toutside)", A::R),
+    otTemp(28, "Return temperature", "Return water temperature (Tret)", A::R),
+    otTemp(29, "Solar storage temp", "Solar storage temperature (Tstorage)", A::R),
+    otTemp(30, "Solar collector temp", "Solar collector temperature (Tcollector)", A::R),
+    otTemp(31, "Flow temp CH2", "Flow water temperature in CH2 circuit", A::R),
+    otTemp(32, "DHW temperature 2", "Domestic hot water temperature 2 (Tdhw2)", A::R),
+    // Texhaust is s16 (°C), not f8.8.
+    OpenThermDataIdMeta{ 33, "Exhaust temperature", "Boiler exhaust temperature (Texhaust)", true, T::S16, "°C", A::R, 1.0f, nullptr },
+    otTemp(34, "Heat exchanger temp", "Boiler heat exchanger temperature", A::R),
+    otId(35, "Fan speed set/actual", "Boiler fan speed setpoint and actual value", T::U8U8, "rpm", A::R),
+    otId(36, "Flame current", "Electrical current through burner flame (uA)", T::F88, "uA", A::R),
+    otTemp(37, "Room temperature CH2", "Measured room temperature for 2nd CH circuit", A::W),
+    otId(38, "Relative humidity", "Actual relative humidity (%)", T::F88, "%", A::RW),
+    otTemp(39, "Room setpoint override 2", "Remote override room setpoint 2", A::R),
+    otNone(40), otNone(41), otNone(42), otNone(43), otNone(44), otNone(45), otNone(46), otNone(47),
+
+    // 48..58: bounds + remote parameters + OTC (Outside Temperature Compensation)
+    otId(48, "DHW setpoint bounds", "Upper/lower bounds for DHW setpoint adjustment (s8)", T::S8S8, "°C", A::R, decodeBounds),
+    otId(49, "Max CH setpoint bounds", "Upper/lower bounds for max CH setpoint adjustment (s8)", T::S8S8, "°C", A::R, decodeBounds),
+    otId(50, "OTC ratio bounds", "Upper/lower bounds for OTC heatcurve ratio (s8)", T::S8S8, "", A::R, decodeBounds),
+    otNone(51), otNone(52), otNone(53), otNone(54), otNone(55),
+    otTemp(56, "DHW setpoint", "DHW setpoint (remote parameter 1)", A::RW),
+    otTemp(57, "Max CH setpoint", "Maximum CH water setpoint (remote parameter 2)", A::RW),
+    otId(58, "OTC heatcurve ratio", "Outside temperature compensation heatcurve ratio", T::F88, "K", A::RW),
+    otNone(59), otNone(60), otNone(61), otNone(62), otNone(63), otNone(64), otNone(65), otNone(66),
+    otNone(67), otNone(68), otNone(69),
+
+    // 70..91: ventilation/heat-recovery (rare)
+    otId(70, "Status V/H", "Ventilation/heat-recovery status flags", T::Flag8Flag8, "", A::R),
+    otId(71, "V/H setpoint", "Relative ventilation position (0..100)", T::U8, "%", A::W),
+    otId(72, "Fault V/H", "Ventilation/heat-recovery fault flags + OEM code", T::Flag8U8, "", A::R),
+    otId(73, "Diagnostic V/H", "Ventilation/heat-recovery OEM diagnostic code", T::U16, "", A::R),
+    otId(74, "Config+MemberID V/H", "Ventilation/heat-recovery config flags + MemberID", T::Flag8U8, "", A::R),
+    otId(75, "OT version V/H", "OpenTherm protocol version (ventilation)", T::F88, "", A::R),
+    otId(76, "Version+type V/H", "Ventilation product version number and type", T::U8U8, "", A::R),
+    otId(77, "Relative ventilation", "Relative ventilation level (0..100)", T::U8, "%", A::R),
+    otId(78, "Humidity exhaust", "Relative humidity exhaust air (0..100)", T::U8, "%", A::RW),
+    otId(79, "CO2 exhaust", "CO2 level exhaust air (ppm)", T::U16, "ppm", A::RW),
+    otTemp(80, "Supply inlet temp", "Supply inlet temperature (Tsi)", A::R),
+    otTemp(81, "Supply outlet temp", "Supply outlet temperature (Tso)", A::R),
+    otTemp(82, "Exhaust inlet temp", "Exhaust inlet temperature (Tei)", A::R),
+    otTemp(83, "Exhaust outlet temp", "Exhaust outlet temperature (Teo)", A::R),
+    otId(84, "RPM exhaust", "Exhaust fan speed (rpm)", T::U16, "rpm", A::R),
+    otId(85, "RPM supply", "Supply fan speed (rpm)", T::U16, "rpm", A::R),
+    otId(86, "RBP flags V/H", "Remote ventilation parameter transfer-enable & read/write flags", T::Flag8Flag8, "", A::R),
+    otId(87, "Nominal ventilation", "Nominal relative ventilation value", T::U8, "%", A::RW),
+    otId(88, "TSP count V/H", "Number of TSP parameters (ventilation)", T::U8U8, "", A::R),
+    otId(89, "TSP entry V/H", "Index/value of ventilation TSP parameter", T::U8U8, "", A::RW),
+    otId(90, "FHB size V/H", "Fault history buffer size (ventilation)", T::U8U8, "", A::R),
+    otId(91, "FHB entry V/H", "Fault history buffer entry (ventilation)", T::U8U8, "", A::R),
+    otNone(92),
+
+    // 93..95: brand strings (rare)
+    otId(93, "Brand char", "Index/character in brand string", T::U8U8, "", A::R),
+    otId(94, "Brand version char", "Index/character in brand version string", T::U8U8, "", A::R),
+    otId(95, "Serial char", "Index/character in brand serial number string", T::U8U8, "", A::R),
+
+    // 96..127: counters + protocol/product info (often supported on modern boilers)
+    otId(96, "Cooling hours", "Hours in cooling mode", T::U16, "h", A::RW),
+    otId(97, "Power cycles", "Number of power cycles (wake-up after reset)", T::U16, "count", A::RW),
+    otId(98, "RF sensor status", "RF signal strength and battery level (special)", T::Special, "", A::R),
+    otId(99, "Operating mode", "Operating mode HC1/HC2 and DHW (special)", T::Special, "", A::RW),
+    otId(100, "Remote override function", "Function of manual/program changes in master/remote room setpoint", T::Flag8Flag8, "", A::R),
+    otNone(101), otNone(102), otNone(103), otNone(104), otNone(105), otNone(106), otNone(107), otNone(108),
+    otId(109, "Elec prod starts", "Electricity producer starts", T::U16, "count", A::RW),
+    otId(110, "Elec prod hours", "Electricity producer hours", T::U16, "h", A::RW),
+    otId(111, "Elec production", "Current electricity production (W)", T::U16, "W", A::R),
+    otId(112, "Elec production cum", "Cumulative electricity production (kWh)", T::U16, "kWh", A::RW),
+    otId(113, "Unsuccessful starts", "Number of unsuccessful burner starts", T::U16, "count", A::RW),
+    otId(114, "Flame low count", "Number of times flame signal was too low", T::U16, "count", A::RW),
+    otId(115, "OEM diagnostic code", "OEM-specific diagnostic/service code", T::U16, "", A::R),
+    otId(116, "Burner starts", "Number of successful burner starts", T::U16, "count", A::RW),
+    otId(117, "CH pump starts", "Number of starts CH pump", T::U16, "count", A::RW),
+    otId(118, "DHW pump/valve starts", "Number of starts DHW pump/valve", T::U16, "count", A::RW),
+    otId(119, "DHW burner starts", "Number of starts burner during DHW mode", T::U16, "count", A::RW),
+    otId(120, "Burner hours", "Hours burner is in operation (flame on)", T::U16, "h", A::RW),
+    otId(121, "CH pump hours", "Hours CH pump has been running", T::U16, "h", A::RW),
+    otId(122, "DHW pump/valve hours", "Hours DHW pump has been running / DHW valve opened", T::U16, "h", A::RW),
+    otId(123, "DHW burner hours", "Hours burner is in operation during DHW mode", T::U16, "h", A::RW),
+    otId(124, "OT version (master)", "OpenTherm protocol version implemented in master", T::F88, "", A::W),
+    otId(125, "OT version (slave)", "OpenTherm protocol version implemented in slave", T::F88, "", A::R),
+    otId(126, "Master product version", "Master product version number and type", T::U8U8, "", A::W),
+    otId(127, "Slave product version", "Slave product version number and type", T::U8U8, "", A::R),
+  };
+
+  // ---- Compile-time consistency checks ----
+  constexpr bool rowOk(const OpenThermDataIdMeta& m, unsigned index) {
+    return m.id == index
+        // temperatures are f8.8 (or s16 for Texhaust)
+        && (!m.isTemperature || m.type == T::F88 || m.type == T::S16)
+        // the scale must match the wire type
+        && (m.type == T::F88 ? m.scale == kF88Scale : m.scale == 1.0f)
+        // s8/s8 rows are bounds and use the bounds decoder
+        && ((m.type == T::S8S8) == (m.decode == decodeBounds))
+        // undocumented rows carry no type-specific information
+        && (m.name != nullptr || (m.access == A::Unknown && m.decode == nullptr && !m.isTemperature))
+        && (m.name == nullptr || m.access != A::Unknown)
+        && m.desc != nullptr && m.unit != nullptr;
+  }
+
+  constexpr bool tableOk(unsigned index) {
+    return index >= 128 || (rowOk(kDataIds[index], index) && tableOk(index + 1));
+  }
+
+  static_assert(sizeof(kDataIds) / sizeof(kDataIds[0]) == 128, "one row per Data-ID");
+  static_assert(tableOk(0), "kDataIds: row out of order or inconsistent type/scale/decoder");
+} // namespace
+
+const OpenThermDataIdMeta& openthermDataIdMeta(uint8_t id) {
+  static const OpenThermDataIdMeta kBeyond = otNone(0xFF);
+  return id < 128 ? kDataIds[id] : kBeyond;
+}
+
+const char* openthermValueTypeText(OtValueType t) {
+  switch (t) {
+    case OtValueType::U16:        return "u16";
+    case OtValueType::S16:        return "s16";
+    case OtValueType::F88:        return "f8.8";
+    case OtValueType::U8:         return "u8";
+    case OtValueType::U8U8:       return "u8/u8";
+    case OtValueType::S8S8:       return "s8/s8";
+    case OtValueType::Flag8Flag8: return "flags/flags";
+    case OtValueType::Flag8U8:    return "flags/u8";
+    case OtValueType::Special:    return "special";
+  }
+  return "u16";
+}
+
+const char* openthermAccessText(OtAccess a) {
+  switch (a) {
+    case OtAccess::R:       return "R";
+    case OtAccess::W:       return "W";
+    case OtAccess::RW:      return "R/W";
+    case OtAccess::Unknown: break;
+  }
+  return "";
+}
+
+void openthermFillDataIdMeta(JsonObject& out, uint8_t id) {
+  const OpenThermDataIdMeta& m = openthermDataIdMeta(id);
+  char nameBuf[8];
+  const char* nm = m.name;
+  if (!nm) { snprintf(nameBuf, sizeof(nameBuf), "ID%u", (unsigned)id); nm = nameBuf; }
+  out["id"] = id;
+  out["name"] = nm;
+  out["desc"] = m.desc;
+  out["isTemp"] = m.isTemperature;
+  out["type"] = openthermValueTypeText(m.type);
+  if (m.access != OtAccess::Unknown) out["rw"] = openthermAccessText(m.access);
+  // Only include unit when it is meaningful.
+  if (m.unit[0]) out["unit"] = m.unit;
+}
+
+void openthermDecodeDataIdValue(JsonObject& out, uint8_t id, uint16_t raw) {
+  const OpenThermDataIdMeta& m = openthermDataIdMeta(id);
+  out["raw"] = raw;
+  out["hb"] = (uint8_t)(raw >> 8);
+  out["lb"] = (uint8_t)(raw & 0xFF);
+  out["u16"] = (uint16_t)raw;
+  out["s16"] = (int16_t)raw;
+
+  if (m.decode) m.decode(out, raw);
+
+  if (m.type == OtValueType::F88) {
+    out["f88"] = (float)(int16_t)raw * m.scale;
+    if (m.unit[0]) out["unit"] = m.unit;
+  } else if (m.type == OtValueType::S16 && m.isTemperature) {
+    out["celsius"] = (int16_t)raw;
+    out["unit"] = m.unit;
+  }
+}
+
+String openthermGetProtocolJson() {
+  String out;
+  out.reserve(12288);
+  out += "{\"ok\":true,\"ids\":[";
+  bool first = true;
+  for (uint8_t id = 0; id < 128; id++) {
+    const OpenThermDataIdMeta& m = kDataIds[id];
+    if (!m.name) continue;
+    StaticJsonDocument<384> doc;
+    JsonObject o = doc.to<JsonObject>();
+    openthermFillDataIdMeta(o, id);
+    o["scale"] = m.scale;
+    if (!first) out += ',';
+    first = false;
+    String item;
+    serializeJson(doc, item);
+    out += item;
+  }
+  out += "]}";
+  return out;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+// Lock-free primitives shared between the OpenTherm task and its callers.
+// Header-only and free of Arduino/FreeRTOS dependencies so the logic can be
+// built and stress-tested on a host compiler as well.
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// Bounded multi-producer / single-consumer command queue (Vyukov-style ring).
+// push() never blocks and returns false when the queue is full; pop() must only
+// be called from the consumer. Items from one producer are popped in the order
+// they were pushed.
+template <typename T, uint32_t N>
+class OtMailbox {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "OtMailbox capacity must be a power of two");
+  static_assert(std::is_trivially_copyable<T>::value, "OtMailbox items must be trivially copyable");
+
+ public:
+  OtMailbox() {
+    for (uint32_t i = 0; i < N; i++) _cells[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  bool push(const T& item) {
+    uint32_t pos = _enqueue.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;) {
+      cell = &_cells[pos & (N - 1)];
+      const uint32_t seq = cell->seq.load(std::memory_order_acquire);
+      const int32_t diff = (int32_t)(seq - pos);
+      if (diff == 0) {
+        if (_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false; // full
+      } else {
+        pos = _enqueue.load(std::memory_order_relaxed);
+      }
+    }
+    memcpy(&cell->item, &item, sizeof(T));
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T& out) {
+    const uint32_t pos = _dequeue.load(std::memory_order_relaxed);
+    Cell& cell = _cells[pos & (N - 1)];
+    const uint32_t seq = cell.seq.load(std::memory_order_acquire);
+    if ((int32_t)(seq - (pos + 1)) < 0) return false; // empty (or producer still writing)
+    memcpy(&out, &cell.item, sizeof(T));
+    cell.seq.store(pos + N, std::memory_order_release);
+    _dequeue.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<uint32_t> seq{0};
+    T item;
+  };
+
+  Cell _cells[N];
+  std::atomic<uint32_t> _enqueue{0};
+  std::atomic<uint32_t> _dequeue{0};
+};
+
+// Published copy of a trivially copyable value (sequence counter over two
+// slots). publish() fills the inactive slot and then bumps the sequence, whose
+// low bit selects the current slot. read() never blocks: it retries when the
+// sequence moved during its copy, because the publish after that one already
+// writes the slot being copied. A writer preempted mid-publish leaves the
+// current slot alone, so it never stalls readers. Writers must be serialised
+// by the caller.
+template <typename T>
+class OtSnapshot {
+  static_assert(std::is_trivially_copyable<T>::value, "OtSnapshot value must be trivially copyable");
+
+ public:
+  void publish(const T& value) {
+    const uint32_t seq = _seq.load(std::memory_order_relaxed);
+    // Order the previous sequence store before the slot writes below.
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&_slot[(seq + 1) & 1], &value, sizeof(T));
+    _seq.store(seq + 1, std::memory_order_release);
+  }
+
+  T read() const {
+    T out;
+    for (;;) {
+      const uint32_t seq = _seq.load(std::memory_order_acquire);
+      memcpy(&out, &_slot[seq & 1], sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_seq.load(std::memory_order_relaxed) == seq) return out;
+    }
+  }
+
+  uint32_t sequence() const { return _seq.load(std::memory_order_acquire); }
+
+ private:
+  T _slot[2];
+  std::atomic<uint32_t> _seq{0};
+};
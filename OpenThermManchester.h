@@ -0,0 +1,181 @@
+#pragma once
+
+// OpenTherm Manchester decoder: turns a captured run-length stream
+// (level + duration, e.g. RMT RX symbols) into a 32-bit frame in one pass.
+// Arduino-free so it can be exercised on a host (tools/ot_rx_bench.cpp).
+//
+// Line levels follow OpenTherm::handleInterrupt(): the RX pin idles at the
+// inactive level, bit "1" is active->inactive at mid-bit, bit "0" is
+// inactive->active. A frame is start bit (1) + 32 data bits + stop bit (1),
+// 1 ms per bit (two 500 us half-bits). Parity is not checked here; the
+// OpenTherm library validates the frame afterwards (isValidResponse()).
+
+#include <stdint.h>
+
+enum class OtManchesterResult : uint8_t {
+  Ok = 0,
+  Empty,      // no active level seen
+  Glitch,     // run shorter than a half-bit but longer than the glitch filter
+  BadTiming,  // run longer than a full bit inside the frame
+  BadMidBit,  // no transition in the middle of a bit
+  BadStart,   // start bit is not "1"
+  BadStop,    // stop bit is not "1"
+  Short,      // fewer than 34 bits
+  Long        // activity after the stop bit
+};
+
+struct OtManchesterTiming {
+  // Runs below glitchUs are merged into the surrounding level.
+  uint16_t glitchUs = 100;
+  // Run classification (same 750 us split as the edge-interrupt decoder).
+  uint16_t halfMinUs = 250;
+  uint16_t fullMinUs = 750;
+  uint16_t fullMaxUs = 1400;
+};
+
+class OtManchesterDecoder {
+public:
+  explicit OtManchesterDecoder(bool activeHigh = true, const OtManchesterTiming& t = OtManchesterTiming())
+    : _active(activeHigh ? 1 : 0), _t(t) { reset(); }
+
+  void reset() {
+    _res = OtManchesterResult::Ok;
+    _started = false;
+    _done = false;
+    _runLevel = 0;
+    _runUs = 0;
+    _halves = 0;
+    _first = 0;
+    _frame = 0;
+  }
+
+  // One run of the line (level 0/1, duration in microseconds). A zero duration
+  // marks the end of the capture (RMT end-of-frame symbol).
+  void feed(uint8_t level, uint32_t durUs) {
+    if (_res != OtManchesterResult::Ok) return;
+    level = level ? 1 : 0;
+    if (!_started) {
+      // Skip leading idle (and anything too short to be a half-bit).
+      if (level != _active || durUs < _t.glitchUs) return;
+      _started = true;
+      _runLevel = level;
+      _runUs = durUs;
+      return;
+    }
+    if (_done) {
+      // Only real activity after the stop bit is an error; idle noise is not.
+      if (level == _active && durUs >= _t.halfMinUs) _res = OtManchesterResult::Long;
+      return;
+    }
+    if (durUs == 0) return;
+    if (level == _runLevel || durUs < _t.glitchUs) {
+      _runUs += durUs;
+      return;
+    }
+    flushRun(false);
+    _runLevel = level;
+    _runUs = durUs;
+    // Mid-bit transition of the stop bit: the frame is complete.
+    if (_res == OtManchesterResult::Ok && level != _active && _halves == kHalves - 1) {
+      pushHalf(level);
+      _done = true;
+    }
+  }
+
+  // Ends the capture; returns Ok and stores the frame when 34 valid bits were seen.
+  OtManchesterResult finish(uint32_t& outFrame) {
+    if (_res == OtManchesterResult::Ok) {
+      if (!_started) {
+        _res = OtManchesterResult::Empty;
+      } else if (!_done) {
+        flushRun(true);
+        // The second half of the stop bit merges into idle; when the capture
+        // ends on the first half, the missing idle half is implied.
+        if (_res == OtManchesterResult::Ok && _halves == kHalves - 1 && _first == _active) {
+          pushHalf((uint8_t)(_active ^ 1));
+        }
+        if (_res == OtManchesterResult::Ok && _halves < kHalves) _res = OtManchesterResult::Short;
+      }
+    }
+    if (_res == OtManchesterResult::Ok) outFrame = _frame;
+    return _res;
+  }
+
+  OtManchesterResult result() const { return _res; }
+  uint8_t bitsDecoded() const { return (uint8_t)(_halves / 2); }
+
+  static const char* resultText(OtManchesterResult r) {
+    switch (r) {
+      case OtManchesterResult::Ok:        return "ok";
+      case OtManchesterResult::Empty:     return "empty";
+      case OtManchesterResult::Glitch:    return "glitch";
+      case OtManchesterResult::BadTiming: return "badTiming";
+      case OtManchesterResult::BadMidBit: return "badMidBit";
+      case OtManchesterResult::BadStart:  return "badStart";
+      case OtManchesterResult::BadStop:   return "badStop";
+      case OtManchesterResult::Short:     return "short";
+      case OtManchesterResult::Long:      return "long";
+    }
+    return "?";
+  }
+
+private:
+  static constexpr uint8_t kHalves = 68; // 34 bits
+
+  void flushRun(bool last) {
+    uint8_t n;
+    if (_runUs < _t.halfMinUs) {
+      _res = OtManchesterResult::Glitch;
+      return;
+    } else if (_runUs < _t.fullMinUs) {
+      n = 1;
+    } else if (_runUs <= _t.fullMaxUs) {
+      n = 2;
+    } else if (last && _runLevel != _active) {
+      n = 1; // trailing idle
+    } else {
+      _res = OtManchesterResult::BadTiming;
+      return;
+    }
+    // A trailing idle run may cover the stop bit's second half and nothing more.
+    if (last && _runLevel != _active && _halves + n > kHalves) n = (uint8_t)(kHalves - _halves);
+    while (n-- && _res == OtManchesterResult::Ok) pushHalf(_runLevel);
+  }
+
+  void pushHalf(uint8_t level) {
+    if (_halves >= kHalves) {
+      _res = OtManchesterResult::Long;
+      return;
+    }
+    if ((_halves & 1) == 0) {
+      _first = level;
+      _halves++;
+      return;
+    }
+    if (level == _first) {
+      _res = OtManchesterResult::BadMidBit;
+      return;
+    }
+    const uint8_t bit = (_first == _active) ? 1 : 0;
+    const uint8_t index = (uint8_t)(_halves / 2);
+    _halves++;
+    if (index == 0) {
+      if (!bit) _res = OtManchesterResult::BadStart;
+    } else if (index <= 32) {
+      _frame = (_frame << 1) | bit;
+    } else if (!bit) {
+      _res = OtManchesterResult::BadStop;
+    }
+  }
+
+  uint8_t _active;
+  OtManchesterTiming _t;
+  OtManchesterResult _res;
+  bool _started;
+  bool _done;     // stop bit seen, the rest of the capture is idle
+  uint8_t _runLevel;
+  uint32_t _runUs;
+  uint8_t _halves;
+  uint8_t _first;
+  uint32_t _frame;
+};
@@ -1,6 +1,6 @@
 #pragma once
 #include <Arduino.h>
-#include "OpenThermProtocolItems.h"
+#include "OpenThermDataIds.h"
 
 /*
   OpenTherm Plus (OT/+) library for ESP32 (Arduino framework)
@@ -125,8 +125,11 @@ public:
   static Frame    parsePayload(uint32_t payload);
 
 
-  // Metadata (subset extracted from OT v2.2 tables; unknown IDs return nullptr)
-  static const OpenThermProtocol::DataIdInfo* dataIdInfo(uint8_t dataId) { return OpenThermProtocol::find(dataId); }
+  // Metadata from the shared Data-ID table (unknown IDs return nullptr)
+  static const OpenThermDataIdMeta* dataIdInfo(uint8_t dataId) {
+    const OpenThermDataIdMeta& m = openthermDataIdMeta(dataId);
+    return m.name ? &m : nullptr;
+  }
 
   // Common field helpers
   static uint8_t hiByte(uint16_t v) { return (uint8_t)((v >> 8) & 0xFF); }
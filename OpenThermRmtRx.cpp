@@ -0,0 +1,117 @@
+#include "OpenThermRmtRx.h"
+
+// Runs shorter than this are dropped by the RMT input filter (hardware limit
+// is ~3.1 us at the 80 MHz source clock); longer glitches are merged by the decoder.
+#define OTRX_FILTER_NS 3000
+// Line idle for this long ends the capture: longer than any valid run (1 ms
+// full bit + tolerance), shorter than the slave's 20 ms inter-frame gap.
+#define OTRX_IDLE_NS 1500000
+
+const rmt_receive_config_t otrxconf = {
+  .signal_range_min_ns = OTRX_FILTER_NS,
+  .signal_range_max_ns = OTRX_IDLE_NS,
+};
+
+IRAM_ATTR bool otrxdone(rmt_channel_handle_t ch, const rmt_rx_done_event_data_t *edata, void *udata) {
+  (void)ch;
+  OpenThermRmtRx* self = (OpenThermRmtRx*)udata;
+  if (!self || !self->rxqueue) return false;
+  BaseType_t h = pdFALSE;
+  xQueueSendFromISR(self->rxqueue, edata, &h);
+  return (h == pdTRUE);
+}
+
+OpenThermRmtRx::~OpenThermRmtRx() {
+  end();
+}
+
+void OpenThermRmtRx::end() {
+  alive = false;
+  armed = false;
+  // order matters: disable -> delete
+  if (rx) {
+    rmt_disable(rx);
+    rmt_del_channel(rx);
+    rx = nullptr;
+  }
+  if (rxqueue) {
+    vQueueDelete(rxqueue);
+    rxqueue = nullptr;
+  }
+}
+
+bool OpenThermRmtRx::begin(int pin, bool activeHigh) {
+  end();
+  this->activeHigh = activeHigh;
+  if (pin < 0) return false;
+
+  const rmt_rx_channel_config_t rxconf = {
+    .gpio_num = static_cast<gpio_num_t>(pin),
+    .clk_src = RMT_CLK_SRC_DEFAULT,
+    .resolution_hz = 1000000, // 1 tick = 1 us
+    .mem_block_symbols = kSymbols
+  };
+  if (rmt_new_rx_channel(&rxconf, &rx) != ESP_OK) {
+    end();
+    return false;
+  }
+
+  rxqueue = xQueueCreate(1, sizeof(rmt_rx_done_event_data_t));
+  if (rxqueue == NULL) {
+    end();
+    return false;
+  }
+
+  rmt_rx_event_callbacks_t rx_callbacks = {
+    .on_recv_done = otrxdone
+  };
+  if (rmt_rx_register_event_callbacks(rx, &rx_callbacks, this) != ESP_OK) {
+    end();
+    return false;
+  }
+
+  if (rmt_enable(rx) != ESP_OK) {
+    end();
+    return false;
+  }
+
+  alive = true;
+  return true;
+}
+
+bool OpenThermRmtRx::arm() {
+  if (!alive) return false;
+  // A capture still running from a timed-out request would deliver a stale
+  // frame; restarting the channel aborts it.
+  if (armed) {
+    rmt_disable(rx);
+    rmt_enable(rx);
+    armed = false;
+  }
+  xQueueReset(rxqueue);
+  if (rmt_receive(rx, rxbuf, sizeof(rxbuf), &otrxconf) != ESP_OK) return false;
+  armed = true;
+  return true;
+}
+
+bool OpenThermRmtRx::poll(uint32_t& outFrame, OtManchesterResult& outResult) {
+  if (!alive || !armed) return false;
+
+  rmt_rx_done_event_data_t evt;
+  if (xQueueReceive(rxqueue, &evt, 0) != pdTRUE) return false;
+  armed = false;
+
+  const uint32_t t0 = micros();
+  OtManchesterDecoder dec(activeHigh);
+  const rmt_symbol_word_t* s = evt.received_symbols;
+  for (size_t i = 0; i < evt.num_symbols; i++) {
+    dec.feed(s[i].level0, s[i].duration0);
+    if (s[i].duration1 == 0) break; // end marker
+    dec.feed(s[i].level1, s[i].duration1);
+  }
+  outFrame = 0;
+  outResult = dec.finish(outFrame);
+  decodeUs = (uint32_t)(micros() - t0);
+  counts[(uint8_t)outResult]++;
+  return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// OpenTherm RX backend on the ESP32-S3 RMT receiver.
+// The RMT peripheral captures the whole response as level/duration symbols
+// (one interrupt per frame instead of one per edge), and poll() decodes the
+// symbol buffer with OtManchesterDecoder. Channel setup follows OneWireESP32.cpp.
+
+#include <Arduino.h>
+
+#include <driver/rmt_rx.h>
+
+#include "OpenThermManchester.h"
+
+class OpenThermRmtRx {
+ public:
+  OpenThermRmtRx() {}
+  ~OpenThermRmtRx();
+
+  // activeHigh: RX pin level of the start bit's first half (true for the
+  // usual adapters, same convention as OpenTherm::handleInterrupt()).
+  bool begin(int pin, bool activeHigh = true);
+  void end();
+  bool ready() const { return alive; }
+
+  // Starts a capture for the next frame and drops any stale result.
+  // Call right after the request has been transmitted.
+  bool arm();
+
+  // Non-blocking. Returns true once a capture completed; outFrame is valid
+  // when outResult == Ok.
+  bool poll(uint32_t& outFrame, OtManchesterResult& outResult);
+
+  // Decode statistics since begin() (indexed by OtManchesterResult).
+  uint32_t count(OtManchesterResult r) const { return counts[(uint8_t)r]; }
+  uint32_t lastDecodeUs() const { return decodeUs; }
+
+  // Used by the RMT ISR callback in OpenThermRmtRx.cpp
+  QueueHandle_t rxqueue = nullptr;
+
+ private:
+  static constexpr size_t kSymbols = 64; // 34 bits need at most 35 symbols
+
+  bool alive = false;
+  bool armed = false;
+  bool activeHigh = true;
+  rmt_channel_handle_t rx = nullptr;
+  rmt_symbol_word_t rxbuf[kSymbols] = {};
+
+  uint32_t counts[(uint8_t)OtManchesterResult::Long + 1] = {0};
+  uint32_t decodeUs = 0;
+};
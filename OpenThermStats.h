@@ -0,0 +1,88 @@
+#pragma once
+
+// Per-Data-ID OpenTherm exchange statistics: outcome counters, last good
+// response and a log-bucketed response-latency histogram in fixed memory.
+// record() is constant time (a few stores, one count-leading-zeros).
+// Arduino-free so the cost can be measured on a host (tools/ot_stats_bench.cpp).
+
+#include <stdint.h>
+
+enum class OtExchangeResult : uint8_t {
+  Ok = 0,   // READ_ACK / WRITE_ACK
+  Timeout,  // no response within 1 s
+  Invalid,  // bad frame, parity or DATA_INVALID
+  Unknown   // UNKNOWN_DATA_ID
+};
+
+// Latency buckets (ms): <32, <64, <128, <256, <512, <1024, <2048, >=2048.
+static constexpr uint8_t kOtLatencyBuckets = 8;
+
+inline uint8_t openthermLatencyBucket(uint32_t ms) {
+  if (ms < 32) return 0;
+  const uint8_t b = (uint8_t)(31 - __builtin_clz(ms) - 4); // floor(log2(ms)) - 4
+  return b < kOtLatencyBuckets - 1 ? b : kOtLatencyBuckets - 1;
+}
+
+inline uint32_t openthermLatencyBucketUpperMs(uint8_t b) {
+  return (b >= kOtLatencyBuckets - 1) ? 0xFFFFFFFFu : (32u << b);
+}
+
+struct OpenThermIdStats {
+  uint32_t ok = 0;
+  uint32_t timeout = 0;
+  uint32_t invalid = 0;
+  uint32_t unknown = 0;
+  uint32_t lastGoodMs = 0;  // millis() of the last Ok (0 = never)
+  uint16_t lastMs = 0;      // latency of the last exchange
+  uint16_t maxMs = 0;       // worst answered latency
+  uint16_t costMs = 0;      // moving average of every exchange incl. timeouts (1/4 weight)
+  uint8_t failStreak = 0;   // consecutive non-Ok exchanges
+  uint16_t hist[kOtLatencyBuckets] = {0}; // answered exchanges only
+
+  // latMs: request start -> response collected.
+  void record(OtExchangeResult r, uint32_t latMs, uint32_t nowMs) {
+    const uint16_t lat = latMs > 0xFFFF ? 0xFFFF : (uint16_t)latMs;
+    lastMs = lat;
+    costMs = (ok | timeout | invalid | unknown) ? (uint16_t)(costMs + ((int32_t)lat - (int32_t)costMs) / 4) : lat;
+    switch (r) {
+      case OtExchangeResult::Ok:
+        ok++;
+        lastGoodMs = nowMs ? nowMs : 1;
+        failStreak = 0;
+        break;
+      case OtExchangeResult::Timeout: timeout++; break;
+      case OtExchangeResult::Invalid: invalid++; break;
+      case OtExchangeResult::Unknown: unknown++; break;
+    }
+    if (r != OtExchangeResult::Ok && failStreak < 0xFF) failStreak++;
+    if (r == OtExchangeResult::Timeout) return;
+
+    if (lat > maxMs) maxMs = lat;
+    uint16_t& h = hist[openthermLatencyBucket(lat)];
+    if (h == 0xFFFF) {
+      // Saturated: halve all buckets, keeping the shape and favouring recent samples.
+      for (uint8_t b = 0; b < kOtLatencyBuckets; b++) hist[b] >>= 1;
+    }
+    h++;
+  }
+
+  uint32_t exchanges() const { return ok + timeout + invalid + unknown; }
+
+  // Upper bound of the bucket holding the percentile (0..100), capped at
+  // maxMs. 0 when no answered exchange was recorded.
+  uint32_t latencyPercentileMs(uint8_t pct) const {
+    uint32_t total = 0;
+    for (uint8_t b = 0; b < kOtLatencyBuckets; b++) total += hist[b];
+    if (!total) return 0;
+    const uint32_t target = (total * pct + 99) / 100;
+    uint32_t acc = 0;
+    for (uint8_t b = 0; b < kOtLatencyBuckets; b++) {
+      acc += hist[b];
+      if (acc >= target) {
+        const uint32_t upper = openthermLatencyBucketUpperMs(b);
+        return upper < maxMs ? upper : maxMs;
+      }
+    }
+    return maxMs;
+  }
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+// OpenTherm frame trace: binary record format shared by the recorder in
+// OpenThermController and the download endpoint (/api/opentherm/trace).
+// Arduino-free so host tools can include it to parse a dump.
+//
+// Dump layout (little-endian, as stored on the ESP32):
+//   OpenThermTraceHeader, then OpenThermTraceRecord[] until end of stream.
+//   Records are consecutive: record i has sequence number firstSeq + i.
+
+#include <stdint.h>
+
+static constexpr uint32_t kOpenThermTraceMagic = 0x5254544FUL; // "OTTR"
+static constexpr uint8_t kOpenThermTraceVersion = 1;
+
+// Who issued the frame.
+enum class OpenThermTraceOrigin : uint8_t {
+  Poll = 1, // poll cycle (reads + control writes)
+  Scan = 2, // Data-ID discovery scan
+  Raw = 3   // manual Data-ID read/write (web "OT Advanced")
+};
+
+struct OpenThermTraceHeader {
+  uint32_t magic = kOpenThermTraceMagic;
+  uint8_t version = kOpenThermTraceVersion;
+  uint8_t recordSize = 16;
+  uint16_t capacity = 0;  // ring size in records
+  uint32_t firstSeq = 0;  // sequence number of the first record in the dump
+  uint32_t dumpUs = 0;    // micros() when the dump started (same clock as tUs)
+};
+
+struct OpenThermTraceRecord {
+  uint32_t tUs = 0;       // micros() when the request was handed to the bus
+  uint32_t request = 0;   // 32-bit master frame
+  uint32_t response = 0;  // 32-bit slave frame (only meaningful for status 1/2)
+  uint16_t durMs = 0;     // request start -> response collected (saturates)
+  uint8_t status = 0;     // OpenThermResponseStatus (0 none, 1 ok, 2 invalid, 3 timeout)
+  uint8_t origin = 0;     // OpenThermTraceOrigin
+};
+
+static_assert(sizeof(OpenThermTraceHeader) == 16, "trace header layout");
+static_assert(sizeof(OpenThermTraceRecord) == 16, "trace record layout");
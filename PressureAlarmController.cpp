@@ -3,6 +3,7 @@
 #include "ConfigStore.h"
 #include "OpenThermController.h"
 #include "BuzzerController.h"
+#include "TaskDomains.h"
 
 namespace {
   PressureAlarmConfig s_cfg;
@@ -54,6 +55,7 @@ namespace {
 }
 
 void pressureAlarmReloadFromStore() {
+  ControlLock lock;
   loadCfg();
 }
 
@@ -63,10 +65,12 @@ void pressureAlarmInit() {
   s_st.enabled = s_cfg.enabled;
   s_st.state = "init";
   s_st.lastChangeMs = millis();
+  // Pressure changes slowly; one CH pressure read per minute is enough.
+  openthermDeclarePollInterest(18, 60000, OpenThermPollPriority::Low);
 }
 
 void pressureAlarmLoop() {
-  OpenThermStatusSnapshot ot = openthermGetStatus();
+  OpenThermTelemetry ot = openthermGetTelemetry();
   const bool sensorValid = ot.present && ot.ready && isfinite(ot.pressureBar) && ot.pressureBar > 0.0f && ot.pressureBar < 10.0f;
   const float p = sensorValid ? ot.pressureBar : NAN;
 
@@ -96,15 +100,18 @@ void pressureAlarmLoop() {
 }
 
 PressureAlarmConfig pressureAlarmGetConfig() {
+  ControlLock lock;
   pressureAlarmReloadFromStore();
   return s_cfg;
 }
 
 PressureAlarmStatus pressureAlarmGetStatus() {
+  ControlLock lock;
   return s_st;
 }
 
 void pressureAlarmFillFastJson(JsonObject& out) {
+  ControlLock lock;
   out["en"] = s_st.enabled;
   out["sv"] = s_st.sensorValid;
   if (isfinite(s_st.pressureBar)) out["p"] = s_st.pressureBar; else out["p"] = nullptr;
@@ -1,8 +1,14 @@
 #include "RelayController.h"
-#include <Wire.h>
+#include <atomic>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include "I2cBus.h"
 #include "config_pins.h"
 #include "RetryPolicy.h"
+#include "TaskDomains.h"
+#include "ValvePulse.h"
 #include "Log.h"
 
 // Minimal driver for TCA9554 output register
@@ -14,6 +20,27 @@ static constexpr uint8_t REG_CFG    = 0x03;
 static bool s_ok = false;
 static uint8_t s_mask = 0x00; // logical ON bits (bit0=R1 ... bit7=R8)
 
+// On the shared bus (I2cBus.h). A register write or read takes ~0.3 ms at
+// 100 kHz; longer means the bus is stuck and goes to recovery.
+static constexpr uint16_t kTcaTimeoutMs = 10;
+static int8_t s_i2cDev = -1;
+
+// The driver's own lock, under ControlLock (TaskDomains.h) for the public
+// calls. The valve stop timer takes only this one and queues its write, so it
+// never waits for a control pass or for the bus.
+static SemaphoreHandle_t s_relayMtx = nullptr;
+
+struct RelayLock {
+  RelayLock() { if (s_relayMtx) xSemaphoreTakeRecursive(s_relayMtx, portMAX_DELAY); }
+  ~RelayLock() { if (s_relayMtx) xSemaphoreGiveRecursive(s_relayMtx); }
+  RelayLock(const RelayLock&) = delete;
+  RelayLock& operator=(const RelayLock&) = delete;
+};
+
+// Completed writes of the output register, for the valve pulse on-time.
+static uint32_t s_outputWrites = 0;
+static uint32_t s_outputWriteUs = 0;
+
 // Safety interlock: configured mixing valve relays must never be ON at the same time.
 // Default remains R1/R2, but Equitherm can remap the pair.
 static uint8_t s_mixInterlockOpenIdx = 0;
@@ -34,6 +61,20 @@ static inline void applyMixingInterlock(uint8_t& logicalMask) {
   }
 }
 
+// ---- Transaction (relayBegin / relayCommit) ----
+static uint8_t s_txDepth = 0;
+static TaskHandle_t s_txOwner = nullptr;
+static uint8_t s_txMask = 0x00;     // staged state of the touched bits
+static uint8_t s_txTouched = 0x00;
+
+static uint8_t stagedMask() {
+  return (uint8_t)((s_mask & (uint8_t)~s_txTouched) | (s_txMask & s_txTouched));
+}
+
+static bool txOwnedHere() {
+  return s_txDepth && s_txOwner == xTaskGetCurrentTaskHandle();
+}
+
 // ---- Non-blocking apply state ----
 static bool     s_applyPending = false;
 static uint8_t  s_pendingMask  = 0x00;
@@ -76,13 +117,16 @@ static void noteI2cErrorThrottled(const char* msg) {
 }
 
 static bool writeRegRaw(uint8_t reg, uint8_t val) {
-  Wire.beginTransmission(TCA9554_ADDR);
-  Wire.write(reg);
-  Wire.write(val);
-  const uint8_t rc = Wire.endTransmission();
-  if (rc != 0) {
+  const uint8_t tx[2] = {reg, val};
+  const I2cResult res = s_i2cDev < 0 ? I2cResult::Offline
+                                     : i2cTransact((uint8_t)s_i2cDev, tx, sizeof(tx), nullptr, 0);
+  if (res == I2cResult::Ok && reg == REG_OUTPUT) {
+    s_outputWriteUs = micros();
+    s_outputWrites++;
+  }
+  if (res != I2cResult::Ok) {
     char buf[64];
-    snprintf(buf, sizeof(buf), "write reg 0x%02X rc=%u", reg, (unsigned)rc);
+    snprintf(buf, sizeof(buf), "write reg 0x%02X %s", reg, i2cResultName(res));
     noteI2cErrorThrottled(buf);
     return false;
   }
@@ -90,22 +134,14 @@ static bool writeRegRaw(uint8_t reg, uint8_t val) {
 }
 
 static bool readRegRaw(uint8_t reg, uint8_t &out) {
-  Wire.beginTransmission(TCA9554_ADDR);
-  Wire.write(reg);
-  if (Wire.endTransmission(false) != 0) {
+  const I2cResult res = s_i2cDev < 0 ? I2cResult::Offline
+                                     : i2cTransact((uint8_t)s_i2cDev, &reg, 1, &out, 1);
+  if (res != I2cResult::Ok) {
     char buf[64];
-    snprintf(buf, sizeof(buf), "read reg 0x%02X addrNACK", reg);
+    snprintf(buf, sizeof(buf), "read reg 0x%02X %s", reg, i2cResultName(res));
     noteI2cErrorThrottled(buf);
     return false;
   }
-  const uint8_t n = Wire.requestFrom((int)TCA9554_ADDR, 1);
-  if (n != 1) {
-    char buf[64];
-    snprintf(buf, sizeof(buf), "read reg 0x%02X req=%u", reg, (unsigned)n);
-    noteI2cErrorThrottled(buf);
-    return false;
-  }
-  out = Wire.read();
   return true;
 }
 
@@ -188,6 +224,7 @@ static bool applyMaskImmediate(uint8_t logicalMask) {
 
 static bool initTca() {
   i2cInit();
+  if (s_i2cDev < 0) s_i2cDev = i2cAddDevice(TCA9554_ADDR, kTcaTimeoutMs);
 
   // polarity normal
   if (!writeRegRaw(REG_POL, 0x00)) return false;
@@ -207,7 +244,209 @@ static bool initTca() {
   return true;
 }
 
+// ---- Health check ----
+// The output register read is queued from relayUpdate() and completes on the
+// i2c task; the next relayUpdate() compares it. A read overtaken by an output
+// write (the valve stop timer) is not judged.
+static constexpr uint8_t kHealthIdle = 0, kHealthQueued = 1, kHealthDone = 2;
+static std::atomic<uint8_t> s_healthState{kHealthIdle};
+static I2cResult s_healthRes = I2cResult::Ok;
+static uint8_t s_healthRb = 0;
+static uint8_t s_healthExpect = 0;
+static uint32_t s_healthWrites = 0;
+
+static void healthReadDone(void*, I2cResult res, const uint8_t* rx, uint8_t rxLen) {
+  s_healthRes = res;
+  s_healthRb = rxLen ? rx[0] : 0;
+  s_healthState.store(kHealthDone, std::memory_order_release);
+}
+
+static void queueHealthRead() {
+  if (s_i2cDev < 0 || s_healthState.load(std::memory_order_acquire) != kHealthIdle) return;
+  I2cTxn t;
+  t.dev = (uint8_t)s_i2cDev;
+  t.tx[0] = REG_OUTPUT;
+  t.txLen = 1;
+  t.rxLen = 1;
+  t.done = healthReadDone;
+  s_healthExpect = toHw(s_mask);
+  s_healthWrites = s_outputWrites;
+  s_healthState.store(kHealthQueued, std::memory_order_release);
+  if (!i2cSubmit(t)) s_healthState.store(kHealthIdle, std::memory_order_relaxed);
+}
+
+static void checkHealthRead() {
+  if (s_healthState.load(std::memory_order_acquire) != kHealthDone) return;
+  s_healthState.store(kHealthIdle, std::memory_order_relaxed);
+  if (!s_ok || s_outputWrites != s_healthWrites || toHw(s_mask) != s_healthExpect) return;
+  if (s_healthRes != I2cResult::Ok || s_healthRb != s_healthExpect) {
+    noteI2cErrorThrottled(s_healthRes != I2cResult::Ok ? "health-check read failed" : "health-check desync");
+    s_ok = false;
+  }
+}
+
+// ---- Timed mixing-valve pulse ----
+static ValvePulse s_valvePulse;
+static uint8_t s_valvePulseBit = 0;
+static bool s_valvePulseTimed = false;
+static bool s_valveOffOk = true;
+static uint8_t s_valveOffMask = 0;
+static esp_timer_handle_t s_mixStopTimer = nullptr;
+
+// The stop timer's OFF write, queued ahead of the bus queue: the register
+// write and its read-back in one transaction (the TCA9554 keeps the command
+// byte). The completion on the i2c task only records the write time and the
+// result; the next call under RelayLock ends the pulse with them.
+static constexpr uint8_t kStopIdle = 0, kStopQueued = 1, kStopDone = 2;
+static std::atomic<uint8_t> s_stopState{kStopIdle};
+static uint32_t s_stopSeq = 0;
+static uint8_t s_stopHw = 0;
+static uint8_t s_stopMask = 0;
+static uint32_t s_stopOffUs = 0;
+static bool s_stopOk = false;
+
+static void valveOffDone(void*, I2cResult res, const uint8_t* rx, uint8_t rxLen) {
+  s_stopOffUs = micros();
+  s_stopOk = res == I2cResult::Ok && rxLen && rx[0] == s_stopHw;
+  s_stopState.store(kStopDone, std::memory_order_release);
+}
+
+// Under RelayLock. A pulse ended or replaced meanwhile keeps its own end; a
+// failed write is retried (and the expander re-initialised) by relayUpdate().
+static void collectValveStop() {
+  if (s_stopState.load(std::memory_order_acquire) != kStopDone) return;
+  s_stopState.store(kStopIdle, std::memory_order_relaxed);
+  if (!s_stopOk) {
+    noteI2cErrorThrottled("valve stop write failed");
+    scheduleApply(s_mask);
+  }
+  if (s_valvePulse.seq() != s_stopSeq || !s_valvePulse.expire(s_stopOffUs)) return;
+  s_valveOffOk = s_stopOk;
+  s_valveOffMask = s_stopMask;
+}
+
+static bool mixingPairBits(uint8_t& openBit, uint8_t& closeBit) {
+  if (s_mixInterlockOpenIdx >= RELAY_COUNT || s_mixInterlockCloseIdx >= RELAY_COUNT) return false;
+  if (s_mixInterlockOpenIdx == s_mixInterlockCloseIdx) return false;
+  openBit = (uint8_t)(1U << s_mixInterlockOpenIdx);
+  closeBit = (uint8_t)(1U << s_mixInterlockCloseIdx);
+  return true;
+}
+
+// Time of the last output register write if there was one since writesBefore.
+static uint32_t outputWriteUsSince(uint32_t writesBefore) {
+  return s_outputWrites != writesBefore ? s_outputWriteUs : micros();
+}
+
+static void endValvePulse(uint32_t writesBefore, bool offOk) {
+  // A stop write queued before this caller's write has completed by now.
+  collectValveStop();
+  if (!s_valvePulse.active()) return;
+  if (s_mixStopTimer) esp_timer_stop(s_mixStopTimer);
+  s_valvePulse.end(outputWriteUsSince(writesBefore));
+  s_valveOffOk = offOk;
+  s_valveOffMask = s_mask;
+}
+
+// Ends the running pulse once its relay is no longer requested ON.
+static void endValvePulseIfDropped(uint32_t writesBefore) {
+  if (!s_valvePulse.active() || (s_mask & s_valvePulseBit)) return;
+  endValvePulse(writesBefore, !s_applyPending);
+}
+
+static bool applyMixingDirection(int8_t direction, uint8_t* appliedMask) {
+  if (direction < -1 || direction > 1) return false;
+  uint8_t openBit = 0, closeBit = 0;
+  if (!mixingPairBits(openBit, closeBit)) return false;
+  const uint8_t pairBits = (uint8_t)(openBit | closeBit);
+
+  // Inside the caller's transaction the verified pair write carries the staged
+  // bits. Not for the stop timer, which would write someone's half decision.
+  if (txOwnedHere()) {
+    s_mask = stagedMask();
+    s_txTouched = 0;
+  }
+
+  uint8_t targetMask = (uint8_t)(s_mask & (uint8_t)~pairBits);
+  if (direction > 0) targetMask |= openBit;
+  else if (direction < 0) targetMask |= closeBit;
+
+  // Update the desired logical state first so diagnostics and retry handling use
+  // the same target. The immediate write below verifies the actual expander state.
+  s_mask = targetMask;
+  const bool ok = applyMaskImmediate(targetMask);
+  if (ok) {
+    if (appliedMask) *appliedMask = s_mask;
+    return true;
+  }
+
+  // Fail safe: a failed ON command must not be applied later by the retry queue
+  // after the controller has already rejected the pulse. Keep both valve relays OFF.
+  const uint8_t safeMask = (uint8_t)(s_mask & (uint8_t)~pairBits);
+  s_mask = safeMask;
+  (void)applyMaskImmediate(safeMask);
+  if (appliedMask) *appliedMask = s_mask;
+  return false;
+}
+
+// esp_timer task. A fire for a pulse that was ended or replaced meanwhile finds
+// nothing due; the replacement has armed the timer again. The OFF write is
+// queued, never waited for here: no I2C transaction and no expander re-init
+// on this task.
+static void mixStopTimerCb(void*) {
+  RelayLock relayLock;
+  collectValveStop();
+  const uint32_t now = micros();
+  if (!s_valvePulse.due(now)) {
+    const uint32_t left = s_valvePulse.remainingUs(now);
+    if (left) esp_timer_start_once(s_mixStopTimer, left);
+    return;
+  }
+  uint8_t openBit = 0, closeBit = 0;
+  if (!mixingPairBits(openBit, closeBit)) return;
+  s_mask = (uint8_t)(s_mask & (uint8_t)~(openBit | closeBit));
+  if (s_applyPending) s_pendingMask = s_mask;
+
+  I2cTxn t;
+  t.tx[0] = REG_OUTPUT;
+  t.tx[1] = toHw(s_mask);
+  t.txLen = 2;
+  t.rxLen = 1;
+  t.done = valveOffDone;
+  const bool queued = s_ok && s_i2cDev >= 0 && s_stopState.load(std::memory_order_acquire) == kStopIdle;
+  if (queued) {
+    t.dev = (uint8_t)s_i2cDev;
+    s_stopSeq = s_valvePulse.seq();
+    s_stopHw = t.tx[1];
+    s_stopMask = s_mask;
+    s_stopState.store(kStopQueued, std::memory_order_release);
+  }
+  if (queued && i2cSubmit(t, true)) {
+    // The completion may already have run (no i2c task on a host build).
+    collectValveStop();
+    return;
+  }
+  if (queued) s_stopState.store(kStopIdle, std::memory_order_relaxed);
+  // Expander offline or queue full: relayUpdate() writes the mask.
+  scheduleApply(s_mask);
+  s_valvePulse.expire(now);
+  s_valveOffOk = false;
+  s_valveOffMask = s_mask;
+}
+
 void relayInit() {
+  if (!s_relayMtx) s_relayMtx = xSemaphoreCreateRecursiveMutex();
+  if (!s_mixStopTimer) {
+    esp_timer_create_args_t args = {};
+    args.callback = mixStopTimerCb;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "mixstop";
+    if (esp_timer_create(&args, &s_mixStopTimer) != ESP_OK) {
+      s_mixStopTimer = nullptr;
+      LOGW("RELAY mixing stop timer unavailable, valve pulses end from the control loop");
+    }
+  }
+  RelayLock relayLock;
   s_mask = 0x00;        // default OFF
   scheduleApply(s_mask);
   s_ok = initTca();
@@ -219,20 +458,19 @@ void relayInit() {
 }
 
 void relayUpdate() {
+  RelayLock relayLock;
   const uint32_t now = millis();
+  collectValveStop();
 
   // Apply pending mask if needed (non-blocking)
   processPending(now);
 
   // Periodic health-check (detect expander reset / desync)
   static uint32_t lastCheckMs = 0;
-  if (s_ok && (uint32_t)(now - lastCheckMs) >= 2000) {
+  checkHealthRead();
+  if (s_ok && !s_applyPending && (uint32_t)(now - lastCheckMs) >= 2000) {
     lastCheckMs = now;
-    uint8_t rb = 0;
-    if (!readRegRaw(REG_OUTPUT, rb) || (rb != toHw(s_mask))) {
-      noteI2cErrorThrottled("health-check desync");
-      s_ok = false;
-    }
+    queueHealthRead();
   }
 
   // Auto-recovery if expander is not OK
@@ -255,9 +493,19 @@ void relayUpdate() {
 }
 
 void relaySet(RelayId id, bool on) {
+  ControlLock lock;
+  RelayLock relayLock;
   if ((uint8_t)id >= RELAY_COUNT) return;
+  const uint32_t writes = s_outputWrites;
 
   const uint8_t bit = (uint8_t)(1U << (uint8_t)id);
+  if (s_txDepth) {
+    s_txTouched |= bit;
+    if (on) s_txMask |= bit;
+    else    s_txMask &= (uint8_t)~bit;
+    return;
+  }
+
   if (on) s_mask |= bit;
   else    s_mask &= (uint8_t)~bit;
 
@@ -265,26 +513,34 @@ void relaySet(RelayId id, bool on) {
 
   scheduleApply(s_mask);
   processPending(millis());
+  endValvePulseIfDropped(writes);
 }
 
 void relayToggle(RelayId id) {
+  ControlLock lock;
+  RelayLock relayLock;
   relaySet(id, !relayGetState(id));
 }
 
 bool relayGetState(RelayId id) {
   if ((uint8_t)id >= RELAY_COUNT) return false;
-  return (s_mask & (1U << (uint8_t)id)) != 0;
+  return (relayGetMask() & (1U << (uint8_t)id)) != 0;
 }
 
 void relayAllOff() {
+  ControlLock lock;
   relaySetMask(0x00);
 }
 
 void relayAllOn() {
+  ControlLock lock;
   relaySetMask(0xFF);
 }
 
 void relaySetMixingInterlockRelays(uint8_t openRelayIndex, uint8_t closeRelayIndex) {
+  ControlLock lock;
+  RelayLock relayLock;
+  const uint32_t writes = s_outputWrites;
   if (openRelayIndex >= RELAY_COUNT) openRelayIndex = 0;
   if (closeRelayIndex >= RELAY_COUNT) closeRelayIndex = 1;
   if (openRelayIndex == closeRelayIndex) closeRelayIndex = (openRelayIndex == 0 ? 1 : 0);
@@ -295,48 +551,99 @@ void relaySetMixingInterlockRelays(uint8_t openRelayIndex, uint8_t closeRelayInd
   applyMixingInterlock(s_mask);
   scheduleApply(s_mask);
   processPending(millis());
+  endValvePulseIfDropped(writes);
 }
 
 bool relaySetMixingDirection(int8_t direction, uint8_t* appliedMask) {
-  if (direction < -1 || direction > 1) return false;
-  if (s_mixInterlockOpenIdx >= RELAY_COUNT || s_mixInterlockCloseIdx >= RELAY_COUNT) return false;
-  if (s_mixInterlockOpenIdx == s_mixInterlockCloseIdx) return false;
-
-  const uint8_t openBit = (uint8_t)(1U << s_mixInterlockOpenIdx);
-  const uint8_t closeBit = (uint8_t)(1U << s_mixInterlockCloseIdx);
-  const uint8_t pairBits = (uint8_t)(openBit | closeBit);
-
-  uint8_t targetMask = (uint8_t)(s_mask & (uint8_t)~pairBits);
-  if (direction > 0) targetMask |= openBit;
-  else if (direction < 0) targetMask |= closeBit;
+  ControlLock lock;
+  RelayLock relayLock;
+  const uint32_t writes = s_outputWrites;
+  const bool ok = applyMixingDirection(direction, appliedMask);
+  endValvePulse(writes, ok);
+  return ok;
+}
 
-  // Update the desired logical state first so diagnostics and retry handling use
-  // the same target. The immediate write below verifies the actual expander state.
-  s_mask = targetMask;
-  const bool ok = applyMaskImmediate(targetMask);
-  if (ok) {
-    if (appliedMask) *appliedMask = s_mask;
-    return true;
+bool relayStartMixingPulse(int8_t direction, uint32_t durationMs, uint8_t* appliedMask) {
+  ControlLock lock;
+  RelayLock relayLock;
+  if (direction != 1 && direction != -1) return false;
+  uint8_t openBit = 0, closeBit = 0;
+  if (!mixingPairBits(openBit, closeBit)) return false;
+  if (durationMs > 1800000u) durationMs = 1800000u;
+
+  const uint32_t writes = s_outputWrites;
+  if (!relaySetMixingDirection(direction, appliedMask)) return false;
+  s_valvePulse.start(direction, outputWriteUsSince(writes), durationMs * 1000u);
+  s_valvePulseBit = direction > 0 ? openBit : closeBit;
+  s_valvePulseTimed = false;
+  if (s_mixStopTimer) {
+    esp_timer_stop(s_mixStopTimer);
+    const uint32_t left = s_valvePulse.remainingUs(micros());
+    s_valvePulseTimed = esp_timer_start_once(s_mixStopTimer, left ? left : 1) == ESP_OK;
   }
+  return true;
+}
 
-  // Fail safe: a failed ON command must not be applied later by the retry queue
-  // after the controller has already rejected the pulse. Keep both valve relays OFF.
-  const uint8_t safeMask = (uint8_t)(s_mask & (uint8_t)~pairBits);
-  s_mask = safeMask;
-  (void)applyMaskImmediate(safeMask);
-  if (appliedMask) *appliedMask = s_mask;
-  return false;
+RelayMixingPulse relayGetMixingPulse() {
+  RelayLock relayLock;
+  collectValveStop();
+  RelayMixingPulse p;
+  p.seq = s_valvePulse.seq();
+  p.active = s_valvePulse.active();
+  p.timed = s_valvePulseTimed;
+  p.requestedUs = s_valvePulse.durationUs();
+  p.onTimeUs = s_valvePulse.onTimeUs();
+  p.endLateUs = s_valvePulse.endLateUs();
+  p.endedByTimer = s_valvePulse.endedByTimer();
+  p.offOk = s_valveOffOk;
+  p.mask = s_valveOffMask;
+  return p;
 }
 
 uint8_t relayGetMask() {
-  return s_mask;
+  return txOwnedHere() ? stagedMask() : s_mask;
 }
 
 void relaySetMask(uint8_t mask) {
+  ControlLock lock;
+  RelayLock relayLock;
+  if (s_txDepth) {
+    s_txTouched = 0xFF;
+    s_txMask = mask;
+    return;
+  }
+  const uint32_t writes = s_outputWrites;
   s_mask = mask;
   applyMixingInterlock(s_mask);
   scheduleApply(s_mask);
   processPending(millis());
+  endValvePulseIfDropped(writes);
+}
+
+void relayBegin() {
+  ControlLock lock;
+  RelayLock relayLock;
+  if (s_txDepth++ == 0) {
+    s_txOwner = xTaskGetCurrentTaskHandle();
+    s_txTouched = 0;
+  }
+}
+
+void relayCommit() {
+  ControlLock lock;
+  RelayLock relayLock;
+  if (!s_txDepth || --s_txDepth) return;
+  uint8_t merged = stagedMask();
+  s_txTouched = 0;
+  s_txOwner = nullptr;
+  applyMixingInterlock(merged);
+  if (merged == s_mask) return;  // no change, no bus traffic
+
+  const uint32_t writes = s_outputWrites;
+  s_mask = merged;
+  scheduleApply(s_mask);
+  processPending(millis());
+  endValvePulseIfDropped(writes);
 }
 
 // !!! Print& (ne Stream&) – aby sedělo na LogicController/.ino
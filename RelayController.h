@@ -2,6 +2,8 @@
 
 #include <Arduino.h>
 
+#include "TaskDomains.h"
+
 static constexpr uint8_t RELAY_COUNT = 8;
 
 enum class RelayId : uint8_t {
@@ -29,14 +31,62 @@ void relaySetMask(uint8_t mask);
 void relayAllOff();
 void relayAllOn();
 
+// Transaction: relaySet() / relaySetMask() calls between relayBegin() and the
+// outermost relayCommit() only stage their bits; the commit merges them into
+// the current mask, applies the mixing interlock to the merged mask and
+// writes the output register once with one verify read (nothing when the mask
+// did not change). A mixing-pair write inside the transaction carries the
+// staged bits with it. Within the transaction relayGetState()/relayGetMask()
+// report the staged state to the task that opened it. Hold ControlLock from
+// begin to commit; RelayTransaction does.
+void relayBegin();
+void relayCommit();
+
+struct RelayTransaction {
+  RelayTransaction() { relayBegin(); }
+  ~RelayTransaction() { relayCommit(); }
+  RelayTransaction(const RelayTransaction&) = delete;
+  RelayTransaction& operator=(const RelayTransaction&) = delete;
+
+private:
+  ControlLock _lock;
+};
+
 // Configurable safety interlock for mixing valve outputs.
 // Indices are 0..7 (= R1..R8). Passing 0,1 keeps the legacy default R1/R2.
 void relaySetMixingInterlockRelays(uint8_t openRelayIndex, uint8_t closeRelayIndex);
 // Atomically apply and verify the complete mixing-valve relay pair.
 // direction: +1 = R1/toward port A (hotter), -1 = R2/toward port B (cooler), 0 = both OFF.
 // Returns true only when the TCA9554 output register read-back matches.
+// A running timed pulse (below) ends at this write.
 bool relaySetMixingDirection(int8_t direction, uint8_t* appliedMask = nullptr);
 
+// Mixing-valve pulse ended by a one-shot esp_timer: the pair is switched to
+// direction now and back OFF after durationMs by the esp_timer task, which
+// holds only the relay driver's own lock and queues the OFF write (with its
+// read-back) at the head of the I2C queue, so the stop never waits for a
+// control pass, the loop or the bus. The pulse ends when that write completes;
+// a failed one is retried by relayUpdate(). Returns false when the ON write
+// fails (pair left OFF). Any command switching the pulse relay off ends it
+// early.
+// Without the timer (creation failed) the caller's relaySetMixingDirection(0)
+// ends it.
+bool relayStartMixingPulse(int8_t direction, uint32_t durationMs, uint8_t* appliedMask = nullptr);
+
+struct RelayMixingPulse {
+  uint32_t seq = 0;          // running or last pulse, 0 = none yet
+  bool active = false;
+  bool timed = false;        // the stop timer is available
+  uint32_t requestedUs = 0;
+  // Last ended pulse, measured from the ON write to the OFF write (ValvePulse.h).
+  uint32_t onTimeUs = 0;
+  uint32_t endLateUs = 0;
+  bool endedByTimer = false;
+  bool offOk = true;         // its OFF write was verified
+  uint8_t mask = 0;          // logical mask after it
+};
+RelayMixingPulse relayGetMixingPulse();
+
 // !!! DŮLEŽITÉ: Print& (ne Stream&) – kvůli LogicController / .ino
 void relayPrintStates(Print& out);
 
@@ -2,7 +2,8 @@
 
 #include <Arduino.h>
 
-// Exponential backoff helper used by RelayController.
+// Exponential backoff helper used by RelayController and the OpenTherm poll
+// scheduler (UNKNOWN-DATA-ID backoff).
 //
 // NOTE:
 // Arduino-ESP32 defines a macro named _max(a,b), therefore member names
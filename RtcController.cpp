@@ -2,10 +2,11 @@
 #include "config_pins.h"
 #include "I2cBus.h"
 
-#include <Wire.h>
 #include <time.h>
 
-static constexpr uint8_t RTC_ADDR = 0x51;
+static constexpr uint8_t RTC_ADDR = PCF85063_ADDR;
+// The 7-byte time read takes ~1 ms at 100 kHz.
+static constexpr uint16_t RTC_TIMEOUT_MS = 20;
 
 // PCF85063 registers
 static constexpr uint8_t REG_CTRL1  = 0x00;
@@ -21,32 +22,30 @@ static constexpr uint8_t REG_MONTH  = 0x09;
 static constexpr uint8_t REG_YEAR   = 0x0A; // 0..99
 
 static bool s_present = false;
+static int8_t s_dev = -1;
 
 static uint8_t bcd2bin(uint8_t v) { return (uint8_t)((v & 0x0F) + 10 * ((v >> 4) & 0x0F)); }
 static uint8_t bin2bcd(uint8_t v) { return (uint8_t)(((v / 10) << 4) | (v % 10)); }
 
 static bool i2cRead(uint8_t reg, uint8_t* buf, size_t len) {
-  Wire.beginTransmission(RTC_ADDR);
-  Wire.write(reg);
-  if (Wire.endTransmission(false) != 0) return false;
-  if (Wire.requestFrom((int)RTC_ADDR, (int)len) != (int)len) return false;
-  for (size_t i=0;i<len;i++) buf[i] = (uint8_t)Wire.read();
-  return true;
+  if (s_dev < 0 || len > kI2cMaxRx) return false;
+  return i2cTransact((uint8_t)s_dev, &reg, 1, buf, (uint8_t)len) == I2cResult::Ok;
 }
 
 static bool i2cWrite(uint8_t reg, const uint8_t* buf, size_t len) {
-  Wire.beginTransmission(RTC_ADDR);
-  Wire.write(reg);
-  for (size_t i=0;i<len;i++) Wire.write(buf[i]);
-  return (Wire.endTransmission() == 0);
+  if (s_dev < 0 || len + 1 > kI2cMaxTx) return false;
+  uint8_t tx[kI2cMaxTx];
+  tx[0] = reg;
+  memcpy(tx + 1, buf, len);
+  return i2cTransact((uint8_t)s_dev, tx, (uint8_t)(len + 1)) == I2cResult::Ok;
 }
 
 void rtcInit() {
-  // I2C init je centralizovaný (jeden begin + nastavení frekvence).
+  // I2C je sdílená fronta (I2cBus.h): RTC je jen další zařízení na ní.
   i2cInit();
+  if (s_dev < 0) s_dev = i2cAddDevice(RTC_ADDR, RTC_TIMEOUT_MS);
 
-  Wire.beginTransmission(RTC_ADDR);
-  s_present = (Wire.endTransmission() == 0);
+  s_present = s_dev >= 0 && i2cProbe(RTC_ADDR) == I2cResult::Ok;
 
   if (s_present) {
     Serial.println(F("[RTC] Detected at 0x51"));
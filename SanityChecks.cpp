@@ -1,5 +1,6 @@
 #include "SanityChecks.h"
 #include "config_pins.h"
+#include "I2cBus.h"
 
 namespace {
   template <size_t N>
@@ -56,5 +57,16 @@ namespace SanityChecks {
     Serial.print(RGB_LED_PIN);
     Serial.print(F(" BUZZ="));
     Serial.println(BUZZER_PIN);
+
+    // Devices on the shared I2C bus; only once it has been started.
+    if (i2cIsReady()) {
+      const I2cResult tca = i2cProbe(TCA9554_ADDR);
+      const I2cResult rtc = i2cProbe(PCF85063_ADDR);
+      if (tca != I2cResult::Ok) warn(F("TCA9554 relay expander does not answer on I2C."));
+      const I2cBusStats bus = i2cGetStats();
+      Serial.printf("[SANITY] I2C: TCA9554 0x%02X %s, RTC 0x%02X %s, bus %s, recoveries %u\n",
+                    (unsigned)TCA9554_ADDR, i2cResultName(tca), (unsigned)PCF85063_ADDR, i2cResultName(rtc),
+                    bus.online ? "online" : "offline", (unsigned)bus.recoveries);
+    }
   }
 }
@@ -3,7 +3,8 @@
 #include <Arduino.h>
 
 namespace SanityChecks {
-  // Runs quick non-blocking checks and prints warnings to Serial.
-  // Safe to call even if some subsystems are disabled.
+  // Runs quick non-blocking checks and prints warnings to Serial (the I2C
+  // probes wait at most their timeout each). Safe to call even if some
+  // subsystems are disabled.
   void runOnce();
 }
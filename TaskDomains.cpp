@@ -0,0 +1,99 @@
+#include "TaskDomains.h"
+
+#include <freertos/task.h>
+
+namespace {
+  struct DomainDef {
+    const char* name;
+    UBaseType_t priority;
+    uint32_t stack;
+  };
+
+  // Net is the Arduino loop task (priority 1, 8 KB stack) and is not created here.
+  constexpr DomainDef kDomains[(uint8_t)TaskDomain::COUNT] = {
+    {"ctl", 4, 8192},
+    {"io", 2, 8192},
+    {"net", 1, 0},
+  };
+  constexpr BaseType_t kDomainCore = 1;
+
+  SemaphoreHandle_t s_mtx[(uint8_t)TaskDomain::COUNT] = {};
+
+  struct DomainTask {
+    TaskDomain domain;
+    LoopScheduler* sched = nullptr;
+    volatile TaskHandle_t handle = nullptr;
+  };
+  DomainTask s_tasks[(uint8_t)TaskDomain::COUNT] = {
+    {TaskDomain::Control}, {TaskDomain::Io}, {TaskDomain::Net},
+  };
+
+  SemaphoreHandle_t domainMutex(TaskDomain domain) {
+    return domain < TaskDomain::COUNT ? s_mtx[(uint8_t)domain] : nullptr;
+  }
+
+  void domainTaskMain(void* arg) {
+    DomainTask& t = *(DomainTask*)arg;
+    for (;;) {
+      const uint32_t idleUs = taskDomainRunPass(t.domain, *t.sched);
+      // At least until the next tick, also when a task is due again at once,
+      // so the lower priorities always get the CPU.
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(idleUs / 1000u) + 1);
+    }
+  }
+}
+
+TaskDomainLock::TaskDomainLock(TaskDomain domain) : _mtx(domainMutex(domain)) {
+  if (_mtx) xSemaphoreTakeRecursive(_mtx, portMAX_DELAY);
+}
+
+TaskDomainLock::~TaskDomainLock() {
+  if (_mtx) xSemaphoreGiveRecursive(_mtx);
+}
+
+void taskDomainsBegin() {
+  if (s_mtx[0]) return;
+  for (SemaphoreHandle_t& m : s_mtx) m = xSemaphoreCreateRecursiveMutex();
+  // Until a domain gets its own task, loop() runs it.
+  const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  for (DomainTask& t : s_tasks) t.handle = self;
+}
+
+bool taskDomainStart(TaskDomain domain, LoopScheduler& sched) {
+  if (domain >= TaskDomain::Net || !s_mtx[0]) return false;
+  DomainTask& t = s_tasks[(uint8_t)domain];
+  if (t.sched) return true;
+  const DomainDef& def = kDomains[(uint8_t)domain];
+  t.sched = &sched;
+  TaskHandle_t h = nullptr;
+  if (xTaskCreatePinnedToCore(domainTaskMain, def.name, def.stack, &t, def.priority, &h, kDomainCore) != pdPASS) {
+    t.sched = nullptr;
+    Serial.printf("[TASK] %s task create failed, staying in loop()\n", def.name);
+    return false;
+  }
+  t.handle = h;
+  Serial.printf("[TASK] %s running (prio %u, core %d)\n", def.name, (unsigned)def.priority, (int)kDomainCore);
+  return true;
+}
+
+bool taskDomainRunning(TaskDomain domain) {
+  return domain < TaskDomain::COUNT && s_tasks[(uint8_t)domain].sched != nullptr;
+}
+
+bool taskDomainIsCurrent(TaskDomain domain) {
+  return domain < TaskDomain::COUNT && s_tasks[(uint8_t)domain].handle == xTaskGetCurrentTaskHandle();
+}
+
+uint32_t taskDomainRunPass(TaskDomain domain, LoopScheduler& sched) {
+  TaskDomainLock lock(domain);
+  return sched.runDue();
+}
+
+void IRAM_ATTR taskDomainNotifyFromIsr(TaskDomain domain) {
+  if (domain >= TaskDomain::COUNT) return;
+  const TaskHandle_t h = s_tasks[(uint8_t)domain].handle;
+  if (!h) return;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(h, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
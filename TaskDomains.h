@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "LoopScheduler.h"
+
+// The main loop split into prioritised FreeRTOS tasks, one LoopScheduler per
+// domain, all on core 1 (WiFi / lwIP and the OpenTherm task run on core 0):
+//   Control  inputs, relays, buzzer, pressure alarm, DHW, equitherm;
+//            priority 4, so a mixing valve pulse ends on time whatever the
+//            other domains are doing.
+//   Io       Dallas, OpenTherm (loop mode), BLE, temperatures, history,
+//            energy; priority 2.
+//   Net      console, network, web portal, OTA, MQTT; stays in the Arduino
+//            loop task (priority 1).
+//
+// A pass runs under its domain lock (ControlLock, IoLock, NetLock). The
+// public API of the control and I/O modules takes that module's lock itself,
+// so handlers on the other tasks can call it; what the network domain reads
+// on every push (BLE, boiler energy) and what the control task needs
+// (temperatures, OpenTherm telemetry) are published snapshots read without
+// locking. OpenTherm requests go through the mailbox (OpenThermController.cpp).
+// Net therefore never holds up the I/O task, also while OTA takes over the
+// loop or a raw Data-ID read waits for the boiler.
+//
+// Lock order: NetLock -> IoLock -> ControlLock -> OpenTherm module lock. The
+// control task never takes IoLock, the I/O task never takes NetLock. Locks
+// are recursive and no-ops until taskDomainsBegin().
+
+enum class TaskDomain : uint8_t { Control = 0, Io, Net, COUNT };
+
+class TaskDomainLock {
+public:
+  explicit TaskDomainLock(TaskDomain domain);
+  ~TaskDomainLock();
+  TaskDomainLock(const TaskDomainLock&) = delete;
+  TaskDomainLock& operator=(const TaskDomainLock&) = delete;
+
+private:
+  SemaphoreHandle_t _mtx;
+};
+
+struct ControlLock : TaskDomainLock {
+  ControlLock() : TaskDomainLock(TaskDomain::Control) {}
+};
+
+struct IoLock : TaskDomainLock {
+  IoLock() : TaskDomainLock(TaskDomain::Io) {}
+};
+
+struct NetLock : TaskDomainLock {
+  NetLock() : TaskDomainLock(TaskDomain::Net) {}
+};
+
+// Creates the locks; called once from setup(), whose task becomes the Net
+// domain.
+void taskDomainsBegin();
+
+// Moves a domain's scheduler to its own task. Returns false when the task
+// cannot be created; the caller then keeps running the scheduler from loop().
+bool taskDomainStart(TaskDomain domain, LoopScheduler& sched);
+bool taskDomainRunning(TaskDomain domain);
+bool taskDomainIsCurrent(TaskDomain domain);
+
+// One pass of sched under the domain's lock; returns runDue()'s idle time.
+uint32_t taskDomainRunPass(TaskDomain domain, LoopScheduler& sched);
+
+// Ends the idle wait of whichever task runs the domain. ISR only.
+void taskDomainNotifyFromIsr(TaskDomain domain);
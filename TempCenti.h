@@ -0,0 +1,67 @@
+#pragma once
+
+// Fixed-point temperature: int16 hundredths of a degree (-327.67..327.67 C)
+// with INT16_MIN as the explicit "no value" sentinel, so a reading fits in
+// two bytes and needs no separate valid flag or isfinite() check.
+// Arduino-free; the formatter is benchmarked against ArduinoJson's float
+// output in tools/temp_fmt_bench.cpp.
+//
+// Text form is the shortest decimal of the value: 45.06, 45.5, 45, -0.05.
+// A 12-bit DS18B20 step (1/16 C) and the OpenTherm f8.8 step (1/256 C) both
+// lie below the 0.01 C resolution, so nothing the UI shows is lost.
+
+#include <math.h>
+#include <stdint.h>
+
+typedef int16_t TempCenti;
+
+constexpr TempCenti kTempCentiInvalid = INT16_MIN;
+constexpr uint8_t kTempCentiTextMax = 8;  // "-327.67" + NUL
+
+inline bool tempCentiValid(TempCenti v) { return v != kTempCentiInvalid; }
+
+// Rounds to the nearest hundredth (half away from zero) and saturates;
+// NAN / inf become the sentinel.
+inline TempCenti tempCentiFromC(float c) {
+  if (!isfinite(c)) return kTempCentiInvalid;
+  const float x = c * 100.0f;
+  if (x >= 32767.0f) return 32767;
+  if (x <= -32767.0f) return -32767;
+  return (TempCenti)(int32_t)(x + (x >= 0.0f ? 0.5f : -0.5f));
+}
+
+inline float tempCentiToC(TempCenti v) {
+  return tempCentiValid(v) ? (float)v * 0.01f : NAN;
+}
+
+// Writes the value as a JSON number ("null" for the sentinel) plus NUL into
+// out[kTempCentiTextMax]; returns the length without the NUL.
+inline uint8_t tempCentiFormat(TempCenti v, char* out) {
+  char* p = out;
+  if (!tempCentiValid(v)) {
+    *p++ = 'n'; *p++ = 'u'; *p++ = 'l'; *p++ = 'l';
+    *p = '\0';
+    return 4;
+  }
+  uint16_t u = (uint16_t)v;
+  if (v < 0) {
+    *p++ = '-';
+    u = (uint16_t)(-(int32_t)v);
+  }
+  const uint16_t ip = (uint16_t)(u / 100u);
+  const uint8_t fp = (uint8_t)(u - ip * 100u);
+  if (ip >= 100u) {
+    *p++ = (char)('0' + ip / 100u);
+    *p++ = (char)('0' + (ip / 10u) % 10u);
+  } else if (ip >= 10u) {
+    *p++ = (char)('0' + ip / 10u);
+  }
+  *p++ = (char)('0' + ip % 10u);
+  if (fp) {
+    *p++ = '.';
+    *p++ = (char)('0' + fp / 10u);
+    if (fp % 10u) *p++ = (char)('0' + fp % 10u);
+  }
+  *p = '\0';
+  return (uint8_t)(p - out);
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+// Per-role temperature signal conditioning for TemperatureManager.
+// Arduino-free so recorded traces can be replayed on a host
+// (tools/valve_replay.cpp).
+//
+// Every new sample of a role passes, in order:
+//   1) plausibility: non-finite and out-of-range values are dropped, as are
+//      the DS18B20 error values -127 and 85.0 (power-on reset value). 85.0 is
+//      accepted only when the filtered value is already close to it, so a real
+//      85 C reading still gets through;
+//   2) median of the last N accepted samples (N = 1, 3 or 5) against single
+//      bad reads;
+//   3) first-order low-pass, y += (x - y) * dt / (tau + dt); tau = 0 skips it;
+//   4) rate of change of the filtered value in C/s, smoothed over
+//      kRateTauMs.
+// A dropped sample leaves the output and its timestamp unchanged, so the
+// value ages normally (maxAgeMs). Fixed memory, no allocation.
+
+#include <math.h>
+#include <stdint.h>
+
+struct TempConditionerConfig {
+  uint8_t medianN = 3;  // 1 (off), 3 or 5
+  uint32_t tauMs = 0;   // low-pass time constant, 0 = off
+};
+
+class TempConditioner {
+public:
+  static constexpr uint8_t kMaxMedian = 5;
+  static constexpr uint32_t kRateTauMs = 30000;
+  static constexpr float kMinC = -55.0f;   // DS18B20 range, covers OT/BLE too
+  static constexpr float kMaxC = 125.0f;
+  static constexpr float kPowerOnC = 85.0f;
+  static constexpr float kPowerOnNearC = 2.0f;
+  static constexpr float kSpikeC = 1.0f;    // median moved the sample this far
+
+  void configure(const TempConditionerConfig& cfg) {
+    uint8_t n = cfg.medianN;
+    if (n != 3 && n != 5) n = 1;
+    if (n == _cfg.medianN && cfg.tauMs == _cfg.tauMs) return;
+    _cfg.medianN = n;
+    _cfg.tauMs = cfg.tauMs;
+    reset();
+  }
+  const TempConditionerConfig& config() const { return _cfg; }
+
+  // Source switched or went away: start over.
+  void reset() {
+    _count = 0;
+    _head = 0;
+    _have = false;
+    _y = NAN;
+    _rate = NAN;
+    _lastMs = 0;
+  }
+
+  // Returns false if the sample was dropped.
+  bool push(float x, uint32_t tMs) {
+    _raw = x;
+    if (!plausible(x)) {
+      _rejected++;
+      return false;
+    }
+
+    _win[_head] = x;
+    _head = (uint8_t)((_head + 1) % _cfg.medianN);
+    if (_count < _cfg.medianN) _count++;
+    const float m = median();
+    if (fabsf(m - x) > kSpikeC) _spikes++;
+
+    if (!_have) {
+      _y = m;
+      _lastMs = tMs;
+      _have = true;
+      return true;
+    }
+
+    const uint32_t dt = tMs - _lastMs;
+    const float prev = _y;
+    if (_cfg.tauMs == 0) _y = m;
+    else _y += (m - _y) * ((float)dt / (float)(_cfg.tauMs + dt));
+
+    if (dt > 0) {
+      const float inst = (_y - prev) * 1000.0f / (float)dt;
+      if (isnan(_rate)) _rate = inst;
+      else _rate += (inst - _rate) * ((float)dt / (float)(kRateTauMs + dt));
+    }
+    _lastMs = tMs;
+    return true;
+  }
+
+  bool valid() const { return _have; }
+  float value() const { return _y; }
+  float rateCps() const { return _rate; }
+  uint32_t sampleMs() const { return _lastMs; }  // time of the last accepted sample
+  float lastRaw() const { return _raw; }
+  uint32_t rejected() const { return _rejected; }
+  uint32_t spikes() const { return _spikes; }  // samples the median overrode
+
+private:
+  bool plausible(float x) const {
+    if (!isfinite(x) || x < kMinC || x > kMaxC) return false;
+    if (x == kPowerOnC) return _have && fabsf(_y - kPowerOnC) <= kPowerOnNearC;
+    return true;
+  }
+
+  float median() const {
+    float s[kMaxMedian];
+    for (uint8_t i = 0; i < _count; i++) {
+      uint8_t j = i;
+      while (j > 0 && s[j - 1] > _win[i]) { s[j] = s[j - 1]; j--; }
+      s[j] = _win[i];
+    }
+    // Even count (window still filling): lower middle.
+    return s[(_count - 1) / 2];
+  }
+
+  TempConditionerConfig _cfg;
+  float _win[kMaxMedian] = {};
+  uint8_t _count = 0;
+  uint8_t _head = 0;
+  bool _have = false;
+  float _y = NAN;
+  float _rate = NAN;
+  float _raw = NAN;
+  uint32_t _lastMs = 0;
+  uint32_t _rejected = 0;
+  uint32_t _spikes = 0;
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+// Multi-source fusion for roles with more than one sensor (Outside: OT /
+// DS18B20 / BLE, Return: OT / DS18B20). Arduino-free so recorded traces
+// can be replayed on a host (tools/fusion_replay.cpp).
+//
+// Sources are given in priority order. Every update():
+//   1) freshness: full weight up to staleMs/2, fading to 0 at staleMs;
+//   2) cross-check: the fresh, healthy source with the largest weight is
+//      the anchor; a source that disagrees with it by more than disagreeC
+//      (after its offset) is marked unhealthy until it agrees again for
+//      kRecoverMs. The anchor is never blamed;
+//   3) offsets: a source joining takes its offset to the anchor right away,
+//      later it is learned slowly (kOffsetTauMs, at most kMaxOffsetC), so a
+//      failover does not step by the calibration difference between the
+//      sensors. The anchor's own offset decays to 0 with the same time
+//      constant, which moves the output to the scale of the highest
+//      priority source without a step;
+//   4) weights: priority weight x health, slewed with kBlendMs so sources
+//      fade in and out instead of switching, times the freshness. Output is
+//      the weighted mean of the offset-corrected fresh sources.
+// Fixed memory, no allocation.
+
+#include <math.h>
+#include <stdint.h>
+
+struct TempFusionInput {
+  float c = NAN;
+  bool valid = false;
+  uint32_t sampleMs = 0;  // measurement time
+};
+
+struct TempFusionConfig {
+  uint32_t staleMs = 120000;
+  float disagreeC = 4.0f;
+};
+
+template <uint8_t N>
+class TempFusion {
+  static_assert(N > 0 && N <= 4, "1..4 sources");
+
+public:
+  static constexpr uint32_t kBlendMs = 60000;
+  static constexpr uint32_t kOffsetTauMs = 600000;
+  static constexpr uint32_t kRecoverMs = 60000;
+  static constexpr float kMaxOffsetC = 3.0f;
+
+  struct SourceState {
+    float weight = 0.0f;      // slewed, not normalised
+    float share = 0.0f;       // normalised contribution to the last output
+    float offsetC = 0.0f;     // learned offset to the anchor
+    bool offsetKnown = false;
+    bool healthy = true;
+    bool fresh = false;
+    uint32_t ageMs = 0;
+    uint32_t agreeSinceMs = 0;
+    uint32_t learnMs = 0;     // sample time of the last offset update
+  };
+
+  explicit TempFusion(const float (&priorityWeights)[N], const TempFusionConfig& cfg = TempFusionConfig())
+    : _cfg(cfg) {
+    for (uint8_t i = 0; i < N; i++) _prio[i] = priorityWeights[i];
+  }
+
+  void reset() {
+    for (SourceState& s : _s) s = SourceState{};
+    _valid = false;
+    _haveLoop = false;
+  }
+
+  void update(const TempFusionInput (&in)[N], uint32_t now) {
+    const uint32_t dt = _haveLoop ? (uint32_t)(now - _lastLoopMs) : 0;
+    _haveLoop = true;
+    _lastLoopMs = now;
+
+    float fade[N];
+    for (uint8_t i = 0; i < N; i++) {
+      SourceState& s = _s[i];
+      s.ageMs = in[i].valid ? (uint32_t)(now - in[i].sampleMs) : 0;
+      s.fresh = in[i].valid && isfinite(in[i].c) && s.ageMs < _cfg.staleMs;
+      fade[i] = 0.0f;
+      if (s.fresh) {
+        const uint32_t half = _cfg.staleMs / 2;
+        fade[i] = s.ageMs <= half ? 1.0f : (float)(_cfg.staleMs - s.ageMs) / (float)(_cfg.staleMs - half);
+      }
+    }
+
+    // Anchor: the established source (largest weight, priority on ties).
+    int8_t anchor = -1;
+    for (uint8_t i = 0; i < N; i++) {
+      if (!_s[i].fresh || !_s[i].healthy) continue;
+      if (anchor < 0 || _s[i].weight > _s[anchor].weight) anchor = (int8_t)i;
+    }
+    for (uint8_t i = 0; i < N && anchor < 0; i++) if (_s[i].fresh) anchor = (int8_t)i;
+    _anchor = anchor;
+
+    if (anchor >= 0) {
+      SourceState& a = _s[anchor];
+      a.offsetKnown = true;
+      a.offsetC -= a.offsetC * ((float)dt / (float)(kOffsetTauMs + dt));
+      const float ref = in[anchor].c - a.offsetC;
+      for (uint8_t i = 0; i < N; i++) {
+        SourceState& s = _s[i];
+        if (i == (uint8_t)anchor || !s.fresh) continue;
+        const float diff = in[i].c - ref;
+        if (!s.offsetKnown) {
+          if (fabsf(diff) <= kMaxOffsetC) {
+            s.offsetC = diff;
+            s.offsetKnown = true;
+            s.learnMs = in[i].sampleMs;
+          }
+        }
+        const bool agrees = fabsf(diff - s.offsetC) <= _cfg.disagreeC;
+        if (!agrees) {
+          s.healthy = false;
+          s.agreeSinceMs = 0;
+        } else if (!s.healthy) {
+          if (!s.agreeSinceMs) s.agreeSinceMs = now ? now : 1;
+          if ((uint32_t)(now - s.agreeSinceMs) >= kRecoverMs) s.healthy = true;
+        }
+        // Learn only from new samples of a healthy pair.
+        if (agrees && s.healthy && s.offsetKnown && in[i].sampleMs != s.learnMs) {
+          const uint32_t ldt = (uint32_t)(in[i].sampleMs - s.learnMs);
+          s.learnMs = in[i].sampleMs;
+          s.offsetC += (diff - s.offsetC) * ((float)ldt / (float)(kOffsetTauMs + ldt));
+          if (s.offsetC > kMaxOffsetC) s.offsetC = kMaxOffsetC;
+          if (s.offsetC < -kMaxOffsetC) s.offsetC = -kMaxOffsetC;
+        }
+      }
+    }
+
+    float sumW = 0.0f;
+    float sum = 0.0f;
+    uint32_t newest = 0;
+    bool haveNewest = false;
+    for (uint8_t i = 0; i < N; i++) {
+      SourceState& s = _s[i];
+      const bool usable = s.fresh && (s.healthy || (int8_t)i == anchor);
+      const float target = usable ? _prio[i] : 0.0f;
+      if (!dt && s.weight == 0.0f) s.weight = target;  // first update: no ramp
+      else s.weight += (target - s.weight) * ((float)dt / (float)(kBlendMs + dt));
+      // Age fades the contribution directly, so a source going stale leaves
+      // without a step; a fresh anchor always carries some weight (failover).
+      float w = s.fresh ? s.weight * fade[i] : 0.0f;
+      if ((int8_t)i == anchor && w < 1e-3f) w = 1e-3f;
+      if (s.fresh && !s.healthy && (int8_t)i != anchor) w = 0.0f;
+      s.share = w;
+      if (w <= 0.0f) continue;
+      sumW += w;
+      sum += w * (in[i].c - s.offsetC);
+      if (!haveNewest || (int32_t)(in[i].sampleMs - newest) > 0) newest = in[i].sampleMs;
+      haveNewest = true;
+    }
+    _valid = sumW > 0.0f;
+    if (!_valid) {
+      _c = NAN;
+      for (SourceState& s : _s) s.share = 0.0f;
+      return;
+    }
+    for (SourceState& s : _s) s.share /= sumW;
+    _c = sum / sumW;
+    _sampleMs = newest;
+  }
+
+  bool valid() const { return _valid; }
+  float value() const { return _c; }
+  uint32_t sampleMs() const { return _sampleMs; }  // newest contributing sample
+  // Index of the source with the largest share (-1 if invalid).
+  int8_t dominant() const {
+    if (!_valid) return -1;
+    int8_t best = 0;
+    for (uint8_t i = 1; i < N; i++) if (_s[i].share > _s[best].share) best = (int8_t)i;
+    return best;
+  }
+  int8_t anchor() const { return _anchor; }
+  const SourceState& source(uint8_t i) const { return _s[i]; }
+  const TempFusionConfig& config() const { return _cfg; }
+
+private:
+  TempFusionConfig _cfg;
+  float _prio[N];
+  SourceState _s[N];
+  bool _valid = false;
+  float _c = NAN;
+  uint32_t _sampleMs = 0;
+  int8_t _anchor = -1;
+  bool _haveLoop = false;
+  uint32_t _lastLoopMs = 0;
+};
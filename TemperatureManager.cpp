@@ -6,9 +6,10 @@
 #include "OpenThermController.h"
 #include "BleController.h"
 #include "DallasController.h"
+#include "OpenThermMailbox.h"
+#include "TaskDomains.h"
+#include "TempFusion.h"
 
-#include <algorithm>
-#include <vector>
 
 namespace {
   struct RoleBindingDef {
@@ -57,13 +58,90 @@ namespace {
     uint32_t updatedMs = 0;
     uint8_t gpio = 255;
     uint64_t rom = 0;
+    float rate = NAN;
+    TempCenti centi = kTempCentiInvalid;  // c after conditioning, set once per loop
   };
 
+  // g_cache is what get() returns, composed every loop from the Dallas
+  // resolution (g_dallas) and the OpenTherm / BLE overrides. g_dallas is
+  // only recomputed when a bus delivered a new reading or the role/ROM
+  // configuration changed. updatedMs is always the measurement time.
   CacheItem g_cache[(uint8_t)TempRole::COUNT];
+  CacheItem g_dallas[(uint8_t)TempRole::COUNT];
+  // Dallas-only Return value (getDallasReturn()): configured ROM only, no
+  // first-valid fallback when one is set, never overridden by OpenTherm.
+  CacheItem g_dallasReturn;
+  CacheItem g_dallasReturnOut;  // g_dallasReturn after conditioning
+
+  // Signal conditioning per role, plus one for the Dallas-only return.
+  constexpr uint8_t kCondCount = (uint8_t)TempRole::COUNT + 1;
+  struct CondState {
+    TempConditioner f;
+    TempSource src = TempSource::None;
+    uint32_t seenMs = 0;   // timestamp of the last sample fed to f
+    bool seen = false;
+  };
+  CondState g_cond[kCondCount];
+
+  // A reconfigured filter starts empty; let it take the current sample again.
+  static void configureCond(CondState &st, const TempConditionerConfig &cfg) {
+    const TempConditionerConfig before = st.f.config();
+    st.f.configure(cfg);
+    const TempConditionerConfig &after = st.f.config();
+    if (after.medianN != before.medianN || after.tauMs != before.tauMs) st.seen = false;
+  }
+
+  // Replaces a raw cache entry with its conditioned value. A new sample is
+  // one with a new timestamp; a source switch starts the filter over.
+  static void conditionItem(CacheItem &it, CondState &st) {
+    if (!it.valid) {
+      it.centi = kTempCentiInvalid;
+      if (st.seen || st.f.valid()) st.f.reset();
+      st.seen = false;
+      st.src = TempSource::None;
+      return;
+    }
+    if (it.src != st.src) {
+      st.f.reset();
+      st.src = it.src;
+      st.seen = false;
+    }
+    if (!st.seen || it.updatedMs != st.seenMs) {
+      st.seen = true;
+      st.seenMs = it.updatedMs;
+      st.f.push(it.c, it.updatedMs);
+    }
+    if (!st.f.valid()) {
+      // Nothing plausible yet from this source.
+      it = CacheItem{};
+      return;
+    }
+    it.c = st.f.value();
+    it.updatedMs = st.f.sampleMs();
+    it.rate = st.f.rateCps();
+    it.centi = tempCentiFromC(it.c);
+  }
+  // What get() / getDallasReturn() read: the conditioned values, published
+  // whenever they change hands, so the control task reads temperatures
+  // without taking IoLock (TaskDomains.h). Everything else here belongs to
+  // the I/O domain.
+  struct PublishedTemps {
+    CacheItem role[(uint8_t)TempRole::COUNT];
+    CacheItem dallasReturn;
+  };
+  OtSnapshot<PublishedTemps> g_pub;
+
+  static void publishTemps() {
+    PublishedTemps p;
+    for (uint8_t i = 0; i < (uint8_t)TempRole::COUNT; i++) p.role[i] = g_cache[i];
+    p.dallasReturn = g_dallasReturnOut;
+    g_pub.publish(p);
+  }
+
+  bool g_dallasDirty = true;
   bool g_inited = false;
 
-  static inline void setCache(TempRole role, float c, bool valid, TempSource src, uint32_t updatedMs, uint8_t gpio=255, uint64_t rom=0) {
-    CacheItem &it = g_cache[(uint8_t)role];
+  static inline void setItem(CacheItem &it, float c, bool valid, TempSource src, uint32_t updatedMs, uint8_t gpio, uint64_t rom) {
     it.c = c;
     it.valid = valid && isfinite(c);
     it.src = it.valid ? src : TempSource::None;
@@ -72,6 +150,30 @@ namespace {
     it.rom = it.valid ? rom : 0;
   }
 
+  static inline void setCache(TempRole role, float c, bool valid, TempSource src, uint32_t updatedMs, uint8_t gpio=255, uint64_t rom=0) {
+    setItem(g_cache[(uint8_t)role], c, valid, src, updatedMs, gpio, rom);
+  }
+
+  static inline void setDallasCache(TempRole role, float c, bool valid, uint32_t readMs, uint8_t gpio, uint64_t rom) {
+    setItem(g_dallas[(uint8_t)role], c, valid, TempSource::Dallas, readMs, gpio, rom);
+  }
+
+  static inline TempValue toValue(const CacheItem &it, uint32_t now, uint32_t maxAgeMs) {
+    TempValue out;
+    if (!it.valid) return out;
+    const uint32_t age = (it.updatedMs > 0) ? (uint32_t)(now - it.updatedMs) : 0;
+    if (age > maxAgeMs) return out;
+    out.c = it.c;
+    out.valid = true;
+    out.src = it.src;
+    out.ageMs = age;
+    out.gpio = it.gpio;
+    out.rom = it.rom;
+    out.rateCps = it.rate;
+    out.centi = it.centi;
+    return out;
+  }
+
   static inline bool pickDallasByRom(uint8_t gpio, uint64_t rom, float& outC, uint64_t& outRom) {
     const DallasGpioStatus* st = DallasController::getStatus(gpio);
     if (!st) return false;
@@ -99,30 +201,6 @@ namespace {
     return false;
   }
 
-  static inline bool pickDallasSortedIndex(uint8_t gpio, uint8_t idx, float& outC, uint64_t& outRom) {
-    const DallasGpioStatus* st = DallasController::getStatus(gpio);
-    if (!st) return false;
-    struct Item { uint64_t rom; float t; bool ok; };
-    std::vector<Item> items;
-    items.reserve(st->devices.size());
-    for (auto &d : st->devices) {
-      Item it{d.rom, d.temperature, d.valid && isfinite(d.temperature)};
-      items.push_back(it);
-    }
-    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b){ return a.rom < b.rom; });
-    uint8_t seen = 0;
-    for (auto &it : items) {
-      if (!it.ok) continue;
-      if (seen == idx) {
-        outC = it.t;
-        outRom = it.rom;
-        return true;
-      }
-      seen++;
-    }
-    return false;
-  }
-
   static inline uint64_t cfgRomForRole(TempRole role) {
     switch (role) {
       case TempRole::TankTop: return ConfigStore::getDallasTankTopRom();
@@ -179,27 +257,65 @@ namespace {
   static inline void clearDallasBackedRoleCaches() {
     for (uint8_t i = 0; i < (uint8_t)TempRole::COUNT; i++) {
       const TempRole role = (TempRole)i;
-      if (roleCanUseDallas(role)) clearRoleCache(role);
+      if (!roleCanUseDallas(role)) continue;
+      clearRoleCache(role);
+      g_dallas[i] = CacheItem{};
     }
+    g_dallasReturn = CacheItem{};
+    g_dallasDirty = true;
   }
 
-  static inline bool containsRom(const std::vector<uint64_t>& roms, uint64_t rom) {
+  static inline bool containsRom(const uint64_t* roms, uint8_t count, uint64_t rom) {
     if (!rom) return false;
-    return std::find(roms.begin(), roms.end(), rom) != roms.end();
+    for (uint8_t i = 0; i < count; i++) if (roms[i] == rom) return true;
+    return false;
   }
 
-  static inline std::vector<uint64_t> collectValidDallasRomsSorted(uint8_t gpio) {
-    std::vector<uint64_t> out;
+  // Valid readings of one bus, ordered by ROM (stable AUTO assignment) and
+  // de-duplicated. Rebuilt only when the bus generation changes.
+  struct SortedBus {
+    bool have = false;
+    uint32_t generation = 0;
+    uint8_t count = 0;
+    uint64_t rom[DALLAS_MAX_DEVICES_PER_GPIO] = {};
+    float c[DALLAS_MAX_DEVICES_PER_GPIO] = {};
+  };
+
+  constexpr uint8_t kDallasBusCount = 4;  // GPIO0..3
+  SortedBus g_sorted[kDallasBusCount];
+
+  static const SortedBus* sortedValidDallas(uint8_t gpio) {
+    if (gpio >= kDallasBusCount) return nullptr;
     const DallasGpioStatus* st = DallasController::getStatus(gpio);
-    if (!st) return out;
-    out.reserve(st->devices.size());
+    if (!st) return nullptr;
+    SortedBus& sb = g_sorted[gpio];
+    if (sb.have && sb.generation == st->generation) return &sb;
+
+    sb.have = true;
+    sb.generation = st->generation;
+    sb.count = 0;
     for (const auto &d : st->devices) {
       if (!d.valid || !isfinite(d.temperature)) continue;
-      out.push_back(d.rom);
+      // Insertion sort: at most 8 entries.
+      uint8_t i = sb.count;
+      while (i > 0 && sb.rom[i - 1] > d.rom) {
+        sb.rom[i] = sb.rom[i - 1];
+        sb.c[i] = sb.c[i - 1];
+        i--;
+      }
+      if (i > 0 && sb.rom[i - 1] == d.rom) {
+        // Duplicate ROM: keep the first reading, undo the shift.
+        for (uint8_t j = i; j < sb.count; j++) {
+          sb.rom[j] = sb.rom[j + 1];
+          sb.c[j] = sb.c[j + 1];
+        }
+        continue;
+      }
+      sb.rom[i] = d.rom;
+      sb.c[i] = d.temperature;
+      sb.count++;
     }
-    std::sort(out.begin(), out.end());
-    out.erase(std::unique(out.begin(), out.end()), out.end());
-    return out;
+    return &sb;
   }
 
   static inline bool resolveDallasRoleValue(TempRole role, float& outC, uint64_t& outRom) {
@@ -210,26 +326,15 @@ namespace {
     return pickDallasFirstValid(gpio, outC, outRom);
   }
 
-  static inline bool pickDallasAutoFromRemaining(uint8_t gpio, const std::vector<uint64_t>& reservedRoms, uint8_t idx, float& outC, uint64_t& outRom) {
-    const DallasGpioStatus* st = DallasController::getStatus(gpio);
-    if (!st) return false;
-    struct Item { uint64_t rom; float t; bool ok; };
-    std::vector<Item> items;
-    items.reserve(st->devices.size());
-    for (const auto &d : st->devices) {
-      const bool ok = d.valid && isfinite(d.temperature) && !containsRom(reservedRoms, d.rom);
-      items.push_back(Item{d.rom, d.temperature, ok});
-    }
-    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b){ return a.rom < b.rom; });
+  static inline bool pickDallasAutoFromRemaining(uint8_t gpio, const uint64_t* reservedRoms, uint8_t reservedCount, uint8_t idx, float& outC, uint64_t& outRom) {
+    const SortedBus* sb = sortedValidDallas(gpio);
+    if (!sb) return false;
     uint8_t seen = 0;
-    uint64_t lastRom = 0;
-    for (const auto &it : items) {
-      if (!it.ok) continue;
-      if (it.rom == lastRom) continue;
-      lastRom = it.rom;
+    for (uint8_t i = 0; i < sb->count; i++) {
+      if (containsRom(reservedRoms, reservedCount, sb->rom[i])) continue;
       if (seen == idx) {
-        outC = it.t;
-        outRom = it.rom;
+        outC = sb->c[i];
+        outRom = sb->rom[i];
         return true;
       }
       seen++;
@@ -237,10 +342,17 @@ namespace {
     return false;
   }
 
-  static inline void updateDallasRoles(uint32_t now) {
+  // Time of the read pass that produced the bus values.
+  static inline uint32_t busReadMs(uint8_t gpio) {
+    const DallasGpioStatus* st = DallasController::getStatus(gpio);
+    return st ? st->lastReadMs : 0;
+  }
+
+  static inline void updateDallasRoles() {
     if (!ConfigStore::getDallasEnabled()) {
       // Clear all Dallas-backed roles. OT/BLE can repopulate them later in the same loop.
-      clearDallasBackedRoleCaches();
+      for (uint8_t i = 0; i < (uint8_t)TempRole::COUNT; i++) g_dallas[i] = CacheItem{};
+      g_dallasReturn = CacheItem{};
       return;
     }
 
@@ -251,19 +363,19 @@ namespace {
       bool ok = false;
       if (cfg) ok = pickDallasByRom(DALLAS_IO0_PIN, cfg, t, rom);
       if (!ok) ok = pickDallasFirstValid(DALLAS_IO0_PIN, t, rom);
-      if (ok) setCache(TempRole::Outside, t, true, TempSource::Dallas, now, DALLAS_IO0_PIN, rom);
-      else setCache(TempRole::Outside, NAN, false, TempSource::None, 0);
+      setDallasCache(TempRole::Outside, ok ? t : NAN, ok, busReadMs(DALLAS_IO0_PIN), DALLAS_IO0_PIN, ok ? rom : 0);
     }
 
     // Tank roles + optional DHW tank fallback (GPIO3)
     {
       float t; uint64_t rom;
+      const uint32_t tankReadMs = busReadMs(DALLAS_TANK_PIN);
 
       // DHW tank fallback: explicit ROM only, no auto-pick to avoid using a wrong sensor.
       uint64_t cfg = cfgRomForRole(TempRole::DhwTank);
       bool ok = false;
       if (cfg) ok = pickDallasByRom(DALLAS_TANK_PIN, cfg, t, rom);
-      setCache(TempRole::DhwTank, ok ? t : NAN, ok, TempSource::Dallas, now, DALLAS_TANK_PIN, ok ? rom : 0);
+      setDallasCache(TempRole::DhwTank, ok ? t : NAN, ok, tankReadMs, DALLAS_TANK_PIN, ok ? rom : 0);
 
       const uint64_t cfgTop = cfgRomForRole(TempRole::TankTop);
       const uint64_t cfgMid = cfgRomForRole(TempRole::TankMid);
@@ -273,34 +385,35 @@ namespace {
       const bool dupMid = cfgMid && (cfgMid == cfgTop);
       const bool dupBottom = cfgBottom && (cfgBottom == cfgTop || cfgBottom == cfgMid);
 
-      std::vector<uint64_t> reservedRoms;
-      if (cfgTop && !dupTop) reservedRoms.push_back(cfgTop);
-      if (cfgMid && !dupMid && !containsRom(reservedRoms, cfgMid)) reservedRoms.push_back(cfgMid);
-      if (cfgBottom && !dupBottom && !containsRom(reservedRoms, cfgBottom)) reservedRoms.push_back(cfgBottom);
+      uint64_t reservedRoms[3];
+      uint8_t reservedCount = 0;
+      if (cfgTop && !dupTop) reservedRoms[reservedCount++] = cfgTop;
+      if (cfgMid && !dupMid && !containsRom(reservedRoms, reservedCount, cfgMid)) reservedRoms[reservedCount++] = cfgMid;
+      if (cfgBottom && !dupBottom && !containsRom(reservedRoms, reservedCount, cfgBottom)) reservedRoms[reservedCount++] = cfgBottom;
 
       bool autoAkuAllowed = false;
       if (!cfgTop && !cfgMid && !cfgBottom) {
-        const std::vector<uint64_t> validTankRoms = collectValidDallasRomsSorted(DALLAS_TANK_PIN);
-        autoAkuAllowed = validTankRoms.size() >= 3;
+        const SortedBus* tank = sortedValidDallas(DALLAS_TANK_PIN);
+        autoAkuAllowed = tank && tank->count >= 3;
       }
 
       // TankTop
       ok = false;
       if (cfgTop && !dupTop) ok = pickDallasByRom(DALLAS_TANK_PIN, cfgTop, t, rom);
-      else if (autoAkuAllowed) ok = pickDallasAutoFromRemaining(DALLAS_TANK_PIN, reservedRoms, 0, t, rom);
-      setCache(TempRole::TankTop, ok ? t : NAN, ok, TempSource::Dallas, now, DALLAS_TANK_PIN, ok ? rom : 0);
+      else if (autoAkuAllowed) ok = pickDallasAutoFromRemaining(DALLAS_TANK_PIN, reservedRoms, reservedCount, 0, t, rom);
+      setDallasCache(TempRole::TankTop, ok ? t : NAN, ok, tankReadMs, DALLAS_TANK_PIN, ok ? rom : 0);
 
       // TankMid
       ok = false;
       if (cfgMid && !dupMid) ok = pickDallasByRom(DALLAS_TANK_PIN, cfgMid, t, rom);
-      else if (autoAkuAllowed) ok = pickDallasAutoFromRemaining(DALLAS_TANK_PIN, reservedRoms, 1, t, rom);
-      setCache(TempRole::TankMid, ok ? t : NAN, ok, TempSource::Dallas, now, DALLAS_TANK_PIN, ok ? rom : 0);
+      else if (autoAkuAllowed) ok = pickDallasAutoFromRemaining(DALLAS_TANK_PIN, reservedRoms, reservedCount, 1, t, rom);
+      setDallasCache(TempRole::TankMid, ok ? t : NAN, ok, tankReadMs, DALLAS_TANK_PIN, ok ? rom : 0);
 
       // TankBottom
       ok = false;
       if (cfgBottom && !dupBottom) ok = pickDallasByRom(DALLAS_TANK_PIN, cfgBottom, t, rom);
-      else if (autoAkuAllowed) ok = pickDallasAutoFromRemaining(DALLAS_TANK_PIN, reservedRoms, 2, t, rom);
-      setCache(TempRole::TankBottom, ok ? t : NAN, ok, TempSource::Dallas, now, DALLAS_TANK_PIN, ok ? rom : 0);
+      else if (autoAkuAllowed) ok = pickDallasAutoFromRemaining(DALLAS_TANK_PIN, reservedRoms, reservedCount, 2, t, rom);
+      setDallasCache(TempRole::TankBottom, ok ? t : NAN, ok, tankReadMs, DALLAS_TANK_PIN, ok ? rom : 0);
     }
 
     // Return DS fallback (GPIO2)
@@ -310,18 +423,12 @@ namespace {
       bool ok = false;
       if (cfg) ok = pickDallasByRom(DALLAS_RETURN_PIN, cfg, t, rom);
       if (!ok) ok = pickDallasFirstValid(DALLAS_RETURN_PIN, t, rom);
-      // We store DS return in cache, but Return role prefers OT if available.
-      if (ok) {
-        // use a dedicated cache slot? we reuse Return slot only when OT not available during update.
-        // handled in updateOpenTherm.
-        // keep it in a temp variable by storing as Dallas but may be overwritten by OT.
-        // We'll keep it as Dallas for now; OT update will override if valid.
-        // ageMs is computed on get().
-        //
-        // Note: gpio/rom are set for diagnostics.
-      }
-      // Save into Return slot as Dallas for now.
-      setCache(TempRole::Return, ok ? t : NAN, ok, TempSource::Dallas, now, DALLAS_RETURN_PIN, ok ? rom : 0);
+      // Return role prefers OT; updateOpenTherm() overrides it when valid.
+      const uint32_t readMs = busReadMs(DALLAS_RETURN_PIN);
+      setDallasCache(TempRole::Return, ok ? t : NAN, ok, readMs, DALLAS_RETURN_PIN, ok ? rom : 0);
+
+      ok = resolveDallasRoleValue(TempRole::Return, t, rom) && readMs != 0;
+      setItem(g_dallasReturn, ok ? t : NAN, ok, TempSource::Dallas, readMs, DALLAS_RETURN_PIN, ok ? rom : 0);
     }
 
     // DHW return (GPIO1)
@@ -331,13 +438,11 @@ namespace {
       bool ok = false;
       if (cfg) ok = pickDallasByRom(DALLAS_DHW_RETURN_PIN, cfg, t, rom);
       if (!ok) ok = pickDallasFirstValid(DALLAS_DHW_RETURN_PIN, t, rom);
-      setCache(TempRole::DhwReturn, ok ? t : NAN, ok, TempSource::Dallas, now, DALLAS_DHW_RETURN_PIN, ok ? rom : 0);
+      setDallasCache(TempRole::DhwReturn, ok ? t : NAN, ok, busReadMs(DALLAS_DHW_RETURN_PIN), DALLAS_DHW_RETURN_PIN, ok ? rom : 0);
     }
   }
 
-  static inline void updateOpenTherm(uint32_t now) {
-    OpenThermStatusSnapshot ot = openthermGetStatus();
-
+  static inline void updateOpenTherm(const OpenThermTelemetry &ot) {
     // Flow + DHW
     if (ot.present && ot.ready && isfinite(ot.boilerTempC)) {
       setCache(TempRole::Flow, ot.boilerTempC, true, TempSource::OpenTherm, ot.lastUpdateMs);
@@ -349,31 +454,88 @@ namespace {
     if (ot.present && ot.ready && isfinite(ot.dhwTempC)) {
       setCache(TempRole::DhwTank, ot.dhwTempC, true, TempSource::OpenTherm, ot.lastUpdateMs);
     }
+  }
 
-    // Outside (OT preferred)
-    if (ot.present && ot.ready && isfinite(ot.outsideTempC)) {
-      setCache(TempRole::Outside, ot.outsideTempC, true, TempSource::OpenTherm, ot.lastUpdateMs);
-    } else {
-      // keep for BLE update
+  // Outside and Return have several sensors; TempFusion.h blends them
+  // (priority OT > DS > BLE) instead of switching, so a dropout or a source
+  // coming back does not step the equitherm target.
+  constexpr TempSource kOutsideSources[3] = {TempSource::OpenTherm, TempSource::Dallas, TempSource::Ble};
+  constexpr TempSource kReturnSources[2] = {TempSource::OpenTherm, TempSource::Dallas};
+  constexpr float kOutsidePriority[3] = {1.0f, 0.5f, 0.2f};
+  constexpr float kReturnPriority[2] = {1.0f, 0.5f};
+  // OT is polled every few seconds, BLE scans every 10 s; return moves fast.
+  constexpr TempFusionConfig kOutsideFusionCfg = {120000, 4.0f};
+  constexpr TempFusionConfig kReturnFusionCfg = {30000, 3.0f};
+  TempFusion<3> g_outsideFusion(kOutsidePriority, kOutsideFusionCfg);
+  TempFusion<2> g_returnFusion(kReturnPriority, kReturnFusionCfg);
+
+  static inline TempFusionInput fusionInput(bool ok, float c, uint32_t sampleMs) {
+    TempFusionInput in;
+    in.valid = ok && isfinite(c) && sampleMs != 0;
+    in.c = c;
+    in.sampleMs = sampleMs;
+    return in;
+  }
+
+  template <uint8_t N>
+  static void setFusedCache(TempRole role, const TempFusion<N> &f, const TempSource (&srcs)[N]) {
+    CacheItem &it = g_cache[(uint8_t)role];
+    const CacheItem ds = g_dallas[(uint8_t)role];
+    if (!f.valid()) {
+      it = CacheItem{};
+      return;
     }
+    const TempSource src = srcs[f.dominant()];
+    setItem(it, f.value(), true, src, f.sampleMs(),
+            src == TempSource::Dallas ? ds.gpio : 255, src == TempSource::Dallas ? ds.rom : 0);
+  }
 
-    // Return (OT preferred). If OT return unavailable, keep Dallas (already set by updateDallasRoles).
-    if (ot.present && ot.ready && isfinite(ot.returnTempC)) {
-      setCache(TempRole::Return, ot.returnTempC, true, TempSource::OpenTherm, ot.lastUpdateMs);
+  static inline void updateFusedRoles(const OpenThermTelemetry &ot, uint32_t now) {
+    const bool otOk = ot.present && ot.ready;
+    {
+      const CacheItem &ds = g_dallas[(uint8_t)TempRole::Outside];
+      const BleMeteoData m = bleGetMeteo();
+      const TempFusionInput in[3] = {
+        fusionInput(otOk, ot.outsideTempC, ot.lastUpdateMs),
+        fusionInput(ds.valid, ds.c, ds.updatedMs),
+        fusionInput(m.valid, m.tempC, m.lastUpdateMs),
+      };
+      g_outsideFusion.update(in, now);
+      setFusedCache(TempRole::Outside, g_outsideFusion, kOutsideSources);
+    }
+    {
+      const CacheItem &ds = g_dallas[(uint8_t)TempRole::Return];
+      const TempFusionInput in[2] = {
+        fusionInput(otOk, ot.returnTempC, ot.lastUpdateMs),
+        fusionInput(ds.valid, ds.c, ds.updatedMs),
+      };
+      g_returnFusion.update(in, now);
+      setFusedCache(TempRole::Return, g_returnFusion, kReturnSources);
     }
   }
 
-  static inline void updateBle(uint32_t now) {
-    // Only used for Outside fallback.
-    // Priority: OT > DS > BLE
-    CacheItem &outside = g_cache[(uint8_t)TempRole::Outside];
-    if (outside.valid && (outside.src == TempSource::OpenTherm || outside.src == TempSource::Dallas)) return;
+  static const char* sourceName(TempSource src) {
+    switch (src) {
+      case TempSource::OpenTherm: return "opentherm";
+      case TempSource::Dallas: return "dallas";
+      case TempSource::Ble: return "ble";
+      default: return nullptr;
+    }
+  }
 
-    BleMeteoData m = bleGetMeteo();
-    if (m.valid && isfinite(m.tempC) && m.lastUpdateMs > 0) {
-      setCache(TempRole::Outside, m.tempC, true, TempSource::Ble, m.lastUpdateMs);
-    } else {
-      setCache(TempRole::Outside, NAN, false, TempSource::None, 0);
+  template <uint8_t N>
+  static void fillFusionJson(JsonObject out, const TempFusion<N> &f, const TempSource (&srcs)[N]) {
+    out["anchor"] = f.anchor() >= 0 ? sourceName(srcs[f.anchor()]) : nullptr;
+    JsonArray arr = out.createNestedArray("sources");
+    for (uint8_t i = 0; i < N; i++) {
+      const auto &st = f.source(i);
+      JsonObject o = arr.createNestedObject();
+      o["src"] = sourceName(srcs[i]);
+      o["weight"] = st.share;
+      o["offsetC"] = st.offsetC;
+      o["fresh"] = st.fresh;
+      o["healthy"] = st.healthy;
+      o["ageMs"] = st.fresh ? st.ageMs : 0;
     }
   }
 }
@@ -385,6 +547,79 @@ namespace TemperatureManager {
     bool s_haveDallasSnapshot = false;
     uint64_t s_lastRoleRoms[(uint8_t)TempRole::COUNT] = {};
 
+    uint32_t s_busGeneration[kDallasBusCount] = {};
+
+    // Change notification: role channels plus the Dallas-only return.
+    constexpr uint8_t kChannelCount = (uint8_t)TempRole::COUNT + 1;
+    constexpr uint8_t kMaxSubscribers = 8;
+
+    struct Subscriber {
+      bool used = false;
+      bool primed = false;
+      ChangeMask mask = 0;
+      ChangeMask pending = 0;  // notified, not yet taken
+      float minDeltaC = 0.0f;
+      uint32_t minIntervalMs = 0;
+      uint32_t maxAgeMs = 600000;
+      uint32_t lastNotifyMs = 0;
+      ChangeCallback cb = nullptr;
+      void* ctx = nullptr;
+      // Last state delivered per channel.
+      float c[kChannelCount] = {};
+      bool valid[kChannelCount] = {};
+      TempSource src[kChannelCount] = {};
+    };
+
+    Subscriber s_subs[kMaxSubscribers];
+
+    const CacheItem& channelItem(uint8_t ch) {
+      return ch < (uint8_t)TempRole::COUNT ? g_cache[ch] : g_dallasReturnOut;
+    }
+
+    void publishChanges(uint32_t now) {
+      for (Subscriber& sub : s_subs) {
+        if (!sub.used) continue;
+        ChangeMask changed = 0;
+        ChangeMask validity = 0;
+        for (uint8_t ch = 0; ch < kChannelCount; ch++) {
+          const ChangeMask bit = (ChangeMask)(1u << ch);
+          if (!(sub.mask & bit)) continue;
+          const TempValue v = toValue(channelItem(ch), now, sub.maxAgeMs);
+          if (!sub.primed || v.valid != sub.valid[ch]) {
+            validity |= bit;
+          } else if (v.valid && (v.src != sub.src[ch] ||
+                                 (v.c != sub.c[ch] && fabsf(v.c - sub.c[ch]) >= sub.minDeltaC))) {
+            changed |= bit;
+          }
+        }
+        if (!validity && !(changed && (uint32_t)(now - sub.lastNotifyMs) >= sub.minIntervalMs)) continue;
+        // Value changes ride along with a validity change.
+        changed |= validity;
+        for (uint8_t ch = 0; ch < kChannelCount; ch++) {
+          if (!(changed & (1u << ch))) continue;
+          const TempValue v = toValue(channelItem(ch), now, sub.maxAgeMs);
+          sub.c[ch] = v.c;
+          sub.valid[ch] = v.valid;
+          sub.src[ch] = v.src;
+        }
+        sub.primed = true;
+        sub.pending |= changed;
+        sub.lastNotifyMs = now;
+        if (sub.cb) sub.cb(changed, sub.ctx);
+      }
+    }
+
+    // Any Dallas bus with a new read pass / discovery since the last call?
+    bool dallasBusesChanged() {
+      bool changed = false;
+      for (uint8_t gpio = 0; gpio < kDallasBusCount; gpio++) {
+        const uint32_t gen = DallasController::generation(gpio);
+        if (gen != s_busGeneration[gpio]) changed = true;
+        s_busGeneration[gpio] = gen;
+      }
+      return changed;
+    }
+
     bool dallasRoleConfigChanged() {
       const bool enabled = ConfigStore::getDallasEnabled();
       bool changed = !s_haveDallasSnapshot || (enabled != s_lastDallasEnabled);
@@ -404,57 +639,100 @@ namespace TemperatureManager {
   void begin() {
     if (g_inited) return;
     g_inited = true;
-    for (uint8_t i = 0; i < (uint8_t)TempRole::COUNT; i++) g_cache[i] = CacheItem{};
+    for (uint8_t i = 0; i < (uint8_t)TempRole::COUNT; i++) {
+      g_cache[i] = CacheItem{};
+      g_dallas[i] = CacheItem{};
+    }
+    g_dallasReturn = CacheItem{};
+    g_dallasReturnOut = CacheItem{};
+    g_dallasDirty = true;
+    publishTemps();
   }
 
   void loop() {
     begin();
-    const uint32_t now = millis();
     if (dallasRoleConfigChanged()) invalidateDallasBackedRoles();
-    // Update Dallas first (so OT can override Return if present)
-    updateDallasRoles(now);
-    updateOpenTherm(now);
-    updateBle(now);
+    // Re-resolve Dallas roles only on new bus data or a config change.
+    if (dallasBusesChanged() || g_dallasDirty) {
+      g_dallasDirty = false;
+      updateDallasRoles();
+    }
+    // Dallas first (so OT can override DHW tank if present)
+    for (uint8_t i = 0; i < (uint8_t)TempRole::COUNT; i++) g_cache[i] = g_dallas[i];
+    const OpenThermTelemetry ot = openthermGetTelemetry();
+    updateOpenTherm(ot);
+    updateFusedRoles(ot, millis());
+    for (uint8_t i = 0; i < (uint8_t)TempRole::COUNT; i++) conditionItem(g_cache[i], g_cond[i]);
+    g_dallasReturnOut = g_dallasReturn;
+    conditionItem(g_dallasReturnOut, g_cond[(uint8_t)TempRole::COUNT]);
+    publishTemps();
+    publishChanges(millis());
   }
 
-  TempValue get(TempRole role, uint32_t maxAgeMs) {
-    begin();
-    const CacheItem &it = g_cache[(uint8_t)role];
-    TempValue out;
-    if (!it.valid) return out;
-    const uint32_t now = millis();
-    uint32_t age = (it.updatedMs > 0) ? (uint32_t)(now - it.updatedMs) : 0;
-    if (age > maxAgeMs) return out;
-    out.c = it.c;
-    out.valid = true;
-    out.src = it.src;
-    out.ageMs = age;
-    out.gpio = it.gpio;
-    out.rom = it.rom;
-    return out;
+  void setRoleFilter(TempRole role, const TempConditionerConfig& cfg) {
+    IoLock lock;
+    if (role >= TempRole::COUNT) return;
+    configureCond(g_cond[(uint8_t)role], cfg);
+    if (role == TempRole::Return) configureCond(g_cond[(uint8_t)TempRole::COUNT], cfg);
   }
 
-  TempValue getDallasReturn(uint32_t maxAgeMs) {
-    begin();
-    TempValue out;
-    float t = NAN;
-    uint64_t rom = 0;
-    if (!resolveDallasRoleValue(TempRole::Return, t, rom) || !isfinite(t)) return out;
+  TempConditionerConfig getRoleFilter(TempRole role) {
+    IoLock lock;
+    if (role >= TempRole::COUNT) return TempConditionerConfig{};
+    return g_cond[(uint8_t)role].f.config();
+  }
 
-    const DallasGpioStatus* st = DallasController::getStatus(DALLAS_RETURN_PIN);
-    if (!st || st->lastReadMs == 0) return out;
+  RoleFilterStats getRoleFilterStats(TempRole role) {
+    IoLock lock;
+    RoleFilterStats st;
+    if (role >= TempRole::COUNT) return st;
+    const TempConditioner& f = g_cond[(uint8_t)role].f;
+    st.rawC = f.lastRaw();
+    st.rejected = f.rejected();
+    st.spikes = f.spikes();
+    return st;
+  }
 
-    const uint32_t now = millis();
-    const uint32_t age = (now >= st->lastReadMs) ? (uint32_t)(now - st->lastReadMs) : 0;
-    if (age > maxAgeMs) return out;
+  int8_t subscribe(ChangeMask mask, float minDeltaC, uint32_t minIntervalMs,
+                   uint32_t maxAgeMs, ChangeCallback cb, void* ctx) {
+    IoLock lock;
+    for (uint8_t i = 0; i < kMaxSubscribers; i++) {
+      Subscriber& sub = s_subs[i];
+      if (sub.used) continue;
+      sub = Subscriber{};
+      sub.used = true;
+      sub.mask = (ChangeMask)(mask & kAllTempsMask);
+      sub.minDeltaC = minDeltaC > 0.0f ? minDeltaC : 0.0f;
+      sub.minIntervalMs = minIntervalMs;
+      sub.maxAgeMs = maxAgeMs;
+      sub.cb = cb;
+      sub.ctx = ctx;
+      return (int8_t)i;
+    }
+    return -1;
+  }
 
-    out.c = t;
-    out.valid = true;
-    out.src = TempSource::Dallas;
-    out.ageMs = age;
-    out.gpio = DALLAS_RETURN_PIN;
-    out.rom = rom;
-    return out;
+  void unsubscribe(int8_t handle) {
+    IoLock lock;
+    if (handle < 0 || handle >= (int8_t)kMaxSubscribers) return;
+    s_subs[handle] = Subscriber{};
+  }
+
+  ChangeMask takeChanged(int8_t handle) {
+    IoLock lock;
+    if (handle < 0 || handle >= (int8_t)kMaxSubscribers) return 0;
+    const ChangeMask m = s_subs[handle].pending;
+    s_subs[handle].pending = 0;
+    return m;
+  }
+
+  TempValue get(TempRole role, uint32_t maxAgeMs) {
+    if (role >= TempRole::COUNT) return TempValue{};
+    return toValue(g_pub.read().role[(uint8_t)role], millis(), maxAgeMs);
+  }
+
+  TempValue getDallasReturn(uint32_t maxAgeMs) {
+    return toValue(g_pub.read().dallasReturn, millis(), maxAgeMs);
   }
 
   TempValue getMixFeedback(uint32_t maxAgeMs) {
@@ -485,16 +763,37 @@ namespace TemperatureManager {
     return String(fallback ? fallback : "none");
   }
 
-  TempValue getBySourceKey(const String& key, uint32_t maxAgeMs) {
+  SourceId resolveSourceKey(const String& key) {
     const String normalized = normalizeSourceKey(key, "none");
-    if (normalized == "none") return TempValue{};
-    if (normalized == "tank_mid") return get(TempRole::TankMid, maxAgeMs);
-    if (normalized == "return_dallas") return getDallasReturn(maxAgeMs);
-    if (normalized == "opentherm_ch") {
-      const TempValue value = get(TempRole::Flow, maxAgeMs);
-      return value.src == TempSource::OpenTherm ? value : TempValue{};
+    if (normalized == "tank_mid") return SourceId::TankMid;
+    if (normalized == "return_dallas") return SourceId::ReturnDallas;
+    if (normalized == "opentherm_ch") return SourceId::OpenThermCh;
+    return SourceId::None;
+  }
+
+  TempValue getBySource(SourceId id, uint32_t maxAgeMs) {
+    switch (id) {
+      case SourceId::TankMid: return get(TempRole::TankMid, maxAgeMs);
+      case SourceId::ReturnDallas: return getDallasReturn(maxAgeMs);
+      case SourceId::OpenThermCh: {
+        const TempValue value = get(TempRole::Flow, maxAgeMs);
+        return value.src == TempSource::OpenTherm ? value : TempValue{};
+      }
+      default: return TempValue{};
+    }
+  }
+
+  ChangeMask sourceBit(SourceId id) {
+    switch (id) {
+      case SourceId::TankMid: return roleBit(TempRole::TankMid);
+      case SourceId::ReturnDallas: return kDallasReturnBit;
+      case SourceId::OpenThermCh: return roleBit(TempRole::Flow);
+      default: return 0;
     }
-    return TempValue{};
+  }
+
+  TempValue getBySourceKey(const String& key, uint32_t maxAgeMs) {
+    return getBySource(resolveSourceKey(key), maxAgeMs);
   }
 
   const SelectableSourceInfo* getSelectableSourcesForPort(const char* port, size_t& count) {
@@ -552,28 +851,38 @@ namespace TemperatureManager {
   }
 
   uint64_t getRoleRom(TempRole role) {
+    IoLock lock;
     return cfgRomForRole(role);
   }
 
   void setRoleRom(TempRole role, uint64_t rom) {
+    IoLock lock;
     setCfgRomForRole(role, rom);
     if (roleCanUseDallas(role)) invalidateDallasBackedRoles();
     else invalidateRole(role);
   }
 
   void invalidateRole(TempRole role) {
+    IoLock lock;
     begin();
     clearRoleCache(role);
+    publishTemps();
   }
 
   void invalidateAll() {
+    IoLock lock;
     begin();
     for (uint8_t i = 0; i < (uint8_t)TempRole::COUNT; i++) clearRoleCache((TempRole)i);
+    g_outsideFusion.reset();
+    g_returnFusion.reset();
+    publishTemps();
   }
 
   void invalidateDallasBackedRoles() {
+    IoLock lock;
     begin();
     clearDallasBackedRoleCaches();
+    publishTemps();
   }
 
   String romToHex(uint64_t rom) {
@@ -607,7 +916,7 @@ namespace TemperatureManager {
     for (const auto &r : kRoleBindings) {
       const char* key = (r.role == TempRole::DhwTank) ? "dhw" : r.key;
       TempValue v = get(r.role, 600000);
-      if (v.valid) out[key] = v.c; else out[key] = nullptr;
+      putCentiJson(out[key], v.centi);
       // sources
       String sk = String(key) + "Src";
       const char* src = nullptr;
@@ -620,22 +929,15 @@ namespace TemperatureManager {
       out[sk] = src;
 
       if (r.role == TempRole::DhwTank) {
-        if (v.valid) out["dhw_tank"] = v.c; else out["dhw_tank"] = nullptr;
+        putCentiJson(out["dhw_tank"], v.centi);
         out["dhw_tankSrc"] = src;
       }
 
       if (r.role == TempRole::Return) {
-        if (v.valid) {
-          out["returnTempC"] = v.c;
-          out["flowReturnC"] = v.c;
-          out["returnFlowC"] = v.c;
-          out["return.flow"] = v.c;
-        } else {
-          out["returnTempC"] = nullptr;
-          out["flowReturnC"] = nullptr;
-          out["returnFlowC"] = nullptr;
-          out["return.flow"] = nullptr;
-        }
+        putCentiJson(out["returnTempC"], v.centi);
+        putCentiJson(out["flowReturnC"], v.centi);
+        putCentiJson(out["returnFlowC"], v.centi);
+        putCentiJson(out["return.flow"], v.centi);
         out["returnTempSrc"] = src;
         out["flowReturnSrc"] = src;
         out["returnFlowSrc"] = src;
@@ -644,7 +946,7 @@ namespace TemperatureManager {
         // Dedicated B branch temperature (Dallas-only Return role).
         const TempValue returnDallas = getDallasReturn(600000);
         const char* returnDallasSrc = returnDallas.valid ? "dallas" : nullptr;
-        if (returnDallas.valid) out["returnDallasC"] = returnDallas.c; else out["returnDallasC"] = nullptr;
+        putCentiJson(out["returnDallasC"], returnDallas.centi);
         out["returnDallasSrc"] = returnDallasSrc;
 
         // Backward-compatible afterMix fields now mirror hydraulic port AB,
@@ -657,7 +959,7 @@ namespace TemperatureManager {
           case TempSource::Ble: mixSrc = "ble"; break;
           default: mixSrc = nullptr; break;
         }
-        if (mix.valid) out["afterMixC"] = mix.c; else out["afterMixC"] = nullptr;
+        putCentiJson(out["afterMixC"], mix.centi);
         out["afterMixSrc"] = mixSrc;
       }
     }
@@ -677,7 +979,21 @@ namespace TemperatureManager {
   }
 
   void fillDallasJson(JsonObject out) {
+    IoLock lock;
     out["enabled"] = ConfigStore::getDallasEnabled();
+    out["schedule"] = DallasController::parallelConversion() ? "parallel" : "sequential";
+    out["cycleMs"] = DallasController::lastParallelCycleMs();
+    {
+      const DallasDriverStats ds = DallasController::getDriverStats();
+      JsonObject drv = out.createNestedObject("driver");
+      drv["pinSwitching"] = ds.pinSwitching;
+      drv["cycleSetupUs"] = ds.cycleSetupUs;
+      drv["cycleTrafficUs"] = ds.cycleTrafficUs;
+      drv["cycleCreates"] = ds.cycleCreates;
+      drv["cycleSwitches"] = ds.cycleSwitches;
+      drv["creates"] = ds.totalCreates;
+      drv["switches"] = ds.totalSwitches;
+    }
 
     JsonObject roles = out.createNestedObject("roles");
     JsonArray available = out.createNestedArray("availableRoles");
@@ -702,6 +1018,19 @@ namespace TemperatureManager {
       r["ageMs"] = v.valid ? (uint32_t)v.ageMs : 0;
       if (v.valid && v.gpio != 255) r["resolvedGpio"] = (int)v.gpio; else r["resolvedGpio"] = nullptr;
       if (v.src == TempSource::Dallas && v.rom) r["resolvedRom"] = romToHex(v.rom); else r["resolvedRom"] = nullptr;
+      {
+        // Same filter instance that produced currentC.
+        const TempConditioner &f =
+          g_cond[def.role == TempRole::Return ? (uint8_t)TempRole::COUNT : (uint8_t)def.role].f;
+        if (isfinite(f.lastRaw())) r["rawC"] = f.lastRaw(); else r["rawC"] = nullptr;
+        if (v.valid && isfinite(v.rateCps)) r["rateCps"] = v.rateCps; else r["rateCps"] = nullptr;
+        r["median"] = f.config().medianN;
+        r["tauS"] = (float)f.config().tauMs / 1000.0f;
+        r["rejected"] = f.rejected();
+        r["spikes"] = f.spikes();
+      }
+      if (def.role == TempRole::Outside) fillFusionJson(r.createNestedObject("fusion"), g_outsideFusion, kOutsideSources);
+      if (def.role == TempRole::Return) fillFusionJson(r.createNestedObject("fusion"), g_returnFusion, kReturnSources);
 
       JsonObject a = available.createNestedObject();
       a["key"] = def.key;
@@ -747,16 +1076,38 @@ namespace TemperatureManager {
       b["gpio"] = (int)gpio;
       b["status"] = st ? (int)st->status : (int)TEMP_STATUS_DISABLED;
       b["lastReadMs"] = st ? (uint32_t)st->lastReadMs : 0;
+      b["convMs"] = DallasController::busConversionMs(gpio);
+      b["periodMs"] = DallasController::busPeriodMs(gpio);
+      b["parasite"] = DallasController::busParasite(gpio);
       JsonArray devs = b.createNestedArray("devs");
       if (st) {
         // stable order
-        std::vector<DallasDeviceInfo> dv = st->devices;
-        std::sort(dv.begin(), dv.end(), [](const DallasDeviceInfo& a, const DallasDeviceInfo& b){ return a.rom < b.rom; });
-        for (auto &d : dv) {
+        const DallasDeviceInfo* dv[DALLAS_MAX_DEVICES_PER_GPIO];
+        uint8_t n = 0;
+        for (const auto &d : st->devices) {
+          uint8_t i = n++;
+          while (i > 0 && dv[i - 1]->rom > d.rom) { dv[i] = dv[i - 1]; i--; }
+          dv[i] = &d;
+        }
+        for (uint8_t i = 0; i < n; i++) {
+          const DallasDeviceInfo& d = *dv[i];
           JsonObject dd = devs.createNestedObject();
           dd["rom"] = romToHex(d.rom);
           if (d.valid && isfinite(d.temperature)) dd["c"] = d.temperature; else dd["c"] = nullptr;
           dd["ok"] = (bool)(d.valid && isfinite(d.temperature));
+          dd["res"] = d.resolution;
+          const uint8_t want = DallasController::configuredResolution(d.rom);
+          if (want) dd["resCfg"] = want; else dd["resCfg"] = nullptr;
+          DallasSensorHealth h;
+          if (DallasController::getSensorHealth(d.rom, h)) {
+            JsonObject hh = dd.createNestedObject("health");
+            hh["reads"] = h.reads;
+            hh["crcErrors"] = h.crcErrors;
+            hh["noPresence"] = h.noPresence;
+            hh["busErrors"] = h.busErrors;
+            hh["retries"] = h.retries;
+            hh["failures"] = h.failures;
+          }
         }
       }
     }
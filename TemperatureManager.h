@@ -3,9 +3,15 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
+#include "TempCenti.h"
+#include "TempConditioner.h"
+
 // Central temperature registry.
 // Goal: every subsystem (console, web UI, logic) reads temperatures consistently
 // via roles, regardless of source (OpenTherm / DS18B20 / BLE).
+// loop() runs on the I/O task. The getters read a published snapshot and take
+// no lock; configuration, subscriptions and diagnostics take IoLock
+// (TaskDomains.h), so the network task can call them.
 
 enum class TempRole : uint8_t {
   // Boiler / system (preferred: OpenTherm)
@@ -37,6 +43,8 @@ struct TempValue {
   bool valid = false;
   TempSource src = TempSource::None;
   uint32_t ageMs = 0;
+  float rateCps = NAN;  // conditioned rate of change, C/s (NAN until known)
+  TempCenti centi = kTempCentiInvalid;  // c in hundredths, for encoders (TempCenti.h)
 
   // Dallas diagnostics (if src == Dallas)
   uint8_t gpio = 255;
@@ -62,6 +70,17 @@ namespace TemperatureManager {
     const char* label;
   };
 
+  // Source key resolved once (at config load) so hot paths skip the string
+  // normalisation of getBySourceKey().
+  enum class SourceId : uint8_t {
+    None = 0,
+    TankMid,       // "tank_mid"      -> TankMid role
+    ReturnDallas,  // "return_dallas" -> getDallasReturn()
+    OpenThermCh    // "opentherm_ch"  -> Flow role, OpenTherm only
+  };
+  SourceId resolveSourceKey(const String& key);
+  TempValue getBySource(SourceId id, uint32_t maxAgeMs = 600000);
+
   // Resolve a configured source key to a live temperature:
   // tank_mid, return_dallas, opentherm_ch, or none.
   // return_dallas always reads the dedicated DS18B20 Return role and is never
@@ -89,6 +108,19 @@ namespace TemperatureManager {
   uint64_t getRoleRom(TempRole role);
   void setRoleRom(TempRole role, uint64_t rom);
 
+  // Per-role signal conditioning (TempConditioner.h): plausibility check,
+  // median-of-N, low-pass, rate of change. Applies to whichever source
+  // currently feeds the role; the Dallas-only return uses the Return setting.
+  void setRoleFilter(TempRole role, const TempConditionerConfig& cfg);
+  TempConditionerConfig getRoleFilter(TempRole role);
+
+  struct RoleFilterStats {
+    float rawC = NAN;        // last sample before conditioning
+    uint32_t rejected = 0;   // implausible samples dropped
+    uint32_t spikes = 0;     // samples overridden by the median
+  };
+  RoleFilterStats getRoleFilterStats(TempRole role);
+
   // Cache invalidation helpers. Useful after config/source changes.
   void invalidateRole(TempRole role);
   void invalidateAll();
@@ -97,7 +129,43 @@ namespace TemperatureManager {
   String romToHex(uint64_t rom);
   bool parseRomHex(const String& s, uint64_t& out);
 
+  // ---- Change notifications ----
+  // A subscriber names the values it cares about as a bit mask (roleBit() /
+  // sourceBit()) and is notified from loop() only when one of them changes
+  // by at least minDeltaC, changes source, or becomes valid / invalid
+  // (including going stale past maxAgeMs). Value changes are delivered at
+  // most once per minIntervalMs; validity changes are delivered at once.
+  // Notification is a callback and/or a dirty mask collected with
+  // takeChanged(). The first loop() after subscribe() reports every bit.
+  typedef uint16_t ChangeMask;
+  typedef void (*ChangeCallback)(ChangeMask changed, void* ctx);
+
+  constexpr ChangeMask roleBit(TempRole role) { return (ChangeMask)(1u << (uint8_t)role); }
+  // The Dallas-only return value (getDallasReturn()) has its own bit.
+  constexpr ChangeMask kDallasReturnBit = (ChangeMask)(1u << (uint8_t)TempRole::COUNT);
+  constexpr ChangeMask kAllTempsMask = (ChangeMask)((kDallasReturnBit << 1) - 1);
+  ChangeMask sourceBit(SourceId id);
+
+  // Returns a handle (>= 0) or -1 when all subscriber slots are taken.
+  int8_t subscribe(ChangeMask mask, float minDeltaC, uint32_t minIntervalMs,
+                   uint32_t maxAgeMs = 600000, ChangeCallback cb = nullptr, void* ctx = nullptr);
+  void unsubscribe(int8_t handle);
+  // Bits notified since the last call; clears them.
+  ChangeMask takeChanged(int8_t handle);
+
   // JSON helpers
+  // Stores a fixed-point value as a pre-formatted JSON number (null when
+  // invalid), so serialisation copies digits instead of formatting a float.
+  template <class TSlot>
+  inline void putCentiJson(TSlot slot, TempCenti v) {
+    if (!tempCentiValid(v)) {
+      slot = nullptr;
+      return;
+    }
+    char buf[kTempCentiTextMax];
+    const uint8_t n = tempCentiFormat(v, buf);
+    slot = serialized(buf, n);  // char* is copied into the document
+  }
   void fillTempsJson(JsonObject out);
   void fillDallasJson(JsonObject out);
 }
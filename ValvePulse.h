@@ -0,0 +1,88 @@
+#pragma once
+
+// Timing of one mixing-valve pulse as the relay driver performed it.
+// Arduino-free (times are passed in) so it can be driven by a virtual clock
+// on a host (tools/valve_pulse_bench.cpp).
+//
+// The verified ON write of the valve relay pair starts the pulse. It ends at
+// the OFF write issued by the stop timer once the deadline has passed, or
+// earlier when the pair is switched by anyone else (stop, direction change,
+// manual relay command). The on-time is measured between the two writes, so
+// the position model integrates what the actuator really got rather than
+// what was requested. A stop timer that fires for a pulse that has already
+// been replaced finds the new one not due and does nothing.
+//
+// Times are micros() values; the arithmetic is wrap-safe for pulses up to
+// ~35 min.
+
+#include <stdint.h>
+
+class ValvePulse {
+public:
+  // Returns the pulse sequence number, never 0.
+  uint32_t start(int8_t dir, uint32_t onUs, uint32_t durationUs) {
+    if (++_seq == 0) _seq = 1;
+    _active = true;
+    _dir = dir;
+    _onUs = onUs;
+    _durationUs = durationUs;
+    _onTimeUs = 0;
+    _endLateUs = 0;
+    _endedByTimer = false;
+    return _seq;
+  }
+
+  bool due(uint32_t nowUs) const {
+    return _active && (int32_t)(nowUs - _onUs) >= 0 && nowUs - _onUs >= _durationUs;
+  }
+
+  // Time left until the deadline, 0 when due or not active.
+  uint32_t remainingUs(uint32_t nowUs) const {
+    if (!_active || due(nowUs)) return 0;
+    const int32_t since = (int32_t)(nowUs - _onUs);
+    return since < 0 ? _durationUs : _durationUs - (uint32_t)since;
+  }
+
+  // Stop timer: ends the pulse only when it is due.
+  bool expire(uint32_t offUs) {
+    if (!due(offUs)) return false;
+    finish(offUs, true);
+    return true;
+  }
+
+  // The pair was switched off by a caller, before or after the deadline.
+  void end(uint32_t offUs) {
+    if (_active) finish(offUs, false);
+  }
+
+  bool active() const { return _active; }
+  int8_t dir() const { return _active ? _dir : 0; }
+  uint32_t seq() const { return _seq; }
+  uint32_t durationUs() const { return _durationUs; }
+  uint32_t elapsedUs(uint32_t nowUs) const {
+    return _active && (int32_t)(nowUs - _onUs) > 0 ? nowUs - _onUs : 0;
+  }
+
+  // Of the last ended pulse.
+  uint32_t onTimeUs() const { return _onTimeUs; }
+  uint32_t endLateUs() const { return _endLateUs; }  // 0 when ended early
+  bool endedByTimer() const { return _endedByTimer; }
+
+private:
+  void finish(uint32_t offUs, bool byTimer) {
+    const int32_t on = (int32_t)(offUs - _onUs);
+    _onTimeUs = on > 0 ? (uint32_t)on : 0;
+    _endLateUs = _onTimeUs > _durationUs ? _onTimeUs - _durationUs : 0;
+    _endedByTimer = byTimer;
+    _active = false;
+  }
+
+  uint32_t _seq = 0;
+  bool _active = false;
+  int8_t _dir = 0;
+  uint32_t _onUs = 0;
+  uint32_t _durationUs = 0;
+  uint32_t _onTimeUs = 0;
+  uint32_t _endLateUs = 0;
+  bool _endedByTimer = false;
+};
@@ -24,6 +24,7 @@
 #include "TemperatureManager.h"
 
 #include "OpenThermController.h"
+#include "OpenThermDataIds.h"
 #include "BleController.h"
 #include "NetworkController.h"
 #include "OtaController.h"
@@ -31,10 +32,13 @@
 #include "MqttController.h"
 #include "DhwController.h"
 #include "PressureAlarmController.h"
+#include "BoilerEnergyController.h"
 #include "BuzzerController.h"
 #include "EventLog.h"
 #include "HistoryBuffer.h"
+#include "AllocCounter.h"
 #include "ConfigRuntime.h"
+#include "TaskDomains.h"
 #include "config_pins.h"
 
 namespace {
@@ -368,7 +372,7 @@ namespace {
 
   static bool allowAction(const char* key, unsigned long minIntervalMs, uint16_t maxPerWindow, unsigned long windowMs, const char* detailOnBlock) {
     static RateLimitEntry entries[] = {
-      {"relay"}, {"config"}, {"reboot"}, {"system_cmd"}, {"dhw_cmd"}, {"ot_cmd"}, {"eq_cmd"}, {"ot_scan_start"}, {"ot_scan_stop"},
+      {"relay"}, {"config"}, {"reboot"}, {"system_cmd"}, {"dhw_cmd"}, {"ot_cmd"}, {"eq_cmd"}, {"ot_scan_start"}, {"ot_scan_stop"}, {"ot_energy_clear"},
       {"ot_data_write"}, {"cfg_inputs"}, {"cfg_ot"}, {"cfg_ble"}, {"cfg_dallas"}, {"cfg_ota"}, {"cfg_mqtt"},
       {"cfg_time"}, {"cfg_eq"}, {"cfg_dhw"}, {"cfg_alerts"}, {"cfg_apply"}, {"cfg_import"}, {"cfg_export"},
       {"fs_write"}, {"fs_mkdir"}, {"fs_rename"}, {"fs_delete"}, {"fs_upload"}, {"fw_update"}, {"fs_update"}
@@ -400,9 +404,14 @@ namespace {
     out["minFree"] = (uint32_t)ESP.getMinFreeHeap();
     out["maxAlloc"] = (uint32_t)ESP.getMaxAllocHeap();
     out["psramFree"] = (uint32_t)ESP.getFreePsram();
+    if (allocCounterSupported()) {
+      const AllocLoopStats ls = allocCounterGetLoopStats();
+      out["allocPerLoop"] = ls.lastPerLoop;
+      out["allocPerLoopMax"] = ls.maxPerLoop;
+    }
   }
 
-  static void fillFastWsStateObject(JsonObject out) {
+  static void fillFastWsStateObject(JsonObject out, bool withTemps) {
     JsonObject sys = out.createNestedObject("sys");
     const bool wifiOk = networkIsWifiConnected();
     const bool ethOk = networkIsEthernetConnected();
@@ -423,8 +432,10 @@ namespace {
     JsonObject system = out.createNestedObject("system");
     system["uptimeSec"] = (uint32_t)(millis() / 1000UL);
 
-    JsonObject temps = out.createNestedObject("temps");
-    fillTemps(temps);
+    if (withTemps) {
+      JsonObject temps = out.createNestedObject("temps");
+      fillTemps(temps);
+    }
 
     JsonObject rel = out.createNestedObject("rel");
     rel["mask"] = relayGetMask();
@@ -476,12 +487,20 @@ namespace {
     // the outgoing WebSocket frame. The previous version serialized each
     // section into a String and then parsed it back into another JSON document;
     // avoiding that parse cycle reduces heap churn and CPU load on ESP32.
+    // Temperatures are rebuilt only when TemperatureManager reports a change
+    // (or for a full frame).
+    static int8_t s_tempSub = -1;
+    if (s_tempSub < 0) s_tempSub = TemperatureManager::subscribe(TemperatureManager::kAllTempsMask, 0.0f, 0);
+    const bool full = forceFull || !g_fastCache.primed;
+    const bool tempsChanged = s_tempSub < 0 || TemperatureManager::takeChanged(s_tempSub) != 0;
+    const bool withTemps = full || tempsChanged;
+
     DynamicJsonDocument curDoc(4096);
     JsonObject cur = curDoc.to<JsonObject>();
-    fillFastWsStateObject(cur);
+    fillFastWsStateObject(cur, withTemps);
 
     const String sysStr = serializeJsonVariant(cur["sys"]);
-    const String tempsStr = serializeJsonVariant(cur["temps"]);
+    const String tempsStr = withTemps ? serializeJsonVariant(cur["temps"]) : g_fastCache.temps;
     const String relStr = serializeJsonVariant(cur["rel"]);
     const String inStr = serializeJsonVariant(cur["in"]);
     const String otStr = serializeJsonVariant(cur["ot"]);
@@ -494,7 +513,7 @@ namespace {
 
     DynamicJsonDocument doc(4096);
     doc["seq"] = ++g_fastCache.seq;
-    if (forceFull || !g_fastCache.primed) {
+    if (full) {
       doc["type"] = "fast_full";
       doc.createNestedObject("data").set(cur);
       g_fastCache = {sysStr, tempsStr, relStr, inStr, otStr, bleStr, otaStr, timeStr, eqStr, dhwStr, alertsStr, true, g_fastCache.seq};
@@ -1029,13 +1048,17 @@ namespace {
     }
 
     String dhwErr;
-    const bool dhwOk = dhwHandleCmdJson("{\"command\":\"safeStop\"}", dhwErr);
-    relaySet((RelayId)kRelayMixOpenIdx, false);
-    relaySet((RelayId)kRelayMixCloseIdx, false);
-    relaySet((RelayId)kRelayDhwValveIdx, false);
-    relaySet((RelayId)kRelayDhwCircIdx, false);
-    relaySet((RelayId)kRelayDhwBoilerIdx, false);
-    relaySet((RelayId)kRelayAccuHeaterIdx, false);
+    bool dhwOk = false;
+    {
+      RelayTransaction relayTx;  // all outputs OFF in one expander write
+      dhwOk = dhwHandleCmdJson("{\"command\":\"safeStop\"}", dhwErr);
+      relaySet((RelayId)kRelayMixOpenIdx, false);
+      relaySet((RelayId)kRelayMixCloseIdx, false);
+      relaySet((RelayId)kRelayDhwValveIdx, false);
+      relaySet((RelayId)kRelayDhwCircIdx, false);
+      relaySet((RelayId)kRelayDhwBoilerIdx, false);
+      relaySet((RelayId)kRelayAccuHeaterIdx, false);
+    }
 
     DynamicJsonDocument out(512);
     out["ok"] = dhwOk;
@@ -1159,6 +1182,9 @@ namespace {
     out["mode"] = oc.mode;
     out["boilerControl"] = oc.boilerControl;
     out["allowRawWrite"] = oc.allowRawWrite;
+    out["runInTask"] = oc.runInTask;
+    JsonArray pollIds = out.createNestedArray("pollIds");
+    for (uint8_t i = 0; i < oc.pollIdsCount; i++) pollIds.add(oc.pollIds[i]);
   }
 
   static void fillBleSectionJson(JsonObject out) {
@@ -1170,6 +1196,25 @@ namespace {
 
   static void fillDallasSectionJson(JsonObject out) {
     out["enabled"] = ConfigStore::getDallasEnabled();
+    out["parallel"] = ConfigStore::getDallasParallel();
+    {
+      uint64_t roms[8];
+      uint8_t bits[8];
+      const uint8_t n = ConfigStore::getDallasResolutions(roms, bits, 8);
+      JsonObject res = out.createNestedObject("resolutions");
+      for (uint8_t i = 0; i < n; i++) res[TemperatureManager::romToHex(roms[i])] = bits[i];
+    }
+    {
+      JsonObject filters = out.createNestedObject("filters");
+      for (uint8_t i = 0; i < (uint8_t)TempRole::COUNT; i++) {
+        uint8_t median = 3;
+        uint32_t tauMs = 0;
+        ConfigStore::getTempFilter(i, median, tauMs);
+        JsonObject f = filters.createNestedObject(TemperatureManager::roleName((TempRole)i));
+        f["median"] = median;
+        f["tauS"] = (float)tauMs / 1000.0f;
+      }
+    }
     JsonObject roles = out.createNestedObject("roles");
     size_t roleCount = 0;
     const auto* bindings = TemperatureManager::getDallasRoleBindings(roleCount);
@@ -1717,6 +1762,17 @@ namespace {
     if (o.containsKey("bootDelayMs")) ConfigStore::setOtBootDelayMs((uint32_t)(o["bootDelayMs"] | 15000));
     if (o.containsKey("mode")) ConfigStore::setOtMode(String((const char*)o["mode"]));
     if (o.containsKey("allowRawWrite")) ConfigStore::setOtAllowRawWrite((bool)(o["allowRawWrite"] | false));
+    if (o.containsKey("runInTask")) ConfigStore::setOtRunInTask((bool)(o["runInTask"] | false));
+    if (o["pollIds"].is<JsonArrayConst>()) {
+      uint8_t ids[32];
+      uint8_t n = 0;
+      for (JsonVariantConst v : o["pollIds"].as<JsonArrayConst>()) {
+        if (n >= sizeof(ids)) break;
+        const int id = v | -1;
+        if (id > 0 && id <= 127) ids[n++] = (uint8_t)id;
+      }
+      ConfigStore::setOtPollIds(ids, n);
+    }
   }
 
   static void applyBleSection(JsonObjectConst b) {
@@ -1803,6 +1859,46 @@ namespace {
       applyDallasEnabled(en);
       changed = true;
     }
+    if (d.containsKey("parallel")) {
+      const bool par = (bool)d["parallel"];
+      ConfigStore::setDallasParallel(par);
+      DallasController::setParallelConversion(par);
+    }
+    if (d["resolutions"].is<JsonObjectConst>()) {
+      uint64_t roms[8];
+      uint8_t bits[8];
+      uint8_t n = 0;
+      for (JsonPairConst kv : d["resolutions"].as<JsonObjectConst>()) {
+        if (n >= 8) break;
+        uint64_t rom = 0;
+        const int b = kv.value() | 0;
+        if (!TemperatureManager::parseRomHex(String(kv.key().c_str()), rom)) continue;
+        if (b < 9 || b > 12) continue;
+        roms[n] = rom;
+        bits[n] = (uint8_t)b;
+        n++;
+      }
+      ConfigStore::setDallasResolutions(roms, bits, n);
+      DallasController::setResolutions(roms, bits, n);
+      changed = true;
+    }
+    if (d["filters"].is<JsonObjectConst>()) {
+      JsonObjectConst ff = d["filters"].as<JsonObjectConst>();
+      for (uint8_t i = 0; i < (uint8_t)TempRole::COUNT; i++) {
+        const TempRole role = (TempRole)i;
+        JsonObjectConst fo = ff[TemperatureManager::roleName(role)];
+        if (fo.isNull()) continue;
+        TempConditionerConfig f = TemperatureManager::getRoleFilter(role);
+        if (fo.containsKey("median")) f.medianN = (uint8_t)(fo["median"] | 3);
+        if (fo.containsKey("tauS")) {
+          const float tau = fo["tauS"] | 0.0f;
+          f.tauMs = tau > 0.0f ? (uint32_t)(tau * 1000.0f + 0.5f) : 0;
+        }
+        ConfigStore::setTempFilter(i, f.medianN, f.tauMs);
+        ConfigStore::getTempFilter(i, f.medianN, f.tauMs);
+        TemperatureManager::setRoleFilter(role, f);
+      }
+    }
     if (d.containsKey("roles") && d["roles"].is<JsonObjectConst>()) {
       JsonObjectConst rr = d["roles"].as<JsonObjectConst>();
       size_t roleCount = 0;
@@ -1855,6 +1951,9 @@ namespace {
       }
     }
     if (changed) {
+      // loop() belongs to the I/O task; run it here under its lock so the
+      // response already shows the new roles.
+      IoLock lock;
       TemperatureManager::invalidateDallasBackedRoles();
       TemperatureManager::loop();
     }
@@ -1983,6 +2082,57 @@ namespace {
     sendJson(200, openthermGetStatusJson());
   }
 
+  static void handleOpenThermPollStats() {
+    sendJson(200, openthermGetPollStatsJson());
+  }
+
+  static void handleOpenThermIdStats() {
+    sendJson(200, openthermGetIdStatsJson());
+  }
+
+  static void handleOpenThermEnergy() {
+    sendJson(200, boilerEnergyGetJson());
+  }
+
+  static void handleOpenThermEnergyClear() {
+    if (rejectActionRateLimit("ot_energy_clear", 5000UL, 3, 60000UL, "energy_clear_guard")) return;
+    const bool ok = boilerEnergyClear();
+    DynamicJsonDocument out(128);
+    out["ok"] = ok;
+    sendJsonDoc(ok ? 200 : 500, out);
+    recordAdminAction("ot_energy_clear", ok, ok ? "cleared" : "write failed");
+  }
+
+  // Binary frame trace dump (OpenThermTrace.h layout), streamed in small
+  // chunks so the ring is never copied whole. Stops early if the recorder
+  // overwrites records that have not been sent yet.
+  static void handleOpenThermTrace() {
+    OpenThermTraceHeader hdr;
+    const uint32_t end = openthermTraceBegin(hdr);
+    g_srv.sendHeader("Cache-Control", "no-store");
+    g_srv.sendHeader("Content-Disposition", "attachment; filename=\"ot_trace.bin\"");
+    g_srv.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    g_srv.send(200, "application/octet-stream", "");
+    g_srv.sendContent((const char*)&hdr, sizeof(hdr));
+
+    OpenThermTraceRecord buf[32];
+    uint32_t seq = hdr.firstSeq;
+    while (seq < end) {
+      const uint32_t left = end - seq;
+      const size_t want = left < 32 ? (size_t)left : 32;
+      const size_t n = openthermTraceRead(seq, buf, want);
+      if (n == 0) break;
+      g_srv.sendContent((const char*)buf, n * sizeof(OpenThermTraceRecord));
+      seq += (uint32_t)n;
+    }
+  }
+
+  static void handleOpenThermTraceReplay() {
+    const uint32_t from = g_srv.hasArg("from") ? (uint32_t)g_srv.arg("from").toInt() : 0;
+    const uint16_t limit = g_srv.hasArg("limit") ? (uint16_t)g_srv.arg("limit").toInt() : 0;
+    sendJson(200, openthermTraceReplayJson(from, limit));
+  }
+
   static void handleOpenThermCmd() {
     if (rejectActionRateLimit("ot_cmd", 250UL, 12, 10000UL, "ot_guard")) return;
     const String body = g_srv.arg("plain");
@@ -2004,6 +2154,10 @@ namespace {
     sendJson(200, openthermGetScanProfileJson());
   }
 
+  static void handleOpenThermProtocol() {
+    sendJson(200, openthermGetProtocolJson());
+  }
+
   static void handleOpenThermScanStart() {
     if (rejectActionRateLimit("ot_scan_start", 3000UL, 3, 60000UL, "scan_start_guard")) return;
     const String body = g_srv.arg("plain");
@@ -2592,6 +2746,12 @@ void webPortalInit() {
   g_srv.on("/api/reboot", HTTP_POST, handleReboot);
 
   g_srv.on("/api/opentherm/status", HTTP_GET, handleOpenThermStatus);
+  g_srv.on("/api/opentherm/poll", HTTP_GET, handleOpenThermPollStats);
+  g_srv.on("/api/opentherm/stats", HTTP_GET, handleOpenThermIdStats);
+  g_srv.on("/api/opentherm/energy", HTTP_GET, handleOpenThermEnergy);
+  g_srv.on("/api/opentherm/energy/clear", HTTP_POST, handleOpenThermEnergyClear);
+  g_srv.on("/api/opentherm/trace", HTTP_GET, handleOpenThermTrace);
+  g_srv.on("/api/opentherm/trace/replay", HTTP_GET, handleOpenThermTraceReplay);
   g_srv.on("/api/dhw/status", HTTP_GET, handleDhwStatus);
   g_srv.on("/api/dhw/cmd", HTTP_POST, handleDhwCmd);
   g_srv.on("/api/opentherm/cmd", HTTP_POST, handleOpenThermCmd);
@@ -2600,6 +2760,7 @@ void webPortalInit() {
   g_srv.on("/api/equitherm/cmd", HTTP_POST, handleEquithermCmd);
   g_srv.on("/api/opentherm/scan/status", HTTP_GET, handleOpenThermScanStatus);
   g_srv.on("/api/opentherm/scan/profile", HTTP_GET, handleOpenThermScanProfile);
+  g_srv.on("/api/opentherm/protocol", HTTP_GET, handleOpenThermProtocol);
   g_srv.on("/api/opentherm/scan/start", HTTP_POST, handleOpenThermScanStart);
   g_srv.on("/api/opentherm/scan/stop", HTTP_POST, handleOpenThermScanStop);
 
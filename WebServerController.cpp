@@ -11,6 +11,7 @@
 
 #include "LogicController.h"
 #include "OpenThermController.h"
+#include "OpenThermDataIds.h"
 #include "DallasController.h"
 #include "NetworkController.h"
 #include "RelayController.h"
@@ -443,6 +444,7 @@ namespace {
     c["assumedMaxBoilerKw"] = cfg.assumedMaxBoilerKw;
     c["invertTx"] = cfg.invertTx;
     c["invertRx"] = cfg.invertRx;
+    c["rxBackend"] = cfg.rxBackend;
     c["autoDetectLogic"] = cfg.autoDetectLogic;
     c["logEnabled"] = nullptr;
     c["logIntervalMs"] = nullptr;
@@ -54,6 +54,11 @@
 #define TCA9554_ADDR 0x20
 #endif
 
+// PCF85063 RTC
+#ifndef PCF85063_ADDR
+#define PCF85063_ADDR 0x51
+#endif
+
 // OpenTherm adapter (default suggestion)
 #define OT_TX_PIN 47
 #define OT_RX_PIN 48
@@ -2904,7 +2904,7 @@ function otSetBadge(id, kind, text){
 function otFmtVal(it){
   if(!it) return "--";
   if(it.f88 != null && isFinite(Number(it.f88))) return Number(it.f88).toFixed(2) + (it.unit ? " " + it.unit : "");
-  if(it.s16 != null && isFinite(Number(it.s16))) return String(it.s16) + (it.unit ? " " + it.unit : "");
+  if(it.celsius != null && isFinite(Number(it.celsius))) return String(it.celsius) + (it.unit ? " " + it.unit : "");
   if(it.upper != null || it.lower != null) return `${it.upper ?? "--"}/${it.lower ?? "--"}${it.unit ? " " + it.unit : ""}`;
   if(it.val != null) return "raw=" + it.val;
   return "--";
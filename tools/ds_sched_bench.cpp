@@ -0,0 +1,204 @@
+// Host check for the DS18B20 conversion scheduler (DallasScheduler.h).
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -I. tools/ds_sched_bench.cpp -o /tmp/ds_sched_bench
+//   /tmp/ds_sched_bench
+//
+// Drives the scheduler with a virtual clock against a fake OneWire32 that
+// models the four DallasController buses with the default role layout
+// (outside on GPIO0, DHW return on GPIO1, return on GPIO2, three tank
+// sensors on GPIO3). Every bus operation advances the clock by a typical
+// RMT transaction time, so a step() that talks to the bus is as slow as it
+// would be on the target. For each role the tool reports the interval
+// between fresh readings in Sequential and Parallel mode, and how much bus
+// time goes to driver setup (RMT re-creation vs. GPIO matrix re-route,
+// OneWire32::switchPin()) versus 1-Wire traffic. The last scenarios set the
+// mixing-valve feedback (return) sensor to 9-bit, with and without parasite
+// power (done-bit polling vs. timed wait). It fails if a scratchpad was read
+// before its conversion finished.
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "../DallasScheduler.h"
+
+namespace {
+
+constexpr uint8_t kBuses = 4;
+
+// Cost model (us), roughly what OneWireESP32.cpp spends per call.
+constexpr uint32_t kDriverSetupUs = 1500;  // new/delete of RMT channels
+constexpr uint32_t kPinSwitchUs = 30;      // GPIO matrix re-route
+constexpr uint32_t kResetUs = 1000;
+constexpr uint32_t kByteUs = 600;
+constexpr uint32_t kSearchPerDevUs = 64 * 3 * 100;
+constexpr uint32_t kReadSlotUs = 70;
+
+// Datasheet max conversion time and the (shorter) typical one the fake uses.
+uint32_t maxConvUs(uint8_t bits) { return 93750u << (bits - 9); }
+uint32_t typConvUs(uint8_t bits) { return maxConvUs(bits) * 8 / 10; }
+// Same margins as DallasController.cpp conversionMsFor().
+uint32_t waitMs(uint8_t bits) { return bits == 9 ? 100 : bits == 10 ? 200 : bits == 11 ? 400 : 800; }
+
+struct FakeSensor {
+  const char* role;
+  uint8_t bits = 12;
+  uint64_t convertDoneUs = 0;
+  bool converted = false;
+  // stats
+  uint64_t lastFreshUs = 0;
+  uint32_t reads = 0;
+  uint64_t sumIntervalUs = 0;
+  uint64_t maxIntervalUs = 0;
+};
+
+// Stand-in for OneWire32: one driver instance at a time, bound to one GPIO.
+struct FakeOneWire32 {
+  uint64_t nowUs = 0;
+  bool pinSwitch = false;
+  int boundGpio = -1;
+  uint32_t driverSwitches = 0;
+  uint32_t staleReads = 0;
+  uint64_t setupUs = 0;
+  uint64_t trafficUs = 0;
+  std::vector<FakeSensor> bus[kBuses];
+  bool parasite[kBuses] = {};
+
+  void bind(uint8_t gpio) {
+    if (boundGpio == (int)gpio) return;
+    const uint32_t c = (pinSwitch && boundGpio >= 0) ? kPinSwitchUs : kDriverSetupUs;
+    boundGpio = gpio;
+    driverSwitches++;
+    nowUs += c;
+    setupUs += c;
+  }
+  void traffic(uint32_t us) {
+    nowUs += us;
+    trafficUs += us;
+  }
+  void convertAll(uint8_t gpio) {
+    bind(gpio);
+    traffic(kResetUs + 2 * kByteUs);
+    for (FakeSensor& s : bus[gpio]) {
+      s.convertDoneUs = nowUs + typConvUs(s.bits);
+      s.converted = true;
+    }
+  }
+  bool doneBit(uint8_t gpio) {
+    bind(gpio);
+    traffic(kReadSlotUs);
+    for (const FakeSensor& s : bus[gpio]) {
+      if (s.converted && nowUs < s.convertDoneUs) return false;
+    }
+    return true;
+  }
+  void readAll(uint8_t gpio) {
+    bind(gpio);
+    for (FakeSensor& s : bus[gpio]) {
+      traffic(kResetUs + (1 + 8 + 1 + 9) * kByteUs);
+      if (!s.converted || nowUs < s.convertDoneUs) {
+        staleReads++;
+        continue;
+      }
+      s.converted = false;
+      if (s.lastFreshUs) {
+        const uint64_t iv = nowUs - s.lastFreshUs;
+        s.sumIntervalUs += iv;
+        s.maxIntervalUs = std::max(s.maxIntervalUs, iv);
+        s.reads++;
+      }
+      s.lastFreshUs = nowUs;
+    }
+  }
+};
+
+struct FakeHal {
+  FakeOneWire32& ow;
+  bool known[kBuses] = {};
+
+  bool busEnabled(uint8_t) const { return true; }
+  bool hasDevices(uint8_t b) const { return known[b]; }
+  bool discover(uint8_t b) {
+    ow.bind(b);
+    ow.traffic(kResetUs + kSearchPerDevUs * (uint32_t)ow.bus[b].size());
+    known[b] = !ow.bus[b].empty();
+    return true;
+  }
+  bool startConversion(uint8_t b) { ow.convertAll(b); return true; }
+  void readTemperatures(uint8_t b) { ow.readAll(b); }
+  uint32_t conversionMs(uint8_t b) const {
+    uint32_t ms = 0;
+    for (const FakeSensor& s : ow.bus[b]) ms = std::max(ms, waitMs(s.bits));
+    return ms ? ms : 800;
+  }
+  bool canPollDone(uint8_t b) const { return !ow.parasite[b]; }
+  bool conversionDone(uint8_t b) { return ow.doneBit(b); }
+};
+
+struct Layout {
+  uint8_t returnBits = 12;
+  bool parasite = true;
+};
+
+void populate(FakeOneWire32& ow, const Layout& l) {
+  ow.bus[0] = {FakeSensor{"outside"}};
+  ow.bus[1] = {FakeSensor{"dhw_return", 10}};
+  ow.bus[2] = {FakeSensor{"return", l.returnBits}};
+  ow.bus[3] = {FakeSensor{"tank_top"}, FakeSensor{"tank_mid"}, FakeSensor{"tank_bottom", 11}};
+  for (bool& p : ow.parasite) p = l.parasite;
+}
+
+bool run(DallasSchedMode mode, bool pinSwitch, const char* label, const Layout& layout = Layout()) {
+  FakeOneWire32 ow;
+  ow.pinSwitch = pinSwitch;
+  populate(ow, layout);
+  FakeHal hal{ow};
+  DallasScheduler<FakeHal, kBuses> sched(hal);
+  sched.setMode(mode);
+
+  // 10 minutes of main loop, 2 ms between loop() iterations.
+  const uint64_t endUs = 600ull * 1000 * 1000;
+  uint64_t maxStepUs = 0;
+  while (ow.nowUs < endUs) {
+    const uint64_t t0 = ow.nowUs;
+    sched.step((uint32_t)(ow.nowUs / 1000));
+    maxStepUs = std::max(maxStepUs, ow.nowUs - t0);
+    ow.nowUs += 2000;
+  }
+
+  std::printf("%s\n", label);
+  std::printf("  %-12s %8s %10s %10s\n", "role", "reads", "avg ms", "max ms");
+  for (uint8_t b = 0; b < kBuses; b++) {
+    for (const FakeSensor& s : ow.bus[b]) {
+      const double avg = s.reads ? (double)s.sumIntervalUs / s.reads / 1000.0 : 0;
+      std::printf("  %-12s %8u %10.0f %10.0f\n", s.role, s.reads, avg, s.maxIntervalUs / 1000.0);
+    }
+  }
+  const double cyc = sched.cycles() ? (double)sched.cycles() : 1.0;
+  std::printf("  per cycle: driver setup %.0f us, 1-Wire traffic %.0f us (%u cycles)\n",
+              ow.setupUs / cyc, ow.trafficUs / cyc, sched.cycles());
+  std::printf("  driver switches/min %.0f, longest step %.1f ms, stale reads %u\n\n",
+              ow.driverSwitches / 10.0, maxStepUs / 1000.0, ow.staleReads);
+  return ow.staleReads == 0;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok &= run(DallasSchedMode::Sequential, false, "Sequential, driver re-created per switch");
+  ok &= run(DallasSchedMode::Parallel, false, "Parallel, driver re-created per switch");
+  ok &= run(DallasSchedMode::Sequential, true, "Sequential, pin re-routed");
+  ok &= run(DallasSchedMode::Parallel, true, "Parallel, pin re-routed");
+  ok &= run(DallasSchedMode::Parallel, true, "Parallel, return 9-bit, parasite (timed wait)",
+            Layout{9, true});
+  ok &= run(DallasSchedMode::Parallel, true, "Parallel, return 9-bit, external power (done-bit poll)",
+            Layout{9, false});
+  if (!ok) {
+    std::printf("FAIL: scratchpad read before conversion finished\n");
+    return 1;
+  }
+  std::printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,207 @@
+// Host check for the DS18B20 scratchpad CRC / retry logic
+// (DallasScratchpad.h).
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -I. tools/ds_scratchpad_bench.cpp -o /tmp/ds_scratchpad_bench
+//   /tmp/ds_scratchpad_bench
+//
+// 1) CRC8 against the Maxim AN27 example and a table-driven reference (the
+//    one OneWireESP32.cpp uses).
+// 2) Every 1-, 2- and 3-bit error in a real scratchpad must be rejected, as
+//    must the blank all-0x00 / all-0xFF reads.
+// 3) A fake bus flips each transferred bit with a given probability and
+//    drops the presence pulse now and then. For 100k reads per error rate it
+//    reports how many bus slots lose the reading without and with the single
+//    retry, and how many corrupted scratchpads got through. The health
+//    counters must match the injected faults exactly.
+
+#include <cstdio>
+#include <cstring>
+
+#include "../DallasScratchpad.h"
+
+namespace {
+
+struct Rng {
+  uint32_t s = 0x9E3779B9u;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  // true with probability p
+  bool chance(double p) { return (double)next() / 4294967296.0 < p; }
+};
+
+uint8_t s_table[256];
+
+void buildTable() {
+  for (int i = 0; i < 256; i++) {
+    uint8_t c = (uint8_t)i;
+    for (int b = 0; b < 8; b++) c = (c & 1) ? (uint8_t)((c >> 1) ^ 0x8C) : (uint8_t)(c >> 1);
+    s_table[i] = c;
+  }
+}
+
+uint8_t tableCrc(const uint8_t* p, uint8_t n) {
+  uint8_t crc = 0;
+  while (n--) crc = s_table[crc ^ *p++];
+  return crc;
+}
+
+// 45.5625 C, TH/TL 0x4B/0x46, 12-bit config.
+void makeScratchpad(uint8_t (&sp)[9], int16_t raw = 0x02D9) {
+  sp[0] = (uint8_t)raw;
+  sp[1] = (uint8_t)(raw >> 8);
+  sp[2] = 0x4B;
+  sp[3] = 0x46;
+  sp[4] = 0x7F;
+  sp[5] = 0xFF;
+  sp[6] = 0x07;
+  sp[7] = 0x10;
+  sp[8] = dallasCrc8(sp, 8);
+}
+
+bool checkCrc() {
+  bool ok = true;
+  const uint8_t an27[7] = {0x02, 0x1C, 0xB8, 0x01, 0x00, 0x00, 0x00};
+  if (dallasCrc8(an27, 7) != 0xA2) {
+    std::printf("  FAIL: AN27 ROM CRC 0x%02X, want 0xA2\n", dallasCrc8(an27, 7));
+    ok = false;
+  }
+  Rng rng;
+  for (int i = 0; i < 10000; i++) {
+    uint8_t buf[8];
+    for (uint8_t& b : buf) b = (uint8_t)rng.next();
+    if (dallasCrc8(buf, 8) != tableCrc(buf, 8)) {
+      std::printf("  FAIL: bitwise and table CRC differ\n");
+      ok = false;
+      break;
+    }
+  }
+  return ok;
+}
+
+bool checkErrorPatterns() {
+  uint8_t good[9];
+  makeScratchpad(good);
+  if (!dallasScratchpadValid(good)) {
+    std::printf("  FAIL: clean scratchpad rejected\n");
+    return false;
+  }
+  uint32_t patterns = 0;
+  uint32_t missed = 0;
+  auto flip = [](uint8_t (&sp)[9], int bit) { sp[bit / 8] ^= (uint8_t)(1u << (bit % 8)); };
+  auto test = [&](int a, int b, int c) {
+    uint8_t sp[9];
+    std::memcpy(sp, good, sizeof(sp));
+    flip(sp, a);
+    if (b >= 0) flip(sp, b);
+    if (c >= 0) flip(sp, c);
+    patterns++;
+    if (dallasScratchpadValid(sp)) missed++;
+  };
+  for (int a = 0; a < 72; a++) {
+    test(a, -1, -1);
+    for (int b = a + 1; b < 72; b++) {
+      test(a, b, -1);
+      for (int c = b + 1; c < 72; c++) test(a, b, c);
+    }
+  }
+  uint8_t zero[9] = {};
+  uint8_t ones[9];
+  std::memset(ones, 0xFF, sizeof(ones));
+  const bool blanks = !dallasScratchpadValid(zero) && !dallasScratchpadValid(ones);
+  std::printf("  1-3 bit error patterns %u, accepted %u; blank reads %s\n", patterns, missed,
+              blanks ? "rejected" : "ACCEPTED");
+  return missed == 0 && blanks;
+}
+
+// Fake bus: one device, every bit of the 9-byte reply flips with `ber`, the
+// presence pulse goes missing with `presenceLoss`.
+struct FakeBus {
+  Rng rng;
+  double ber = 0.0;
+  double presenceLoss = 0.0;
+  uint8_t truth[9];
+  uint32_t injectedNoPresence = 0;
+  uint32_t injectedCorrupt = 0;
+
+  FakeBus() { makeScratchpad(truth); }
+
+  DallasReadStatus readScratchpadRaw(uint64_t, uint8_t (&sp)[9]) {
+    if (rng.chance(presenceLoss)) {
+      injectedNoPresence++;
+      return DallasReadStatus::NoPresence;
+    }
+    bool corrupt = false;
+    for (uint8_t i = 0; i < 9; i++) {
+      sp[i] = truth[i];
+      for (uint8_t b = 0; b < 8; b++) {
+        if (rng.chance(ber)) {
+          sp[i] ^= (uint8_t)(1u << b);
+          corrupt = true;
+        }
+      }
+    }
+    if (corrupt) injectedCorrupt++;
+    return DallasReadStatus::Ok;
+  }
+};
+
+bool runNoise(double ber, double presenceLoss) {
+  bool ok = true;
+  uint32_t lost[2] = {};
+  uint32_t accepted = 0;
+  for (uint8_t retries = 0; retries <= 1; retries++) {
+    uint32_t undetected = 0;
+    FakeBus bus;
+    bus.ber = ber;
+    bus.presenceLoss = presenceLoss;
+    DallasSensorHealth h;
+    const uint32_t n = 100000;
+    for (uint32_t i = 0; i < n; i++) {
+      uint8_t sp[9];
+      if (dallasReadScratchpad(bus, 0x1100000000000028ull, sp, h, retries) != DallasReadStatus::Ok) continue;
+      if (std::memcmp(sp, bus.truth, sizeof(sp)) != 0) undetected++;
+    }
+    lost[retries] = h.failures;
+    accepted += undetected;
+    // Every injected fault shows up in exactly one counter; a corrupted
+    // frame that passed the CRC is the only one missing from crcErrors.
+    // Each failed first attempt is retried once, the rest are failures.
+    if (h.reads != n || h.noPresence != bus.injectedNoPresence || h.busErrors != 0 ||
+        h.crcErrors + undetected != bus.injectedCorrupt ||
+        h.retries != (retries ? h.crcErrors + h.noPresence - h.failures : 0)) {
+      std::printf("  FAIL: counters reads %u crc %u/%u presence %u/%u retries %u failures %u\n", h.reads,
+                  h.crcErrors, bus.injectedCorrupt, h.noPresence, bus.injectedNoPresence, h.retries, h.failures);
+      ok = false;
+    }
+  }
+  std::printf("  BER %-7g presence loss %-6g  lost slots: no retry %6u, one retry %5u; corrupt accepted %u\n",
+              ber, presenceLoss, lost[0], lost[1], accepted);
+  if (lost[1] > lost[0]) ok = false;
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  buildTable();
+  bool ok = true;
+  std::printf("CRC8\n");
+  ok &= checkCrc();
+  std::printf("Error patterns\n");
+  ok &= checkErrorPatterns();
+  std::printf("Injected bit errors, 100k reads each\n");
+  ok &= runNoise(1e-4, 0.0);
+  ok &= runNoise(1e-3, 1e-3);
+  ok &= runNoise(1e-2, 1e-3);
+  if (!ok) {
+    std::printf("FAIL\n");
+    return 1;
+  }
+  std::printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,215 @@
+// Host replay of multi-source role traces through TempFusion.h, against the
+// fixed-priority selection TemperatureManager used before.
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -I. tools/fusion_replay.cpp -o /tmp/fusion_replay
+//   /tmp/fusion_replay
+//
+// Two synthetic 12 h traces, sampled at the real cadences:
+//   outside: OpenTherm ID27 (+0.8 C, every 10 s), DS18B20 on GPIO0 (-0.3 C,
+//            1/16 C steps, every second), BLE meteo (+0.2 C, noisy, every
+//            10 s). OT drops out twice, DS once, BLE in short random gaps.
+//   return:  OpenTherm return (every 10 s) and DS18B20 on GPIO2 (-1.2 C, a
+//            pipe-surface sensor). OT drops out twice; for 10 min the DS
+//            sensor slips off the pipe and reads room temperature.
+// Reported per trace: the largest one-second jump of the output beyond the
+// true change (what the equitherm target sees on a source switch), the
+// time the output was invalid, and the final fusion weights. Fails if the
+// fused output jumps by more than 0.3 C, goes invalid while a source is
+// fresh, or follows the sensor that fell off the pipe.
+
+#include <cmath>
+#include <cstdio>
+
+#include "../TempFusion.h"
+
+namespace {
+
+constexpr uint32_t kStepMs = 1000;
+constexpr uint32_t kDurationMs = 12u * 3600u * 1000u;
+
+struct Rng {
+  uint32_t s = 0x1234567u;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  float uniform() { return (float)(next() >> 8) / 16777216.0f; }
+  float noise(float sd) { return (uniform() + uniform() + uniform() + uniform() - 2.0f) * 1.7320508f * sd; }
+};
+
+bool inWindow(uint32_t t, uint32_t fromMin, uint32_t toMin) {
+  return t >= fromMin * 60000u && t < toMin * 60000u;
+}
+
+// Sample-and-hold source: produces a new sample every periodMs while up.
+struct Source {
+  uint32_t periodMs;
+  float c = NAN;
+  uint32_t sampleMs = 0;
+  bool have = false;
+
+  void tick(uint32_t t, bool up, float value) {
+    if (!up) return;
+    if (have && t - sampleMs < periodMs) return;
+    c = value;
+    sampleMs = t;
+    have = true;
+  }
+  TempFusionInput input() const {
+    TempFusionInput in;
+    in.c = c;
+    in.valid = have;
+    in.sampleMs = sampleMs;
+    return in;
+  }
+};
+
+struct Stats {
+  float maxJumpC = 0.0f;
+  uint32_t jumpsOver02 = 0;
+  uint32_t invalidS = 0;
+  float maxErrC = 0.0f;  // against the truth (offset-free), outside the fault window
+
+  void add(float out, float prevOut, float truth, float prevTruth, bool valid, bool prevValid) {
+    if (!valid) {
+      invalidS++;
+      return;
+    }
+    if (prevValid) {
+      const float j = fabsf((out - prevOut) - (truth - prevTruth));
+      if (j > maxJumpC) maxJumpC = j;
+      if (j > 0.2f) jumpsOver02++;
+    }
+  }
+};
+
+// Fixed priority: first source whose sample is younger than staleMs.
+template <uint8_t N>
+bool legacyPick(const TempFusionInput (&in)[N], uint32_t now, uint32_t staleMs, float& out) {
+  for (uint8_t i = 0; i < N; i++) {
+    if (in[i].valid && now - in[i].sampleMs < staleMs) {
+      out = in[i].c;
+      return true;
+    }
+  }
+  return false;
+}
+
+template <uint8_t N>
+void printWeights(const TempFusion<N>& f, const char* const (&names)[N]) {
+  std::printf("  fusion weights at the end:");
+  for (uint8_t i = 0; i < N; i++) {
+    const auto& s = f.source(i);
+    std::printf(" %s %.2f (offset %+.2f%s)", names[i], s.share, s.offsetC, s.healthy ? "" : ", unhealthy");
+  }
+  std::printf("\n");
+}
+
+bool runOutside() {
+  Rng rng;
+  Source ot{10000}, ds{1000}, ble{10000};
+  const float prio[3] = {1.0f, 0.5f, 0.2f};
+  TempFusionConfig cfg;
+  cfg.staleMs = 120000;
+  cfg.disagreeC = 4.0f;
+  TempFusion<3> fusion(prio, cfg);
+
+  Stats legacy, fused;
+  float prevL = NAN, prevF = NAN, prevTruth = NAN;
+  bool prevLv = false, prevFv = false;
+  uint32_t bleGapUntil = 0;
+  for (uint32_t t = 0; t < kDurationMs; t += kStepMs) {
+    const float truth = 5.0f + 4.0f * sinf((float)t / 86400000.0f * 6.2831853f);
+    if (t >= bleGapUntil && rng.next() % 600 == 0) bleGapUntil = t + 60000 + rng.next() % 120000;
+
+    ot.tick(t, !inWindow(t, 60, 100) && !inWindow(t, 400, 460), roundf((truth + 0.8f) * 256.0f) / 256.0f);
+    ds.tick(t, !inWindow(t, 200, 215), roundf((truth - 0.3f + rng.noise(0.03f)) * 16.0f) / 16.0f);
+    ble.tick(t, t >= bleGapUntil, truth + 0.2f + rng.noise(0.1f));
+
+    const TempFusionInput in[3] = {ot.input(), ds.input(), ble.input()};
+    float l = NAN;
+    const bool lv = legacyPick(in, t, 30000, l);
+    fusion.update(in, t);
+    const bool fv = fusion.valid();
+    const float f = fusion.value();
+
+    legacy.add(l, prevL, truth, prevTruth, lv, prevLv);
+    fused.add(f, prevF, truth, prevTruth, fv, prevFv);
+    prevL = l; prevLv = lv;
+    prevF = f; prevFv = fv;
+    prevTruth = truth;
+  }
+
+  std::printf("Outside (OT / DS GPIO0 / BLE), 12 h\n");
+  std::printf("  %-16s %12s %10s %10s\n", "selection", "max jump C", "jumps>0.2", "invalid s");
+  std::printf("  %-16s %12.2f %10u %10u\n", "fixed priority", legacy.maxJumpC, legacy.jumpsOver02, legacy.invalidS);
+  std::printf("  %-16s %12.2f %10u %10u\n", "fusion", fused.maxJumpC, fused.jumpsOver02, fused.invalidS);
+  const char* const names[3] = {"ot", "ds", "ble"};
+  printWeights(fusion, names);
+  std::printf("\n");
+  return fused.maxJumpC <= 0.3f && fused.invalidS == 0;
+}
+
+bool runReturn() {
+  Rng rng;
+  Source ot{10000}, ds{1000};
+  const float prio[2] = {1.0f, 0.5f};
+  TempFusionConfig cfg;
+  cfg.staleMs = 30000;
+  cfg.disagreeC = 3.0f;
+  TempFusion<2> fusion(prio, cfg);
+
+  Stats legacy, fused;
+  float prevL = NAN, prevF = NAN, prevTruth = NAN;
+  bool prevLv = false, prevFv = false;
+  float worstInFault = 0.0f;
+  for (uint32_t t = 0; t < kDurationMs; t += kStepMs) {
+    const float truth = 40.0f + 3.0f * sinf((float)t / 1200000.0f * 6.2831853f);
+    const bool slipped = inWindow(t, 300, 310);
+    const float dsValue = slipped ? 24.0f : truth - 1.2f + rng.noise(0.03f);
+
+    ot.tick(t, !inWindow(t, 90, 120) && !inWindow(t, 500, 505), roundf(truth * 256.0f) / 256.0f);
+    ds.tick(t, true, roundf(dsValue * 16.0f) / 16.0f);
+
+    const TempFusionInput in[2] = {ot.input(), ds.input()};
+    float l = NAN;
+    const bool lv = legacyPick(in, t, 30000, l);
+    fusion.update(in, t);
+    const bool fv = fusion.valid();
+    const float f = fusion.value();
+    if (slipped && fv && fabsf(f - truth) > worstInFault) worstInFault = fabsf(f - truth);
+
+    legacy.add(l, prevL, truth, prevTruth, lv, prevLv);
+    fused.add(f, prevF, truth, prevTruth, fv, prevFv);
+    prevL = l; prevLv = lv;
+    prevF = f; prevFv = fv;
+    prevTruth = truth;
+  }
+
+  std::printf("Return (OT / DS GPIO2), 12 h\n");
+  std::printf("  %-16s %12s %10s %10s\n", "selection", "max jump C", "jumps>0.2", "invalid s");
+  std::printf("  %-16s %12.2f %10u %10u\n", "fixed priority", legacy.maxJumpC, legacy.jumpsOver02, legacy.invalidS);
+  std::printf("  %-16s %12.2f %10u %10u\n", "fusion", fused.maxJumpC, fused.jumpsOver02, fused.invalidS);
+  std::printf("  worst error while the DS sensor was off the pipe: %.2f C\n", worstInFault);
+  const char* const names[2] = {"ot", "ds"};
+  printWeights(fusion, names);
+  std::printf("\n");
+  return fused.maxJumpC <= 0.3f && fused.invalidS == 0 && worstInFault < 1.0f;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok &= runOutside();
+  ok &= runReturn();
+  if (!ok) {
+    std::printf("FAIL\n");
+    return 1;
+  }
+  std::printf("OK\n");
+  return 0;
+}
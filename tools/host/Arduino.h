@@ -0,0 +1,116 @@
+#pragma once
+
+// Minimal Arduino core stand-in for host tools that compile firmware
+// sources unchanged (see tools/tm_loop_bench.cpp). Only what those
+// sources use; the tool defines millis()/micros(), and delay(),
+// delayMicroseconds() and yield() when the sources it compiles wait (they
+// advance its virtual clock). Pins are no-ops. Serial discards output.
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include <functional>
+#include <string>
+
+typedef uint8_t byte;
+typedef char __FlashStringHelper;  // F("...") stays a plain C string
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define CHANGE 0x03
+#define HEX 16
+// Optional observer of output writes, for a tool that simulates the device
+// on the other end of a line (tools/ot_sim_slave.h).
+inline void (*hostPinWrite)(int pin, int level) = nullptr;
+inline void pinMode(int, int) {}
+inline void digitalWrite(int pin, int level) { if (hostPinWrite) hostPinWrite(pin, level); }
+inline int digitalRead(int) { return HIGH; }
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void attachInterrupt(int, void (*)(void), int) {}
+inline void attachInterruptArg(int, void (*)(void*), void*, int) {}
+inline void detachInterrupt(int) {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+
+class String {
+public:
+  String() = default;
+  String(const char* s) : _s(s ? s : "") {}
+  String(const std::string& s) : _s(s) {}
+  explicit String(char c) : _s(1, c) {}
+  explicit String(int v) : _s(std::to_string(v)) {}
+  explicit String(unsigned v) : _s(std::to_string(v)) {}
+  explicit String(long v) : _s(std::to_string(v)) {}
+  explicit String(unsigned long v) : _s(std::to_string(v)) {}
+  explicit String(double v, unsigned decimals = 2) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    _s = buf;
+  }
+
+  const char* c_str() const { return _s.c_str(); }
+  size_t length() const { return _s.size(); }
+  bool reserve(size_t n) { _s.reserve(n); return true; }
+  char operator[](size_t i) const { return i < _s.size() ? _s[i] : 0; }
+
+  void trim() {
+    const size_t b = _s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) { _s.clear(); return; }
+    _s = _s.substr(b, _s.find_last_not_of(" \t\r\n") - b + 1);
+  }
+  void toLowerCase() { for (char& c : _s) if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a'); }
+  void replace(const char* from, const char* to) {
+    const size_t fl = strlen(from), tl = strlen(to);
+    if (!fl) return;
+    for (size_t p = _s.find(from); p != std::string::npos; p = _s.find(from, p + tl)) _s.replace(p, fl, to);
+  }
+  int indexOf(const char* s) const {
+    const size_t p = _s.find(s);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  bool equalsIgnoreCase(const String& o) const { return strcasecmp(c_str(), o.c_str()) == 0; }
+
+  bool operator==(const char* o) const { return _s == o; }
+  bool operator==(const String& o) const { return _s == o._s; }
+  bool operator!=(const char* o) const { return _s != o; }
+  String operator+(const char* o) const { return String(_s + o); }
+  String operator+(const String& o) const { return String(_s + o._s); }
+  String& operator+=(const char* o) { _s += o ? o : ""; return *this; }
+  String& operator+=(const String& o) { _s += o._s; return *this; }
+  String& operator+=(char c) { _s += c; return *this; }
+
+private:
+  std::string _s;
+};
+
+#define F(s) (s)
+#define IRAM_ATTR
+
+class Print {
+public:
+  template <class T> size_t print(const T&) { return 0; }
+  template <class T> size_t println(const T&) { return 0; }
+  template <class T> size_t print(const T&, int) { return 0; }
+  template <class T> size_t println(const T&, int) { return 0; }
+  size_t println() { return 0; }
+  size_t printf(const char*, ...) { return 0; }
+  size_t vprintf(const char*, va_list) { return 0; }
+};
+
+class Stream : public Print {};
+
+inline Stream Serial;
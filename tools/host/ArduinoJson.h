@@ -0,0 +1,579 @@
+#pragma once
+
+// ArduinoJson 6 stand-in for host tools: a small document tree with the
+// calls the firmware sources make (documents, objects, arrays, variants with
+// "|" defaults, deserializeJson / serializeJson). Values are kept, so a tool
+// can inspect what a firmware function wrote. Capacities are ignored and
+// deserialization filters keep everything.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <Arduino.h>
+
+template <class T> struct SerializedValue {
+  T* data;
+  size_t size;
+};
+template <class T> SerializedValue<T> serialized(T* data, size_t size) { return SerializedValue<T>{data, size}; }
+
+namespace hostjson {
+
+struct Node {
+  enum Kind : uint8_t { Null, Bool, Int, Float, Str, Raw, Obj, Arr } kind = Null;
+  bool b = false;
+  int64_t i = 0;
+  double f = 0;
+  std::string s;  // Str, Raw
+  std::vector<std::pair<std::string, std::unique_ptr<Node>>> members;
+  std::vector<std::unique_ptr<Node>> items;
+
+  void reset(Kind k) {
+    kind = k;
+    s.clear();
+    members.clear();
+    items.clear();
+  }
+  Node* member(const char* key) const {
+    for (const auto& m : members) {
+      if (m.first == key) return m.second.get();
+    }
+    return nullptr;
+  }
+  Node* addMember(const char* key) {
+    if (Node* n = member(key)) return n;
+    members.emplace_back(key, std::unique_ptr<Node>(new Node));
+    return members.back().second.get();
+  }
+  Node* addItem() {
+    items.emplace_back(new Node);
+    return items.back().get();
+  }
+  double number() const { return kind == Int ? (double)i : kind == Float ? f : kind == Bool ? (b ? 1 : 0) : 0; }
+};
+
+inline const char* keyText(const char* k) { return k ? k : ""; }
+inline const char* keyText(const String& k) { return k.c_str(); }
+
+}  // namespace hostjson
+
+class JsonObject;
+class JsonArray;
+
+// A slot: an existing node, or a member/element created on first write.
+class JsonVariant {
+public:
+  JsonVariant() = default;
+  JsonVariant(const JsonVariant&) = default;
+  explicit JsonVariant(hostjson::Node* n) : _node(n) {}
+  JsonVariant(hostjson::Node* parent, const char* key) : _node(parent ? parent->member(key) : nullptr), _parent(parent), _key(key) {}
+
+  bool isNull() const { return !_node || _node->kind == hostjson::Node::Null; }
+
+  template <class T> bool is() const { return isT((T*)nullptr); }
+  template <class T> T as() const { return asT((T*)nullptr); }
+  template <class T, class = typename std::enable_if<!std::is_same<T, JsonVariant>::value>::type>
+  operator T() const { return as<T>(); }
+
+  template <class K> JsonVariant operator[](const K& key) const {
+    if (_node && _node->kind == hostjson::Node::Obj) return JsonVariant(_node, hostjson::keyText(key));
+    if (isNull() && _parent) return JsonVariant(const_cast<JsonVariant*>(this)->bind(hostjson::Node::Obj), hostjson::keyText(key));
+    return JsonVariant();
+  }
+  JsonVariant operator[](int index) const {
+    if (!_node || _node->kind != hostjson::Node::Arr || index < 0 || (size_t)index >= _node->items.size()) return JsonVariant();
+    return JsonVariant(_node->items[(size_t)index].get());
+  }
+  bool containsKey(const char* key) const { return _node && _node->kind == hostjson::Node::Obj && _node->member(key); }
+
+  JsonVariant& operator=(bool v) { if (auto* n = bind(hostjson::Node::Bool)) n->b = v; return *this; }
+  JsonVariant& operator=(float v) { return setFloat(v); }
+  JsonVariant& operator=(double v) { return setFloat(v); }
+  JsonVariant& operator=(const char* v) {
+    if (!v) return *this = nullptr;
+    if (auto* n = bind(hostjson::Node::Str)) n->s = v;
+    return *this;
+  }
+  JsonVariant& operator=(char* v) { return *this = (const char*)v; }
+  JsonVariant& operator=(const String& v) { return *this = v.c_str(); }
+  JsonVariant& operator=(std::nullptr_t) { bind(hostjson::Node::Null); return *this; }
+  template <class T> JsonVariant& operator=(const SerializedValue<T>& v) {
+    if (auto* n = bind(hostjson::Node::Raw)) n->s.assign((const char*)v.data, v.size);
+    return *this;
+  }
+  template <class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+  JsonVariant& operator=(T v) {
+    if (auto* n = bind(hostjson::Node::Int)) n->i = (int64_t)v;
+    return *this;
+  }
+  JsonVariant& operator=(const JsonVariant& o);
+
+  bool set(const JsonVariant& o) { *this = o; return true; }
+
+  JsonObject createNestedObject() const;
+  JsonArray createNestedArray() const;
+  template <class K> JsonObject createNestedObject(const K& key) const;
+  template <class K> JsonArray createNestedArray(const K& key) const;
+  template <class T> bool add(const T& v) const;
+
+  // "|": the value when it has the type of the default, the default otherwise.
+  template <class T> typename std::conditional<std::is_same<T, String>::value, String, T>::type operator|(const T& def) const {
+    return is<T>() ? as<T>() : def;
+  }
+  const char* operator|(const char* def) const { return is<const char*>() ? as<const char*>() : def; }
+  JsonVariant operator|(const JsonVariant& def) const { return isNull() ? def : *this; }
+
+  hostjson::Node* node() const { return _node; }
+
+  // Creates the slot (when it is a missing member) and gives it the kind.
+  hostjson::Node* bind(hostjson::Node::Kind kind) {
+    if (!_node && _parent) _node = _parent->addMember(_key.c_str());
+    if (_node && _node->kind != kind) _node->reset(kind);
+    return _node;
+  }
+
+private:
+  JsonVariant& setFloat(double v) {
+    if (auto* n = bind(hostjson::Node::Float)) n->f = v;
+    return *this;
+  }
+
+  bool num() const { return _node && (_node->kind == hostjson::Node::Int || _node->kind == hostjson::Node::Float); }
+  bool isT(bool*) const { return _node && _node->kind == hostjson::Node::Bool; }
+  bool isT(float*) const { return num(); }
+  bool isT(double*) const { return num(); }
+  template <class T> bool isT(T*) const {
+    static_assert(std::is_integral<T>::value, "unsupported type");
+    return num();
+  }
+  bool isT(const char**) const { return _node && _node->kind == hostjson::Node::Str; }
+  bool isT(String*) const { return isT((const char**)nullptr); }
+  bool isT(JsonObject*) const { return _node && _node->kind == hostjson::Node::Obj; }
+  bool isT(JsonArray*) const { return _node && _node->kind == hostjson::Node::Arr; }
+
+  bool asT(bool*) const { return _node && (_node->kind == hostjson::Node::Bool ? _node->b : _node->number() != 0); }
+  float asT(float*) const { return num() ? (float)_node->number() : NAN; }
+  double asT(double*) const { return num() ? _node->number() : NAN; }
+  template <class T> T asT(T*) const {
+    static_assert(std::is_integral<T>::value, "unsupported type");
+    return num() ? (T)(_node->kind == hostjson::Node::Int ? _node->i : (int64_t)_node->f) : (T)0;
+  }
+  const char* asT(const char**) const { return isT((const char**)nullptr) ? _node->s.c_str() : nullptr; }
+  String asT(String*) const { return isT((const char**)nullptr) ? String(_node->s) : String(); }
+  JsonObject asT(JsonObject*) const;
+  JsonArray asT(JsonArray*) const;
+
+  hostjson::Node* _node = nullptr;
+  hostjson::Node* _parent = nullptr;  // object holding the missing member _key
+  std::string _key;
+};
+
+class JsonObject {
+public:
+  JsonObject() = default;
+  explicit JsonObject(hostjson::Node* n) : _node(n && n->kind == hostjson::Node::Obj ? n : nullptr) {}
+
+  bool isNull() const { return !_node; }
+  size_t size() const { return _node ? _node->members.size() : 0; }
+  template <class K> JsonVariant operator[](const K& key) const { return JsonVariant(_node, hostjson::keyText(key)); }
+  template <class K> bool containsKey(const K& key) const { return _node && _node->member(hostjson::keyText(key)); }
+  template <class K> JsonObject createNestedObject(const K& key) const { return (*this)[key].createNestedObject(); }
+  template <class K> JsonArray createNestedArray(const K& key) const;
+  template <class K> void remove(const K& key) const {
+    if (!_node) return;
+    auto& m = _node->members;
+    for (size_t i = 0; i < m.size(); i++) {
+      if (m[i].first == hostjson::keyText(key)) { m.erase(m.begin() + (long)i); return; }
+    }
+  }
+  operator JsonVariant() const { return JsonVariant(_node); }
+  hostjson::Node* node() const { return _node; }
+
+private:
+  hostjson::Node* _node = nullptr;
+};
+
+class JsonArray {
+public:
+  class iterator {
+  public:
+    iterator(const std::unique_ptr<hostjson::Node>* p) : _p(p) {}
+    JsonVariant operator*() const { return JsonVariant(_p->get()); }
+    iterator& operator++() { ++_p; return *this; }
+    bool operator!=(const iterator& o) const { return _p != o._p; }
+
+  private:
+    const std::unique_ptr<hostjson::Node>* _p;
+  };
+
+  JsonArray() = default;
+  explicit JsonArray(hostjson::Node* n) : _node(n && n->kind == hostjson::Node::Arr ? n : nullptr) {}
+
+  bool isNull() const { return !_node; }
+  size_t size() const { return _node ? _node->items.size() : 0; }
+  JsonVariant operator[](size_t i) const { return _node && i < _node->items.size() ? JsonVariant(_node->items[i].get()) : JsonVariant(); }
+  iterator begin() const { return iterator(_node ? _node->items.data() : nullptr); }
+  iterator end() const { return iterator(_node ? _node->items.data() + _node->items.size() : nullptr); }
+
+  JsonVariant addElement() const { return _node ? JsonVariant(_node->addItem()) : JsonVariant(); }
+  template <class T> bool add(const T& v) const {
+    if (!_node) return false;
+    JsonVariant slot = addElement();
+    slot = v;
+    return true;
+  }
+  JsonObject createNestedObject() const { return addElement().createNestedObject(); }
+  JsonArray createNestedArray() const { return addElement().createNestedArray(); }
+  operator JsonVariant() const { return JsonVariant(_node); }
+  hostjson::Node* node() const { return _node; }
+
+private:
+  hostjson::Node* _node = nullptr;
+};
+
+inline JsonObject JsonVariant::asT(JsonObject*) const { return JsonObject(_node); }
+inline JsonArray JsonVariant::asT(JsonArray*) const { return JsonArray(_node); }
+inline JsonObject JsonVariant::createNestedObject() const { return JsonObject(const_cast<JsonVariant*>(this)->bind(hostjson::Node::Obj)); }
+inline JsonArray JsonVariant::createNestedArray() const { return JsonArray(const_cast<JsonVariant*>(this)->bind(hostjson::Node::Arr)); }
+template <class K> JsonObject JsonVariant::createNestedObject(const K& key) const { return (*this)[key].createNestedObject(); }
+template <class K> JsonArray JsonVariant::createNestedArray(const K& key) const { return (*this)[key].createNestedArray(); }
+template <class K> JsonArray JsonObject::createNestedArray(const K& key) const { return (*this)[key].createNestedArray(); }
+template <class T> bool JsonVariant::add(const T& v) const { return JsonArray(const_cast<JsonVariant*>(this)->bind(hostjson::Node::Arr)).add(v); }
+
+namespace hostjson {
+inline void copyNode(Node& dst, const Node& src) {
+  dst.reset(src.kind);
+  dst.b = src.b;
+  dst.i = src.i;
+  dst.f = src.f;
+  dst.s = src.s;
+  for (const auto& m : src.members) copyNode(*dst.addMember(m.first.c_str()), *m.second);
+  for (const auto& it : src.items) copyNode(*dst.addItem(), *it);
+}
+}  // namespace hostjson
+
+inline JsonVariant& JsonVariant::operator=(const JsonVariant& o) {
+  if (!o._node) return *this = nullptr;
+  if (o._node == _node) return *this;
+  if (auto* n = bind(o._node->kind)) hostjson::copyNode(*n, *o._node);
+  return *this;
+}
+
+class JsonDocument {
+public:
+  JsonDocument() = default;
+  JsonDocument(const JsonDocument&) = delete;
+  JsonDocument& operator=(const JsonDocument&) = delete;
+
+  template <class T> T to() {
+    _root.reset(std::is_same<T, JsonArray>::value ? hostjson::Node::Arr : hostjson::Node::Obj);
+    return JsonVariant(&_root).as<T>();
+  }
+  template <class T> T as() const { return JsonVariant(const_cast<hostjson::Node*>(&_root)).as<T>(); }
+  template <class T> bool is() const { return JsonVariant(const_cast<hostjson::Node*>(&_root)).is<T>(); }
+  bool isNull() const { return _root.kind == hostjson::Node::Null; }
+  void clear() { _root.reset(hostjson::Node::Null); }
+  size_t capacity() const { return 0; }
+  bool overflowed() const { return false; }
+
+  template <class K> JsonVariant operator[](const K& key) { return JsonVariant(obj(), hostjson::keyText(key)); }
+  template <class K> bool containsKey(const K& key) const { return _root.kind == hostjson::Node::Obj && _root.member(hostjson::keyText(key)); }
+  template <class K> JsonObject createNestedObject(const K& key) { return (*this)[key].createNestedObject(); }
+  template <class K> JsonArray createNestedArray(const K& key) { return (*this)[key].createNestedArray(); }
+  JsonObject createNestedObject() { return arr().createNestedObject(); }
+  JsonArray createNestedArray() { return arr().createNestedArray(); }
+  template <class T> bool add(const T& v) { return arr().add(v); }
+
+  operator JsonVariant() { return JsonVariant(&_root); }
+  hostjson::Node& root() { return _root; }
+  const hostjson::Node& root() const { return _root; }
+
+private:
+  hostjson::Node* obj() {
+    if (_root.kind != hostjson::Node::Obj) _root.reset(hostjson::Node::Obj);
+    return &_root;
+  }
+  JsonArray arr() {
+    if (_root.kind != hostjson::Node::Arr) _root.reset(hostjson::Node::Arr);
+    return JsonArray(&_root);
+  }
+
+  hostjson::Node _root;
+};
+
+class DynamicJsonDocument : public JsonDocument {
+public:
+  explicit DynamicJsonDocument(size_t) {}
+};
+
+template <size_t N> class StaticJsonDocument : public JsonDocument {};
+
+// ---- serializeJson ---------------------------------------------------------
+
+namespace hostjson {
+inline void writeString(std::string& out, const std::string& s) {
+  out += '"';
+  for (char c : s) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)(unsigned char)c);
+          out += buf;
+        } else {
+          out += c;
+        }
+    }
+  }
+  out += '"';
+}
+
+inline void write(std::string& out, const Node& n) {
+  char buf[32];
+  switch (n.kind) {
+    case Node::Null: out += "null"; break;
+    case Node::Bool: out += n.b ? "true" : "false"; break;
+    case Node::Int: snprintf(buf, sizeof(buf), "%lld", (long long)n.i); out += buf; break;
+    case Node::Float:
+      if (!isfinite(n.f)) { out += "null"; break; }
+      snprintf(buf, sizeof(buf), "%.9g", n.f);
+      out += buf;
+      break;
+    case Node::Str: writeString(out, n.s); break;
+    case Node::Raw: out += n.s; break;
+    case Node::Obj:
+      out += '{';
+      for (size_t k = 0; k < n.members.size(); k++) {
+        if (k) out += ',';
+        writeString(out, n.members[k].first);
+        out += ':';
+        write(out, *n.members[k].second);
+      }
+      out += '}';
+      break;
+    case Node::Arr:
+      out += '[';
+      for (size_t k = 0; k < n.items.size(); k++) {
+        if (k) out += ',';
+        write(out, *n.items[k]);
+      }
+      out += ']';
+      break;
+  }
+}
+
+inline size_t emit(const Node* n, String& out) {
+  std::string s;
+  if (n) write(s, *n); else s = "null";
+  out = String(s);
+  return s.size();
+}
+
+inline size_t emit(const Node* n, char* buf, size_t cap) {
+  std::string s;
+  if (n) write(s, *n); else s = "null";
+  if (!cap) return 0;
+  const size_t len = s.size() < cap - 1 ? s.size() : cap - 1;
+  memcpy(buf, s.data(), len);
+  buf[len] = 0;
+  return len;
+}
+}  // namespace hostjson
+
+inline size_t serializeJson(const JsonDocument& doc, String& out) { return hostjson::emit(&doc.root(), out); }
+inline size_t serializeJson(const JsonDocument& doc, char* buf, size_t cap) { return hostjson::emit(&doc.root(), buf, cap); }
+inline size_t serializeJson(JsonVariant v, String& out) { return hostjson::emit(v.node(), out); }
+inline size_t serializeJson(JsonObject v, String& out) { return hostjson::emit(v.node(), out); }
+inline size_t serializeJson(JsonArray v, String& out) { return hostjson::emit(v.node(), out); }
+inline size_t measureJson(const JsonDocument& doc) {
+  String s;
+  return serializeJson(doc, s);
+}
+
+// ---- deserializeJson -------------------------------------------------------
+
+class DeserializationError {
+public:
+  enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+  DeserializationError(Code c = Ok) : _code(c) {}
+  explicit operator bool() const { return _code != Ok; }
+  Code code() const { return _code; }
+  bool operator==(Code c) const { return _code == c; }
+  const char* c_str() const {
+    static const char* const kText[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+    return kText[_code];
+  }
+
+private:
+  Code _code;
+};
+
+namespace DeserializationOption {
+struct Filter {
+  explicit Filter(const JsonDocument&) {}
+};
+}  // namespace DeserializationOption
+
+namespace hostjson {
+class Parser {
+public:
+  Parser(const char* p, const char* end) : _p(p), _end(end) {}
+
+  DeserializationError parse(Node& root) {
+    ws();
+    if (_p >= _end) return DeserializationError::EmptyInput;
+    const DeserializationError e = value(root, 0);
+    return e;
+  }
+
+private:
+  void ws() {
+    while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\r' || *_p == '\n')) _p++;
+  }
+  bool lit(const char* s) {
+    const size_t n = strlen(s);
+    if ((size_t)(_end - _p) < n || strncmp(_p, s, n) != 0) return false;
+    _p += n;
+    return true;
+  }
+
+  DeserializationError str(std::string& out) {
+    _p++;  // opening quote
+    while (_p < _end && *_p != '"') {
+      char c = *_p++;
+      if (c == '\\') {
+        if (_p >= _end) return DeserializationError::IncompleteInput;
+        c = *_p++;
+        switch (c) {
+          case 'n': c = '\n'; break;
+          case 'r': c = '\r'; break;
+          case 't': c = '\t'; break;
+          case 'b': c = '\b'; break;
+          case 'f': c = '\f'; break;
+          case 'u': {
+            if (_end - _p < 4) return DeserializationError::IncompleteInput;
+            const unsigned cp = (unsigned)strtoul(std::string(_p, 4).c_str(), nullptr, 16);
+            _p += 4;
+            if (cp < 0x80) {
+              out += (char)cp;
+            } else if (cp < 0x800) {
+              out += (char)(0xC0 | (cp >> 6));
+              out += (char)(0x80 | (cp & 0x3F));
+            } else {
+              out += (char)(0xE0 | (cp >> 12));
+              out += (char)(0x80 | ((cp >> 6) & 0x3F));
+              out += (char)(0x80 | (cp & 0x3F));
+            }
+            continue;
+          }
+          default: break;
+        }
+      }
+      out += c;
+    }
+    if (_p >= _end) return DeserializationError::IncompleteInput;
+    _p++;
+    return DeserializationError::Ok;
+  }
+
+  DeserializationError value(Node& n, int depth) {
+    if (depth > 32) return DeserializationError::TooDeep;
+    ws();
+    if (_p >= _end) return DeserializationError::IncompleteInput;
+    const char c = *_p;
+    if (c == '{') {
+      n.reset(Node::Obj);
+      _p++;
+      ws();
+      if (_p < _end && *_p == '}') { _p++; return DeserializationError::Ok; }
+      for (;;) {
+        ws();
+        if (_p >= _end) return DeserializationError::IncompleteInput;
+        if (*_p != '"') return DeserializationError::InvalidInput;
+        std::string key;
+        DeserializationError e = str(key);
+        if (e) return e;
+        ws();
+        if (_p >= _end) return DeserializationError::IncompleteInput;
+        if (*_p++ != ':') return DeserializationError::InvalidInput;
+        e = value(*n.addMember(key.c_str()), depth + 1);
+        if (e) return e;
+        ws();
+        if (_p >= _end) return DeserializationError::IncompleteInput;
+        if (*_p == ',') { _p++; continue; }
+        if (*_p == '}') { _p++; return DeserializationError::Ok; }
+        return DeserializationError::InvalidInput;
+      }
+    }
+    if (c == '[') {
+      n.reset(Node::Arr);
+      _p++;
+      ws();
+      if (_p < _end && *_p == ']') { _p++; return DeserializationError::Ok; }
+      for (;;) {
+        DeserializationError e = value(*n.addItem(), depth + 1);
+        if (e) return e;
+        ws();
+        if (_p >= _end) return DeserializationError::IncompleteInput;
+        if (*_p == ',') { _p++; continue; }
+        if (*_p == ']') { _p++; return DeserializationError::Ok; }
+        return DeserializationError::InvalidInput;
+      }
+    }
+    if (c == '"') {
+      n.reset(Node::Str);
+      return str(n.s);
+    }
+    if (lit("true")) { n.reset(Node::Bool); n.b = true; return DeserializationError::Ok; }
+    if (lit("false")) { n.reset(Node::Bool); n.b = false; return DeserializationError::Ok; }
+    if (lit("null")) { n.reset(Node::Null); return DeserializationError::Ok; }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      const char* start = _p;
+      bool real = false;
+      while (_p < _end && strchr("+-0123456789.eE", *_p)) {
+        if (*_p == '.' || *_p == 'e' || *_p == 'E') real = true;
+        _p++;
+      }
+      const std::string num(start, _p);
+      if (real) { n.reset(Node::Float); n.f = strtod(num.c_str(), nullptr); }
+      else { n.reset(Node::Int); n.i = strtoll(num.c_str(), nullptr, 10); }
+      return DeserializationError::Ok;
+    }
+    return DeserializationError::InvalidInput;
+  }
+
+  const char* _p;
+  const char* _end;
+};
+}  // namespace hostjson
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* json, size_t len) {
+  doc.clear();
+  if (!json) return DeserializationError::EmptyInput;
+  return hostjson::Parser(json, json + len).parse(doc.root());
+}
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* json) {
+  return deserializeJson(doc, json, json ? strlen(json) : 0);
+}
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& json) {
+  return deserializeJson(doc, json.c_str(), json.length());
+}
+template <class In>
+DeserializationError deserializeJson(JsonDocument& doc, const In& json, DeserializationOption::Filter) {
+  return deserializeJson(doc, json);
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Arduino-ESP32 FunctionalInterrupt stand-in: attachInterruptArg() is in the
+// Arduino.h stand-in.
+
+#include <Arduino.h>
@@ -0,0 +1,45 @@
+#pragma once
+
+// Preferences (NVS) stand-in for host tools: namespaces live in memory for
+// the lifetime of the process.
+
+#include <Arduino.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+  bool begin(const char* ns, bool readOnly = false) {
+    _ns = ns ? ns : "";
+    _readOnly = readOnly;
+    return true;
+  }
+  void end() { _ns.clear(); }
+
+  size_t getBytes(const char* key, void* buf, size_t len) {
+    const auto it = store().find(_ns + "/" + key);
+    if (it == store().end() || it->second.size() > len) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+  size_t putBytes(const char* key, const void* buf, size_t len) {
+    if (_readOnly) return 0;
+    const uint8_t* p = (const uint8_t*)buf;
+    store()[_ns + "/" + key].assign(p, p + len);
+    return len;
+  }
+  bool remove(const char* key) { return !_readOnly && store().erase(_ns + "/" + key) > 0; }
+  bool isKey(const char* key) { return store().count(_ns + "/" + key) > 0; }
+
+  // Whole store, e.g. to start a tool run with empty NVS.
+  static std::map<std::string, std::vector<uint8_t>>& store() {
+    static std::map<std::string, std::vector<uint8_t>> s;
+    return s;
+  }
+
+private:
+  std::string _ns;
+  bool _readOnly = false;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+// ESP-IDF RMT RX stand-in for host tools: the types OpenThermRmtRx.h
+// declares its members with. A tool that includes it provides the
+// OpenThermRmtRx methods itself (a simulated capture).
+
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+
+typedef struct rmt_channel_t* rmt_channel_handle_t;
+
+typedef union {
+  struct {
+    uint16_t duration0 : 15;
+    uint16_t level0 : 1;
+    uint16_t duration1 : 15;
+    uint16_t level1 : 1;
+  };
+  uint32_t val;
+} rmt_symbol_word_t;
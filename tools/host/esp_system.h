@@ -0,0 +1,8 @@
+#pragma once
+
+// ESP-IDF esp_system stand-in for host tools.
+
+#include <stdlib.h>
+#include <stdint.h>
+
+inline uint32_t esp_random() { return (uint32_t)rand(); }
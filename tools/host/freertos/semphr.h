@@ -0,0 +1,10 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  static int s_mutex;
+  return &s_mutex;
+}
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t) { return pdTRUE; }
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+  static int s_task;
+  return &s_task;
+}
+
+// No second task on the host: creation fails and callers stay single-threaded.
+typedef void (*TaskFunction_t)(void*);
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t, TaskHandle_t*,
+                                          BaseType_t) {
+  return pdFALSE;
+}
+inline void vTaskDelay(TickType_t) {}
+inline void vTaskDelete(TaskHandle_t) {}
@@ -0,0 +1,471 @@
+// Host fault-injection test of the shared I2C bus queue (I2cBusCore.h) with
+// a mock bus on a virtual clock, against blocking Wire calls in the caller.
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -Itools/host -I. tools/i2c_bus_bench.cpp RetryPolicy.cpp -o /tmp/i2c_bus_bench
+//   /tmp/i2c_bus_bench
+//
+// The mock bus has the TCA9554 (0x20, 10 ms timeout) and the PCF85063 (0x51,
+// 20 ms timeout); a transfer takes ~90 us per byte at 100 kHz. Injected
+// faults over 10 min of virtual time:
+//   stuck bus   SDA held low for 3 s at 120 s, 10 s at 300 s, 0.5 s at 450 s:
+//               every transfer runs into its timeout, recovery fails until
+//               the episode is over,
+//   RTC NACKs   0.5 % of its transfers, and absent from 200 to 260 s.
+// The traffic is the firmware's: a relay write + verify read every 100 ms
+// (control task, waits for the result), a valve OFF write every 30 s (stop
+// timer, urgent, waits), the relay health-check read every 2 s (queued, result
+// in the callback) and an RTC time read every 1 s (waits).
+//   queue   one worker runs the queue as the i2c task does (I2cBus.cpp):
+//           service(), then one transaction; the caller waits for its
+//           callback.
+//   inline  the former Wire path: the caller runs each transfer itself with
+//           the 50 ms Wire timeout and no notion of a bus being down.
+// Checked: exactly one callback per accepted transaction, no bus traffic
+// while the bus is known down except the recovery attempts, the device
+// timeouts, read-back of what was written, recovery within the backoff
+// after each episode, urgent before queued, a full queue refused.
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "I2cBusCore.h"
+
+static uint32_t g_nowUs = 0;
+uint32_t millis() { return g_nowUs / 1000u; }
+uint32_t micros() { return g_nowUs; }
+
+namespace {
+
+constexpr uint8_t kTcaAddr = 0x20;
+constexpr uint8_t kRtcAddr = 0x51;
+constexpr uint16_t kTcaTimeoutMs = 10;
+constexpr uint16_t kRtcTimeoutMs = 20;
+constexpr uint32_t kWireTimeoutMs = 50;
+constexpr uint32_t kByteUs = 90;
+constexpr uint32_t kDurationUs = 600000000u;
+
+struct Rng {
+  uint32_t s = 0x12C0FFEEu;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  bool chance(uint32_t perMille) { return next() % 1000 < perMille; }
+};
+
+struct Episode {
+  uint32_t fromUs, toUs;
+};
+const Episode kStuck[] = {{120000000u, 123000000u}, {300000000u, 310000000u}, {450000000u, 450500000u}};
+
+bool stuckAt(uint32_t us) {
+  for (const Episode& e : kStuck) {
+    if (us >= e.fromUs && us < e.toUs) return true;
+  }
+  return false;
+}
+
+class MockBus : public I2cBackend {
+public:
+  bool attach(uint8_t dev, uint8_t addr) override {
+    if (dev >= I2cBusCore::kMaxDevices) return false;
+    _addr[dev] = addr;
+    return true;
+  }
+
+  I2cResult transfer(uint8_t dev, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen,
+                     uint32_t timeoutMs) override {
+    transfers++;
+    const uint8_t addr = _addr[dev];
+    if (timeoutMs != (addr == kTcaAddr ? kTcaTimeoutMs : kRtcTimeoutMs)) wrongTimeouts++;
+    if (stuckAt(g_nowUs)) {
+      stuckTransfers++;
+      g_nowUs += timeoutMs * 1000u;
+      return I2cResult::Timeout;
+    }
+    if (addr != kTcaAddr && (rtcAbsent() || rng.chance(5))) {
+      g_nowUs += kByteUs;
+      return I2cResult::Nack;
+    }
+    uint8_t* regs = addr == kTcaAddr ? tcaRegs : rtcRegs;
+    uint8_t& ptr = addr == kTcaAddr ? tcaPtr : rtcPtr;
+    const uint8_t mask = addr == kTcaAddr ? 3 : 15;
+    if (txLen) ptr = tx[0] & mask;
+    for (uint8_t i = 1; i < txLen; i++) regs[(ptr + i - 1) & mask] = tx[i];
+    for (uint8_t i = 0; i < rxLen; i++) rx[i] = regs[(ptr + i) & mask];
+    g_nowUs += (1u + txLen + (rxLen ? 1u + rxLen : 0u)) * kByteUs;
+    return I2cResult::Ok;
+  }
+
+  I2cResult probe(uint8_t addr, uint32_t timeoutMs) override {
+    if (stuckAt(g_nowUs)) {
+      stuckTransfers++;
+      g_nowUs += timeoutMs * 1000u;
+      return I2cResult::Timeout;
+    }
+    g_nowUs += kByteUs;
+    return addr == kTcaAddr || (addr == kRtcAddr && !rtcAbsent()) ? I2cResult::Ok : I2cResult::Nack;
+  }
+
+  bool recover() override {
+    recoverCalls++;
+    g_nowUs += 200;
+    return !stuckAt(g_nowUs);
+  }
+
+  static bool rtcAbsent() { return g_nowUs >= 200000000u && g_nowUs < 260000000u; }
+
+  Rng rng;
+  uint8_t tcaRegs[4] = {0xFF, 0xFF, 0x00, 0xFF};
+  uint8_t rtcRegs[16] = {};
+  uint8_t tcaPtr = 0, rtcPtr = 0;
+  uint32_t transfers = 0;
+  uint32_t stuckTransfers = 0;
+  uint32_t wrongTimeouts = 0;
+  uint32_t recoverCalls = 0;
+
+private:
+  uint8_t _addr[I2cBusCore::kMaxDevices] = {};
+};
+
+uint32_t clockUs() { return g_nowUs; }
+
+// ---- traffic ----------------------------------------------------------------
+
+enum OpKind : uint8_t { kRelayWrite = 0, kValveOff, kHealthRead, kRtcRead };
+const char* const kOpNames[] = {"relay write+verify", "valve OFF (urgent)", "health read (async)", "RTC read"};
+
+struct Op {
+  uint32_t atUs;
+  OpKind kind;
+};
+
+std::vector<Op> makeOps() {
+  std::vector<Op> ops;
+  for (uint32_t t = 5000; t < kDurationUs; t += 100000) ops.push_back({t, kRelayWrite});
+  for (uint32_t t = 17000; t < kDurationUs; t += 30000000) ops.push_back({t, kValveOff});
+  for (uint32_t t = 31000; t < kDurationUs; t += 2000000) ops.push_back({t, kHealthRead});
+  for (uint32_t t = 53000; t < kDurationUs; t += 1000000) ops.push_back({t, kRtcRead});
+  std::stable_sort(ops.begin(), ops.end(), [](const Op& a, const Op& b) { return a.atUs < b.atUs; });
+  return ops;
+}
+
+struct Waits {
+  std::vector<uint32_t> us[4];  // per op kind: caller blocked (sync) / until the callback (async)
+  uint32_t over10ms = 0;        // sync callers blocked > 10 ms
+  uint64_t blockedUs = 0;       // sync callers, total
+  void add(OpKind k, uint32_t w) {
+    us[k].push_back(w);
+    if (k == kHealthRead) return;
+    blockedUs += w;
+    if (w > 10000) over10ms++;
+  }
+};
+
+uint32_t pct(std::vector<uint32_t> v, uint32_t p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min<size_t>(v.size() - 1, v.size() * p / 100)];
+}
+
+// ---- queue ------------------------------------------------------------------
+
+struct QueueRun {
+  MockBus bus;
+  I2cBusCore core{bus, clockUs};
+  int8_t tca = -1, rtc = -1;
+  Waits waits;
+  uint32_t accepted = 0, callbacks = 0, doubleCallbacks = 0, refused = 0;
+  uint32_t offlineResults = 0, verifyMismatch = 0, verifyOk = 0;
+  uint32_t busWhileDown = 0;  // transfers started while the core was offline
+  uint32_t recoveredLateUs = 0;
+  uint8_t written = 0;
+};
+
+// One caller operation; a relay write chains its verify read from the
+// write's callback, like writeRegRaw() + readRegRaw() back to back.
+struct Call {
+  QueueRun* run;
+  OpKind kind;
+  uint32_t atUs;
+  uint8_t value;
+  uint8_t stage;  // relay write: 0 write, 1 verify read
+  bool done;
+};
+
+void onDone(void* ctx, I2cResult res, const uint8_t* rx, uint8_t rxLen);
+
+bool submitCall(Call& c, bool urgent) {
+  QueueRun& r = *c.run;
+  I2cTxn t;
+  t.ctx = &c;
+  t.done = onDone;
+  switch (c.kind) {
+    case kRelayWrite:
+    case kValveOff:
+      t.dev = (uint8_t)r.tca;
+      t.tx[0] = 0x01;
+      if (c.stage == 0) {
+        t.tx[1] = c.value;
+        t.txLen = 2;
+      } else {
+        t.txLen = 1;
+        t.rxLen = 1;
+      }
+      break;
+    case kHealthRead:
+      t.dev = (uint8_t)r.tca;
+      t.tx[0] = 0x01;
+      t.txLen = 1;
+      t.rxLen = 1;
+      break;
+    case kRtcRead:
+      t.dev = (uint8_t)r.rtc;
+      t.tx[0] = 0x04;
+      t.txLen = 1;
+      t.rxLen = 7;
+      break;
+  }
+  if (!r.core.submit(t, urgent)) {
+    r.refused++;
+    return false;
+  }
+  r.accepted++;
+  return true;
+}
+
+void finish(Call& c) {
+  c.done = true;
+  c.run->waits.add(c.kind, g_nowUs - c.atUs);
+}
+
+void onDone(void* ctx, I2cResult res, const uint8_t* rx, uint8_t rxLen) {
+  Call& c = *(Call*)ctx;
+  QueueRun& r = *c.run;
+  r.callbacks++;
+  if (c.done) r.doubleCallbacks++;
+  if (res == I2cResult::Offline) r.offlineResults++;
+  const bool pair = c.kind == kRelayWrite || c.kind == kValveOff;
+  if (pair && c.stage == 0 && res == I2cResult::Ok) {
+    r.written = c.value;
+    c.stage = 1;
+    if (submitCall(c, c.kind == kValveOff)) return;
+  } else if (pair && c.stage == 1 && res == I2cResult::Ok) {
+    if (rxLen == 1 && rx[0] == c.value) r.verifyOk++;
+    else r.verifyMismatch++;
+  } else if (c.kind == kHealthRead && res == I2cResult::Ok) {
+    if (rxLen != 1 || rx[0] != r.written) r.verifyMismatch++;
+  }
+  finish(c);
+}
+
+void runQueue(QueueRun& r) {
+  g_nowUs = 0;
+  r.tca = r.core.addDevice(kTcaAddr, kTcaTimeoutMs);
+  r.rtc = r.core.addDevice(kRtcAddr, kRtcTimeoutMs);
+  const std::vector<Op> ops = makeOps();
+  std::vector<Call> calls(ops.size());
+  size_t next = 0;
+  uint8_t value = 0;
+  bool wasOnline = true;
+  uint32_t downSinceUs = 0;
+  while (g_nowUs < kDurationUs) {
+    // Callers that became due while the worker was on the bus queue now,
+    // stamped with their own time.
+    while (next < ops.size() && ops[next].atUs <= g_nowUs) {
+      const uint32_t now = g_nowUs;
+      Call& c = calls[next];
+      c = Call{&r, ops[next].kind, ops[next].atUs, (uint8_t)(++value & 0xFC), 0, false};
+      g_nowUs = c.atUs;
+      if (!submitCall(c, c.kind == kValveOff)) finish(c);
+      g_nowUs = now;
+      next++;
+    }
+
+    r.core.service();
+    const bool online = r.core.online();
+    if (online && !wasOnline) {
+      // From the end of the episode that took it down to back online.
+      for (const Episode& e : kStuck) {
+        if (downSinceUs >= e.fromUs && downSinceUs < e.toUs) {
+          r.recoveredLateUs = std::max(r.recoveredLateUs, g_nowUs - e.toUs);
+        }
+      }
+    }
+    if (!online && wasOnline) downSinceUs = g_nowUs;
+    wasOnline = online;
+
+    I2cTxn t;
+    if (r.core.pop(t)) {
+      const uint32_t before = r.bus.transfers;
+      const bool down = !r.core.online();
+      r.core.execute(t);
+      if (down && r.bus.transfers != before) r.busWhileDown++;
+      continue;
+    }
+    uint32_t wake = next < ops.size() ? ops[next].atUs : kDurationUs;
+    if (!online) wake = std::min(wake, g_nowUs + r.core.recoveryInMs() * 1000u);
+    g_nowUs = std::max(wake, g_nowUs + 1);
+  }
+}
+
+// ---- inline Wire ------------------------------------------------------------
+
+struct InlineRun {
+  MockBus bus;
+  Waits waits;
+};
+
+void runInline(InlineRun& r) {
+  g_nowUs = 0;
+  r.bus.attach(0, kTcaAddr);
+  r.bus.attach(1, kRtcAddr);
+  const std::vector<Op> ops = makeOps();
+  uint32_t callerFreeUs = 0;
+  uint8_t rx[8];
+  for (const Op& op : ops) {
+    g_nowUs = std::max(op.atUs, callerFreeUs);
+    const uint8_t reg = op.kind == kRtcRead ? 0x04 : 0x01;
+    const uint8_t dev = op.kind == kRtcRead ? 1 : 0;
+    const uint8_t w[2] = {reg, 0x10};
+    switch (op.kind) {
+      case kRelayWrite:
+      case kValveOff:
+        if (r.bus.transfer(dev, w, 2, rx, 0, kWireTimeoutMs) == I2cResult::Ok) {
+          r.bus.transfer(dev, &reg, 1, rx, 1, kWireTimeoutMs);
+        }
+        break;
+      case kHealthRead:
+        r.bus.transfer(dev, &reg, 1, rx, 1, kWireTimeoutMs);
+        break;
+      case kRtcRead:
+        r.bus.transfer(dev, &reg, 1, rx, 7, kWireTimeoutMs);
+        break;
+    }
+    callerFreeUs = g_nowUs;
+    // Here the health read blocks its caller too.
+    const uint32_t blocked = g_nowUs - op.atUs;
+    r.waits.us[op.kind].push_back(blocked);
+    r.waits.blockedUs += blocked;
+    if (blocked > 10000) r.waits.over10ms++;
+  }
+}
+
+// ---- queue order and limits -------------------------------------------------
+
+struct OrderLog {
+  uint8_t order[I2cBusCore::kQueueLen + 2];
+  uint8_t n = 0;
+};
+OrderLog* s_orderLog = nullptr;
+
+void logOrder(void* ctx, I2cResult, const uint8_t*, uint8_t) {
+  s_orderLog->order[s_orderLog->n++] = (uint8_t)(uintptr_t)ctx;
+}
+
+bool checkOrderAndLimits() {
+  MockBus bus;
+  I2cBusCore core(bus, clockUs);
+  g_nowUs = 1000000;
+  const int8_t tca = core.addDevice(kTcaAddr, kTcaTimeoutMs);
+  bool ok = tca == 0 && core.addDevice(kTcaAddr, 99) == 0 && core.deviceTimeoutMs(0) == kTcaTimeoutMs;
+
+  OrderLog log;
+  s_orderLog = &log;
+  I2cTxn t;
+  t.dev = (uint8_t)tca;
+  t.tx[0] = 0x01;
+  t.tx[1] = 0x00;
+  t.txLen = 2;
+  t.done = logOrder;
+  for (uint8_t i = 1; i <= 5; i++) {
+    t.ctx = (void*)(uintptr_t)i;
+    ok &= core.submit(t);
+  }
+  t.ctx = (void*)(uintptr_t)99;
+  ok &= core.submit(t, true);
+  I2cTxn q;
+  while (core.pop(q)) core.execute(q);
+  ok &= log.n == 6 && log.order[0] == 99 && log.order[1] == 1 && log.order[5] == 5;
+
+  // Full queue: refused without a callback, counted.
+  log.n = 0;
+  uint8_t accepted = 0;
+  for (uint8_t i = 0; i < I2cBusCore::kQueueLen + 1; i++) accepted += core.submit(t) ? 1 : 0;
+  ok &= accepted == I2cBusCore::kQueueLen && core.stats().queueFull == 1;
+  while (core.pop(q)) core.execute(q);
+  ok &= log.n == I2cBusCore::kQueueLen;
+
+  // Invalid: unknown device, oversized read, empty transfer.
+  I2cTxn bad = t;
+  bad.dev = 3;
+  ok &= !core.submit(bad);
+  bad = t;
+  bad.rxLen = kI2cMaxRx + 1;
+  ok &= !core.submit(bad);
+  bad = t;
+  bad.txLen = 0;
+  ok &= !core.submit(bad);
+  std::printf("queue order (urgent first), full queue, invalid transfers: %s\n", ok ? "ok" : "FAILED");
+  return ok;
+}
+
+void printWaits(const char* mode, const Waits& w) {
+  for (uint8_t k = 0; k < 4; k++) {
+    std::printf("  %-7s %-20s %9.2f %9.2f %9.2f ms\n", k == 0 ? mode : "", kOpNames[k], pct(w.us[k], 50) / 1000.0,
+                pct(w.us[k], 99) / 1000.0, pct(w.us[k], 100) / 1000.0);
+  }
+  std::printf("  %-7s callers blocked > 10 ms: %u, blocked in total %.1f ms\n", "", w.over10ms, w.blockedUs / 1000.0);
+}
+
+}  // namespace
+
+int main() {
+  bool ok = checkOrderAndLimits();
+
+  static QueueRun q;
+  runQueue(q);
+  static InlineRun w;
+  runInline(w);
+
+  const I2cBusStats s = q.core.stats();
+  const I2cDeviceStats tca = q.core.deviceStats((uint8_t)q.tca);
+  const I2cDeviceStats rtc = q.core.deviceStats((uint8_t)q.rtc);
+  std::printf("\nfaults: stuck bus 3 s / 10 s / 0.5 s, RTC NACK 0.5 %% and absent 60 s; 10 min\n");
+  std::printf("queue: %u accepted, %u callbacks (%u twice), %u refused, %u offline results\n", q.accepted,
+              q.callbacks, q.doubleCallbacks, q.refused, q.offlineResults);
+  std::printf("       recoveries %u (failed %u), bus transfers in stuck episodes %u, while down %u, "
+              "back online at most %.0f ms after an episode\n",
+              s.recoveries, s.recoveryFails, q.bus.stuckTransfers, q.busWhileDown, q.recoveredLateUs / 1000.0);
+  std::printf("       TCA ok %u timeout %u offline %u bus max %u us; RTC ok %u nack %u timeout %u offline %u\n", tca.ok,
+              tca.timeouts, tca.offline, tca.busMaxUs, rtc.ok, rtc.nacks, rtc.timeouts, rtc.offline);
+  std::printf("       verify reads ok %u, mismatches %u, device timeouts wrong %u; queued max %u, wait max %.2f ms\n",
+              q.verifyOk, q.verifyMismatch, q.bus.wrongTimeouts, s.queuedMax, s.waitMaxUs / 1000.0);
+  std::printf("inline: bus transfers in stuck episodes %u\n", w.bus.stuckTransfers);
+
+  std::printf("\nCaller wait (submit to result)\n  %-7s %-20s %9s %9s %9s\n", "", "", "p50", "p99", "max");
+  printWaits("queue", q.waits);
+  printWaits("inline", w.waits);
+
+  ok &= q.accepted == q.callbacks && q.doubleCallbacks == 0 && q.refused == 0;
+  // One timeout per episode; after that only recovery attempts touch the bus.
+  ok &= q.bus.stuckTransfers == 3 && q.busWhileDown == 0 && s.recoveries == 3 && s.recoveryFails > 0;
+  ok &= q.recoveredLateUs <= 2400000u + 1000u;  // backoff cap 2 s + 20 % jitter
+  ok &= q.verifyMismatch == 0 && q.verifyOk > 5000 && q.bus.wrongTimeouts == 0;
+  ok &= tca.timeouts + rtc.timeouts == 3 && rtc.nacks > 0 && tca.offline > 0;
+  // A caller waits at most for a stuck RTC read ahead of it plus its own timeout.
+  uint32_t maxSync = 0;
+  for (uint8_t k : {kRelayWrite, kValveOff, kRtcRead}) maxSync = std::max(maxSync, pct(q.waits.us[k], 100));
+  ok &= maxSync <= (kRtcTimeoutMs + kTcaTimeoutMs + 2) * 1000u;
+  ok &= q.waits.over10ms == 0 && w.waits.over10ms > 100 && q.waits.blockedUs < w.waits.blockedUs;
+  if (!ok) {
+    std::printf("FAIL\n");
+    return 1;
+  }
+  std::printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,265 @@
+// Host simulation of the main loop scheduler (LoopScheduler.h) on a virtual
+// clock, against the former call-everything loop().
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -I. tools/loop_sched_bench.cpp -o /tmp/loop_sched_bench
+//   /tmp/loop_sched_bench
+//
+// The 17 loop tasks of the .ino are modelled with their scheduler periods,
+// the cost of a call that finds nothing to do, and the cost and cadence of
+// their real work (estimates; OpenTherm includes the synchronous ~34 ms
+// frame transmit once per second). Idle waits follow FreeRTOS tick
+// semantics (1 kHz tick, a wait of n ticks ends on the n-th tick
+// interrupt) and end early on an input edge, like ulTaskNotifyTake() woken
+// from the GPIO interrupt.
+// Reported: module calls per second, CPU busy share, per-task start
+// lateness, input edge to inputUpdate() latency. Also checked: no catch-up
+// burst after an overrunning task, micros() wrap-around.
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "../LoopScheduler.h"
+
+namespace {
+
+uint32_t g_nowUs = 0;
+uint32_t clockUs() { return g_nowUs; }
+
+struct Module {
+  const char* name;
+  uint32_t periodMs;     // scheduler period (as registered in the .ino)
+  uint32_t idleCostUs;   // call that only checks its timers
+  uint32_t workCostUs;   // call that does its work
+  uint32_t workEveryMs;  // internal cadence of that work (0 = every call)
+  uint32_t lastWorkUs = 0;
+  bool worked = false;
+  uint32_t calls = 0;
+};
+
+Module g_mods[] = {
+  {"console", 20, 2, 2, 0},
+  {"inputs", 10, 6, 6, 0},
+  {"relays", 10, 2, 180, 2000},
+  {"dallas", 10, 3, 900, 1000},
+  {"network", 10, 4, 4, 0},
+  {"web", 5, 25, 2500, 1000},
+  {"opentherm", 5, 15, 34000, 1000},
+  {"ble", 20, 5, 5, 0},
+  {"history", 1000, 1, 400, 60000},
+  {"temps", 100, 60, 60, 0},
+  {"ota", 10, 3, 3, 0},
+  {"mqtt", 20, 8, 1800, 10000},
+  {"buzzer", 10, 1, 1, 0},
+  {"pressure", 200, 4, 4, 0},
+  {"energy", 100, 2, 120, 1000},
+  {"dhw", 100, 90, 90, 0},
+  {"equitherm", 5, 6, 350, 200},
+};
+constexpr uint8_t kMods = sizeof(g_mods) / sizeof(g_mods[0]);
+constexpr uint8_t kInputs = 1;
+constexpr uint32_t kWakeInput = 1u << 0;
+
+// Pending input edge (virtual time) and measured latencies.
+bool g_edgePending = false;
+uint32_t g_edgeUs = 0;
+std::vector<uint32_t> g_edgeLatency;
+
+void callModule(uint8_t i) {
+  Module& m = g_mods[i];
+  m.calls++;
+  if (i == kInputs && g_edgePending && (int32_t)(g_nowUs - g_edgeUs) >= 0) {
+    g_edgeLatency.push_back(g_nowUs - g_edgeUs);
+    g_edgePending = false;
+  }
+  const bool due = !m.worked || !m.workEveryMs || (uint32_t)(g_nowUs - m.lastWorkUs) >= m.workEveryMs * 1000u;
+  if (due) {
+    m.worked = true;
+    m.lastWorkUs = g_nowUs;
+    g_nowUs += m.workCostUs;
+  } else {
+    g_nowUs += m.idleCostUs;
+  }
+}
+
+template <uint8_t I>
+void thunk() { callModule(I); }
+
+template <uint8_t... I>
+struct Thunks {
+  static constexpr LoopScheduler::TaskFn fns[] = {&thunk<I>...};
+};
+using AllThunks = Thunks<0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16>;
+static_assert(sizeof(AllThunks::fns) / sizeof(AllThunks::fns[0]) == kMods, "one thunk per module");
+
+void resetModules() {
+  for (Module& m : g_mods) {
+    m.lastWorkUs = 0;
+    m.worked = false;
+    m.calls = 0;
+  }
+  g_edgePending = false;
+  g_edgeLatency.clear();
+}
+
+struct Rng {
+  uint32_t s = 0xC0FFEEu;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+};
+
+constexpr uint32_t kTickUs = 1000;
+constexpr uint32_t kTickPhaseUs = 370;
+
+// End of a wait of n ticks started at t: the n-th tick interrupt after t.
+uint32_t tickWaitEnd(uint32_t t, uint32_t n) {
+  const uint32_t sincePhase = t - kTickPhaseUs;
+  const uint32_t firstTick = t + (kTickUs - sincePhase % kTickUs);
+  return firstTick + (n - 1) * kTickUs;
+}
+
+struct RunResult {
+  uint64_t calls = 0;
+  uint64_t busyUs = 0;
+  uint64_t spanUs = 0;
+  uint32_t maxPassUs = 0;
+};
+
+RunResult runLegacy(uint32_t startUs, uint32_t durationUs) {
+  resetModules();
+  g_nowUs = startUs;
+  RunResult r;
+  while ((uint32_t)(g_nowUs - startUs) < durationUs) {
+    for (uint8_t i = 0; i < kMods; i++) callModule(i);
+  }
+  for (const Module& m : g_mods) r.calls += m.calls;
+  r.spanUs = (uint32_t)(g_nowUs - startUs);
+  r.busyUs = r.spanUs;  // never idles
+  return r;
+}
+
+RunResult runScheduled(LoopScheduler& sched, uint32_t startUs, uint32_t durationUs, uint32_t edgeMeanMs) {
+  Rng rng;
+  RunResult r;
+  uint32_t nextEdge = startUs + 1000u * (rng.next() % (2 * edgeMeanMs));
+  while ((uint32_t)(g_nowUs - startUs) < durationUs) {
+    const uint32_t passStart = g_nowUs;
+    const uint32_t idle = sched.runDue();
+    r.maxPassUs = std::max(r.maxPassUs, g_nowUs - passStart);
+    // Edges that happened while the pass was running (ISR set the event).
+    if ((int32_t)(g_nowUs - nextEdge) >= 0) {
+      g_edgePending = true;
+      g_edgeUs = nextEdge;
+      sched.wake(kWakeInput);
+      nextEdge += 1000u * (1 + rng.next() % (2 * edgeMeanMs));
+      continue;
+    }
+    if (!idle) continue;
+    const uint32_t wakeAt = tickWaitEnd(g_nowUs, idle / 1000u + 1);
+    if ((int32_t)(nextEdge - wakeAt) < 0) {
+      g_nowUs = nextEdge;
+      g_edgePending = true;
+      g_edgeUs = nextEdge;
+      sched.wake(kWakeInput);
+      nextEdge += 1000u * (1 + rng.next() % (2 * edgeMeanMs));
+    } else {
+      g_nowUs = wakeAt;
+    }
+  }
+  for (const Module& m : g_mods) r.calls += m.calls;
+  r.spanUs = (uint32_t)(g_nowUs - startUs);
+  r.busyUs = sched.busyUs();
+  return r;
+}
+
+bool runMain() {
+  constexpr uint32_t kDurationUs = 600u * 1000000u;  // 10 min
+  const RunResult legacy = runLegacy(0, kDurationUs);
+
+  resetModules();
+  g_nowUs = 0;
+  LoopScheduler sched(clockUs);
+  for (uint8_t i = 0; i < kMods; i++)
+    sched.add(g_mods[i].name, AllThunks::fns[i], g_mods[i].periodMs, i == kInputs ? kWakeInput : 0);
+  const RunResult sch = runScheduled(sched, 0, kDurationUs, 2000);
+
+  const double s = kDurationUs / 1e6;
+  std::printf("10 min, %u tasks\n", kMods);
+  std::printf("  %-20s %14s %8s\n", "loop", "module calls/s", "busy %");
+  std::printf("  %-20s %14.0f %8.1f\n", "call everything", legacy.calls / s, 100.0 * legacy.busyUs / legacy.spanUs);
+  std::printf("  %-20s %14.0f %8.1f\n", "scheduler", sch.calls / s, 100.0 * sch.busyUs / sch.spanUs);
+  std::printf("  passes/s %.0f, longest pass %.2f ms\n\n", sched.passes() / s, sch.maxPassUs / 1000.0);
+
+  bool ok = true;
+  const uint32_t lateBound = sch.maxPassUs + 2 * kTickUs;
+  std::printf("  %-10s %6s %8s %9s %9s\n", "task", "period", "runs", "late avg", "late max");
+  for (uint8_t i = 0; i < kMods; i++) {
+    const LoopTaskStats& st = sched.taskStats(i);
+    const uint32_t timed = st.runs - st.wakeRuns;
+    const uint32_t expected = kDurationUs / (g_mods[i].periodMs * 1000u);
+    std::printf("  %-10s %4u ms %8u %6.2f ms %6.2f ms%s\n", g_mods[i].name, g_mods[i].periodMs, st.runs,
+                timed ? st.lateSumUs / 1000.0 / timed : 0.0, st.lateMaxUs / 1000.0,
+                st.wakeRuns ? " (+edge wakes)" : "");
+    // Cadence kept (a run is lost only when the OT transmit covered whole
+    // periods), never later than the longest pass plus the tick.
+    if (timed + expected / 10 < expected || timed > expected + 1 || st.lateMaxUs > lateBound) {
+      std::printf("    FAIL: expected ~%u timed runs, late bound %.2f ms\n", expected, lateBound / 1000.0);
+      ok = false;
+    }
+  }
+
+  std::vector<uint32_t> lat = g_edgeLatency;
+  std::sort(lat.begin(), lat.end());
+  const uint32_t p50 = lat.empty() ? 0 : lat[lat.size() / 2];
+  const uint32_t p99 = lat.empty() ? 0 : lat[lat.size() * 99 / 100];
+  const uint32_t mx = lat.empty() ? 0 : lat.back();
+  std::printf("\n  input edge -> inputUpdate(): %zu edges, p50 %u us, p99 %u us, max %.2f ms\n", lat.size(), p50, p99,
+              mx / 1000.0);
+  ok &= !lat.empty() && p50 < 500 && mx <= sch.maxPassUs;
+  ok &= sch.busyUs * 5 < legacy.busyUs && sch.calls * 20 < legacy.calls;
+  return ok;
+}
+
+// A 1 ms task that takes 3 ms per run must not starve the others nor run
+// in bursts to catch up; across a micros() wrap.
+uint32_t g_slowRuns = 0, g_fastRuns = 0;
+void slowTask() { g_slowRuns++; g_nowUs += 3000; }
+void fastTask() { g_fastRuns++; g_nowUs += 10; }
+
+bool runOverrunAndWrap() {
+  const uint32_t start = 0xFFFFFFFFu - 3000000u;
+  g_nowUs = start;
+  LoopScheduler sched(clockUs);
+  sched.add("slow", slowTask, 1);
+  sched.add("fast", fastTask, 10);
+  constexpr uint32_t kDurationUs = 10u * 1000000u;
+  while ((uint32_t)(g_nowUs - start) < kDurationUs) {
+    const uint32_t idle = sched.runDue();
+    if (idle) g_nowUs = tickWaitEnd(g_nowUs, idle / 1000u + 1);
+  }
+  const LoopTaskStats& fast = sched.taskStats(1);
+  std::printf("Overrun + micros() wrap, 10 s: slow (1 ms, costs 3 ms) %u runs, fast (10 ms) %u runs, "
+              "fast late max %.2f ms\n", g_slowRuns, g_fastRuns, fast.lateMaxUs / 1000.0);
+  // slow can run at most once per pass (<= every 3 ms), fast keeps 10 ms.
+  return g_slowRuns <= kDurationUs / 3000u + 1 && g_fastRuns + 30 >= kDurationUs / 10000u &&
+         g_fastRuns <= kDurationUs / 10000u + 1 && fast.lateMaxUs <= 3000u + 10u;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok &= runMain();
+  ok &= runOverrunAndWrap();
+  if (!ok) {
+    std::printf("FAIL\n");
+    return 1;
+  }
+  std::printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,343 @@
+// Host check of the Data-ID table decoders (OpenThermDataIds.cpp) and of the
+// scan JSON built from them (OpenThermController.cpp).
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -Itools/host -I. tools/ot_dataid_check.cpp OpenThermController.cpp OpenThermDataIds.cpp OTBusESP32Pro.cpp OpenTherm.cpp RetryPolicy.cpp -o /tmp/ot_dataid_check
+//   /tmp/ot_dataid_check
+//
+// 1. Every row (IDs 0..127 and one beyond) is decoded for every 16-bit value
+//    by openthermDecodeDataIdValue() into the ArduinoJson stand-in and
+//    compared with an expectation written here from the OpenTherm v2.2
+//    field layouts (raw/hb/lb/u16/s16, f8.8 IDs, s16 Texhaust, status and
+//    configuration flags, RBP masks, TSP, capacity, day/time, date, year,
+//    s8 bounds). Also checked: the output serializes and parses back
+//    unchanged, its ArduinoJson pool estimate on the ESP32 (16-byte slots,
+//    every key and string counted as copied) fits the 640-byte document of
+//    the scan JSON and trace replay, and its text fits the 512-byte buffer
+//    of jsonAppendDecodedValue().
+// 2. A Data-ID scan 0..127 against the simulated boiler of
+//    tools/ot_sim_slave.h; the scan status and scan profile JSON must parse
+//    and every item must carry the same decoded fields as
+//    openthermDecodeDataIdValue() for its value.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "ot_sim_slave.h"
+
+#include "OpenThermController.h"
+#include "OpenThermDataIds.h"
+
+namespace {
+
+constexpr size_t kDocBytes = 640;   // StaticJsonDocument in the scan JSON / replay budget per frame
+constexpr size_t kTextBytes = 511;  // jsonAppendDecodedValue() buffer minus the terminator
+
+// f8.8 Data-IDs (OpenTherm v2.2 section 5.3, plus the ventilation and
+// version IDs).
+bool isF88(uint8_t id) {
+  static const uint8_t kIds[] = {1,  7,  8,  9,  14, 16, 17, 18, 19, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32,
+                                 34, 36, 37, 38, 39, 56, 57, 58, 75, 80, 81, 82, 83, 124, 125};
+  for (uint8_t x : kIds) {
+    if (x == id) return true;
+  }
+  return false;
+}
+
+void flags(JsonObject o, uint8_t bits, const char* const* names, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) {
+    if (names[i]) o[names[i]] = (bool)((bits >> i) & 1);
+  }
+}
+
+// What the firmware should write for (id, raw), independent of the table.
+void expect(JsonObject o, uint8_t id, uint16_t raw) {
+  const uint8_t hb = (uint8_t)(raw >> 8);
+  const uint8_t lb = (uint8_t)(raw & 0xFF);
+  o["raw"] = raw;
+  o["hb"] = hb;
+  o["lb"] = lb;
+  o["u16"] = raw;
+  o["s16"] = (int16_t)raw;
+  switch (id) {
+    case 0: {
+      static const char* const kMaster[] = {"chEnable", "dhwEnable", "coolingEnable", "otcActive", "ch2Enable"};
+      static const char* const kSlave[] = {"fault", "chActive", "dhwActive", "flameOn", "coolingActive", "ch2Active",
+                                           "diagnostic"};
+      JsonObject st = o.createNestedObject("status");
+      flags(st, hb, kMaster, 5);
+      flags(st, lb, kSlave, 7);
+      break;
+    }
+    case 2: {
+      JsonObject c = o.createNestedObject("masterCfg");
+      c["memberId"] = lb;
+      c["smartPower"] = (bool)(hb & 1);
+      c["cfgRaw"] = hb;
+      break;
+    }
+    case 3: {
+      static const char* const kCfg[] = {"dhwPresent", "controlType", "coolingSupported", "dhwConfiguration",
+                                         "masterLowOffPumpCtrl", "ch2Present", "remoteWaterFilling",
+                                         "heatCoolModeCtrl"};
+      JsonObject c = o.createNestedObject("slaveCfg");
+      c["memberId"] = lb;
+      flags(c, hb, kCfg, 8);
+      c["cfgRaw"] = hb;
+      break;
+    }
+    case 5:
+      o["asfFlags"] = hb;
+      o["oemFault"] = lb;
+      break;
+    case 6: {
+      JsonObject r = o.createNestedObject("rbp");
+      r["teMask"] = hb;
+      r["rwMask"] = lb;
+      for (int i = 0; i < 8; i++) {
+        r[String("p") + String(i + 1) + "TE"] = (bool)((hb >> i) & 1);
+        r[String("p") + String(i + 1) + "RW"] = (bool)((lb >> i) & 1);
+      }
+      break;
+    }
+    case 10:
+      o["tspCount"] = hb;
+      break;
+    case 11:
+      o["tspIndex"] = hb;
+      o["tspValue"] = lb;
+      break;
+    case 15:
+      o["maxCapacityKw"] = hb;
+      o["minModulationPct"] = lb;
+      break;
+    case 20: {
+      JsonObject t = o.createNestedObject("dayTime");
+      t["day"] = (uint8_t)(hb >> 5);
+      t["hour"] = (uint8_t)(hb & 0x1F);
+      t["minute"] = lb;
+      break;
+    }
+    case 21: {
+      JsonObject t = o.createNestedObject("date");
+      t["month"] = hb;
+      t["day"] = lb;
+      break;
+    }
+    case 22:
+      o["year"] = raw;
+      break;
+    case 48:
+    case 49:
+    case 50:
+      o["upper"] = (int)(int8_t)hb;
+      o["lower"] = (int)(int8_t)lb;
+      break;
+    default:
+      break;
+  }
+  const char* unit = openthermDataIdMeta(id).unit;
+  if (isF88(id)) {
+    o["f88"] = (int16_t)raw / 256.0;
+    if (unit[0]) o["unit"] = unit;
+  } else if (id == 33) {
+    o["celsius"] = (int16_t)raw;
+    o["unit"] = unit;
+  }
+}
+
+// Same members and values; member order does not matter.
+bool sameJson(const hostjson::Node& a, const hostjson::Node& b) {
+  using N = hostjson::Node;
+  const bool an = a.kind == N::Int || a.kind == N::Float;
+  const bool bn = b.kind == N::Int || b.kind == N::Float;
+  if (an && bn) return std::fabs(a.number() - b.number()) <= 1e-6 * (1.0 + std::fabs(b.number()));
+  if (a.kind != b.kind) return false;
+  switch (a.kind) {
+    case N::Bool: return a.b == b.b;
+    case N::Str:
+    case N::Raw: return a.s == b.s;
+    case N::Obj:
+      if (a.members.size() != b.members.size()) return false;
+      for (const auto& m : a.members) {
+        const N* other = b.member(m.first.c_str());
+        if (!other || !sameJson(*m.second, *other)) return false;
+      }
+      return true;
+    case N::Arr:
+      if (a.items.size() != b.items.size()) return false;
+      for (size_t i = 0; i < a.items.size(); i++) {
+        if (!sameJson(*a.items[i], *b.items[i])) return false;
+      }
+      return true;
+    default: return true;
+  }
+}
+
+// Every member of `want` is in `got` with the same value.
+bool containsJson(const hostjson::Node& got, const hostjson::Node& want) {
+  for (const auto& m : want.members) {
+    const hostjson::Node* g = got.member(m.first.c_str());
+    if (!g || !sameJson(*g, *m.second)) return false;
+  }
+  return true;
+}
+
+// ArduinoJson 6 pool on a 32-bit target: one 16-byte slot per member or
+// element, plus copied strings (upper bound: all keys and string values).
+size_t poolEstimate(const hostjson::Node& n) {
+  size_t bytes = 0;
+  if (n.kind == hostjson::Node::Str) bytes += n.s.size() + 1;
+  for (const auto& m : n.members) bytes += 16 + m.first.size() + 1 + poolEstimate(*m.second);
+  for (const auto& it : n.items) bytes += 16 + poolEstimate(*it);
+  return bytes;
+}
+
+// Decoded fields as the scan JSON carries them.
+void decodeAsScan(JsonDocument& doc, uint8_t id, uint16_t raw) {
+  JsonObject val = doc.to<JsonObject>();
+  openthermDecodeDataIdValue(val, id, raw);
+  const OpenThermDataIdMeta& meta = openthermDataIdMeta(id);
+  if (meta.unit[0]) val["unit"] = meta.unit;
+}
+
+bool checkRows() {
+  bool ok = true;
+  uint32_t bad = 0;
+  size_t maxPool = 0, maxText = 0;
+  uint8_t maxPoolId = 0, maxTextId = 0;
+  // All table rows and one ID beyond the table (undocumented entry).
+  for (uint16_t row = 0; row <= 128; row++) {
+    const uint8_t id = row < 128 ? (uint8_t)row : 200;
+    for (uint32_t r = 0; r <= 0xFFFF; r++) {
+      const uint16_t raw = (uint16_t)r;
+      StaticJsonDocument<kDocBytes> got;
+      JsonObject o = got.to<JsonObject>();
+      openthermDecodeDataIdValue(o, id, raw);
+      StaticJsonDocument<kDocBytes> want;
+      expect(want.to<JsonObject>(), id, raw);
+
+      bool rowOk = sameJson(got.root(), want.root());
+
+      // Round trip through the text form.
+      String text;
+      serializeJson(got, text);
+      DynamicJsonDocument back(1024);
+      rowOk = rowOk && !deserializeJson(back, text) && sameJson(back.root(), got.root());
+
+      // Sizes as used in the scan JSON (with the unit of every type).
+      StaticJsonDocument<kDocBytes> scan;
+      decodeAsScan(scan, id, raw);
+      String scanText;
+      serializeJson(scan, scanText);
+      const size_t pool = poolEstimate(scan.root());
+      if (pool > maxPool) { maxPool = pool; maxPoolId = id; }
+      if (scanText.length() > maxText) { maxText = scanText.length(); maxTextId = id; }
+      rowOk = rowOk && pool <= kDocBytes && scanText.length() <= kTextBytes;
+
+      if (!rowOk) {
+        ok = false;
+        if (bad++ < 5) {
+          String w;
+          serializeJson(want, w);
+          std::printf("  ID%u raw 0x%04X:\n    got  %s\n    want %s\n", (unsigned)id, (unsigned)raw, text.c_str(),
+                      w.c_str());
+        }
+      }
+    }
+  }
+  std::printf("decoders: %u rows x 65536 values, %u mismatches; largest output ID%u %u B pool (of %u), "
+              "ID%u %u B text (of %u)\n",
+              129u, bad, (unsigned)maxPoolId, (unsigned)maxPool,
+              (unsigned)kDocBytes, (unsigned)maxTextId, (unsigned)maxText, (unsigned)kTextBytes);
+  return ok;
+}
+
+// Items of a scan JSON array against the direct decode of their value.
+bool checkItems(const char* what, JsonArray items, uint32_t expectCount) {
+  bool ok = items.size() == expectCount;
+  uint32_t bad = 0;
+  for (JsonVariant it : items) {
+    const uint8_t id = it["id"].as<uint8_t>();
+    const uint16_t raw = it["val"].as<uint16_t>();
+    StaticJsonDocument<kDocBytes> want;
+    decodeAsScan(want, id, raw);
+    if (containsJson(*it.node(), want.root())) continue;
+    ok = false;
+    if (bad++ < 5) {
+      String g, w;
+      serializeJson(it, g);
+      serializeJson(want, w);
+      std::printf("  %s ID%u:\n    got  %s\n    want %s\n", what, (unsigned)id, g.c_str(), w.c_str());
+    }
+  }
+  std::printf("%s: %u items, %u without the decoded value\n", what, (unsigned)items.size(), bad);
+  return ok;
+}
+
+bool checkScan() {
+  openthermInit();
+  openthermApplyConfig(
+      "{\"opentherm\":{\"enabled\":true,\"autoStart\":true,\"bootDelayMs\":0,\"rxBackend\":\"rmt\","
+      "\"mode\":\"readOnly\",\"txPin\":4,\"rxPin\":5}}");
+  openthermLoop();  // bus start
+  if (!openthermScanStart(0, 127, 20, true)) {
+    std::printf("scan did not start\n");
+    return false;
+  }
+
+  DynamicJsonDocument status(65536);
+  const uint32_t endUs = g_nowUs + 5u * 60u * 1000000u;
+  bool done = false;
+  while (!done && (int32_t)(g_nowUs - endUs) < 0) {
+    const uint32_t t = g_nowUs;
+    openthermLoop();
+    g_nowUs = t + 5000 > g_nowUs ? t + 5000 : g_nowUs;
+    if (deserializeJson(status, openthermScanGetStatusJson(true))) break;
+    done = status["scan"]["done"].as<bool>();
+  }
+  if (!done) {
+    std::printf("scan status JSON did not parse or the scan did not finish\n");
+    return false;
+  }
+
+  uint32_t supported = 0;
+  JsonArray items = status["scan"]["items"].as<JsonArray>();
+  for (JsonVariant it : items) {
+    if (it["supported"].as<bool>()) supported++;
+  }
+  bool ok = checkItems("scan status", items, 128);
+
+  // The ID-specific hints for the simulated boiler's values.
+  JsonVariant id0 = items[0];
+  JsonVariant id3 = items[3];
+  JsonVariant id48 = items[48];
+  ok = ok && id0["status"]["flameOn"].as<bool>() && id0["status"]["chActive"].as<bool>();
+  ok = ok && id3["slaveCfg"]["memberId"].as<int>() == 5 && id3["slaveCfg"]["dhwPresent"].as<bool>();
+  ok = ok && id48["upper"].as<int>() == 60 && id48["lower"].as<int>() == 40;
+  ok = ok && std::fabs(items[25]["f88"].as<float>() - 25.5f) < 1e-6f;
+  ok = ok && items[15].containsKey("maxCapacityKw") && items[6].containsKey("rbp") && items[10].containsKey("tspCount");
+
+  DynamicJsonDocument profile(65536);
+  if (deserializeJson(profile, openthermGetScanProfileJson())) {
+    std::printf("scan profile JSON did not parse\n");
+    return false;
+  }
+  ok = checkItems("scan profile", profile["profile"]["items"].as<JsonArray>(), supported) && ok;
+  ok = ok && supported == 16;
+  std::printf("scan: %u of 128 IDs supported; ID0 flameOn %d, ID3 memberId %d, ID48 %d/%d\n", supported,
+              (int)id0["status"]["flameOn"].as<bool>(), id3["slaveCfg"]["memberId"].as<int>(),
+              id48["upper"].as<int>(), id48["lower"].as<int>());
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = checkRows();
+  ok = checkScan() && ok;
+  std::printf("%s\n", ok ? "OK" : "FAIL");
+  return ok ? 0 : 1;
+}
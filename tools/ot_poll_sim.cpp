@@ -0,0 +1,209 @@
+// Host simulation of the OpenTherm poll scheduler (poll table in
+// OpenThermController.cpp) against the former fixed poll list, on a virtual
+// clock with a simulated boiler.
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -Itools/host -I. tools/ot_poll_sim.cpp OpenThermController.cpp OpenThermDataIds.cpp OTBusESP32Pro.cpp OpenTherm.cpp RetryPolicy.cpp -o /tmp/ot_poll_sim
+//   /tmp/ot_poll_sim
+//
+// The boiler (tools/ot_sim_slave.h) answers the IDs a typical boiler has
+// (status, temperatures 25/26/27/28, modulation, pressure, ASF flags,
+// remote parameters 48/49/56/57, identity 3/127, counters 116..123) and
+// UNKNOWN_DATA_ID for the extended temperatures 24 and 29..34.
+// "after": the controller compiled unchanged, openthermLoop() every 5 ms,
+// with the consumer declarations of the firmware (Ekviterm ID25 2 s
+// Control, DHW ID26 10 s / ID56 30 s, pressure alarm ID18 60 s, energy
+// counters 116..123 10 min). "before": the removed otPollOnce() order on
+// the same bus model: ID0, 25, 28, 26, 17, 18, two of the extended
+// temperatures round-robin, ID5, and one of 48/49/56/57 every 5 s, each a
+// blocking request, a cycle every pollMs (2 s).
+// Reported per run: frames per minute on the bus and, per Data-ID, the age
+// of the value a consumer sees (sampled every 100 ms): p50 / p95 / max.
+// 15 min per run, clean line and 10 % timeouts.
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "ot_sim_slave.h"
+
+#include "OTBusESP32Pro.h"
+#include "OpenThermController.h"
+
+namespace {
+
+constexpr uint32_t kLoopPeriodUs = 5000;
+constexpr uint32_t kRunUs = 15u * 60u * 1000000u;  // four runs stay below the micros() wrap
+constexpr uint32_t kSampleMs = 100;
+
+struct Report {
+  uint8_t id;
+  uint32_t maxAgeMs;  // declared maximum age ("after")
+};
+
+const Report kReport[] = {
+  {25, 2000}, {28, 10000}, {26, 10000}, {17, 10000}, {18, 60000}, {5, 30000},
+  {27, 60000}, {48, 60000}, {49, 60000}, {56, 30000}, {57, 60000}, {116, 600000},
+};
+
+// Successful reads per Data-ID, in virtual ms.
+struct Run {
+  std::vector<uint32_t> okMs[128];
+  uint32_t startMs = 0;
+  uint32_t endMs = 0;
+  uint32_t frames = 0;
+
+  void noteOk(uint8_t id, uint32_t ms) {
+    if (okMs[id].empty() || okMs[id].back() != ms) okMs[id].push_back(ms);
+  }
+
+  // Age seen by a consumer every kSampleMs, from the first value on.
+  void agePercentiles(uint8_t id, uint32_t& p50, uint32_t& p95, uint32_t& mx) const {
+    p50 = p95 = mx = 0;
+    const std::vector<uint32_t>& ok = okMs[id];
+    if (ok.empty()) return;
+    std::vector<uint32_t> ages;
+    size_t i = 0;
+    for (uint32_t t = ok.front(); t < endMs; t += kSampleMs) {
+      while (i + 1 < ok.size() && ok[i + 1] <= t) i++;
+      ages.push_back(t - ok[i]);
+    }
+    std::sort(ages.begin(), ages.end());
+    p50 = ages[(ages.size() - 1) * 50 / 100];
+    p95 = ages[(ages.size() - 1) * 95 / 100];
+    mx = ages.back();
+  }
+};
+
+void slaveSetup(uint16_t timeoutPm) {
+  otsim::g_slave.reset();
+  for (uint8_t id = 116; id < 124; id++) otsim::g_slave.setSupported(id, true);
+  otsim::g_slave.faults.timeoutPm = timeoutPm;
+}
+
+void runAfter(Run& r, uint16_t timeoutPm) {
+  slaveSetup(timeoutPm);
+  r.startMs = millis();
+  const uint32_t endUs = g_nowUs + kRunUs;
+  while ((int32_t)(g_nowUs - endUs) < 0) {
+    const uint32_t t = g_nowUs;
+    openthermLoop();
+    for (const Report& rep : kReport) {
+      uint16_t raw;
+      uint32_t age = 0;
+      if (openthermGetDataIdValue(rep.id, raw, 0xFFFFFFFFu, &age)) r.noteOk(rep.id, millis() - age);
+    }
+    g_nowUs = t + kLoopPeriodUs > g_nowUs ? t + kLoopPeriodUs : g_nowUs;
+  }
+  r.endMs = millis();
+  r.frames = otsim::g_slave.counts.requests;
+}
+
+bool readOk(OTBusESP32Pro& bus, Run& r, uint8_t id) {
+  otbus::Frame f;
+  OpenThermResponseStatus rs;
+  if (!bus.request(otbus::MessageType::READ_DATA, (otbus::DataID)id, 0, f, rs)) return false;
+  r.noteOk(id, millis());
+  return true;
+}
+
+void runBefore(OTBusESP32Pro& bus, Run& r, uint16_t timeoutPm) {
+  static const uint8_t kCore[] = {25, 28, 26, 17, 18};
+  static const uint8_t kExt[] = {24, 27, 29, 30, 31, 32, 33, 34};
+  static const uint8_t kRp[] = {48, 49, 56, 57};
+  uint8_t extRr = 0;
+  uint8_t rpRr = 0;
+  uint32_t lastRpMs = 0;
+  uint32_t lastPollMs = 0;
+
+  slaveSetup(timeoutPm);
+  r.startMs = millis();
+  const uint32_t endUs = g_nowUs + kRunUs;
+  while ((int32_t)(g_nowUs - endUs) < 0) {
+    const uint32_t t = g_nowUs;
+    bus.loop();
+    const uint32_t now = millis();
+    if (now - lastPollMs >= 2000) {
+      lastPollMs = now;
+      if (readOk(bus, r, 0)) {
+        for (uint8_t id : kCore) readOk(bus, r, id);
+        for (int i = 0; i < 2; i++) readOk(bus, r, kExt[extRr++ % sizeof(kExt)]);
+        readOk(bus, r, 5);
+        if (millis() - lastRpMs >= 5000) {
+          lastRpMs = millis();
+          readOk(bus, r, kRp[rpRr++ % sizeof(kRp)]);
+        }
+      }
+    }
+    g_nowUs = t + kLoopPeriodUs > g_nowUs ? t + kLoopPeriodUs : g_nowUs;
+  }
+  r.endMs = millis();
+  r.frames = otsim::g_slave.counts.requests;
+}
+
+double framesPerMin(const Run& r) {
+  return r.frames * 60000.0 / (double)(r.endMs - r.startMs);
+}
+
+// Prints both runs side by side; checks the declared ages of "after".
+bool compare(const char* title, const Run& before, const Run& after, bool clean) {
+  std::printf("%s, 15 min\n", title);
+  std::printf("  frames/min: before %.1f, after %.1f\n", framesPerMin(before), framesPerMin(after));
+  std::printf("  %-4s %9s   %-26s %-26s\n", "ID", "max age", "before p50 / p95 / max", "after p50 / p95 / max");
+  bool ok = framesPerMin(after) < framesPerMin(before);
+  for (const Report& rep : kReport) {
+    uint32_t b50, b95, bmx, a50, a95, amx;
+    before.agePercentiles(rep.id, b50, b95, bmx);
+    after.agePercentiles(rep.id, a50, a95, amx);
+    char bs[32], as[32];
+    if (before.okMs[rep.id].empty()) std::snprintf(bs, sizeof(bs), "never read");
+    else std::snprintf(bs, sizeof(bs), "%6.1f %6.1f %7.1f s", b50 / 1000.0, b95 / 1000.0, bmx / 1000.0);
+    std::snprintf(as, sizeof(as), "%6.1f %6.1f %7.1f s", a50 / 1000.0, a95 / 1000.0, amx / 1000.0);
+    // On a clean line the declared age holds at p95. The worst case adds the
+    // read's position in its cycle (at most the cycle budget, pollMs) and one
+    // more cycle when the budget deferred a low-priority read.
+    const bool held =
+        !clean || (!after.okMs[rep.id].empty() && a95 <= rep.maxAgeMs && amx <= rep.maxAgeMs + 2 * 2000);
+    std::printf("  %-4u %7.0f s   %-26s %-26s%s\n", rep.id, rep.maxAgeMs / 1000.0, bs, as, held ? "" : "  FAIL");
+    ok = ok && held;
+  }
+  // The control input must be at least as fresh as with the fixed list.
+  uint32_t b50, b95, bmx, a50, a95, amx;
+  before.agePercentiles(25, b50, b95, bmx);
+  after.agePercentiles(25, a50, a95, amx);
+  ok = ok && a95 <= b95;
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  openthermInit();
+  openthermApplyConfig(
+      "{\"opentherm\":{\"enabled\":true,\"autoStart\":true,\"bootDelayMs\":0,\"rxBackend\":\"rmt\","
+      "\"mode\":\"readOnly\",\"txPin\":4,\"rxPin\":5}}");
+  // Firmware consumers (EquithermController, DhwController,
+  // PressureAlarmController, BoilerEnergyController).
+  openthermDeclarePollInterest(25, 2000, OpenThermPollPriority::Control);
+  openthermDeclarePollInterest(26, 10000, OpenThermPollPriority::Normal);
+  openthermDeclarePollInterest(56, 30000, OpenThermPollPriority::Low);
+  openthermDeclarePollInterest(18, 60000, OpenThermPollPriority::Low);
+  for (uint8_t id = 116; id < 124; id++) openthermDeclarePollInterest(id, 600000, OpenThermPollPriority::Low);
+
+  static Run after[2];
+  runAfter(after[0], 0);
+  runAfter(after[1], 100);
+
+  // Second bus on the same line; the controller is not stepped any more.
+  OTBusESP32Pro bus;
+  bus.begin(5, 4, true, OTBusESP32Pro::RxBackend::Rmt);
+  static Run before[2];
+  runBefore(bus, before[0], 0);
+  runBefore(bus, before[1], 100);
+
+  bool ok = compare("clean line", before[0], after[0], true);
+  std::printf("\n");
+  ok = compare("10% timeouts", before[1], after[1], false) && ok;
+  std::printf("%s\n", ok ? "OK" : "FAIL");
+  return ok ? 0 : 1;
+}
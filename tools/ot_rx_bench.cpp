@@ -0,0 +1,257 @@
+// Host benchmark for the OpenTherm RX decoders.
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -I. tools/ot_rx_bench.cpp -o /tmp/ot_rx_bench
+//   /tmp/ot_rx_bench [frames]           synthetic jittered streams, error-rate table
+//   /tmp/ot_rx_bench --file capture.txt decode a recorded stream
+//
+// Synthetic mode encodes random valid slave frames, adds edge jitter, bit-rate
+// skew and short glitches, then decodes every frame twice:
+//  - "rmt": OtManchesterDecoder on the exact run lengths (what the RMT
+//    peripheral captures; runs below the 3 us input filter are dropped),
+//  - "isr": a model of OpenTherm::handleInterrupt() where each edge is
+//    serviced after an interrupt latency and samples the pin at that moment.
+// "err" counts frames that are not delivered correctly; "silent" counts wrong
+// frames that still pass the parity check.
+//
+// Recorded stream format: one run per line, "<level> <duration_us>", frames
+// separated by an empty line (e.g. RMT symbols dumped on the device).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../OpenThermManchester.h"
+
+namespace {
+
+struct Edge {
+  double t;   // us
+  int level;  // level after the edge
+};
+
+struct Scenario {
+  const char* name;
+  double jitterUs;     // uniform +-jitter per edge
+  double skew;         // bit-rate error, +-fraction
+  double glitchProb;   // glitches per frame (probability of one)
+  double busyProb;     // probability an edge meets a long interrupt latency
+  double busyMinUs;
+  double busyMaxUs;
+};
+
+bool parityOk(uint32_t f) {
+  return (__builtin_popcount(f) & 1) == 0;
+}
+
+uint32_t randomResponse(std::mt19937& rng) {
+  const uint32_t type = 4 + (rng() % 4);  // READ_ACK .. UNKNOWN_DATA_ID
+  const uint32_t id = rng() % 128;
+  const uint32_t value = rng() & 0xFFFF;
+  uint32_t f = (type << 28) | (id << 16) | value;
+  if (!parityOk(f)) f |= 0x80000000UL;
+  return f;
+}
+
+// Waveform as edges, starting from idle (0); the line ends idle.
+std::vector<Edge> encode(uint32_t frame, const Scenario& sc, std::mt19937& rng) {
+  std::uniform_real_distribution<double> u(-1.0, 1.0);
+  const double half = 500.0 * (1.0 + sc.skew * u(rng));
+  int halves[68];
+  for (int b = 0; b < 34; b++) {
+    const int bit = (b == 0 || b == 33) ? 1 : (int)((frame >> (32 - b)) & 1);
+    halves[2 * b] = bit ? 1 : 0;
+    halves[2 * b + 1] = bit ? 0 : 1;
+  }
+  std::vector<Edge> edges;
+  int level = 0;
+  const double t0 = 2000.0;
+  for (int h = 0; h < 68; h++) {
+    if (halves[h] != level) {
+      level = halves[h];
+      edges.push_back({t0 + h * half + sc.jitterUs * u(rng), level});
+    }
+  }
+  if (level != 0) edges.push_back({t0 + 68 * half + sc.jitterUs * u(rng), 0});
+
+  if (std::uniform_real_distribution<double>(0, 1)(rng) < sc.glitchProb) {
+    const double at = t0 + std::uniform_real_distribution<double>(0, 68 * half)(rng);
+    const double width = std::uniform_real_distribution<double>(1, 60)(rng);
+    size_t i = 0;
+    while (i < edges.size() && edges[i].t < at) i++;
+    const int cur = i ? edges[i - 1].level : 0;
+    if (i == edges.size() || edges[i].t > at + width) {
+      edges.insert(edges.begin() + i, {at + width, cur});
+      edges.insert(edges.begin() + i, {at, cur ^ 1});
+    }
+  }
+  return edges;
+}
+
+int levelAt(const std::vector<Edge>& edges, double t) {
+  int level = 0;
+  for (const Edge& e : edges) {
+    if (e.t > t) break;
+    level = e.level;
+  }
+  return level;
+}
+
+// RMT view: runs between edges; the last idle run is reported with duration 0.
+OtManchesterResult decodeRmt(const std::vector<Edge>& edges, uint32_t& out) {
+  OtManchesterDecoder dec(true);
+  for (size_t i = 0; i < edges.size(); i++) {
+    const double dur = (i + 1 < edges.size()) ? edges[i + 1].t - edges[i].t : 0.0;
+    if (dur > 0.0 && dur < 3.0) continue;  // RMT input filter
+    dec.feed((uint8_t)edges[i].level, (uint32_t)(dur + 0.5));
+  }
+  return dec.finish(out);
+}
+
+// Model of OpenTherm::handleInterrupt() (master). Returns true when the state
+// machine reaches RESPONSE_READY.
+bool decodeIsr(const std::vector<Edge>& edges, const Scenario& sc, std::mt19937& rng, uint32_t& out) {
+  std::uniform_real_distribution<double> u(0, 1);
+  enum { WAITING, START_BIT, RECEIVING, READY, INVALID } st = WAITING;
+  double ts = 0, lastService = -1e9;
+  uint32_t resp = 0;
+  int idx = 0;
+  for (const Edge& e : edges) {
+    // An edge arriving before the previous interrupt was serviced is merged into it.
+    if (e.t < lastService) continue;
+    double lat = 2.0 + 8.0 * u(rng);
+    if (u(rng) < sc.busyProb) lat = sc.busyMinUs + (sc.busyMaxUs - sc.busyMinUs) * u(rng);
+    const double s = std::max(e.t + lat, lastService + 2.0);
+    lastService = s;
+    const int level = levelAt(edges, s);
+    if (st == WAITING) {
+      st = level ? START_BIT : INVALID;
+      ts = s;
+    } else if (st == START_BIT) {
+      if (s - ts < 750 && level == 0) {
+        st = RECEIVING;
+        ts = s;
+        idx = 0;
+      } else {
+        st = INVALID;
+      }
+    } else if (st == RECEIVING) {
+      if (s - ts > 750) {
+        if (idx < 32) {
+          resp = (resp << 1) | (uint32_t)!level;
+          ts = s;
+          idx++;
+        } else {
+          st = READY;
+        }
+      }
+    }
+    if (st == INVALID || st == READY) break;
+  }
+  out = resp;
+  return st == READY;
+}
+
+void runSynthetic(unsigned frames) {
+  static const Scenario kScenarios[] = {
+    {"clean",            0.0, 0.00, 0.00, 0.000,   0,   0},
+    {"jitter 50us",     50.0, 0.02, 0.00, 0.000,   0,   0},
+    {"jitter 120us",   120.0, 0.05, 0.00, 0.000,   0,   0},
+    {"glitches",        30.0, 0.02, 0.30, 0.000,   0,   0},
+    {"wifi latency",    30.0, 0.02, 0.00, 0.010,  50, 300},
+    {"wifi+ble heavy",  50.0, 0.03, 0.05, 0.050, 100, 700},
+  };
+  std::printf("%-16s %8s %8s %8s %8s %8s\n", "scenario", "frames", "rmt err", "silent", "isr err", "silent");
+  unsigned long resultCounts[(int)OtManchesterResult::Long + 1] = {0};
+  for (const Scenario& sc : kScenarios) {
+    std::mt19937 rng(12345);
+    unsigned rmtErr = 0, rmtSilent = 0, isrErr = 0, isrSilent = 0;
+    for (unsigned i = 0; i < frames; i++) {
+      const uint32_t truth = randomResponse(rng);
+      const std::vector<Edge> edges = encode(truth, sc, rng);
+
+      uint32_t f = 0;
+      const OtManchesterResult r = decodeRmt(edges, f);
+      resultCounts[(int)r]++;
+      if (r != OtManchesterResult::Ok || !parityOk(f)) rmtErr++;
+      else if (f != truth) { rmtErr++; rmtSilent++; }
+
+      uint32_t g = 0;
+      if (!decodeIsr(edges, sc, rng, g) || !parityOk(g)) isrErr++;
+      else if (g != truth) { isrErr++; isrSilent++; }
+    }
+    std::printf("%-16s %8u %7.3f%% %8u %7.3f%% %8u\n", sc.name, frames,
+                100.0 * rmtErr / frames, rmtSilent, 100.0 * isrErr / frames, isrSilent);
+  }
+  std::printf("\nrmt decoder results:");
+  for (int r = 0; r <= (int)OtManchesterResult::Long; r++) {
+    if (resultCounts[r]) std::printf(" %s=%lu", OtManchesterDecoder::resultText((OtManchesterResult)r), resultCounts[r]);
+  }
+  std::printf("\n");
+
+  // Decoder cost per frame (host CPU, pre-built run lists).
+  std::mt19937 rng(1);
+  std::vector<std::vector<Edge>> set;
+  for (int i = 0; i < 1000; i++) set.push_back(encode(randomResponse(rng), kScenarios[1], rng));
+  const auto t0 = std::chrono::steady_clock::now();
+  uint32_t sink = 0;
+  const int rounds = 200;
+  for (int k = 0; k < rounds; k++) {
+    for (const auto& e : set) {
+      uint32_t f = 0;
+      decodeRmt(e, f);
+      sink += f;
+    }
+  }
+  const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+  std::printf("decode: %.0f ns/frame (host, checksum %08x)\n", ns / (rounds * set.size()), (unsigned)sink);
+}
+
+int runFile(const char* path) {
+  FILE* fp = std::fopen(path, "r");
+  if (!fp) {
+    std::perror(path);
+    return 1;
+  }
+  char line[64];
+  OtManchesterDecoder dec(true);
+  bool any = false;
+  unsigned n = 0, bad = 0;
+  auto flush = [&]() {
+    if (!any) return;
+    uint32_t f = 0;
+    const OtManchesterResult r = dec.finish(f);
+    const bool ok = r == OtManchesterResult::Ok && parityOk(f);
+    std::printf("%4u %-10s 0x%08X%s\n", n, OtManchesterDecoder::resultText(r), (unsigned)f,
+                (r == OtManchesterResult::Ok && !ok) ? " parity" : "");
+    n++;
+    if (!ok) bad++;
+    dec.reset();
+    any = false;
+  };
+  while (std::fgets(line, sizeof(line), fp)) {
+    unsigned level = 0, dur = 0;
+    if (std::sscanf(line, "%u %u", &level, &dur) == 2) {
+      dec.feed((uint8_t)level, dur);
+      any = true;
+    } else {
+      flush();
+    }
+  }
+  flush();
+  std::fclose(fp);
+  std::printf("# frames=%u bad=%u\n", n, bad);
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc >= 3 && std::strcmp(argv[1], "--file") == 0) return runFile(argv[2]);
+  const unsigned frames = (argc >= 2) ? (unsigned)std::strtoul(argv[1], nullptr, 10) : 20000;
+  runSynthetic(frames ? frames : 20000);
+  return 0;
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+// Simulated OpenTherm boiler for the host tools that run the OpenTherm stack
+// (OpenThermController.cpp, OTBusESP32Pro.cpp, OpenTherm.cpp) unchanged on a
+// virtual clock: tools/ot_slave_sim.cpp and tools/ot_poll_sim.cpp. Include it
+// from the tool's .cpp only: it defines the Arduino clock functions and the
+// OpenThermRmtRx methods.
+//
+// Master -> slave: the request is read off the TX pin writes of
+// OpenTherm::sendBit() (Manchester, 1 ms per bit, so a transmit takes 34 ms
+// of virtual time as on the wire). Slave -> master: OpenThermRmtRx (config
+// rxBackend "rmt") is a capture of the simulated line. arm() starts it,
+// poll() returns the first frame on the line after that, and frames that
+// ended before arm() are gone. A late answer to a request that already timed
+// out therefore lands in the capture of the next request, as it would on
+// the real line.
+//
+// Faults are drawn per request: no answer, an answer with a flipped bit (bad
+// parity), or an answer after the master's 1 s timeout.
+
+#include <cstdio>
+#include <deque>
+
+#include "../OpenTherm.h"
+#include "../OpenThermRmtRx.h"
+
+// ---- virtual clock -----------------------------------------------------------
+
+static uint32_t g_nowUs = 0;
+uint32_t millis() { return g_nowUs / 1000u; }
+uint32_t micros() { return g_nowUs; }
+void delay(uint32_t ms) { g_nowUs += ms * 1000u; }
+void delayMicroseconds(uint32_t us) { g_nowUs += us; }
+// Busy-wait loops (OTBusESP32Pro::request()) advance the clock per turn.
+void yield() { g_nowUs += 100; }
+
+namespace otsim {
+
+struct Rng {
+  uint32_t s = 0x5EED0u;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  uint32_t below(uint32_t n) { return n ? next() % n : 0; }
+};
+
+struct Faults {
+  uint16_t timeoutPm = 0;  // per mille of requests: no answer
+  uint16_t parityPm = 0;   // answer with one bit flipped
+  uint16_t latePm = 0;     // answer 1.05..1.35 s after the request
+};
+
+struct Counts {
+  uint32_t requests = 0;
+  uint32_t timeouts = 0;  // injected
+  uint32_t parity = 0;
+  uint32_t late = 0;
+  // What the master captured, by what the frame was:
+  uint32_t gotAck = 0;      // the answer to this request
+  uint32_t gotUnknown = 0;  // UNKNOWN_DATA_ID for this request
+  uint32_t gotParity = 0;   // this request's answer, corrupted
+  uint32_t gotStray = 0;    // a late answer to an earlier request
+  uint32_t gotExpired = 0;  // this request's answer, after the master gave up
+};
+
+struct LineFrame {
+  uint32_t atUs;  // end of the frame on the line
+  uint32_t word;
+  uint32_t reqNo;
+  bool corrupt;
+};
+
+class Slave {
+public:
+  // Answer time of a good response (the spec allows 20..800 ms).
+  uint32_t minLatencyUs = 40000;
+  uint32_t maxLatencyUs = 160000;
+  Faults faults;
+  Counts counts;
+  Rng rng;
+
+  Slave() { reset(); }
+
+  // Supported IDs answer READ_ACK with value(); the rest UNKNOWN_DATA_ID.
+  void reset() {
+    for (uint16_t id = 0; id < 128; id++) _supported[id] = false;
+    static const uint8_t kIds[] = {0, 1, 3, 5, 14, 17, 18, 25, 26, 27, 28, 48, 49, 56, 57, 127};
+    for (uint8_t id : kIds) _supported[id] = true;
+    counts = Counts{};
+    faults = Faults{};
+    _line.clear();
+    _levels.clear();
+    _armed = false;
+    silent = false;
+  }
+  void setSupported(uint8_t id, bool on) { _supported[id & 0x7F] = on; }
+
+  // Every supported ID has a value unique to it, so a response published
+  // under the wrong Data-ID is visible in the telemetry.
+  static uint16_t value(uint8_t id) {
+    switch (id) {
+      case 0: return 0x000A;       // slave: CH active, flame on
+      case 3: return 0x0105;       // DHW present, member ID 5
+      case 5: return 0x0000;       // no fault
+      case 48: return 0x3C28;      // DHW setpoint bounds 60 / 40
+      case 49: return 0x5019;      // max CH setpoint bounds 80 / 25
+      case 127: return 0x0203;     // product type 2, version 3
+      default: return (uint16_t)((id << 8) | 0x80);  // f8.8: id + 0.5
+    }
+  }
+
+  bool silent = false;  // no answer at all (adapter unplugged)
+
+  // ---- line ----
+  void onPinWrite(int level) {
+    // sendBit(): the first half of each bit is active (LOW) for a 1. Only
+    // the last frame's writes are kept.
+    _levels.push_back(level);
+    if (_levels.size() > 69) _levels.pop_front();
+  }
+
+  // Called from OpenThermRmtRx::arm(), right after the transmit.
+  void onRequestSent() {
+    uint32_t req = 0;
+    const bool ok = _levels.size() == 69;  // 34 bits, two writes each, + idle
+    if (ok) {
+      for (int b = 1; b <= 32; b++) req = (req << 1) | (_levels[2 * b] == LOW ? 1u : 0u);
+    }
+    _levels.clear();
+    _armed = true;
+    _armUs = g_nowUs;
+    while (!_line.empty() && (int32_t)(_line.front().atUs - g_nowUs) < 0) _line.pop_front();
+    if (!ok) return;
+    counts.requests++;
+    _reqNo++;
+    if (!silent) answer(req);
+  }
+
+  bool capture(uint32_t& outWord) {
+    if (!_armed || _line.empty() || (int32_t)(g_nowUs - _line.front().atUs) < 0) return false;
+    const LineFrame f = _line.front();
+    _line.pop_front();
+    _armed = false;
+    outWord = f.word;
+    // OpenTherm::process() times a request out 1 s after the transmit; late
+    // answers end at least 84 ms after that, past the next loop() call.
+    if (f.reqNo != _reqNo) counts.gotStray++;
+    else if (g_nowUs - _armUs > 1000000) counts.gotExpired++;
+    else if (f.corrupt) counts.gotParity++;
+    else if (((f.word >> 28) & 7) == (uint32_t)OpenThermMessageType::UNKNOWN_DATA_ID) counts.gotUnknown++;
+    else counts.gotAck++;
+    return true;
+  }
+
+private:
+  void answer(uint32_t req) {
+    const uint8_t id = (uint8_t)((req >> 16) & 0xFF);
+    const uint8_t type = (uint8_t)((req >> 28) & 7);
+    uint32_t word;
+    if (id < 128 && _supported[id]) {
+      const bool write = type == (uint8_t)OpenThermMessageType::WRITE_DATA;
+      word = OpenTherm::buildResponse(write ? OpenThermMessageType::WRITE_ACK : OpenThermMessageType::READ_ACK,
+                                      (OpenThermMessageID)id, write ? (uint16_t)req : value(id));
+    } else {
+      word = OpenTherm::buildResponse(OpenThermMessageType::UNKNOWN_DATA_ID, (OpenThermMessageID)id, 0);
+    }
+
+    const uint32_t roll = rng.below(1000);
+    uint32_t latencyUs = minLatencyUs + rng.below(maxLatencyUs - minLatencyUs + 1);
+    if (roll < faults.timeoutPm) {
+      counts.timeouts++;
+      return;
+    }
+    bool corrupt = false;
+    if (roll < (uint32_t)faults.timeoutPm + faults.parityPm) {
+      counts.parity++;
+      corrupt = true;
+      word ^= 1u << (rng.below(16));
+    } else if (roll < (uint32_t)faults.timeoutPm + faults.parityPm + faults.latePm) {
+      counts.late++;
+      latencyUs = 1050000 + rng.below(300000);
+    }
+    // Frame end: answer time plus the 34 ms the response takes on the line.
+    LineFrame f{g_nowUs + latencyUs + 34000, word, _reqNo, corrupt};
+    auto it = _line.begin();
+    while (it != _line.end() && (int32_t)(it->atUs - f.atUs) <= 0) ++it;
+    _line.insert(it, f);
+  }
+
+  bool _supported[128];
+  std::deque<LineFrame> _line;
+  std::deque<int> _levels;
+  uint32_t _reqNo = 0;
+  uint32_t _armUs = 0;
+  bool _armed = false;
+};
+
+inline Slave g_slave;
+
+inline void pinWrite(int, int level) { g_slave.onPinWrite(level); }
+
+}  // namespace otsim
+
+// ---- OpenThermRmtRx on the simulated line -----------------------------------
+
+OpenThermRmtRx::~OpenThermRmtRx() {}
+
+bool OpenThermRmtRx::begin(int, bool high) {
+  activeHigh = high;
+  alive = true;
+  hostPinWrite = otsim::pinWrite;
+  return true;
+}
+
+void OpenThermRmtRx::end() { alive = false; }
+
+bool OpenThermRmtRx::arm() {
+  armed = true;
+  otsim::g_slave.onRequestSent();
+  return true;
+}
+
+bool OpenThermRmtRx::poll(uint32_t& outFrame, OtManchesterResult& outResult) {
+  if (!armed || !otsim::g_slave.capture(outFrame)) return false;
+  armed = false;
+  outResult = OtManchesterResult::Ok;
+  counts[(uint8_t)OtManchesterResult::Ok]++;
+  return true;
+}
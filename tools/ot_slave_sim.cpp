@@ -0,0 +1,219 @@
+// Host test of the asynchronous OpenTherm transaction engine (otStep() in
+// OpenThermController.cpp) against a simulated boiler, and the loop() stall
+// of the former blocking poll (otPollOnce) for comparison.
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -Itools/host -I. tools/ot_slave_sim.cpp OpenThermController.cpp OpenThermDataIds.cpp OTBusESP32Pro.cpp OpenTherm.cpp RetryPolicy.cpp -o /tmp/ot_slave_sim
+//   /tmp/ot_slave_sim
+//
+// The controller, OTBusESP32Pro and the OpenTherm library are compiled
+// unchanged against the stand-ins in tools/host/; the boiler is the line
+// model of tools/ot_sim_slave.h (rxBackend "rmt"). openthermLoop() is
+// called every 5 ms of virtual time, 10 min per scenario: clean line, 10 %
+// timeouts, 10 % bad parity, 10 % answers after the 1 s timeout, and a
+// dead slave. Checked after every call: each published value is either
+// unavailable (NaN / 0) or the value the boiler sends for that Data-ID,
+// so a response published under another ID fails. Per scenario the
+// ok / timeout / invalid counters must match what the master captured.
+// "before" runs the nine blocking request() calls of the removed
+// otPollOnce() every 2 s on a second bus and reports the loop() stall.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "ot_sim_slave.h"
+
+#include "OTBusESP32Pro.h"
+#include "OpenThermController.h"
+
+namespace {
+
+constexpr uint32_t kLoopPeriodUs = 5000;
+constexpr uint32_t kScenarioUs = 10u * 60u * 1000000u;
+constexpr uint32_t kBeforeUs = 2u * 60u * 1000000u;
+
+struct Scenario {
+  const char* name;
+  otsim::Faults faults;
+  bool silent;
+};
+
+const Scenario kScenarios[] = {
+  {"clean", {0, 0, 0}, false},
+  {"10% timeouts", {100, 0, 0}, false},
+  {"10% bad parity", {0, 100, 0}, false},
+  {"10% late (>1 s)", {0, 0, 100}, false},
+  {"dead slave", {0, 0, 0}, true},
+};
+
+struct Lat {
+  std::vector<uint32_t> us;
+  uint32_t pct(uint8_t p) {
+    if (us.empty()) return 0;
+    std::sort(us.begin(), us.end());
+    return us[(us.size() - 1) * p / 100];
+  }
+  uint32_t max() { return us.empty() ? 0 : *std::max_element(us.begin(), us.end()); }
+};
+
+// NaN (not read yet / invalidated) or the boiler's value for that ID.
+bool fieldOk(float v, float expect) {
+  return std::isnan(v) || std::fabs(v - expect) < 0.001f;
+}
+
+float f88(uint8_t id) {
+  return (float)(int16_t)otsim::Slave::value(id) / 256.0f;
+}
+
+uint32_t g_wrong = 0;
+uint32_t g_wrongPrinted = 0;
+
+void checkTelemetry(const OpenThermTelemetry& t) {
+  struct Field {
+    const char* name;
+    float v;
+    float expect;
+  };
+  const Field fields[] = {
+    {"boilerTempC (25)", t.boilerTempC, f88(25)},
+    {"dhwTempC (26)", t.dhwTempC, f88(26)},
+    {"returnTempC (28)", t.returnTempC, f88(28)},
+    {"outsideTempC (27)", t.outsideTempC, f88(27)},
+    {"modulationPct (17)", t.modulationPct, f88(17)},
+    {"pressureBar (18)", t.pressureBar, f88(18)},
+    {"dhwSetpointC (56)", t.dhwSetpointC, f88(56)},
+    {"maxChSetpointC (57)", t.maxChSetpointC, f88(57)},
+    {"dhwBoundMaxC (48)", t.dhwBoundMaxC, 60.0f},
+    {"dhwBoundMinC (48)", t.dhwBoundMinC, 40.0f},
+    {"maxChBoundMaxC (49)", t.maxChBoundMaxC, 80.0f},
+    {"maxChBoundMinC (49)", t.maxChBoundMinC, 25.0f},
+    // IDs the boiler does not support stay unavailable.
+    {"roomTempC (24)", t.roomTempC, NAN},
+    {"exhaustTempC (33)", t.exhaustTempC, NAN},
+  };
+  bool bad = false;
+  for (const Field& f : fields) {
+    if (fieldOk(f.v, f.expect)) continue;
+    bad = true;
+    if (g_wrongPrinted++ < 5) std::printf("    wrong value at %u ms: %s = %g\n", (unsigned)millis(), f.name, f.v);
+  }
+  if (t.slaveStatusRaw != 0 && t.slaveStatusRaw != 0x0A) bad = true;
+  if (t.faultFlags != 0 || t.oemFaultCode != 0) bad = true;
+  if (bad) g_wrong++;
+}
+
+bool runAfter(const Scenario& sc) {
+  otsim::g_slave.reset();
+  otsim::g_slave.faults = sc.faults;
+  otsim::g_slave.silent = sc.silent;
+  const OpenThermTelemetry t0 = openthermGetTelemetry();
+  g_wrong = 0;
+  g_wrongPrinted = 0;
+
+  Lat lat;
+  uint32_t cycles = 0;
+  uint32_t lastCycle = t0.lastUpdateMs;
+  const uint32_t endUs = g_nowUs + kScenarioUs;
+  while ((int32_t)(g_nowUs - endUs) < 0) {
+    const uint32_t t = g_nowUs;
+    openthermLoop();
+    lat.us.push_back(g_nowUs - t);
+    const OpenThermTelemetry tel = openthermGetTelemetry();
+    checkTelemetry(tel);
+    if (tel.lastUpdateMs != lastCycle) {
+      lastCycle = tel.lastUpdateMs;
+      cycles++;
+    }
+    g_nowUs = t + kLoopPeriodUs > g_nowUs ? t + kLoopPeriodUs : g_nowUs;
+  }
+
+  const OpenThermTelemetry t1 = openthermGetTelemetry();
+  const otsim::Counts& c = otsim::g_slave.counts;
+  const uint32_t ok = t1.okCount - t0.okCount;
+  const uint32_t to = t1.timeoutCount - t0.timeoutCount;
+  const uint32_t inv = t1.invalidCount - t0.invalidCount;
+  const uint32_t captured = c.gotAck + c.gotUnknown + c.gotParity + c.gotStray;
+
+  std::printf("  %-16s loop() p50 %5.2f ms  p99 %5.2f ms  max %5.2f ms  cycles %u  frames/min %u\n", sc.name,
+              lat.pct(50) / 1000.0, lat.pct(99) / 1000.0, lat.max() / 1000.0, cycles, t1.framesPerMin);
+  std::printf("    slave: %u requests, injected %u timeouts / %u parity / %u late; captured %u ack, %u unknown, "
+              "%u corrupt, %u stray, %u expired\n",
+              c.requests, c.timeouts, c.parity, c.late, c.gotAck, c.gotUnknown, c.gotParity, c.gotStray,
+              c.gotExpired);
+  std::printf("    master: ok %u, timeout %u, invalid %u; wrong published values in %u loop calls\n", ok, to, inv,
+              g_wrong);
+
+  // A request in flight at a scenario change counts in the next one.
+  bool pass = g_wrong == 0 && lat.max() <= 40000;
+  pass = pass && ok == c.gotAck;
+  pass = pass && inv == c.gotUnknown + c.gotParity + c.gotStray;
+  pass = pass && to + captured + 1 >= c.requests && to + captured <= c.requests + 1;
+  if (sc.silent) {
+    pass = pass && t1.reasonCode == OpenThermReason::Timeout && std::isnan(t1.boilerTempC) && ok == 0;
+  } else {
+    pass = pass && cycles > 0;
+  }
+  if (!pass) std::printf("    FAIL\n");
+  return pass;
+}
+
+// The removed otPollOnce(): status exchange plus eight telemetry reads, each
+// a blocking request() (transmit, wait for the answer or the 1 s timeout,
+// 100 ms inter-frame delay), all inside one openthermLoop() call.
+void runBefore(OTBusESP32Pro& bus, const Scenario& sc) {
+  static const uint8_t kIds[] = {0, 25, 28, 26, 17, 18, 5, 56, 57};
+  otsim::g_slave.reset();
+  otsim::g_slave.faults = sc.faults;
+  otsim::g_slave.silent = sc.silent;
+
+  Lat lat;
+  uint32_t lastPollMs = millis();
+  const uint32_t endUs = g_nowUs + kBeforeUs;
+  while ((int32_t)(g_nowUs - endUs) < 0) {
+    const uint32_t t = g_nowUs;
+    bus.loop();
+    if (millis() - lastPollMs >= 2000) {
+      lastPollMs = millis();
+      for (uint8_t id : kIds) {
+        otbus::Frame f;
+        OpenThermResponseStatus rs;
+        bus.request(otbus::MessageType::READ_DATA, (otbus::DataID)id, 0, f, rs);
+      }
+    }
+    lat.us.push_back(g_nowUs - t);
+    g_nowUs = t + kLoopPeriodUs > g_nowUs ? t + kLoopPeriodUs : g_nowUs;
+  }
+  std::printf("  %-16s loop() p50 %5.2f ms  p99 %7.2f ms  max %7.2f ms\n", sc.name, lat.pct(50) / 1000.0,
+              lat.pct(99) / 1000.0, lat.max() / 1000.0);
+}
+
+}  // namespace
+
+int main() {
+  openthermInit();
+  openthermApplyConfig(
+      "{\"opentherm\":{\"enabled\":true,\"autoStart\":true,\"bootDelayMs\":0,\"rxBackend\":\"rmt\","
+      "\"mode\":\"readOnly\",\"txPin\":4,\"rxPin\":5}}");
+
+  // Bus start: OpenTherm::begin() holds the line idle for 1 s (once).
+  uint32_t t = g_nowUs;
+  openthermLoop();
+  std::printf("init: first openthermLoop() %.0f ms\n", (g_nowUs - t) / 1000.0);
+
+  bool ok = true;
+  std::printf("after: asynchronous engine, openthermLoop() every 5 ms, 10 min per scenario\n");
+  for (const Scenario& sc : kScenarios) ok = runAfter(sc) && ok;
+
+  // Second bus on the same line; the controller is not stepped any more.
+  OTBusESP32Pro bus;
+  bus.begin(5, 4, true, OTBusESP32Pro::RxBackend::Rmt);
+  std::printf("\nbefore: blocking poll of 9 Data-IDs every 2 s, 2 min per scenario\n");
+  runBefore(bus, kScenarios[0]);
+  runBefore(bus, kScenarios[1]);
+  runBefore(bus, kScenarios[4]);
+
+  std::printf("%s\n", ok ? "OK" : "FAIL");
+  return ok ? 0 : 1;
+}
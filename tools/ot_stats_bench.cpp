@@ -0,0 +1,103 @@
+// Host benchmark for the per-Data-ID OpenTherm statistics (OpenThermStats.h).
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -I. tools/ot_stats_bench.cpp -o /tmp/ot_stats_bench
+//   /tmp/ot_stats_bench
+//
+// Measures OpenThermIdStats::record() per frame for several latency mixes
+// (including saturated histograms) to show the cost does not depend on the
+// history, and the cost of a percentile query as used by the JSON endpoints.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../OpenThermStats.h"
+
+namespace {
+
+struct Sample {
+  uint8_t id;
+  OtExchangeResult r;
+  uint32_t latMs;
+};
+
+std::vector<Sample> makeSamples(size_t n, double timeoutRate, double unknownRate, uint32_t latMaxMs, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(0, 1);
+  std::vector<Sample> v;
+  v.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    Sample s;
+    s.id = (uint8_t)(rng() % 128);
+    const double x = u(rng);
+    if (x < timeoutRate) {
+      s.r = OtExchangeResult::Timeout;
+      s.latMs = 1100;
+    } else if (x < timeoutRate + unknownRate) {
+      s.r = OtExchangeResult::Unknown;
+      s.latMs = 40 + rng() % latMaxMs;
+    } else {
+      s.r = OtExchangeResult::Ok;
+      s.latMs = 40 + rng() % latMaxMs;
+    }
+    v.push_back(s);
+  }
+  return v;
+}
+
+double nsPerRecord(OpenThermIdStats* stats, const std::vector<Sample>& samples, int rounds) {
+  const auto t0 = std::chrono::steady_clock::now();
+  uint32_t now = 1;
+  for (int k = 0; k < rounds; k++) {
+    for (const Sample& s : samples) stats[s.id].record(s.r, s.latMs, now++);
+  }
+  const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+  return ns / ((double)rounds * samples.size());
+}
+
+}  // namespace
+
+int main() {
+  struct Mix {
+    const char* name;
+    double timeoutRate;
+    double unknownRate;
+    uint32_t latMaxMs;
+  } mixes[] = {
+    {"fast boiler", 0.00, 0.00, 60},
+    {"typical", 0.01, 0.05, 300},
+    {"slow + timeouts", 0.20, 0.10, 900},
+  };
+
+  std::printf("sizeof(OpenThermIdStats) = %zu B, 128 IDs = %zu B\n\n",
+              sizeof(OpenThermIdStats), 128 * sizeof(OpenThermIdStats));
+  std::printf("%-18s %12s %12s\n", "mix", "fresh ns", "saturated ns");
+  static OpenThermIdStats stats[128];
+  for (const Mix& m : mixes) {
+    const std::vector<Sample> samples = makeSamples(100000, m.timeoutRate, m.unknownRate, m.latMaxMs, 7);
+    for (OpenThermIdStats& s : stats) s = OpenThermIdStats();
+    const double fresh = nsPerRecord(stats, samples, 1);
+    // ~20M frames per pass: every bucket in use saturates and gets halved repeatedly.
+    nsPerRecord(stats, samples, 200);
+    const double saturated = nsPerRecord(stats, samples, 20);
+    std::printf("%-18s %12.1f %12.1f\n", m.name, fresh, saturated);
+  }
+
+  const auto t0 = std::chrono::steady_clock::now();
+  uint64_t sink = 0;
+  const int rounds = 20000;
+  for (int k = 0; k < rounds; k++) {
+    for (const OpenThermIdStats& s : stats) sink += s.latencyPercentileMs((uint8_t)(50 + (k & 1) * 45));
+  }
+  const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+  std::printf("\npercentile query: %.1f ns (checksum %llu)\n", ns / (rounds * 128.0), (unsigned long long)sink);
+
+  const OpenThermIdStats& s = stats[25];
+  std::printf("example id 25: ok=%u timeout=%u unknown=%u p50=%u p95=%u max=%u cost=%u hist=",
+              (unsigned)s.ok, (unsigned)s.timeout, (unsigned)s.unknown, (unsigned)s.latencyPercentileMs(50),
+              (unsigned)s.latencyPercentileMs(95), (unsigned)s.maxMs, (unsigned)s.costMs);
+  for (uint8_t b = 0; b < kOtLatencyBuckets; b++) std::printf("%u%s", (unsigned)s.hist[b], b + 1 < kOtLatencyBuckets ? "/" : "\n");
+  return 0;
+}
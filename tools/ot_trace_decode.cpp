@@ -0,0 +1,322 @@
+// Host decoder of an OpenTherm frame trace downloaded from
+// /api/opentherm/trace, with the firmware's own Data-ID table.
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -Itools/host -I. tools/ot_trace_decode.cpp OpenThermDataIds.cpp -o /tmp/ot_trace_decode
+//   curl -o ot_trace.bin http://<device>/api/opentherm/trace
+//   /tmp/ot_trace_decode ot_trace.bin [--id 25] [--csv | --json]
+//   /tmp/ot_trace_decode                 # self-check on a synthetic dump
+//
+// The dump layout is read through the structs of OpenThermTrace.h (the
+// ESP32 and the PC are both little-endian). Response values are decoded by
+// openthermDecodeDataIdValue() from OpenThermDataIds.cpp into the
+// ArduinoJson stand-in, so the tool prints exactly what
+// /api/opentherm/dataid/read and the trace replay report: f8.8 and s16
+// temperatures, s8 bounds, status / configuration flags, RBP masks, TSP,
+// capacity, day/time, date, year. Default output: one line per frame
+// (seq, time relative to the dump start, origin, response status, Data-ID,
+// request value, message type, decoded value, duration) and the value
+// timeline of every Data-ID. --csv prints
+// seq,t_ms,origin,status,mt,id,value; --json one decoded JSON object per
+// frame.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "OpenThermDataIds.h"
+#include "OpenThermTrace.h"
+
+namespace {
+
+const char* statusText(uint8_t s) {
+  static const char* const kText[] = {"NONE", "SUCCESS", "INVALID", "TIMEOUT"};
+  return s < 4 ? kText[s] : "?";
+}
+
+const char* originText(uint8_t o) {
+  switch ((OpenThermTraceOrigin)o) {
+    case OpenThermTraceOrigin::Poll: return "poll";
+    case OpenThermTraceOrigin::Scan: return "scan";
+    case OpenThermTraceOrigin::Raw: return "raw";
+  }
+  return "?";
+}
+
+const char* msgTypeText(uint8_t mt) {
+  static const char* const kText[] = {"READ_DATA", "WRITE_DATA", "INVALID_DATA", "RESERVED",
+                                      "READ_ACK",  "WRITE_ACK",  "DATA_INVALID", "UNKNOWN_DATA_ID"};
+  return kText[mt & 7];
+}
+
+uint8_t frameType(uint32_t f) { return (uint8_t)((f >> 28) & 7); }
+uint8_t frameId(uint32_t f) { return (uint8_t)((f >> 16) & 0xFF); }
+uint16_t frameValue(uint32_t f) { return (uint16_t)(f & 0xFFFF); }
+
+// The response carries a value (READ_ACK / WRITE_ACK); DATA_INVALID and
+// UNKNOWN_DATA_ID answers are listed without one.
+bool hasValue(const OpenThermTraceRecord& r) {
+  return r.status == 1 && (frameType(r.response) == 4 || frameType(r.response) == 5);
+}
+
+struct Trace {
+  OpenThermTraceHeader hdr;
+  std::vector<OpenThermTraceRecord> recs;
+};
+
+bool readTrace(const char* path, Trace& t, std::string& err) {
+  FILE* fp = std::fopen(path, "rb");
+  if (!fp) {
+    err = "cannot open file";
+    return false;
+  }
+  const bool hdrOk = std::fread(&t.hdr, sizeof(t.hdr), 1, fp) == 1;
+  if (!hdrOk || t.hdr.magic != kOpenThermTraceMagic || t.hdr.version != kOpenThermTraceVersion ||
+      t.hdr.recordSize != sizeof(OpenThermTraceRecord)) {
+    std::fclose(fp);
+    err = hdrOk ? "not an OpenTherm trace (magic/version/record size mismatch)" : "trace too short";
+    return false;
+  }
+  OpenThermTraceRecord r;
+  while (std::fread(&r, sizeof(r), 1, fp) == 1) t.recs.push_back(r);
+  std::fclose(fp);
+  return true;
+}
+
+// Decoded value as the firmware reports it, and a short text form: f8.8 /
+// s16 temperature / the ID-specific fields, or the raw value when the
+// generic fields are all there is.
+struct Decoded {
+  std::string json;
+  std::string text;
+  std::string unit;
+};
+
+Decoded decode(uint8_t id, uint16_t raw) {
+  Decoded d;
+  StaticJsonDocument<640> doc;
+  JsonObject val = doc.to<JsonObject>();
+  openthermDecodeDataIdValue(val, id, raw);
+  String s;
+  serializeJson(doc, s);
+  d.json = s.c_str();
+  d.unit = openthermDataIdMeta(id).unit;
+
+  char buf[32];
+  if (val.containsKey("f88")) {
+    std::snprintf(buf, sizeof(buf), "%.2f", val["f88"].as<float>());
+    d.text = buf;
+    return d;
+  }
+  if (val.containsKey("celsius")) {
+    std::snprintf(buf, sizeof(buf), "%d", val["celsius"].as<int>());
+    d.text = buf;
+    return d;
+  }
+  static const char* const kGeneric[] = {"raw", "hb", "lb", "u16", "s16", "unit"};
+  for (const char* k : kGeneric) val.remove(k);
+  if (val.size() > 0) {
+    serializeJson(doc, s);
+    d.text = s.c_str();
+  } else {
+    std::snprintf(buf, sizeof(buf), "0x%04X", (unsigned)raw);
+    d.text = buf;
+    d.unit.clear();
+  }
+  return d;
+}
+
+enum class Format { Text, Csv, Json };
+
+// RFC 4180 field: quoted (inner quotes doubled) when it holds ',' or '"'.
+std::string csvField(const std::string& v) {
+  if (v.find_first_of(",\"") == std::string::npos) return v;
+  std::string out = "\"";
+  for (char c : v) {
+    if (c == '"') out += '"';
+    out += c;
+  }
+  return out + "\"";
+}
+
+// Prints the trace; returns the number of decoded responses.
+size_t printTrace(const Trace& t, int onlyId, Format fmt, FILE* out) {
+  if (fmt == Format::Text) {
+    std::fprintf(out, "# capacity=%u first=%u frames=%zu\n", (unsigned)t.hdr.capacity, (unsigned)t.hdr.firstSeq,
+                 t.recs.size());
+  }
+  std::map<uint8_t, std::vector<std::pair<double, std::string>>> timeline;
+  size_t decoded = 0;
+  for (size_t i = 0; i < t.recs.size(); i++) {
+    const OpenThermTraceRecord& r = t.recs[i];
+    const uint32_t seq = t.hdr.firstSeq + (uint32_t)i;
+    const uint8_t id = frameId(r.request);
+    if (onlyId >= 0 && id != onlyId) continue;
+    // Relative to the dump start; unsigned arithmetic handles the micros() wrap.
+    const double tMs = -((double)(uint32_t)(t.hdr.dumpUs - r.tUs) / 1000.0);
+    uint8_t mt = frameType(r.request);
+    Decoded d;
+    if (r.status == 1) mt = frameType(r.response);
+    const bool ok = hasValue(r);
+    if (ok) {
+      d = decode(frameId(r.response), frameValue(r.response));
+      decoded++;
+      timeline[frameId(r.response)].push_back({tMs, d.text});
+    }
+    switch (fmt) {
+      case Format::Csv:
+        std::fprintf(out, "%u,%.1f,%s,%s,%s,%u,%s\n", (unsigned)seq, tMs, originText(r.origin),
+                     statusText(r.status), msgTypeText(mt), (unsigned)id,
+                     csvField(d.text).c_str());
+        break;
+      case Format::Json:
+        std::fprintf(out,
+                     "{\"seq\":%u,\"tMs\":%.1f,\"origin\":\"%s\",\"rs\":\"%s\",\"id\":%u,\"req\":%u,\"mt\":\"%s\","
+                     "\"durMs\":%u%s%s}\n",
+                     (unsigned)seq, tMs, originText(r.origin), statusText(r.status), (unsigned)id,
+                     (unsigned)frameValue(r.request), msgTypeText(mt), (unsigned)r.durMs, ok ? ",\"val\":" : "",
+                     ok ? d.json.c_str() : "");
+        break;
+      case Format::Text:
+        std::fprintf(out, "%8u %10.1f ms %-4s %-7s id=%-3u req=0x%04X %-15s %s%s%s (%u ms)\n", (unsigned)seq, tMs,
+                     originText(r.origin), statusText(r.status), (unsigned)id, (unsigned)frameValue(r.request),
+                     msgTypeText(mt), d.text.c_str(), d.unit.empty() ? "" : " ", d.unit.c_str(), (unsigned)r.durMs);
+        break;
+    }
+  }
+  if (fmt == Format::Text) {
+    std::fprintf(out, "# timeline\n");
+    for (const auto& e : timeline) {
+      std::fprintf(out, "id %3u:", (unsigned)e.first);
+      for (const auto& p : e.second) std::fprintf(out, " %.0f:%s", p.first, p.second.c_str());
+      std::fprintf(out, "\n");
+    }
+  }
+  return decoded;
+}
+
+// ---- self-check -------------------------------------------------------------
+
+uint32_t frame(uint8_t mt, uint8_t id, uint16_t value) {
+  uint32_t f = ((uint32_t)mt << 28) | ((uint32_t)id << 16) | value;
+  if (__builtin_popcount(f) & 1) f |= 0x80000000u;
+  return f;
+}
+
+struct Expect {
+  uint8_t id;
+  uint16_t value;
+  uint8_t respType;
+  uint8_t status;
+  const char* text;  // decoded value text, "" when the response has no value
+};
+
+bool selfCheck() {
+  const Expect kFrames[] = {
+    {0, 0x000A, 4, 1, "{\"status\":{\"chEnable\":false,\"dhwEnable\":false,\"coolingEnable\":false,"
+                     "\"otcActive\":false,\"ch2Enable\":false,\"fault\":false,\"chActive\":true,\"dhwActive\":false,"
+                     "\"flameOn\":true,\"coolingActive\":false,\"ch2Active\":false,\"diagnostic\":false}}"},
+    {25, 0x1980, 4, 1, "25.50"},
+    {18, 0x0180, 4, 1, "1.50"},
+    {33, 0xFFFB, 4, 1, "-5"},
+    {48, 0x3C28, 4, 1, "{\"upper\":60,\"lower\":40}"},
+    {3, 0x0105, 4, 1, "{\"slaveCfg\":{\"memberId\":5,\"dhwPresent\":true,\"controlType\":false,"
+                     "\"coolingSupported\":false,\"dhwConfiguration\":false,\"masterLowOffPumpCtrl\":false,"
+                     "\"ch2Present\":false,\"remoteWaterFilling\":false,\"heatCoolModeCtrl\":false,\"cfgRaw\":1}}"},
+    {15, 0x1814, 4, 1, "{\"maxCapacityKw\":24,\"minModulationPct\":20}"},
+    {116, 0x04D2, 4, 1, "0x04D2"},
+    {1, 0x3C00, 5, 1, "60.00"},
+    {26, 0, 0, 3, ""},
+    {29, 0, 7, 1, ""},
+  };
+  const size_t n = sizeof(kFrames) / sizeof(kFrames[0]);
+
+  // Records 2 s apart, the last one 1 s before the dump; the first ones
+  // before the micros() wrap.
+  Trace t;
+  t.hdr.capacity = 512;
+  t.hdr.firstSeq = 1000;
+  t.hdr.dumpUs = 5000000u;
+  for (size_t i = 0; i < n; i++) {
+    const Expect& e = kFrames[i];
+    OpenThermTraceRecord r;
+    r.tUs = t.hdr.dumpUs - 1000000u - (uint32_t)(n - 1 - i) * 2000000u;
+    r.request = frame(e.respType == 5 ? 1 : 0, e.id, e.respType == 5 ? e.value : 0);
+    r.response = e.status == 1 ? frame(e.respType, e.id, e.respType == 7 ? 0 : e.value) : 0;
+    r.durMs = 120;
+    r.status = e.status;
+    r.origin = (uint8_t)OpenThermTraceOrigin::Poll;
+    t.recs.push_back(r);
+  }
+
+  const char* path = "/tmp/ot_trace_selfcheck.bin";
+  FILE* fp = std::fopen(path, "wb");
+  if (!fp) {
+    std::printf("cannot write %s\n", path);
+    return false;
+  }
+  std::fwrite(&t.hdr, sizeof(t.hdr), 1, fp);
+  for (const OpenThermTraceRecord& r : t.recs) std::fwrite(&r, sizeof(r), 1, fp);
+  std::fwrite("\x01\x02\x03", 3, 1, fp);  // partial record at the end is ignored
+  std::fclose(fp);
+
+  Trace back;
+  std::string err;
+  bool ok = readTrace(path, back, err) && back.recs.size() == n && back.hdr.firstSeq == 1000;
+  size_t bad = 0;
+  for (size_t i = 0; ok && i < n; i++) {
+    const Expect& e = kFrames[i];
+    const OpenThermTraceRecord& r = back.recs[i];
+    const std::string got = hasValue(r) ? decode(frameId(r.response), frameValue(r.response)).text : "";
+    if (got == e.text) continue;
+    ok = false;
+    if (bad++ < 3) std::printf("  ID%u: got %s, want %s\n", (unsigned)e.id, got.c_str(), e.text);
+  }
+  ok = ok && printTrace(back, -1, Format::Text, stdout) == 9;
+
+  // Time of the first record: 1 s + 10 * 2 s before the dump, across the wrap.
+  const double firstMs = -((double)(uint32_t)(back.hdr.dumpUs - back.recs[0].tUs) / 1000.0);
+  ok = ok && firstMs == -21000.0;
+
+  // Bad magic is rejected.
+  fp = std::fopen(path, "r+b");
+  if (fp) {
+    std::fwrite("XXXX", 4, 1, fp);
+    std::fclose(fp);
+  }
+  Trace junk;
+  ok = ok && !readTrace(path, junk, err);
+  std::remove(path);
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    const bool ok = selfCheck();
+    std::printf("%s\n", ok ? "OK" : "FAIL");
+    return ok ? 0 : 1;
+  }
+  const char* path = nullptr;
+  int onlyId = -1;
+  Format fmt = Format::Text;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--id") == 0 && i + 1 < argc) onlyId = std::atoi(argv[++i]);
+    else if (std::strcmp(argv[i], "--csv") == 0) fmt = Format::Csv;
+    else if (std::strcmp(argv[i], "--json") == 0) fmt = Format::Json;
+    else path = argv[i];
+  }
+  Trace t;
+  std::string err;
+  if (!path || !readTrace(path, t, err)) {
+    std::fprintf(stderr, "%s: %s\n", path ? path : "no trace file", path ? err.c_str() : "");
+    return 1;
+  }
+  printTrace(t, onlyId, fmt, stdout);
+  return 0;
+}
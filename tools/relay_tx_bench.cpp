@@ -0,0 +1,304 @@
+// Host benchmark for the relay transaction (relayBegin / relayCommit in
+// RelayController.h): I2C transactions per minute on a simulated bus, with
+// and without transactions around a control decision.
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -Itools/host -I. tools/relay_tx_bench.cpp RelayController.cpp RetryPolicy.cpp -o /tmp/relay_tx_bench
+//   /tmp/relay_tx_bench
+//
+// RelayController.cpp is compiled unchanged against the stand-ins in
+// tools/host/. The TCA9554 is simulated behind the I2cBus.h calls: every
+// queued transaction (a register write, or a write + read) is one bus
+// transaction, completed at once. An output register write with both
+// mixing relays ON is counted as an interlock violation. The esp_timer is
+// driven by the virtual clock; its callback must end each pulse with one
+// urgent queued write (i2cSubmit), never a blocking i2cTransact().
+//
+// The control calls follow the firmware, 10 min of virtual time:
+//   relayUpdate() every 10 ms (health-check read every 2 s),
+//   dhwLoop() every 100 ms: valve, boiler request and circulation relays
+//     (heating 60..300 s, circulation 60 s in every 180 s),
+//   equitherm every 200 ms: night relay (night from 400 s), a 300 ms valve
+//     pulse every 30 s.
+// "before" calls relaySet() as is, "after" wraps each dhwLoop() and
+// equitherm decision in a RelayTransaction. Also checked: a direction
+// change written as R1 ON then R2 OFF trips the per-call interlock, but not
+// the merged mask of a transaction; and a failed stop write leaves the
+// pulse marked not OK and the pair OFF after the next relayUpdate().
+
+#include <cstdio>
+#include <cstring>
+
+#include <esp_timer.h>
+
+#include "I2cBus.h"
+#include "RelayController.h"
+#include "TaskDomains.h"
+
+// ---- virtual clock ----------------------------------------------------------
+
+static uint32_t g_nowUs = 0;
+uint32_t millis() { return g_nowUs / 1000u; }
+uint32_t micros() { return g_nowUs; }
+
+// ---- firmware stand-ins -----------------------------------------------------
+
+TaskDomainLock::TaskDomainLock(TaskDomain) : _mtx(nullptr) {}
+TaskDomainLock::~TaskDomainLock() {}
+
+struct esp_timer {
+  esp_timer_cb_t cb = nullptr;
+  void* arg = nullptr;
+  bool armed = false;
+  uint32_t atUs = 0;
+};
+static esp_timer g_timer;
+static bool g_inTimer = false;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+  g_timer.cb = args->callback;
+  g_timer.arg = args->arg;
+  *out = &g_timer;
+  return ESP_OK;
+}
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeoutUs) {
+  if (t->armed) return ESP_ERR_INVALID_STATE;
+  t->armed = true;
+  t->atUs = g_nowUs + (uint32_t)timeoutUs;
+  return ESP_OK;
+}
+esp_err_t esp_timer_stop(esp_timer_handle_t t) {
+  if (!t->armed) return ESP_ERR_INVALID_STATE;
+  t->armed = false;
+  return ESP_OK;
+}
+static void fireTimer() {
+  if (g_timer.armed && (int32_t)(g_nowUs - g_timer.atUs) >= 0) {
+    g_timer.armed = false;
+    g_inTimer = true;
+    g_timer.cb(g_timer.arg);
+    g_inTimer = false;
+  }
+}
+
+// ---- simulated TCA9554 ------------------------------------------------------
+
+namespace {
+  struct Tca {
+    uint8_t regs[4] = {0xFF, 0xFF, 0x00, 0xFF};
+    uint8_t ptr = 0;
+    uint32_t transactions = 0;
+    uint32_t outputWrites = 0;
+    uint32_t interlockViolations = 0;
+    uint32_t urgent = 0;
+    uint32_t timerBlocking = 0;  // i2cTransact() on the esp_timer task
+    bool failNextUrgent = false;
+  };
+  Tca g_tca;
+  constexpr uint8_t kMixPair = 0x03;  // R1 + R2
+}
+
+void i2cInit() {}
+bool i2cIsReady() { return true; }
+int8_t i2cAddDevice(uint8_t, uint16_t) { return 0; }
+
+static I2cResult tcaTransaction(const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen) {
+  g_tca.transactions++;
+  if (txLen >= 1) g_tca.ptr = tx[0] & 3;
+  if (txLen >= 2) {
+    g_tca.regs[g_tca.ptr] = tx[1];
+    if (g_tca.ptr == 1) {
+      g_tca.outputWrites++;
+      if ((tx[1] & kMixPair) == kMixPair) g_tca.interlockViolations++;
+    }
+  }
+  if (rxLen) rx[0] = g_tca.regs[g_tca.ptr];
+  return I2cResult::Ok;
+}
+
+I2cResult i2cTransact(uint8_t, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen, bool) {
+  if (g_inTimer) g_tca.timerBlocking++;
+  return tcaTransaction(tx, txLen, rx, rxLen);
+}
+
+// Completes at once, the callback inline (the firmware runs it on the i2c
+// task).
+bool i2cSubmit(const I2cTxn& t, bool urgent) {
+  uint8_t rx[kI2cMaxRx] = {};
+  I2cResult res = I2cResult::Timeout;
+  if (urgent) g_tca.urgent++;
+  if (urgent && g_tca.failNextUrgent) g_tca.failNextUrgent = false;
+  else res = tcaTransaction(t.tx, t.txLen, rx, t.rxLen);
+  if (t.done) t.done(t.ctx, res, rx, t.rxLen);
+  return true;
+}
+
+// ---- control call pattern ---------------------------------------------------
+
+namespace {
+
+constexpr RelayId kDhwValve = RelayId::R3;
+constexpr RelayId kDhwCirc = RelayId::R4;
+constexpr RelayId kDhwBoiler = RelayId::R5;
+constexpr RelayId kNight = RelayId::R6;
+
+void dhwPass(uint32_t tS, bool tx) {
+  const bool heating = tS >= 60 && tS < 300;
+  const bool circ = (tS % 180) < 60;
+  auto apply = [&] {
+    relaySet(kDhwValve, heating);
+    relaySet(kDhwBoiler, heating);
+    relaySet(kDhwCirc, circ);
+  };
+  if (tx) {
+    RelayTransaction relayTx;
+    apply();
+  } else {
+    apply();
+  }
+}
+
+void equithermPass(uint32_t tS, bool pulse, int8_t dir, bool tx) {
+  auto apply = [&] {
+    relaySet(kNight, tS >= 400);
+    if (pulse) relayStartMixingPulse(dir, 300);
+  };
+  if (tx) {
+    RelayTransaction relayTx;
+    apply();
+  } else {
+    apply();
+  }
+}
+
+struct RunResult {
+  double perMin = 0;
+  uint32_t outputWrites = 0;
+  uint32_t violations = 0;
+  uint32_t pulses = 0;
+  uint32_t timerEnds = 0;
+  uint32_t urgent = 0;
+  uint32_t timerBlocking = 0;
+  bool finalOk = false;
+};
+
+RunResult run(bool tx) {
+  g_tca = Tca{};
+  g_nowUs = 0;
+  relayInit();
+  const uint32_t initTransactions = g_tca.transactions;
+  RunResult r;
+  constexpr uint32_t kDurationMs = 600000;
+  uint32_t lastSeq = 0;
+  int8_t dir = 1;
+  for (uint32_t ms = 0; ms < kDurationMs; ms++) {
+    g_nowUs = ms * 1000u;
+    fireTimer();
+    const uint32_t tS = ms / 1000u;
+    if (ms % 10 == 0) relayUpdate();
+    if (ms % 100 == 0) dhwPass(tS, tx);
+    if (ms % 200 == 0) {
+      const bool pulse = ms % 30000 == 0;
+      equithermPass(tS, pulse, dir, tx);
+      if (pulse) dir = (int8_t)-dir;
+    }
+    const RelayMixingPulse p = relayGetMixingPulse();
+    if (p.seq != lastSeq && !p.active) {
+      lastSeq = p.seq;
+      r.pulses++;
+      if (p.endedByTimer) r.timerEnds++;
+    }
+  }
+  r.perMin = (g_tca.transactions - initTransactions) / (kDurationMs / 60000.0);
+  r.outputWrites = g_tca.outputWrites;
+  r.violations = g_tca.interlockViolations;
+  r.urgent = g_tca.urgent;
+  r.timerBlocking = g_tca.timerBlocking;
+  // Last pass at 599 s: no heating, circulation (599 % 180 < 60) and night ON.
+  const uint8_t want = (uint8_t)((1u << (uint8_t)kNight) | (1u << (uint8_t)kDhwCirc));
+  r.finalOk = g_tca.regs[1] == want && relayGetMask() == want;
+  return r;
+}
+
+// R2 (closing) is ON; the decision switches to R1 by setting R1 first.
+bool checkMergedInterlock() {
+  g_tca = Tca{};
+  g_nowUs = 0;
+  relayInit();
+  relaySetMask(0x02);
+  relaySet(RelayId::R1, true);  // per call: R1+R2 -> both forced OFF
+  relaySet(RelayId::R2, false);
+  const bool perCallTripped = (g_tca.regs[1] & kMixPair) == 0;
+
+  relaySetMask(0x02);
+  const uint32_t before = g_tca.transactions;
+  {
+    RelayTransaction relayTx;
+    relaySet(RelayId::R1, true);
+    relaySet(RelayId::R2, false);
+    if (!relayGetState(RelayId::R1) || relayGetState(RelayId::R2)) return false;  // staged view
+    if ((g_tca.regs[1] & kMixPair) != 0x02) return false;  // nothing written yet
+  }
+  const bool mergedOk = (g_tca.regs[1] & kMixPair) == 0x01;
+  const uint32_t used = g_tca.transactions - before;
+
+  // Both ON in one transaction is still refused on the merged mask.
+  {
+    RelayTransaction relayTx;
+    relaySet(RelayId::R2, true);
+  }
+  const bool stillRefused = (g_tca.regs[1] & kMixPair) == 0 && g_tca.interlockViolations == 0;
+  std::printf("interlock: per-call R1 ON / R2 OFF trips %s, transaction %s (%u bus transactions), "
+              "R1+R2 refused %s\n", perCallTripped ? "yes" : "no", mergedOk ? "switches" : "FAILED",
+              used, stillRefused ? "yes" : "NO");
+  return perCallTripped && mergedOk && used == 2 && stillRefused;
+}
+
+// The stop timer's write fails: the pulse ends marked not OK, and the next
+// relayUpdate() (not the timer) writes the pair OFF.
+bool checkFailedStop() {
+  g_tca = Tca{};
+  g_nowUs = 0;
+  relayInit();
+  if (!relayStartMixingPulse(1, 300)) return false;
+  g_tca.failNextUrgent = true;
+  g_nowUs = 300000;
+  fireTimer();
+  const RelayMixingPulse p = relayGetMixingPulse();
+  const bool stillOn = (g_tca.regs[1] & kMixPair) == 0x01;
+  g_nowUs = 310000;
+  relayUpdate();
+  const bool off = (g_tca.regs[1] & kMixPair) == 0 && (relayGetMask() & kMixPair) == 0;
+  std::printf("failed stop write: pulse ended %s, offOk %s, pair OFF after relayUpdate() %s, "
+              "blocking I/O in the timer %u\n", !p.active && p.endedByTimer ? "yes" : "NO",
+              p.offOk ? "YES" : "no", stillOn && off ? "yes" : "NO", g_tca.timerBlocking);
+  return !p.active && p.endedByTimer && !p.offOk && stillOn && off && !g_tca.timerBlocking;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = checkMergedInterlock();
+  ok &= checkFailedStop();
+
+  const RunResult before = run(false);
+  const RunResult after = run(true);
+  std::printf("\nI2C transactions per minute (TCA9554, 10 min of control calls)\n");
+  std::printf("  %-8s %10s %14s %10s %14s %8s\n", "", "per min", "output writes", "pulses", "timer ends",
+              "urgent");
+  for (const RunResult* r : {&before, &after}) {
+    std::printf("  %-8s %10.0f %14u %10u %14u %8u\n", r == &before ? "before" : "after", r->perMin, r->outputWrites,
+                r->pulses, r->timerEnds, r->urgent);
+    // Each timer end is one queued urgent write; nothing blocks the timer.
+    ok &= r->urgent == r->timerEnds && !r->timerBlocking;
+  }
+  ok &= before.finalOk && after.finalOk && !before.violations && !after.violations;
+  ok &= after.pulses == 20 && after.timerEnds == 20 && before.pulses == 20;
+  ok &= after.perMin * 20 < before.perMin;
+  if (!ok) {
+    std::printf("FAIL\n");
+    return 1;
+  }
+  std::printf("OK\n");
+  return 0;
+}
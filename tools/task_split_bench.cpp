@@ -0,0 +1,381 @@
+// Host simulation of the task split (TaskDomains.h) against the single
+// cooperative loop, on a virtual clock, under synthetic network load.
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -I. tools/task_split_bench.cpp -o /tmp/task_split_bench
+//   /tmp/task_split_bench
+//
+// The modules of the .ino are modelled as in tools/loop_sched_bench.cpp,
+// plus the "netload" task of the console NETLOAD command: busy for L ms
+// every P ms, like a long HTTP response. Two more network loads stand for
+// a synchronous raw Data-ID read (2.5 s; it holds the OpenTherm lock, so the
+// opentherm task skips its work meanwhile, see openthermLoop()) and an OTA
+// upload (ArduinoOTA.handle() keeps the loop for the whole transfer). One
+// core (all three domains run on core 1), fixed-priority preemption at
+// FreeRTOS tick resolution: a blocked task becomes ready on the tick
+// interrupt ending its wait and preempts a lower priority at once. Threads
+// sharing a lock cannot preempt each other's pass (the waiter runs right
+// after it). Control shares no lock with the other domains; Io and Net are
+// run both ways: sharing IoLock (the previous layout) and with NetLock of
+// their own (TaskDomains.h). Preemption is simulated by nesting: a module
+// consuming CPU time runs the higher priority passes that become ready
+// meanwhile before it continues.
+//
+// The equitherm model starts a 300 ms valve pulse every 2..3 s and ends it
+// at its first run after the requested end, like mixUpdate(). Reported: the
+// pulse end error (how late the relays go off) per load, its histogram for
+// NETLOAD 500 ms / 2000 ms, and the worst start lateness of OpenTherm and
+// Dallas per load and lock layout. The I/O domain must not get worse than in
+// the single loop, and with NetLock no network load may delay it at all.
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "../LoopScheduler.h"
+
+namespace {
+
+uint32_t g_nowUs = 0;
+uint32_t clockUs() { return g_nowUs; }
+
+enum Domain : uint8_t { kControl = 0, kIo, kNet };
+
+struct Module {
+  const char* name;
+  Domain domain;
+  uint32_t periodMs;
+  uint32_t idleCostUs;
+  uint32_t workCostUs;
+  uint32_t workEveryMs;
+  uint32_t lastWorkUs = 0;
+  bool worked = false;
+};
+
+// Registration order of setupLoopTasks() per domain.
+Module g_mods[] = {
+  {"inputs", kControl, 10, 6, 6, 0},
+  {"relays", kControl, 10, 2, 180, 2000},
+  {"buzzer", kControl, 10, 1, 1, 0},
+  {"pressure", kControl, 200, 4, 4, 0},
+  {"dhw", kControl, 100, 90, 90, 0},
+  {"equitherm", kControl, 5, 6, 350, 200},
+  {"dallas", kIo, 10, 3, 900, 1000},
+  {"opentherm", kIo, 5, 15, 34000, 1000},
+  {"ble", kIo, 20, 5, 5, 0},
+  {"history", kIo, 1000, 1, 400, 60000},
+  {"temps", kIo, 100, 60, 60, 0},
+  {"energy", kIo, 100, 2, 120, 1000},
+  {"console", kNet, 20, 2, 2, 0},
+  {"network", kNet, 10, 4, 4, 0},
+  {"web", kNet, 5, 25, 2500, 1000},
+  {"ota", kNet, 10, 3, 3, 0},
+  {"mqtt", kNet, 20, 8, 1800, 10000},
+  {"netload", kNet, 1000, 0, 0, 0},
+};
+constexpr uint8_t kMods = sizeof(g_mods) / sizeof(g_mods[0]);
+constexpr uint8_t kEquitherm = 5;
+constexpr uint8_t kDallas = 6;
+constexpr uint8_t kOpenTherm = 7;
+constexpr uint8_t kNetLoad = kMods - 1;
+
+uint32_t g_loadBusyUs = 0;
+bool g_loadHoldsOt = false;
+bool g_otHeld = false;
+
+struct Rng {
+  uint32_t s = 0xC0FFEEu;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+};
+
+constexpr uint32_t kTickUs = 1000;
+constexpr uint32_t kTickPhaseUs = 370;
+
+uint32_t tickWaitEnd(uint32_t t, uint32_t n) {
+  const uint32_t sincePhase = t - kTickPhaseUs;
+  const uint32_t firstTick = t + (kTickUs - sincePhase % kTickUs);
+  return firstTick + (n - 1) * kTickUs;
+}
+
+// ---- valve pulse model (equithermLoop -> mixUpdate) ----
+constexpr uint32_t kPulseUs = 300000;
+struct Pulse {
+  bool active = false;
+  uint32_t untilUs = 0;
+  uint32_t nextStartUs = 0;
+} g_pulse;
+Rng g_pulseRng;
+std::vector<uint32_t> g_pulseLate;
+
+void equithermTick() {
+  if (g_pulse.active && (int32_t)(g_nowUs - g_pulse.untilUs) >= 0) {
+    g_pulseLate.push_back(g_nowUs - g_pulse.untilUs);
+    g_pulse.active = false;
+  }
+  if (!g_pulse.active && (int32_t)(g_nowUs - g_pulse.nextStartUs) >= 0) {
+    g_pulse.active = true;
+    g_pulse.untilUs = g_nowUs + kPulseUs;
+    g_pulse.nextStartUs = g_nowUs + 2000000u + 1000u * (g_pulseRng.next() % 1000u);
+  }
+}
+
+// ---- one core, fixed priorities ----
+struct Thread {
+  const char* name;
+  uint8_t prio;
+  int8_t lockGroup;      // threads of one group never preempt each other's pass
+  bool minTick;          // domain task: always blocks at least until the next tick
+  LoopScheduler* sched;
+  uint32_t wakeAtUs = 0;
+  bool inPass = false;
+};
+
+std::vector<Thread*> g_threads;
+uint8_t g_curPrio = 0;
+Thread* g_lockHolder[2] = {nullptr, nullptr};
+
+bool canPreempt(const Thread& t, uint8_t abovePrio) {
+  if (t.inPass || t.prio <= abovePrio) return false;
+  if (t.lockGroup >= 0 && g_lockHolder[t.lockGroup] && g_lockHolder[t.lockGroup] != &t) return false;
+  return true;
+}
+
+void runPass(Thread& t);
+
+// The highest priority thread above abovePrio that may run by time `until`,
+// and when it is ready.
+Thread* nextPreemption(uint8_t abovePrio, uint32_t until, uint32_t& atUs) {
+  Thread* best = nullptr;
+  for (Thread* t : g_threads) {
+    if (!canPreempt(*t, abovePrio)) continue;
+    const uint32_t at = (int32_t)(t->wakeAtUs - g_nowUs) > 0 ? t->wakeAtUs : g_nowUs;
+    if ((int32_t)(at - until) >= 0) continue;
+    if (!best || (int32_t)(at - atUs) < 0 || (at == atUs && t->prio > best->prio)) {
+      best = t;
+      atUs = at;
+    }
+  }
+  return best;
+}
+
+// CPU time of the running module; higher priorities run in between.
+void consume(uint32_t costUs) {
+  while (costUs) {
+    uint32_t atUs = 0;
+    Thread* t = nextPreemption(g_curPrio, g_nowUs + costUs, atUs);
+    if (!t) {
+      g_nowUs += costUs;
+      return;
+    }
+    costUs -= atUs - g_nowUs;
+    g_nowUs = atUs;
+    runPass(*t);
+  }
+}
+
+void runPass(Thread& t) {
+  const uint8_t saved = g_curPrio;
+  g_curPrio = t.prio;
+  t.inPass = true;
+  if (t.lockGroup >= 0) g_lockHolder[t.lockGroup] = &t;
+  const uint32_t idleUs = t.sched->runDue();
+  if (t.lockGroup >= 0) g_lockHolder[t.lockGroup] = nullptr;
+  t.inPass = false;
+  g_curPrio = saved;
+  if (t.minTick || idleUs) t.wakeAtUs = tickWaitEnd(g_nowUs, idleUs / 1000u + 1);
+  else t.wakeAtUs = g_nowUs;
+}
+
+void callModule(uint8_t i) {
+  Module& m = g_mods[i];
+  if (i == kEquitherm) equithermTick();
+  if (i == kNetLoad) {
+    g_otHeld = g_loadHoldsOt;
+    consume(g_loadBusyUs);
+    g_otHeld = false;
+    return;
+  }
+  if (i == kOpenTherm && g_otHeld) {
+    consume(m.idleCostUs);
+    return;
+  }
+  const bool due = !m.worked || !m.workEveryMs || (uint32_t)(g_nowUs - m.lastWorkUs) >= m.workEveryMs * 1000u;
+  if (due) {
+    m.worked = true;
+    m.lastWorkUs = g_nowUs;
+    consume(m.workCostUs);
+  } else {
+    consume(m.idleCostUs);
+  }
+}
+
+template <uint8_t I>
+void thunk() { callModule(I); }
+
+template <uint8_t... I>
+struct Thunks {
+  static constexpr LoopScheduler::TaskFn fns[] = {&thunk<I>...};
+};
+using AllThunks = Thunks<0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17>;
+static_assert(sizeof(AllThunks::fns) / sizeof(AllThunks::fns[0]) == kMods, "one thunk per module");
+
+struct Load {
+  const char* name;
+  uint32_t busyMs;
+  uint32_t everyMs;
+  bool holdsOt;  // raw Data-ID exchange: OpenTherm lock held throughout
+};
+
+// Single cooperative loop; domain tasks with Io and Net sharing IoLock; the
+// firmware layout with NetLock.
+enum Layout : uint8_t { kSingleLoop = 0, kSharedIoLock, kOwnNetLock };
+
+struct RunResult {
+  std::vector<uint32_t> pulseLate;
+  uint32_t otLateMaxUs = 0;
+  uint32_t dallasLateMaxUs = 0;
+  uint32_t ioLateMaxUs() const { return std::max(otLateMaxUs, dallasLateMaxUs); }
+};
+
+void resetModel() {
+  for (Module& m : g_mods) {
+    m.lastWorkUs = 0;
+    m.worked = false;
+  }
+  g_pulse = Pulse{};
+  g_pulseRng = Rng{};
+  g_pulseLate.clear();
+  g_threads.clear();
+  g_lockHolder[0] = g_lockHolder[1] = nullptr;
+  g_otHeld = false;
+  g_curPrio = 0;
+  g_nowUs = 0;
+}
+
+RunResult simulate(Layout layout, const Load& load, uint32_t durationUs) {
+  resetModel();
+  const bool split = layout != kSingleLoop;
+  g_loadBusyUs = load.busyMs * 1000u;
+  g_loadHoldsOt = load.holdsOt;
+  LoopScheduler scheds[3] = {LoopScheduler(clockUs), LoopScheduler(clockUs), LoopScheduler(clockUs)};
+  int8_t ids[kMods];
+  for (uint8_t i = 0; i < kMods; i++) {
+    LoopScheduler& s = split ? scheds[g_mods[i].domain] : scheds[0];
+    const uint32_t period = i == kNetLoad ? (load.everyMs ? load.everyMs : 1000) : g_mods[i].periodMs;
+    ids[i] = s.add(g_mods[i].name, AllThunks::fns[i], period);
+  }
+  Thread ctl{"ctl", 4, -1, true, &scheds[0]};
+  Thread io{"io", 2, 0, true, &scheds[1]};
+  Thread net{"net", 1, (int8_t)(layout == kSharedIoLock ? 0 : 1), false, &scheds[2]};
+  Thread single{"loop", 1, -1, false, &scheds[0]};
+  if (split) g_threads = {&ctl, &io, &net};
+  else g_threads = {&single};
+
+  while ((uint32_t)g_nowUs < durationUs) {
+    uint32_t atUs = 0;
+    Thread* t = nextPreemption(0, g_nowUs + 0x40000000u, atUs);
+    if (!t) break;
+    g_nowUs = atUs;
+    runPass(*t);
+  }
+
+  RunResult r;
+  r.pulseLate = g_pulseLate;
+  const LoopScheduler& ioSched = split ? scheds[kIo] : scheds[0];
+  r.otLateMaxUs = ioSched.taskStats((uint8_t)ids[kOpenTherm]).lateMaxUs;
+  r.dallasLateMaxUs = ioSched.taskStats((uint8_t)ids[kDallas]).lateMaxUs;
+  return r;
+}
+
+uint32_t pct(std::vector<uint32_t> v, uint32_t p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min<size_t>(v.size() - 1, v.size() * p / 100)];
+}
+
+void printHistogram(const char* title, const std::vector<uint32_t>& late) {
+  static const uint32_t kEdgesMs[] = {1, 2, 5, 10, 20, 50, 100, 200, 500};
+  constexpr uint8_t kBins = sizeof(kEdgesMs) / sizeof(kEdgesMs[0]) + 1;
+  uint32_t bins[kBins] = {};
+  for (uint32_t us : late) {
+    uint8_t b = 0;
+    while (b < kBins - 1 && us >= kEdgesMs[b] * 1000u) b++;
+    bins[b]++;
+  }
+  std::printf("  %s, %zu pulses\n", title, late.size());
+  for (uint8_t b = 0; b < kBins; b++) {
+    char label[24];
+    if (b == 0) std::snprintf(label, sizeof(label), "< %u ms", kEdgesMs[0]);
+    else if (b == kBins - 1) std::snprintf(label, sizeof(label), ">= %u ms", kEdgesMs[b - 1]);
+    else std::snprintf(label, sizeof(label), "%u..%u ms", kEdgesMs[b - 1], kEdgesMs[b]);
+    std::printf("    %-12s %5u %6.1f%%\n", label, bins[b], late.empty() ? 0.0 : 100.0 * bins[b] / late.size());
+  }
+}
+
+}  // namespace
+
+int main() {
+  constexpr uint32_t kDurationUs = 600u * 1000000u;  // 10 min
+  const Load loads[] = {
+    {"none", 0, 0, false},
+    {"20 ms / 200 ms", 20, 200, false},
+    {"100 ms / 1000 ms", 100, 1000, false},
+    {"250 ms / 1000 ms", 250, 1000, false},
+    {"500 ms / 2000 ms", 500, 2000, false},
+    {"OT raw 2.5 s/10 s", 2500, 10000, true},
+    {"OTA 30 s / 120 s", 30000, 120000, false},
+  };
+  constexpr uint8_t kLoads = sizeof(loads) / sizeof(loads[0]);
+
+  bool ok = true;
+  RunResult res[kLoads][3];
+  std::printf("Valve pulse end error (ms late), 10 min per run\n");
+  std::printf("  %-18s | %-26s | %-26s\n", "netload", "single loop p50/p99/max", "control task p50/p99/max");
+  for (uint8_t l = 0; l < kLoads; l++) {
+    const Load& load = loads[l];
+    for (uint8_t k = 0; k < 3; k++) res[l][k] = simulate((Layout)k, load, kDurationUs);
+    const RunResult& a = res[l][kSingleLoop];
+    const RunResult& b = res[l][kSharedIoLock];
+    const RunResult& c = res[l][kOwnNetLock];
+    std::printf("  %-18s | %7.1f %7.1f %8.1f   | %7.1f %7.1f %8.1f\n", load.name, pct(a.pulseLate, 50) / 1000.0,
+                pct(a.pulseLate, 99) / 1000.0, pct(a.pulseLate, 100) / 1000.0, pct(c.pulseLate, 50) / 1000.0,
+                pct(c.pulseLate, 99) / 1000.0, pct(c.pulseLate, 100) / 1000.0);
+    // Every pulse ends within the equitherm period plus the tick and the
+    // control pass itself, whatever the load and the Io/Net lock layout.
+    for (const RunResult* r : {&b, &c}) {
+      ok &= r->pulseLate.size() > 150 && pct(r->pulseLate, 100) <= 5000u + 2 * kTickUs + 1000u;
+    }
+    if (load.busyMs >= 100) ok &= pct(a.pulseLate, 100) >= load.busyMs * 1000u / 2;
+    // The I/O domain is not starved more than by the single loop; with its
+    // own lock the network domain does not delay it at all. (Sharing IoLock
+    // it waits for whole network passes, see the second table.)
+    ok &= c.ioLateMaxUs() <= a.ioLateMaxUs() + 2 * kTickUs;
+    ok &= c.ioLateMaxUs() <= res[0][kOwnNetLock].ioLateMaxUs() + 2 * kTickUs;
+  }
+
+  std::printf("\nI/O start lateness max (ms), OpenTherm / Dallas\n");
+  std::printf("  %-18s | %-15s | %-15s | %-15s\n", "netload", "single loop", "shared IoLock", "NetLock");
+  for (uint8_t l = 0; l < kLoads; l++) {
+    std::printf("  %-18s |", loads[l].name);
+    for (uint8_t k = 0; k < 3; k++) {
+      const RunResult& r = res[l][k];
+      std::printf(" %7.1f/%7.1f%s", r.otLateMaxUs / 1000.0, r.dallasLateMaxUs / 1000.0, k < 2 ? " |" : "\n");
+    }
+  }
+
+  constexpr uint8_t kHistLoad = 4;
+  std::printf("\n");
+  printHistogram("single loop, netload 500 ms / 2000 ms", res[kHistLoad][kSingleLoop].pulseLate);
+  printHistogram("control task, netload 500 ms / 2000 ms", res[kHistLoad][kOwnNetLock].pulseLate);
+  if (!ok) {
+    std::printf("FAIL\n");
+    return 1;
+  }
+  std::printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,239 @@
+// Host check and micro-benchmark for the fixed-point temperature type
+// (TempCenti.h) against the float output of ArduinoJson 6.
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -I. tools/temp_fmt_bench.cpp -o /tmp/temp_fmt_bench
+//   /tmp/temp_fmt_bench
+//
+// 1) Every int16 value: the text parses back to exactly the same hundredths,
+//    float -> centi -> float -> centi is stable, NAN gives "null", out of
+//    range saturates.
+// 2) Speed and size per value on realistic readings (DS18B20 1/16 C steps,
+//    OpenTherm f8.8, -25..95 C). ArduinoJson is not available on the host;
+//    its writer is re-implemented below the way 6.x does it on ESP32
+//    (ARDUINOJSON_USE_DOUBLE: the float is widened to double, split into
+//    integral + 9 decimal digits, trailing zeros trimmed). On the ESP32-S3
+//    double arithmetic is software-emulated, so the gap there is wider than
+//    the host numbers show.
+// 3) History buffer memory, float vs fixed-point sample layout.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../TempCenti.h"
+
+namespace {
+
+// ---- ArduinoJson 6 TextFormatter::writeFloat<double>, re-implemented ----
+uint8_t ajWriteInteger(uint32_t v, char* out) {
+  char buf[11];
+  char* p = buf + sizeof(buf);
+  do {
+    *--p = (char)('0' + v % 10);
+    v /= 10;
+  } while (v);
+  const uint8_t n = (uint8_t)(buf + sizeof(buf) - p);
+  std::memcpy(out, p, n);
+  return n;
+}
+
+uint8_t ajWriteFloat(double value, char* out) {
+  char* p = out;
+  if (std::isnan(value) || std::isinf(value)) {
+    std::memcpy(p, "null", 4);
+    return 4;
+  }
+  if (value < 0.0) {
+    *p++ = '-';
+    value = -value;
+  }
+  // FloatParts<double>::normalize()
+  int16_t exponent = 0;
+  if (value >= 1e7) {
+    static const double pos[] = {1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256};
+    static const double neg[] = {1e-1, 1e-2, 1e-4, 1e-8, 1e-16, 1e-32, 1e-64, 1e-128, 1e-256};
+    for (int i = 8; i >= 0; i--) {
+      if (value >= pos[i]) {
+        value *= neg[i];
+        exponent = (int16_t)(exponent + (1 << i));
+      }
+    }
+  }
+  if (value > 0 && value <= 1e-5) {
+    static const double pos[] = {1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256};
+    static const double negm[] = {1e-0, 1e-1, 1e-3, 1e-7, 1e-15, 1e-31, 1e-63, 1e-127, 1e-255};
+    for (int i = 8; i >= 0; i--) {
+      if (value < negm[i]) {
+        value *= pos[i];
+        exponent = (int16_t)(exponent - (1 << i));
+      }
+    }
+  }
+  // FloatParts<double>
+  uint32_t maxDecimalPart = 1000000000;
+  int8_t decimalPlaces = 9;
+  uint32_t integral = (uint32_t)value;
+  for (uint32_t tmp = integral; tmp >= 10; tmp /= 10) {
+    maxDecimalPart /= 10;
+    decimalPlaces--;
+  }
+  double remainder = (value - (double)integral) * (double)maxDecimalPart;
+  uint32_t decimal = (uint32_t)remainder;
+  remainder -= (double)decimal;
+  decimal += (uint32_t)(remainder * 2);
+  if (decimal >= maxDecimalPart) {
+    decimal = 0;
+    integral++;
+    if (exponent && integral >= 10) {
+      exponent++;
+      integral = 1;
+    }
+  }
+  while (decimal % 10 == 0 && decimalPlaces > 0) {
+    decimal /= 10;
+    decimalPlaces--;
+  }
+  p += ajWriteInteger(integral, p);
+  if (decimalPlaces) {
+    char buf[10];
+    char* b = buf + sizeof(buf);
+    for (int8_t i = 0; i < decimalPlaces; i++) {
+      *--b = (char)('0' + decimal % 10);
+      decimal /= 10;
+    }
+    *p++ = '.';
+    const uint8_t n = (uint8_t)(buf + sizeof(buf) - b);
+    std::memcpy(p, b, n);
+    p += n;
+  }
+  if (exponent) {
+    *p++ = 'e';
+    if (exponent < 0) {
+      *p++ = '-';
+      exponent = (int16_t)-exponent;
+    }
+    p += ajWriteInteger((uint32_t)exponent, p);
+  }
+  return (uint8_t)(p - out);
+}
+
+// ---- 1) exhaustive correctness ----
+bool checkAll() {
+  bool ok = true;
+  uint32_t bad = 0;
+  uint8_t maxLen = 0;
+  for (int32_t v = -32767; v <= 32767; v++) {
+    char buf[kTempCentiTextMax];
+    const uint8_t n = tempCentiFormat((TempCenti)v, buf);
+    if (n > maxLen) maxLen = n;
+    const double back = std::strtod(buf, nullptr);
+    if (n != std::strlen(buf) || std::llround(back * 100.0) != v ||
+        tempCentiFromC(tempCentiToC((TempCenti)v)) != v) {
+      if (bad++ < 5) std::printf("  FAIL: %d -> \"%s\"\n", (int)v, buf);
+    }
+  }
+  char buf[kTempCentiTextMax];
+  tempCentiFormat(kTempCentiInvalid, buf);
+  const bool edges = std::strcmp(buf, "null") == 0 && tempCentiFromC(NAN) == kTempCentiInvalid &&
+                     tempCentiFromC(INFINITY) == kTempCentiInvalid && tempCentiFromC(1000.0f) == 32767 &&
+                     tempCentiFromC(-1000.0f) == -32767 && tempCentiFromC(45.0625f) == 4506 &&
+                     tempCentiFromC(-0.005f) == -1 && std::isnan(tempCentiToC(kTempCentiInvalid));
+  std::printf("  65535 values, mismatches %u, longest text %u chars; sentinel / rounding / saturation %s\n",
+              bad, maxLen, edges ? "ok" : "WRONG");
+  ok &= bad == 0 && edges && maxLen < kTempCentiTextMax;
+  return ok;
+}
+
+// ---- 2) speed ----
+constexpr uint32_t kValues = 4096;
+constexpr uint32_t kRounds = 400;
+
+struct Result {
+  double nsPerValue;
+  double bytesPerValue;
+  uint32_t check;
+};
+
+template <class F>
+Result timeIt(F&& fmt) {
+  char buf[32];
+  uint32_t check = 0;
+  uint64_t bytes = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < kRounds; r++) {
+    for (uint32_t i = 0; i < kValues; i++) {
+      const uint8_t n = fmt(i, buf);
+      bytes += n;
+      check += (uint8_t)buf[n - 1];
+    }
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  return Result{ns / (kValues * kRounds), (double)bytes / (kValues * kRounds), check};
+}
+
+bool runSpeed() {
+  static float f[kValues];
+  static TempCenti c[kValues];
+  uint32_t s = 0x2545F491u;
+  for (uint32_t i = 0; i < kValues; i++) {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    const float t = -25.0f + (float)(s % 12000) / 100.0f;
+    // Half DS18B20 (1/16 C), half OpenTherm f8.8 (1/256 C), a few missing.
+    f[i] = (i & 1) ? roundf(t * 16.0f) / 16.0f : roundf(t * 256.0f) / 256.0f;
+    if (i % 97 == 0) f[i] = NAN;
+    c[i] = tempCentiFromC(f[i]);
+  }
+  const Result aj = timeIt([&](uint32_t i, char* b) { return ajWriteFloat((double)f[i], b); });
+  const Result cc = timeIt([&](uint32_t i, char* b) { return tempCentiFormat(c[i], b); });
+  const Result cv = timeIt([&](uint32_t i, char* b) { return tempCentiFormat(tempCentiFromC(f[i]), b); });
+  std::printf("  %-34s %10s %12s\n", "writer", "ns/value", "bytes/value");
+  std::printf("  %-34s %10.1f %12.2f\n", "ArduinoJson float (as double)", aj.nsPerValue, aj.bytesPerValue);
+  std::printf("  %-34s %10.1f %12.2f\n", "tempCentiFormat", cc.nsPerValue, cc.bytesPerValue);
+  std::printf("  %-34s %10.1f %12.2f\n", "tempCentiFromC + tempCentiFormat", cv.nsPerValue, cv.bytesPerValue);
+  std::printf("  speed-up %.1fx, %.0f%% fewer bytes on the wire (checksums %u/%u)\n",
+              aj.nsPerValue / cc.nsPerValue, 100.0 * (1.0 - cc.bytesPerValue / aj.bytesPerValue), aj.check, cc.check);
+  return cc.nsPerValue < aj.nsPerValue && cc.bytesPerValue < aj.bytesPerValue;
+}
+
+// ---- 3) history memory: mirrors of HistoryBuffer.cpp's Sample, before/after ----
+struct FloatSample {
+  uint32_t ms;
+  float v[9];
+  bool dhwHeat;
+};
+struct CentiSample {
+  uint32_t ms;
+  TempCenti v[9];
+  bool dhwHeat;
+};
+
+bool runMemory() {
+  constexpr size_t kCap = 240;
+  std::printf("  sample %zu -> %zu bytes, 240 samples %zu -> %zu bytes\n", sizeof(FloatSample),
+              sizeof(CentiSample), sizeof(FloatSample) * kCap, sizeof(CentiSample) * kCap);
+  return sizeof(CentiSample) * 2 <= sizeof(FloatSample) + 4;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  std::printf("Exhaustive format / round trip\n");
+  ok &= checkAll();
+  std::printf("Formatting %u readings x %u\n", kValues, kRounds);
+  ok &= runSpeed();
+  std::printf("History buffer\n");
+  ok &= runMemory();
+  if (!ok) {
+    std::printf("FAIL\n");
+    return 1;
+  }
+  std::printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,379 @@
+// Host benchmark for TemperatureManager::loop(): heap allocations and time
+// per call.
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -Itools/host -I. tools/tm_loop_bench.cpp TemperatureManager.cpp -o /tmp/tm_loop_bench
+//   /tmp/tm_loop_bench
+//
+// TemperatureManager.cpp is compiled unchanged against the stand-ins in
+// tools/host/. DallasController, ConfigStore, OpenTherm, BLE and the task
+// domain locks are faked here: four buses with the default role layout
+// (outside on GPIO0, DHW return on GPIO1, return on GPIO2, three tank
+// sensors on GPIO3), every bus delivering a fresh read pass once a second
+// like the Sequential scheduler does. The main loop runs every 2 ms of virtual time.
+//
+// Reported per loop(): operator new calls, DallasController::getStatus()
+// calls and wall time. Fails if loop() allocates, if the resolved roles do
+// not match the layout, if ageMs is not the age of the bus reading, or if a
+// stalled bus still passes a maxAgeMs check. The last part checks the
+// change-notification filter (minimum delta, minimum interval, staleness)
+// and that the default conditioning keeps single bad reads out of a role.
+
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+#include "ConfigStore.h"
+#include "DallasController.h"
+#include "OpenThermController.h"
+#include "BleController.h"
+#include "TaskDomains.h"
+#include "TemperatureManager.h"
+#include "config_pins.h"
+
+// ---- allocation counter ----------------------------------------------------
+
+static uint64_t g_allocs = 0;
+
+void* operator new(size_t n) {
+  g_allocs++;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+// ---- virtual clock ---------------------------------------------------------
+
+static uint32_t g_nowMs = 1;
+uint32_t millis() { return g_nowMs; }
+uint32_t micros() { return g_nowMs * 1000u; }
+
+// ---- fakes -----------------------------------------------------------------
+
+// One task here: the domain locks are no-ops.
+TaskDomainLock::TaskDomainLock(TaskDomain) : _mtx(nullptr) {}
+TaskDomainLock::~TaskDomainLock() {}
+
+namespace {
+
+constexpr uint8_t kBuses = 4;
+DallasGpioStatus g_bus[kBuses];
+uint64_t g_getStatusCalls = 0;
+
+struct Config {
+  bool otPresent = false;
+  uint64_t tankRoms[3] = {};  // top, mid, bottom; 0 = AUTO
+} g_cfg;
+
+void addDevice(uint8_t gpio, uint64_t rom) {
+  DallasDeviceInfo d;
+  d.rom = rom;
+  d.address = rom;
+  g_bus[gpio].devices.push_back(d);
+}
+
+void populate() {
+  for (uint8_t i = 0; i < kBuses; i++) {
+    g_bus[i] = DallasGpioStatus{};
+    g_bus[i].gpio = i;
+    g_bus[i].status = TEMP_STATUS_OK;
+  }
+  addDevice(DALLAS_IO0_PIN, 0x1100000000000028ull);
+  addDevice(DALLAS_DHW_RETURN_PIN, 0x2200000000000028ull);
+  addDevice(DALLAS_RETURN_PIN, 0x3300000000000028ull);
+  // Discovery order differs from ROM order on purpose.
+  addDevice(DALLAS_TANK_PIN, 0x4600000000000028ull);
+  addDevice(DALLAS_TANK_PIN, 0x4400000000000028ull);
+  addDevice(DALLAS_TANK_PIN, 0x4500000000000028ull);
+}
+
+// One read pass per bus per second, as the scheduler would deliver it.
+void readPass(uint8_t gpio) {
+  DallasGpioStatus& b = g_bus[gpio];
+  for (auto& d : b.devices) {
+    d.temperature = 20.0f + (float)(d.rom >> 56) / 16.0f + (float)(g_nowMs % 1000) / 1000.0f;
+    d.valid = true;
+  }
+  b.lastReadMs = g_nowMs;
+  b.generation++;
+}
+
+}  // namespace
+
+const DallasGpioStatus* DallasController::getStatus(uint8_t gpio) {
+  g_getStatusCalls++;
+  return gpio < kBuses ? &g_bus[gpio] : nullptr;
+}
+uint32_t DallasController::generation(uint8_t gpio) { return gpio < kBuses ? g_bus[gpio].generation : 0; }
+bool DallasController::parallelConversion() { return false; }
+uint32_t DallasController::lastParallelCycleMs() { return 0; }
+DallasDriverStats DallasController::getDriverStats() { return DallasDriverStats(); }
+uint8_t DallasController::configuredResolution(uint64_t) { return 0; }
+bool DallasController::getSensorHealth(uint64_t, DallasSensorHealth&) { return false; }
+uint32_t DallasController::busConversionMs(uint8_t) { return 800; }
+uint32_t DallasController::busPeriodMs(uint8_t) { return 1500; }
+bool DallasController::busParasite(uint8_t) { return true; }
+
+bool ConfigStore::getDallasEnabled() { return true; }
+uint64_t ConfigStore::getDallasTankTopRom() { return g_cfg.tankRoms[0]; }
+uint64_t ConfigStore::getDallasTankMidRom() { return g_cfg.tankRoms[1]; }
+uint64_t ConfigStore::getDallasTankBottomRom() { return g_cfg.tankRoms[2]; }
+uint64_t ConfigStore::getDallasReturnRom() { return 0; }
+uint64_t ConfigStore::getDallasDhwReturnRom() { return 0; }
+uint64_t ConfigStore::getDallasDhwTankRom() { return 0; }
+uint64_t ConfigStore::getDallasOutsideRom() { return 0; }
+void ConfigStore::setDallasTankTopRom(uint64_t v) { g_cfg.tankRoms[0] = v; }
+void ConfigStore::setDallasTankMidRom(uint64_t v) { g_cfg.tankRoms[1] = v; }
+void ConfigStore::setDallasTankBottomRom(uint64_t v) { g_cfg.tankRoms[2] = v; }
+void ConfigStore::setDallasReturnRom(uint64_t) {}
+void ConfigStore::setDallasDhwReturnRom(uint64_t) {}
+void ConfigStore::setDallasDhwTankRom(uint64_t) {}
+void ConfigStore::setDallasOutsideRom(uint64_t) {}
+String ConfigStore::getEqMixTempSourceA() { return String("tank_mid"); }
+String ConfigStore::getEqMixTempSourceB() { return String("return_dallas"); }
+String ConfigStore::getEqMixTempSourceAB() { return String("opentherm_ch"); }
+
+OpenThermTelemetry openthermGetTelemetry() {
+  OpenThermTelemetry t;
+  if (g_cfg.otPresent) {
+    t.present = true;
+    t.ready = true;
+    t.boilerTempC = 55.0f;
+    t.returnTempC = 40.0f;
+    t.lastUpdateMs = g_nowMs;
+  }
+  return t;
+}
+
+BleMeteoData bleGetMeteo() { return BleMeteoData(); }
+
+// ---- benchmark -------------------------------------------------------------
+
+namespace {
+
+bool expectRom(TempRole role, uint64_t rom) {
+  const TempValue v = TemperatureManager::get(role);
+  if (v.valid && v.rom == rom) return true;
+  std::printf("  FAIL: %s resolved to %016llX, want %016llX\n", TemperatureManager::roleName(role),
+              (unsigned long long)v.rom, (unsigned long long)rom);
+  return false;
+}
+
+bool run(const char* label, const Config& cfg) {
+  g_cfg = cfg;
+  g_nowMs = 1;
+  populate();
+  for (uint8_t i = 0; i < kBuses; i++) readPass(i);
+  TemperatureManager::begin();
+  TemperatureManager::invalidateAll();
+  TemperatureManager::loop();  // first pass builds the caches
+
+  // 10 minutes of main loop.
+  const uint32_t loops = 300000;
+  g_allocs = 0;
+  g_getStatusCalls = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < loops; n++) {
+    g_nowMs += 2;
+    // Buses are read in turn, one every 250 ms.
+    if (n % 125 == 0) readPass((uint8_t)((n / 125) % kBuses));
+    TemperatureManager::loop();
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+  std::printf("%s\n", label);
+  std::printf("  allocations/loop %.2f, getStatus/loop %.2f, time/loop %.0f ns\n", (double)g_allocs / loops,
+              (double)g_getStatusCalls / loops, ns / loops);
+
+  bool ok = g_allocs == 0;
+  if (!ok) std::printf("  FAIL: loop() allocated\n");
+  ok &= expectRom(TempRole::Outside, 0x1100000000000028ull);
+  ok &= expectRom(TempRole::DhwReturn, 0x2200000000000028ull);
+  if (!cfg.otPresent) ok &= expectRom(TempRole::Return, 0x3300000000000028ull);
+  if (cfg.tankRoms[0]) {
+    ok &= expectRom(TempRole::TankTop, cfg.tankRoms[0]);
+    ok &= expectRom(TempRole::TankMid, cfg.tankRoms[1]);
+    ok &= expectRom(TempRole::TankBottom, cfg.tankRoms[2]);
+  } else {
+    // AUTO: ascending ROM order.
+    ok &= expectRom(TempRole::TankTop, 0x4400000000000028ull);
+    ok &= expectRom(TempRole::TankMid, 0x4500000000000028ull);
+    ok &= expectRom(TempRole::TankBottom, 0x4600000000000028ull);
+  }
+
+  // ageMs is the age of the measurement, not of the last loop().
+  const TempValue dhwRet = TemperatureManager::get(TempRole::DhwReturn);
+  const uint32_t wantAge = g_nowMs - g_bus[DALLAS_DHW_RETURN_PIN].lastReadMs;
+  if (dhwRet.ageMs != wantAge) {
+    std::printf("  FAIL: dhw_return ageMs %u, want %u\n", dhwRet.ageMs, wantAge);
+    ok = false;
+  }
+
+  // Stalled bus: the role must go stale once maxAgeMs is exceeded.
+  for (uint32_t n = 0; n < 5000; n++) {
+    g_nowMs += 2;
+    TemperatureManager::loop();
+  }
+  if (TemperatureManager::get(TempRole::Outside, 5000).valid) {
+    std::printf("  FAIL: outside still valid 10 s after the last read\n");
+    ok = false;
+  }
+  std::printf("\n");
+  return ok;
+}
+
+// ---- change notifications --------------------------------------------------
+
+struct Notified {
+  uint32_t calls = 0;
+  TemperatureManager::ChangeMask mask = 0;
+};
+
+void onChange(TemperatureManager::ChangeMask changed, void* ctx) {
+  Notified* n = static_cast<Notified*>(ctx);
+  n->calls++;
+  n->mask |= changed;
+}
+
+// Sets every sensor on a bus to `c` and publishes it as a new read pass.
+void readPassAt(uint8_t gpio, float c) {
+  for (auto& d : g_bus[gpio].devices) {
+    d.temperature = c;
+    d.valid = true;
+  }
+  g_bus[gpio].lastReadMs = g_nowMs;
+  g_bus[gpio].generation++;
+}
+
+void advance(uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t += 2) {
+    g_nowMs += 2;
+    TemperatureManager::loop();
+  }
+}
+
+bool expectNotified(const char* what, Notified& n, uint32_t calls, TemperatureManager::ChangeMask mask) {
+  const bool ok = n.calls == calls && n.mask == mask;
+  if (!ok) std::printf("  FAIL: %s: %u calls mask 0x%03X, want %u calls mask 0x%03X\n", what, n.calls, n.mask, calls, mask);
+  n = Notified{};
+  return ok;
+}
+
+bool runSubscriptions() {
+  using namespace TemperatureManager;
+  g_cfg = Config{};
+  g_nowMs = 1;
+  populate();
+  for (uint8_t i = 0; i < kBuses; i++) readPassAt(i, 50.0f);
+  invalidateAll();
+  loop();
+
+  std::printf("Change notifications (return_dallas, 0.5 C / 1 s / stale after 5 s)\n");
+  // Unfiltered, so every read pass reaches the cache as is.
+  TempConditionerConfig raw;
+  raw.medianN = 1;
+  setRoleFilter(TempRole::Return, raw);
+  const ChangeMask want = sourceBit(resolveSourceKey("Return-DS"));
+  Notified n;
+  const int8_t h = subscribe(want, 0.5f, 1000, 5000, onChange, &n);
+  bool ok = h >= 0;
+
+  advance(2);
+  ok &= expectNotified("first loop reports everything", n, 1, want);
+  ok &= takeChanged(h) == want && takeChanged(h) == 0;
+
+  // Below the threshold and on other buses: nothing.
+  advance(2000);
+  readPassAt(DALLAS_RETURN_PIN, 50.3f);
+  readPassAt(DALLAS_TANK_PIN, 40.0f);
+  advance(200);
+  ok &= expectNotified("0.3 C change", n, 0, 0);
+
+  // Over the threshold, but within 1 s of the last notification.
+  readPassAt(DALLAS_RETURN_PIN, 50.6f);
+  advance(2);
+  ok &= expectNotified("0.6 C change after 2 s", n, 1, want);
+  readPassAt(DALLAS_RETURN_PIN, 51.2f);
+  advance(500);
+  ok &= expectNotified("0.6 C change within minInterval", n, 0, 0);
+  advance(600);
+  ok &= expectNotified("deferred 0.6 C change", n, 1, want);
+
+  // Bus stalls: one notification when the value goes stale, none after.
+  advance(6000);
+  ok &= expectNotified("stale", n, 1, want);
+  ok &= !getBySource(SourceId::ReturnDallas, 5000).valid;
+  advance(3000);
+  ok &= expectNotified("still stale", n, 0, 0);
+
+  // Fresh again: validity change bypasses minInterval.
+  readPassAt(DALLAS_RETURN_PIN, 51.2f);
+  advance(2);
+  ok &= expectNotified("fresh again", n, 1, want);
+
+  unsubscribe(h);
+  readPassAt(DALLAS_RETURN_PIN, 60.0f);
+  advance(2000);
+  ok &= expectNotified("after unsubscribe", n, 0, 0);
+  std::printf("\n");
+  setRoleFilter(TempRole::Return, TempConditionerConfig{});
+  return ok;
+}
+
+// Default conditioning (median of 3) on the return role: single bad reads
+// never reach the cache.
+bool runConditioning() {
+  using namespace TemperatureManager;
+  g_cfg = Config{};
+  g_nowMs = 1;
+  populate();
+  invalidateAll();
+  std::printf("Conditioning (return, median 3)\n");
+  bool ok = true;
+  const float seq[] = {45.0f, 45.1f, 85.0f, 45.2f, -127.0f, 61.0f, 45.3f, 45.4f};
+  float worst = 0.0f;
+  for (float t : seq) {
+    readPassAt(DALLAS_RETURN_PIN, t);
+    advance(1000);
+    const TempValue v = get(TempRole::Return, 5000);
+    if (!v.valid) ok = false;
+    else if (fabsf(v.c - 45.2f) > worst) worst = fabsf(v.c - 45.2f);
+  }
+  const RoleFilterStats st = getRoleFilterStats(TempRole::Return);
+  std::printf("  worst deviation %.2f C, rejected %u, spikes %u\n\n", worst, st.rejected, st.spikes);
+  if (worst > 0.3f || st.rejected != 2 || st.spikes != 1) {
+    std::printf("  FAIL: 85.0 / -127 / 61.0 leaked into the return role\n");
+    ok = false;
+  }
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok &= run("AUTO tank roles, no OpenTherm", Config{});
+  Config fixed;
+  fixed.tankRoms[0] = 0x4600000000000028ull;
+  fixed.tankRoms[1] = 0x4400000000000028ull;
+  fixed.tankRoms[2] = 0x4500000000000028ull;
+  ok &= run("Configured tank ROMs, no OpenTherm", fixed);
+  Config ot;
+  ot.otPresent = true;
+  ok &= run("AUTO tank roles, OpenTherm present", ot);
+  ok &= runSubscriptions();
+  ok &= runConditioning();
+  if (!ok) {
+    std::printf("FAIL\n");
+    return 1;
+  }
+  std::printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,294 @@
+// Host replay of mixing-valve feedback traces through TempConditioner.h:
+// how many valve pulses does the Equitherm decision logic issue with raw
+// vs. conditioned feedback?
+//
+// Build and run on Linux (from the repository root):
+//   g++ -std=c++17 -O2 -I. tools/valve_replay.cpp -o /tmp/valve_replay
+//   /tmp/valve_replay                   # synthetic closed loop, 2 h
+//   /tmp/valve_replay trace.csv [45.0]  # recorded trace, open loop
+//
+// The decision model mirrors EquithermController.cpp: evaluated every
+// kEqControlIntervalMs (200 ms), deadband 0.5 C, 30 s minimum interval
+// between actions, 300 ms pulses, hold while the feedback trend already
+// points at the target (same trend estimator and thresholds), no action on
+// invalid feedback.
+//
+// Synthetic trace: the mixed flow follows the valve position with a 40 s
+// lag, the boiler side drifts +-2 C over an hour. The sensor (one read per
+// second, 1/16 C steps, 0.1 C noise) also delivers the DS18B20 failure
+// modes seen on long cables: 85.0 power-on values after a brown-out, single
+// bit errors worth +-16 C, and -127. "bad pulses" are pulses started while
+// the feedback the controller saw was more than 1 C off the true value.
+//
+// CSV format: one "t_ms,temp_c" sample per line, '#' comments allowed.
+// Fails if the default conditioning (median 3) issues more pulses than raw
+// feedback, or more than a tenth of its bad pulses. Median 3 still lets two
+// same-sign bit errors in a row through; median 5 covers that.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../TempConditioner.h"
+
+namespace {
+
+// EquithermController.cpp defaults
+constexpr uint32_t kControlMs = 200;
+constexpr float kDeadbandC = 0.5f;
+constexpr uint32_t kMinIntervalMs = 30000;
+constexpr uint32_t kPulseMs = 300;
+constexpr float kTrendStrongCps = 0.020f;
+constexpr uint32_t kTravelMs = 60000;
+
+constexpr uint32_t kSampleMs = 1000;
+constexpr float kTargetC = 45.0f;
+
+struct Sample {
+  uint32_t ms;
+  float c;
+};
+
+// Deterministic, so every filter sees the same sensor faults.
+struct Rng {
+  uint32_t s = 0x2545F491u;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  float uniform() { return (float)(next() >> 8) / 16777216.0f; }
+  float gauss() {
+    float a = 0.0f;
+    for (int i = 0; i < 4; i++) a += uniform();
+    return (a - 2.0f) * 1.7320508f;  // ~N(0,1)
+  }
+};
+
+// updateMixFeedbackTrend() and mixShouldHoldForTrend() from Equitherm.
+struct Valve {
+  float lastC = NAN;
+  uint32_t lastMs = 0;
+  float trendCps = 0.0f;
+  uint32_t lastActMs = 0;
+  bool acted = false;
+  uint32_t pulses = 0;
+  uint32_t badPulses = 0;
+
+  float trend(float c, bool valid, uint32_t now) {
+    if (!valid) {
+      lastC = NAN;
+      lastMs = 0;
+      trendCps = 0.0f;
+      return 0.0f;
+    }
+    if (std::isnan(lastC) || lastMs == 0 || now <= lastMs) {
+      lastC = c;
+      lastMs = now;
+      trendCps = 0.0f;
+      return 0.0f;
+    }
+    const uint32_t dt = now - lastMs;
+    if (dt < 800) return trendCps;
+    const float inst = (c - lastC) / ((float)dt / 1000.0f);
+    lastC = c;
+    lastMs = now;
+    trendCps = 0.65f * trendCps + 0.35f * inst;
+    return trendCps;
+  }
+
+  // Returns -1/0/+1: close, nothing, open.
+  int decide(float c, bool valid, float target, uint32_t now) {
+    const float tr = trend(c, valid, now);
+    if (!valid) return 0;
+    const float err = target - c;
+    const bool wantsOpen = c + kDeadbandC < target;
+    const bool wantsClose = c - kDeadbandC > target;
+    if (!wantsOpen && !wantsClose) return 0;
+    float hold = kDeadbandC * 4.0f;
+    if (hold < 1.5f) hold = 1.5f;
+    if (fabsf(err) <= hold && ((err > 0 && tr > kTrendStrongCps) || (err < 0 && tr < -kTrendStrongCps))) return 0;
+    if (acted && now - lastActMs < kMinIntervalMs) return 0;
+    acted = true;
+    lastActMs = now;
+    pulses++;
+    return wantsOpen ? 1 : -1;
+  }
+};
+
+struct Filter {
+  const char* name;
+  bool conditioned;
+  TempConditionerConfig cfg;
+};
+
+// What the controller reads between samples: the latest value, valid while
+// it is not older than 5 s (the feedback maxAge used by Equitherm).
+struct Feedback {
+  TempConditioner cond;
+  bool conditioned = false;
+  float c = NAN;
+  uint32_t ms = 0;
+  bool have = false;
+
+  void push(float x, uint32_t t) {
+    if (!conditioned) {
+      c = x;
+      ms = t;
+      have = true;
+      return;
+    }
+    cond.push(x, t);
+    if (cond.valid()) {
+      c = cond.value();
+      ms = cond.sampleMs();
+      have = true;
+    }
+  }
+  bool valid(uint32_t now) const { return have && now - ms <= 5000; }
+};
+
+struct Result {
+  uint32_t pulses = 0;
+  uint32_t badPulses = 0;
+  double sqErr = 0.0;
+  uint32_t errN = 0;
+  uint32_t rejected = 0;
+  uint32_t spikes = 0;
+};
+
+Result simulate(const Filter& f, uint32_t durationMs) {
+  Rng rng;
+  Feedback fb;
+  fb.conditioned = f.conditioned;
+  fb.cond.configure(f.cfg);
+  Valve v;
+  Result r;
+
+  float pos = 40.0f;  // %
+  float mixed = 30.0f + 0.3f * pos;
+  uint32_t pulseEndMs = 0;
+  int pulseDir = 0;
+  for (uint32_t t = 0; t < durationMs; t += kControlMs) {
+    // Plant: boiler side drifts, mixed flow lags the valve.
+    const float boiler = 60.0f + 2.0f * sinf((float)t / 3600000.0f * 6.2831853f);
+    const float mixTarget = 30.0f + (boiler - 30.0f) * pos / 100.0f;
+    mixed += (mixTarget - mixed) * (float)kControlMs / (40000.0f + kControlMs);
+    if (pulseDir && t < pulseEndMs) {
+      pos += pulseDir * 100.0f * kControlMs / kTravelMs;
+      if (pos < 0.0f) pos = 0.0f;
+      if (pos > 100.0f) pos = 100.0f;
+    } else {
+      pulseDir = 0;
+    }
+
+    if (t % kSampleMs == 0) {
+      float x = roundf((mixed + 0.1f * rng.gauss()) * 16.0f) / 16.0f;
+      const uint32_t k = rng.next() % 1000;
+      if (k < 4) x = 85.0f;                                    // power-on value
+      else if (k < 12) x += (rng.next() & 1) ? 16.0f : -16.0f;  // bit error
+      else if (k < 14) x = -127.0f;
+      fb.push(x, t);
+      if (t > 600000) {
+        r.sqErr += (double)(mixed - kTargetC) * (mixed - kTargetC);
+        r.errN++;
+      }
+    }
+
+    const bool ok = fb.valid(t);
+    const int d = v.decide(fb.c, ok, kTargetC, t);
+    if (d) {
+      pulseDir = d;
+      pulseEndMs = t + kPulseMs;
+      if (fabsf(fb.c - mixed) > 1.0f) v.badPulses++;
+    }
+  }
+  r.pulses = v.pulses;
+  r.badPulses = v.badPulses;
+  r.rejected = fb.cond.rejected();
+  r.spikes = fb.cond.spikes();
+  return r;
+}
+
+Result replay(const Filter& f, const std::vector<Sample>& trace, float target) {
+  Feedback fb;
+  fb.conditioned = f.conditioned;
+  fb.cond.configure(f.cfg);
+  Valve v;
+  Result r;
+  if (trace.empty()) return r;
+  size_t i = 0;
+  for (uint32_t t = trace.front().ms; t <= trace.back().ms; t += kControlMs) {
+    while (i < trace.size() && trace[i].ms <= t) {
+      fb.push(trace[i].c, trace[i].ms);
+      i++;
+    }
+    v.decide(fb.c, fb.valid(t), target, t);
+  }
+  r.pulses = v.pulses;
+  r.rejected = fb.cond.rejected();
+  r.spikes = fb.cond.spikes();
+  return r;
+}
+
+bool loadCsv(const char* path, std::vector<Sample>& out) {
+  FILE* fp = std::fopen(path, "r");
+  if (!fp) return false;
+  char line[128];
+  while (std::fgets(line, sizeof(line), fp)) {
+    if (line[0] == '#') continue;
+    unsigned long ms = 0;
+    float c = 0.0f;
+    if (std::sscanf(line, "%lu,%f", &ms, &c) == 2) out.push_back(Sample{(uint32_t)ms, c});
+  }
+  std::fclose(fp);
+  return !out.empty();
+}
+
+const Filter kFilters[] = {
+  {"raw (before)", false, {1, 0}},
+  {"plausibility only", true, {1, 0}},
+  {"median 3 (default)", true, {3, 0}},
+  {"median 3 + tau 10 s", true, {3, 10000}},
+  {"median 5 + tau 20 s", true, {5, 20000}},
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    std::vector<Sample> trace;
+    if (!loadCsv(argv[1], trace)) {
+      std::printf("cannot read %s\n", argv[1]);
+      return 2;
+    }
+    const float target = argc > 2 ? (float)std::atof(argv[2]) : kTargetC;
+    std::printf("%s: %zu samples, target %.1f C (open loop)\n", argv[1], trace.size(), target);
+    std::printf("  %-22s %8s %9s %7s\n", "feedback", "pulses", "rejected", "spikes");
+    for (const Filter& f : kFilters) {
+      const Result r = replay(f, trace, target);
+      std::printf("  %-22s %8u %9u %7u\n", f.name, r.pulses, r.rejected, r.spikes);
+    }
+    return 0;
+  }
+
+  const uint32_t durationMs = 2u * 3600u * 1000u;
+  std::printf("Synthetic closed loop, 2 h, target %.1f C\n", kTargetC);
+  std::printf("  %-22s %8s %10s %9s %9s %7s\n", "feedback", "pulses", "bad", "rms C", "rejected", "spikes");
+  Result res[sizeof(kFilters) / sizeof(kFilters[0])];
+  for (size_t i = 0; i < sizeof(kFilters) / sizeof(kFilters[0]); i++) {
+    const Result& r = res[i] = simulate(kFilters[i], durationMs);
+    std::printf("  %-22s %8u %10u %9.2f %9u %7u\n", kFilters[i].name, r.pulses, r.badPulses,
+                r.errN ? std::sqrt(r.sqErr / r.errN) : 0.0, r.rejected, r.spikes);
+  }
+  const Result& raw = res[0];
+  const Result& def = res[2];
+  if (def.pulses > raw.pulses || def.badPulses * 10 > raw.badPulses) {
+    std::printf("FAIL: median 3 did not keep bad samples away from the valve\n");
+    return 1;
+  }
+  std::printf("OK\n");
+  return 0;
+}